@@ -24,8 +24,17 @@ constexpr int TEMP_NIGHT     = 2900;
 constexpr int CLOUD_THRESHOLD = 75;
 
 /* Timing */
-constexpr int WEATHER_REFRESH_SEC = 900;   /* 15 minutes */
-constexpr int TEMP_UPDATE_SEC     = 60;    /* 1 minute   */
+constexpr int WEATHER_REFRESH_SEC = 900;   /* 15 minutes, cache without a timeline */
+constexpr int WEATHER_RETRY_SEC   = 60;    /* after a failed fetch */
+
+/* Timeline refresh: refetch once the forecast is this old, or earlier if
+   fewer than WEATHER_MIN_HORIZON_SEC of forecast hours remain */
+constexpr int WEATHER_MAX_AGE_SEC     = 3 * 3600;
+constexpr int WEATHER_MIN_HORIZON_SEC = 12 * 3600;
+
+/* Scheduler granularity: wake when the output has moved this many Kelvin.
+ * 1 = every integer change; larger values trade resolution for wakeups. */
+constexpr int TEMP_STEP_K = 1;
 
 /* Transition windows (minutes) */
 constexpr int DAWN_DURATION = 90;
@@ -43,14 +52,25 @@ constexpr double SIGMOID_STEEPNESS = 8.0;
 /* Path buffer size */
 #define ABRAXAS_PATH_MAX 512
 
+/* System daemon (--system): state directory and the socket every user's
+ * CLI tries when no daemon of their own is listening */
+#define ABRAXAS_SYSTEM_DIR    "/var/lib/abraxas"
+#define ABRAXAS_SYSTEM_SOCKET "/run/abraxas/control.sock"
+
 /* Resolved filesystem paths */
 typedef struct {
     char config_dir[ABRAXAS_PATH_MAX];     /* ~/.config/abraxas         */
     char config_file[ABRAXAS_PATH_MAX];    /* ~/.config/abraxas/config.ini */
     char cache_file[ABRAXAS_PATH_MAX];     /* ~/.config/abraxas/weather_cache.json */
+    char grid_file[ABRAXAS_PATH_MAX];      /* ~/.config/abraxas/gridpoint.json */
     char override_file[ABRAXAS_PATH_MAX];  /* ~/.config/abraxas/override.json */
     char zipdb_file[ABRAXAS_PATH_MAX];     /* ~/.config/abraxas/us_zipcodes.bin */
     char pid_file[ABRAXAS_PATH_MAX];       /* ~/.config/abraxas/daemon.pid */
+    char control_socket[ABRAXAS_PATH_MAX]; /* ~/.config/abraxas/control.sock */
+    char status_page[ABRAXAS_PATH_MAX];    /* ~/.config/abraxas/status */
+    char probe_file[ABRAXAS_PATH_MAX];     /* ~/.config/abraxas/backend.json */
+    char snapshot_file[ABRAXAS_PATH_MAX];  /* ~/.config/abraxas/state.bin */
+    char schedule_file[ABRAXAS_PATH_MAX];  /* ~/.config/abraxas/schedule.bin */
 } abraxas_paths_t;
 
 /* Geographic location */
@@ -60,16 +80,36 @@ typedef struct {
     bool   valid;
 } location_t;
 
+/* Hourly forecast periods kept (NOAA publishes ~156) */
+#define WEATHER_HOURS_MAX 168
+
 /* Cached weather data */
 typedef struct {
-    int     cloud_cover;           /* 0-100 % */
+    int     cloud_cover;           /* 0-100 %, first period */
     char    forecast[128];         /* short description */
     double  temperature;           /* F from NOAA */
     bool    is_day;
     time_t  fetched_at;            /* epoch seconds */
     bool    has_error;
+
+    /* Cloud cover per forecast hour: cloud[i] covers
+       [timeline_start + i h, timeline_start + (i+1) h) */
+    time_t  timeline_start;
+    int     timeline_hours;        /* 0 = no timeline, use cloud_cover */
+    uint8_t cloud[WEATHER_HOURS_MAX];
 } weather_data_t;
 
+/* Resolved NOAA gridpoint and HTTP validators (persisted to gridpoint.json).
+   'point' is the "lat,lon" key of the /points request the URL came from;
+   etag/last_modified belong to the last forecast response parsed. */
+typedef struct {
+    bool    valid;
+    char    point[48];
+    char    forecast_url[512];
+    char    etag[128];
+    char    last_modified[64];
+} gridpoint_cache_t;
+
 /* Manual override state (persisted to override.json) */
 typedef struct {
     bool    active;
@@ -77,6 +117,7 @@ typedef struct {
     int     duration_minutes;
     time_t  issued_at;             /* epoch seconds */
     int     start_temp;            /* Kelvin at moment of override */
+    int     fade_ms;               /* frame-rate fade instead of minutes; 0 = none */
 } override_state_t;
 
 /* Full daemon runtime state */
@@ -0,0 +1,25 @@
+/*
+ * alloccount.h - Process-wide heap allocation counter
+ *
+ * The check build (make ALLOC_CHECK=1, abraxas-alloc-check) interposes
+ * malloc, calloc and realloc on glibc's own allocator, so every heap
+ * allocation in the process -- ours, libmeridian's, glibc-internal ones
+ * like fopen's FILE -- bumps one counter. abraxas --alloc-check reads it
+ * around the daemon's tick, and the daemon around each steady-state
+ * wakeup, to prove the steady state allocates nothing.
+ *
+ * The regular build and static musl builds leave the libc allocator
+ * alone; the counter is unavailable there and always reads 0.
+ */
+
+#ifndef ABRAXAS_ALLOCCOUNT_H
+#define ABRAXAS_ALLOCCOUNT_H
+
+#include <stdbool.h>
+
+/* Allocations counted so far (malloc, calloc, and realloc calls) */
+unsigned long alloc_count(void);
+
+bool alloc_count_available(void);
+
+#endif /* ABRAXAS_ALLOCCOUNT_H */
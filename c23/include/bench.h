@@ -0,0 +1,25 @@
+/*
+ * bench.h - Benchmark harness behind --benchmark
+ *
+ * Every case is warmed up, then timed as a few hundred samples of a
+ * calibrated batch of calls. Reports p50/p99/max per call, the mean with
+ * outliers (Tukey fence) removed, and cycles/instructions per call from
+ * perf_event_open when the kernel allows it. Parsing cases read the
+ * fixture corpus in bench/fixtures instead of the user's config.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "abraxas.h"
+
+typedef struct {
+    bool        json;       /* one JSON document on stdout instead of the table */
+    const char *fixtures;   /* fixture directory; nullptr searches bench/fixtures
+                               and ../bench/fixtures */
+} bench_options_t;
+
+/* Run every case. Returns the process exit code. */
+int bench_run(const abraxas_paths_t *paths, const bench_options_t *opt);
+
+#endif /* BENCH_H */
@@ -9,11 +9,16 @@
 #define CONFIG_H
 
 #include "abraxas.h"
+#include "meridian.h"
 
 /* Initialize all paths from $HOME. Creates config dir if needed.
    Returns false on failure ($HOME not set, mkdir failed). */
 bool config_init_paths(abraxas_paths_t *paths);
 
+/* Paths for the system daemon (--system): ABRAXAS_SYSTEM_DIR, with the
+   control socket at ABRAXAS_SYSTEM_SOCKET. Creates the directory. */
+bool config_init_system_paths(abraxas_paths_t *paths);
+
 /* Load location from config.ini. Returns location_t with valid=false if missing. */
 location_t config_load_location(const abraxas_paths_t *paths);
 
@@ -35,9 +40,26 @@ weather_data_t config_load_weather_cache(const abraxas_paths_t *paths);
 /* Save weather cache. */
 bool config_save_weather_cache(const abraxas_paths_t *paths, const weather_data_t *wd);
 
+/* Load the cached gridpoint. Returns with valid=false if missing/invalid. */
+gridpoint_cache_t config_load_gridpoint(const abraxas_paths_t *paths);
+
+/* Save the cached gridpoint (valid=false removes the file). */
+bool config_save_gridpoint(const abraxas_paths_t *paths, const gridpoint_cache_t *gp);
+
+/* Epoch second after which the cache is stale: forecast age or remaining
+   horizon with a timeline, a fixed interval without one. 0 = stale now. */
+time_t config_weather_refresh_at(const weather_data_t *wd);
+
 /* Check if weather cache needs refresh. */
 bool config_weather_needs_refresh(const weather_data_t *wd);
 
+/* Load the backend probe record from backend.json. Returns false (and
+   card_num -1) if missing/invalid. */
+bool config_load_probe(const abraxas_paths_t *paths, meridian_probe_t *probe);
+
+/* Save the backend probe record. */
+bool config_save_probe(const abraxas_paths_t *paths, const meridian_probe_t *probe);
+
 /* Check if daemon process is alive via PID file. */
 bool config_check_daemon_alive(const abraxas_paths_t *paths);
 
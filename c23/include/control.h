@@ -0,0 +1,69 @@
+/*
+ * control.h - Daemon control socket
+ *
+ * The CLI's --set, --resume and --refresh talk to a running daemon over a
+ * SOCK_SEQPACKET Unix socket in the config directory: one request
+ * message, one reply message carrying the state the daemon applied.
+ * override.json is still written, by the daemon, as the snapshot it
+ * recovers from on restart.
+ *
+ * Wire format is one text line each way:
+ *   set TEMP MINUTES [FADE_MS] | resume | refresh
+ *   ok temp=K manual=0|1 target=K duration=MIN resume_at=EPOCH clouds=PCT forecast=TEXT
+ *   err MESSAGE
+ */
+
+#ifndef ABRAXAS_CONTROL_H
+#define ABRAXAS_CONTROL_H
+
+#include "abraxas.h"
+
+#define CONTROL_MSG_MAX 256
+
+typedef enum {
+    CONTROL_SET,
+    CONTROL_RESUME,
+    CONTROL_REFRESH,
+} control_op_t;
+
+typedef struct {
+    control_op_t op;
+    int          target_temp;       /* CONTROL_SET */
+    int          duration_minutes;  /* CONTROL_SET */
+    int          fade_ms;           /* CONTROL_SET: seconds-scale fade, 0 = none */
+} control_request_t;
+
+typedef struct {
+    bool   ok;
+    int    temp;                /* applied now; 0 = nothing applied yet */
+    bool   manual;
+    int    target_temp;         /* manual only */
+    int    duration_minutes;
+    time_t resume_at;           /* manual only: auto-resume instant */
+    int    cloud_cover;         /* CONTROL_REFRESH; -1 = fetch failed */
+    char   forecast[64];
+    char   error[96];           /* !ok */
+} control_reply_t;
+
+/* --- Daemon side --- */
+
+/* Bind and listen on path (mode 0600; the system daemon widens it). A socket a live daemon still
+   answers on is left alone; a stale one is replaced. Returns the fd or -1. */
+int control_listen(const char *path);
+
+/* Parse one request message. Returns false on anything malformed. */
+bool control_parse_request(const char *msg, size_t len, control_request_t *req);
+
+/* Format a reply into buf. Returns the message length (no terminator sent). */
+size_t control_format_reply(const control_reply_t *reply, char *buf, size_t cap);
+
+/* --- CLI side --- */
+
+/* Send req to the daemon and wait for its reply. Without one on
+   paths->control_socket the system daemon's ABRAXAS_SYSTEM_SOCKET is tried.
+   Returns 0 with *reply filled, -1 if no daemon is listening,
+   -2 if one is but the exchange failed or timed out. */
+int control_send(const abraxas_paths_t *paths, const control_request_t *req,
+                 control_reply_t *reply);
+
+#endif /* ABRAXAS_CONTROL_H */
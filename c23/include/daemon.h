@@ -9,8 +9,59 @@
 #define DAEMON_H
 
 #include "abraxas.h"
+#include "snapshot.h"
 
-/* Run the daemon event loop. Does not return until signal received. */
-void daemon_run(daemon_state_t *state);
+#include <stdio.h>
+#include <time.h>
+
+/* Run the daemon event loop until a shutdown signal. loaded is the
+   state.bin read at startup, or nullptr. Returns the process exit status:
+   nonzero if the display or the fetch worker was lost for good. */
+int daemon_run(daemon_state_t *state, const snapshot_t *loaded);
+
+/* --- Simulation (abraxas --simulate) --- */
+
+/* Events one simulation accepts */
+#define SIM_EVENTS_MAX 4096
+
+typedef enum {
+    SIM_SET,            /* override to temp over minutes (0 = instant) */
+    SIM_RESUME,         /* clear the override */
+    SIM_CLOUDS,         /* flat cloud cover from here on */
+} sim_event_kind_t;
+
+typedef struct {
+    time_t           at;
+    sim_event_kind_t kind;
+    int              temp;          /* SIM_SET, Kelvin */
+    int              minutes;       /* SIM_SET */
+    int              clouds;        /* SIM_CLOUDS, percent */
+} sim_event_t;
+
+/* What the ticks from count_from on cost the heap (abraxas --alloc-check) */
+typedef struct {
+    long          ticks;
+    long          sets;             /* ticks that applied a ramp */
+    unsigned long allocs;
+} sim_alloc_stats_t;
+
+typedef struct {
+    time_t             start;
+    time_t             end;
+    const sim_event_t *events;      /* in time order */
+    int                event_count;
+    FILE              *record;      /* one line per applied ramp, or nullptr */
+    time_t             count_from;  /* with alloc_stats: warm-up ends here */
+    sim_alloc_stats_t *alloc_stats; /* count allocations per tick, or nullptr */
+} sim_options_t;
+
+/* Drive the daemon's tick from start to end on a virtual clock, jumping
+   from one wakeup deadline to the next, against the null gamma backend.
+   Logs to stderr like the daemon and ends with a throughput summary.
+   Nothing in the config dir is read besides schedule.bin, or written.
+   With alloc_stats, ramps are computed even without a record, and every
+   tick's allocations are counted; applying events is not part of a tick.
+   Returns 0 on success. */
+int daemon_simulate(daemon_state_t *state, const sim_options_t *opt);
 
 #endif /* DAEMON_H */
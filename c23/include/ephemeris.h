@@ -0,0 +1,85 @@
+/*
+ * ephemeris.h - Per-day solar ephemeris and minute temperature tables
+ *
+ * The NOAA math and sigmoid curve are evaluated once per local day and
+ * location; the daemon tick then reduces to a table lookup. Entry i
+ * holds the value at local midnight + i minutes; elevation lookups
+ * interpolate linearly between neighbouring minutes. The temperature
+ * comes from a list of the seconds where each curve's whole Kelvin
+ * changes, indexed by minute.
+ */
+
+#ifndef EPHEMERIS_H
+#define EPHEMERIS_H
+
+#include "solar.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/* Longest local day (DST fall-back) in minutes */
+#define EPHEM_MINUTES_MAX (25 * 60)
+
+/* Whole-Kelvin steps one curve can take in a day: dawn and dusk each
+   cross TEMP_DAY_CLEAR - TEMP_NIGHT, plus jumps where windows overlap */
+#define EPHEM_STEPS_MAX (2 * (6500 - 2900) + 16)
+
+/* One curve as a step function: kelvin[j] holds from day second sec[j]
+   until sec[j + 1]. Step 0 is at second 0. */
+typedef struct {
+    int         count;
+    int16_t     at[EPHEM_MINUTES_MAX + 1];  /* step holding at each minute */
+    int32_t     sec[EPHEM_STEPS_MAX];
+    int16_t     kelvin[EPHEM_STEPS_MAX];
+} ephemeris_steps_t;
+
+typedef struct {
+    bool        valid;
+    double      lat;
+    double      lon;
+
+    time_t      day_start;          /* local midnight */
+    time_t      day_end;            /* next local midnight */
+    int         minutes;            /* entries used, minus one */
+
+    sun_times_t sun;
+    time_t      dawn_start, dawn_end;   /* transition windows (epoch) */
+    time_t      dusk_start, dusk_end;
+
+    float       temp[2][EPHEM_MINUTES_MAX + 1];  /* [0] clear, [1] dark */
+    float       elevation[EPHEM_MINUTES_MAX + 1];
+    ephemeris_steps_t steps[2];     /* calculate_solar_temp() to the second */
+} ephemeris_t;
+
+/* Local midnight starting the day containing 'now', and the next one. */
+void ephemeris_day_bounds(time_t now, time_t *day_start, time_t *day_end);
+
+/* Compute the ephemeris for the local day containing 'now'. */
+void ephemeris_build(ephemeris_t *e, time_t now, double lat, double lon);
+
+/* Derive steps[] from sun, day_start and minutes. ephemeris_build() does
+   this itself; a day filled in from elsewhere (schedule.bin) needs it. */
+void ephemeris_build_steps(ephemeris_t *e);
+
+/* The tables hold the local day containing 'now' at lat/lon. */
+bool ephemeris_current(const ephemeris_t *e, time_t now, double lat, double lon);
+
+/* Rebuild if 'now' left the cached day or the location moved.
+   Returns true if the tables were recomputed. */
+bool ephemeris_refresh(ephemeris_t *e, time_t now, double lat, double lon);
+
+/* Force the next refresh to rebuild (config reload, TZ or clock change). */
+void ephemeris_invalidate(ephemeris_t *e);
+
+/* Solar color temperature at 'now' (Kelvin). */
+int ephemeris_temp(const ephemeris_t *e, time_t now, bool is_dark_mode);
+
+/* Sun elevation at 'now' (degrees). */
+double ephemeris_elevation(const ephemeris_t *e, time_t now);
+
+/* Epoch second at which ephemeris_temp() next moves TEMP_STEP_K.
+   Returns day_end when nothing changes for the rest of the day. */
+time_t ephemeris_next_change(const ephemeris_t *e, time_t now, bool is_dark_mode);
+
+#endif /* EPHEMERIS_H */
@@ -0,0 +1,59 @@
+/*
+ * fade.h - Frame-rate manual override fades
+ *
+ * `--set TEMP 2s` fades over seconds instead of minutes. The Kelvin value
+ * of every display frame is tabulated when the fade starts; the daemon
+ * then uploads one entry per refresh and never recomputes the curve. A
+ * frame that comes due while the previous one is still in flight, or
+ * after the loop overslept, is skipped rather than queued.
+ */
+
+#ifndef FADE_H
+#define FADE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* 5 s at 144 Hz; faster displays are stepped at 720 per fade */
+#define FADE_MAX_FRAMES 720
+
+constexpr int FADE_MIN_MS = 100;
+constexpr int FADE_MAX_MS = 5000;
+
+/* Used when the backend cannot report the display refresh rate */
+constexpr int FADE_DEFAULT_MHZ = 60000;
+
+typedef struct {
+    bool    active;
+    int     start_temp;
+    int     target_temp;
+    int     frames;             /* entries used in temp[] */
+    int     shown;              /* last uploaded frame, -1 = none yet */
+    int     stride;             /* frames advanced per upload, 1 unless over budget */
+    int     dropped;            /* frames skipped so far */
+    int64_t start_ns;           /* CLOCK_MONOTONIC at frame 0 */
+    int64_t period_ns;
+    int64_t budget_ns;          /* allowed upload time per frame */
+    int     temp[FADE_MAX_FRAMES];
+} fade_t;
+
+/* Tabulate a sigmoid from start_temp to target_temp over duration_ms at
+   refresh_mhz (0 = unknown), frame 0 due at now_ns. The last frame is
+   exactly target_temp. */
+void fade_start(fade_t *f, int start_temp, int target_temp, int duration_ms,
+                int refresh_mhz, int64_t now_ns);
+
+/* Frame to upload at now_ns, or -1 if the one shown is still current. */
+int fade_due(const fade_t *f, int64_t now_ns);
+
+/* Record that frame idx was uploaded in upload_ns. Uploads over budget
+   widen the stride; uploads well under it narrow it again. */
+void fade_shown(fade_t *f, int idx, int64_t upload_ns);
+
+/* CLOCK_MONOTONIC instant the next frame comes due. */
+int64_t fade_next_ns(const fade_t *f);
+
+/* The last frame has been uploaded. */
+bool fade_finished(const fade_t *f);
+
+#endif /* FADE_H */
@@ -3,13 +3,21 @@
  *
  * Mirrors RFC 8259 grammar. Read-only: parse, navigate, extract, free.
  * No writer (fprintf handles our known schemas).
- * No mutation, streaming, custom allocators, or Windows compat.
+ * No mutation or Windows compat.
+ *
+ * Three ways in:
+ *   json_parse()        heap DOM, one allocation per node, json_free()
+ *   json_parse_arena()  same DOM bump-allocated in a json_arena_t,
+ *                       released in one json_arena_free()
+ *   json_scan()         no DOM: skip-scans the text for a few dot-paths
+ *                       and stops once all of them are found
  */
 
 #ifndef JSON_H
 #define JSON_H
 
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef enum {
     JSON_NULL,
@@ -27,6 +35,30 @@ typedef struct json_value json_value_t;
 /* Parse a JSON text. Returns nullptr on error. Caller must json_free(). */
 [[nodiscard]] json_value_t *json_parse(const char *text);
 
+/* --- Arena --- */
+
+typedef struct json_chunk json_chunk_t;
+
+/*
+ * Bump allocator. Starts in an optional caller buffer (typically on the
+ * stack) and falls back to heap chunks when that runs out.
+ */
+typedef struct {
+    char         *buf;
+    size_t        used;
+    size_t        size;
+    json_chunk_t *chunks;   /* heap overflow, newest first */
+} json_arena_t;
+
+/* Start an arena in buf[0..size) (buf may be nullptr). */
+void json_arena_init(json_arena_t *arena, void *buf, size_t size);
+
+/* Release every heap chunk; values parsed into the arena become invalid. */
+void json_arena_free(json_arena_t *arena);
+
+/* Parse into the arena. Do not json_free() the result. Returns nullptr on error. */
+[[nodiscard]] json_value_t *json_parse_arena(const char *text, json_arena_t *arena);
+
 /* --- Navigate --- */
 
 /* Get value by key from an object. Returns nullptr if not object or key missing. */
@@ -35,7 +67,8 @@ typedef struct json_value json_value_t;
 /* Get value by index from an array. Returns nullptr if not array or out of bounds. */
 [[nodiscard]] const json_value_t *json_at(const json_value_t *arr, int index);
 
-/* Navigate a dot-separated path (e.g. "properties.periods"). */
+/* Navigate a dot-separated path (e.g. "properties.periods.0").
+   Numeric segments index arrays. */
 [[nodiscard]] const json_value_t *json_path(const json_value_t *root, const char *dotpath);
 
 /* --- Extract --- */
@@ -46,6 +79,50 @@ double       json_number(const json_value_t *val);    /* 0.0 if not number   */
 bool         json_bool(const json_value_t *val);      /* false if not bool   */
 int          json_count(const json_value_t *val);     /* array/object count  */
 
+/* --- Scan (no DOM) --- */
+
+/* Most targets one json_scan() call resolves */
+#define JSON_SCAN_MAX 16
+
+/*
+ * One dot-path to find. Same syntax as json_path(); keys are compared
+ * with their raw (still escaped) spelling. On a hit, [start, start+len)
+ * is the value's text, e.g. "\"Sunny\"" or "{...}".
+ */
+typedef struct {
+    const char  *path;      /* in */
+    bool         found;     /* out */
+    json_type_t  type;
+    const char  *start;
+    size_t       len;
+} json_target_t;
+
+/*
+ * Locate targets in text without allocating. Subtrees no target runs
+ * through are skipped by bracket matching, not parsed, and the scan
+ * returns as soon as every target is found -- usually long before the
+ * end of a large response. A path seen twice resolves to its first hit.
+ *
+ * Returns: number of targets found, or -1 on malformed input before
+ *          the last one (hits recorded so far stay valid)
+ */
+int json_scan(const char *text, json_target_t *targets, int count);
+
+/* Decode a found JSON_STRING target into out[0..cap), truncating to fit;
+   always terminated. Returns false if the target is not a string. */
+bool   json_target_string(const json_target_t *t, char *out, size_t cap);
+double json_target_number(const json_target_t *t);   /* 0.0 if not number */
+bool   json_target_bool(const json_target_t *t);     /* false if not bool */
+
+/*
+ * Step through the elements of a found JSON_ARRAY target, still without
+ * a DOM. *iter must be nullptr on the first call; each call sets elem to
+ * the next element (usable as json_scan() text). Returns false after the
+ * last element or on malformed input.
+ */
+bool   json_target_next(const json_target_t *array, const char **iter,
+                        json_target_t *elem);
+
 /* --- Cleanup --- */
 
 /* Free entire tree. Safe to call with nullptr. */
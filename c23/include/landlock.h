@@ -19,4 +19,9 @@
  * Gracefully returns false if kernel doesn't support landlock. */
 bool landlock_install_sandbox(const char *config_dir);
 
+/* The fetch worker's sandbox, inherited by each curl it runs: /usr, /lib,
+ * /etc and the resolver's directory readable, /usr executable, nothing
+ * writable anywhere. Returns true on success. */
+bool landlock_install_worker_sandbox(void);
+
 #endif /* ABRAXAS_LANDLOCK_H */
@@ -0,0 +1,100 @@
+/*
+ * schedule.h - Precomputed solar schedule file
+ *
+ * `abraxas --export-schedule FILE` writes a year of ephemeris days for
+ * one location: per-day sun and transition-window boundaries plus the
+ * clear and dark Kelvin curves and sun elevation at every minute. Copied
+ * to ~/.config/abraxas/schedule.bin, the daemon maps it and fills each
+ * day's ephemeris from it instead of running the NOAA math and sigmoid.
+ *
+ * Layout: a 64-byte header, then 'days' fixed-size records sorted by
+ * day_start, one per local day in the exporting machine's timezone.
+ * Kelvin is stored in 1/SCHEDULE_TEMP_SCALE K and elevation in
+ * 1/SCHEDULE_ELEV_SCALE degrees, so a lookup is within half a step of
+ * the live tables. All fields little-endian.
+ *
+ * A day is only taken from the file when the header's location and
+ * curve id match this build and config.ini, and the record's day
+ * boundaries match local midnight here; anything else is computed live.
+ * Replace the file by rename, never by rewriting it in place: a mapped
+ * file that shrinks under the daemon faults on the next read.
+ */
+
+#ifndef SCHEDULE_H
+#define SCHEDULE_H
+
+#include "ephemeris.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#define SCHEDULE_MAGIC    "ABSC"
+#define SCHEDULE_VERSION  1
+
+/* A leap year's worth, so an export always reaches the same date next year */
+constexpr int SCHEDULE_DAYS        = 366;
+constexpr int SCHEDULE_TEMP_SCALE  = 8;      /* 1/8 K */
+constexpr int SCHEDULE_ELEV_SCALE  = 100;    /* 1/100 degree */
+
+typedef struct {
+    char     magic[4];          /* SCHEDULE_MAGIC */
+    uint16_t version;           /* SCHEDULE_VERSION */
+    uint16_t header_size;       /* sizeof(schedule_header_t) */
+    uint32_t day_size;          /* sizeof(schedule_day_t) */
+    uint32_t days;
+    uint32_t minutes_max;       /* EPHEM_MINUTES_MAX */
+    uint32_t curve_id;          /* schedule_curve_id() of the exporter */
+    uint16_t temp_scale;
+    uint16_t elev_scale;
+    uint32_t pad0;
+    double   lat;
+    double   lon;
+    int64_t  created_at;        /* epoch seconds */
+    int64_t  pad1;
+} schedule_header_t;
+
+typedef struct {
+    int64_t  day_start;         /* local midnight */
+    int64_t  day_end;           /* next local midnight */
+    int64_t  sunrise, sunset;
+    int64_t  dawn_start, dawn_end;
+    int64_t  dusk_start, dusk_end;
+    int32_t  minutes;           /* entries used, minus one */
+    int32_t  sun_valid;         /* 0 = polar day or night */
+    uint16_t temp[2][EPHEM_MINUTES_MAX + 1];   /* [0] clear, [1] dark */
+    int16_t  elevation[EPHEM_MINUTES_MAX + 1];
+} schedule_day_t;
+
+/* An open schedule; keep it mapped for the daemon's lifetime. */
+typedef struct {
+    const uint8_t           *map;
+    size_t                   size;
+    const schedule_header_t *hdr;
+    const schedule_day_t    *day;   /* hdr->days records */
+} schedule_t;
+
+/* Hash of the curve constants and sigmoid shape this build computes. */
+uint32_t schedule_curve_id(void);
+
+/* Compute 'days' local days starting with the one containing 'from'
+   and write them to 'path' (via a temporary file and rename). */
+bool schedule_export(const char *path, double lat, double lon, time_t from, int days);
+
+/* Map 'path' read-only. Returns false if missing, malformed or written
+   by a build with another layout or curve. */
+bool schedule_open(schedule_t *s, const char *path);
+
+/* Unmap; safe on a closed or failed schedule. */
+void schedule_close(schedule_t *s);
+
+/* The schedule was exported for lat/lon. */
+bool schedule_matches(const schedule_t *s, double lat, double lon);
+
+/* Fill 'e' for the local day containing 'now' from the schedule.
+   Returns false (e untouched) when the schedule does not cover it. */
+bool schedule_fill(const schedule_t *s, ephemeris_t *e, time_t now,
+                   double lat, double lon);
+
+#endif /* SCHEDULE_H */
@@ -16,4 +16,14 @@
  * Requires PR_SET_NO_NEW_PRIVS to be set first. */
 bool seccomp_install_filter(void);
 
+/* The fetch worker's filter: the daemon's syscalls plus the WORKER
+ * entries curl needs, which it inherits across execve. */
+bool seccomp_install_worker_filter(void);
+
+/* Replay every syscall number through both compiled filters (in a BPF
+ * interpreter, nothing is installed) and compare with syscalls.def.
+ * Prints a summary and the allowed numbers of each, the worker's lines
+ * marked "worker"; returns 0 when they agree. */
+int seccomp_verify(void);
+
 #endif /* ABRAXAS_SECCOMP_H */
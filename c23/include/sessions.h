@@ -0,0 +1,67 @@
+/*
+ * sessions.h - logind session and seat tracking
+ *
+ * systemd-logind keeps one key=value file per session under
+ * /run/systemd/sessions, replaced by rename whenever the session changes
+ * (VT switch, lock, logout). Reading those files directly needs no bus
+ * connection and no libsystemd; an inotify watch on the directory says
+ * when to read them again.
+ *
+ * A session is a gamma target when it is the active session of its
+ * seat, or a seatless X11 session with a DISPLAY (xrdp, Xvnc). Remote
+ * and closing sessions never are.
+ */
+
+#ifndef ABRAXAS_SESSIONS_H
+#define ABRAXAS_SESSIONS_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define SESSIONS_DIR "/run/systemd/sessions"
+
+/* DRM cards, and udev's database holding their seat assignment */
+#define DRM_CLASS_DIR "/sys/class/drm"
+#define UDEV_DATA_DIR "/run/udev/data"
+
+/* Targets followed at once: one per seat plus a few virtual displays */
+#define SESSIONS_MAX 16
+
+typedef enum {
+    SESSION_TTY,
+    SESSION_X11,
+    SESSION_WAYLAND,
+    SESSION_OTHER,      /* mir, unspecified, ... */
+} session_type_t;
+
+typedef struct {
+    char           id[32];          /* logind session id, the file name */
+    uid_t          uid;
+    char           user[64];
+    char           seat[32];        /* empty for seatless sessions */
+    char           display[32];     /* X11 DISPLAY, empty if none */
+    session_type_t type;
+    bool           active;          /* foreground session of its seat */
+    bool           remote;
+    bool           closing;         /* STATE=closing: logged out, processes linger */
+} session_info_t;
+
+/* Parse one session file. Returns false if it is unreadable or has no UID. */
+bool session_parse(const char *path, const char *id, session_info_t *s);
+
+/* The session should get its own gamma state. */
+bool session_is_target(const session_info_t *s);
+
+/* Read every session in dir and keep the targets, sorted by id.
+   Returns how many were written to out (at most max). */
+int sessions_scan(const char *dir, session_info_t *out, int max);
+
+/* Same session, same display: an existing gamma state still fits it. */
+bool session_same_target(const session_info_t *a, const session_info_t *b);
+
+/* The lowest-numbered DRM card (N of drm_dir/cardN) assigned to seat, or
+   -1 if the seat has none. udev tags a card with ID_SEAT; untagged cards
+   belong to seat0, as in logind. */
+int seat_drm_card(const char *drm_dir, const char *udev_dir, const char *seat);
+
+#endif /* ABRAXAS_SESSIONS_H */
@@ -13,10 +13,29 @@
 /* Sigmoid normalized to exactly [0,1] over [-1,1]. */
 double sigmoid_norm(double x, double steepness);
 
+/* Solar color temperature curve before truncation to whole Kelvin. */
+double solar_temp_curve(double minutes_from_sunrise, double minutes_to_sunset,
+                        bool is_dark_mode);
+
 /* Calculate solar-based color temperature (Kelvin). */
 int calculate_solar_temp(double minutes_from_sunrise, double minutes_to_sunset,
                          bool is_dark_mode);
 
+/* One day's solar curve, for evaluating it at many instants: the sigmoid's
+   end values are worked out once instead of on every call. */
+typedef struct {
+    time_t sunrise, sunset;
+    double low, high;       /* raw sigmoid at x = -1 and 1 */
+} solar_curve_t;
+
+void solar_curve_init(solar_curve_t *c, time_t sunrise, time_t sunset);
+
+/* calculate_solar_temp() at epoch second 't', to the same bit. */
+int solar_curve_kelvin(const solar_curve_t *c, time_t t, bool is_dark_mode);
+
+/* Kelvin at progress [0,1] of a sigmoid transition from start to target. */
+int sigmoid_fade_temp(int start_temp, int target_temp, double progress);
+
 /* Calculate manual override temperature during sigmoid transition. */
 int calculate_manual_temp(int start_temp, int target_temp,
                           time_t start_time, int duration_min, time_t now);
@@ -25,4 +44,9 @@ int calculate_manual_temp(int start_temp, int target_temp,
    Returns epoch time 15 minutes before next transition window. */
 time_t next_transition_resume(time_t now, double lat, double lon);
 
+/* Epoch second at which calculate_manual_temp() next changes value,
+   or 0 once the override holds its target. */
+time_t next_manual_change(int start_temp, int target_temp,
+                          time_t start_time, int duration_min, time_t now);
+
 #endif /* SIGMOID_H */
@@ -0,0 +1,74 @@
+/*
+ * snapshot.h - Binary cold-start snapshot of daemon state
+ *
+ * ~/.config/abraxas/state.bin keeps what the daemon parsed out of
+ * config.ini, weather_cache.json, override.json and backend.json, plus
+ * the last temperature it applied, as one fixed-layout record. A start
+ * reads it in one read() instead of parsing four text files.
+ *
+ * The text files stay the source of truth. Each section records the
+ * identity (inode, size, mtime) of the file it was taken from and is
+ * only used while that file still matches; a changed file is parsed as
+ * before. The record is native-endian and private to this build: bump
+ * SNAPSHOT_VERSION on any layout change.
+ */
+
+#ifndef ABRAXAS_SNAPSHOT_H
+#define ABRAXAS_SNAPSHOT_H
+
+#include "abraxas.h"
+
+#include <meridian.h>
+#include <stdint.h>
+
+#define SNAPSHOT_MAGIC      0x54535841u   /* "AXST" */
+#define SNAPSHOT_VERSION    1
+
+/* Text files a section is taken from */
+typedef enum {
+    SNAP_CONFIG,            /* location    <- config.ini */
+    SNAP_WEATHER,           /* weather     <- weather_cache.json */
+    SNAP_OVERRIDE,          /* override    <- override.json */
+    SNAP_PROBE,             /* probe       <- backend.json */
+    SNAP_SOURCES
+} snapshot_source_t;
+
+/* A source file as it was when its section was taken; all zero = absent */
+typedef struct {
+    uint64_t ino;
+    int64_t  size;
+    int64_t  mtime_ns;
+} snapshot_ident_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              /* sizeof(snapshot_t) */
+    uint32_t checksum;          /* FNV-1a of every byte after this field */
+
+    int64_t  saved_at;          /* epoch seconds */
+    int32_t  last_temp;         /* Kelvin, 0 = nothing applied yet */
+    int32_t  pad0;
+
+    snapshot_ident_t ident[SNAP_SOURCES];
+    location_t       location;
+    weather_data_t   weather;
+    override_state_t override;
+    meridian_probe_t probe;
+} snapshot_t;
+
+/* Read and validate the snapshot at path. Returns false (and a zeroed
+   *snap) when it is missing, truncated, from another version or corrupt. */
+bool snapshot_load(const char *path, snapshot_t *snap);
+
+/* Stamp header, saved_at and checksum, then rewrite the file at path
+   in one write(); a torn write fails the checksum on the next load. */
+bool snapshot_save(const char *path, snapshot_t *snap);
+
+/* Identity of the file at path now (all zero if it does not exist). */
+snapshot_ident_t snapshot_ident(const char *path);
+
+/* The section for src was taken from the file at path as it is now. */
+bool snapshot_fresh(const snapshot_t *snap, snapshot_source_t src, const char *path);
+
+#endif /* ABRAXAS_SNAPSHOT_H */
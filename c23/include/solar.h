@@ -9,6 +9,7 @@
 #define SOLAR_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <time.h>
 
 /* Sun elevation at a given time and location */
@@ -29,4 +30,23 @@ sun_position_t solar_position(time_t when, double lat, double lon);
 /* Calculate sunrise and sunset for the date containing 'when'. */
 sun_times_t solar_sunrise_sunset(time_t when, double lat, double lon);
 
+/*
+ * Batch forms. Inputs and outputs are parallel arrays (structure of
+ * arrays), so the per-row work is straight-line arithmetic over
+ * contiguous doubles.
+ */
+
+/* Sun elevation for n instants at one location. Rows that share a local
+   date share one set of solar parameters, interpolated across the day:
+   about 1e-6 degrees from solar_position(), up to 1e-4 near the zenith.
+   Ascending 'when' keeps those runs long. */
+void solar_position_batch(const time_t *when, size_t n, double lat, double lon,
+                          double *elevation);
+
+/* Sunrise and sunset at n locations for the date containing 'when',
+   one solar solve for all of them. Same results as solar_sunrise_sunset();
+   sunrise/sunset are 0 where valid is false. */
+void solar_sunrise_sunset_batch(time_t when, const double *lat, const double *lon,
+                                size_t n, time_t *sunrise, time_t *sunset, bool *valid);
+
 #endif /* SOLAR_H */
@@ -0,0 +1,91 @@
+/*
+ * status.h - Shared-memory status page
+ *
+ * The daemon keeps its live state in one page mapped from
+ * ~/.config/abraxas/status and rewrites it after every tick; --status
+ * and monitoring agents map it read-only and copy it out under a
+ * seqlock, so a read is a memcpy with no parsing and no solar math.
+ *
+ * Reading: load seq; odd means a write is in progress, retry. Copy the
+ * page, load seq again; a different value means the copy tore, retry.
+ * The layout is fixed-width and little-endian so agents in other
+ * languages can map it directly; bump STATUS_VERSION on any change.
+ */
+
+#ifndef ABRAXAS_STATUS_H
+#define ABRAXAS_STATUS_H
+
+#include "abraxas.h"
+
+#include <stdint.h>
+
+#define STATUS_MAGIC        0x53585241u   /* "ARXS" */
+#define STATUS_VERSION      1
+#define STATUS_MAX_OUTPUTS  8
+
+typedef enum {
+    STATUS_MODE_SOLAR  = 0,
+    STATUS_MODE_MANUAL = 1,
+} status_mode_t;
+
+typedef struct {
+    uint32_t index;
+    int32_t  gamma_size;
+} status_output_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;               /* seqlock; odd while the daemon writes */
+    uint32_t pid;
+    uint32_t running;           /* cleared on clean shutdown */
+    uint32_t mode;              /* status_mode_t */
+
+    int64_t  updated_at;        /* epoch seconds of the last publish */
+    int32_t  temp;              /* last applied K, 0 before the first set */
+    int32_t  set_ok;            /* that set call succeeded */
+    int64_t  next_change;       /* next scheduled Kelvin step or flip */
+
+    int32_t  manual_target;     /* manual mode only */
+    int32_t  manual_duration;   /* minutes */
+    int64_t  manual_start;
+    int64_t  manual_resume;
+
+    double   lat, lon;
+    double   elevation;         /* degrees, at updated_at */
+    int64_t  sunrise, sunset;   /* 0 when the sun doesn't cross (polar) */
+
+    int32_t  weather_ok;
+    int32_t  cloud_cover;       /* percent at updated_at */
+    int32_t  dark;              /* cloud cover at or above threshold */
+    int32_t  pad0;
+    int64_t  weather_fetched_at;
+    int64_t  next_dark_change;  /* 0 when the forecast has no flip ahead */
+    char     forecast[64];
+
+    char     backend[32];
+    uint32_t output_count;
+    uint32_t pad1;
+    status_output_t outputs[STATUS_MAX_OUTPUTS];
+} status_page_t;
+
+/* --- Daemon side --- */
+
+/* Create (or take over) the page at path and map it shared.
+   Returns nullptr on failure; the daemon runs without one. */
+status_page_t *status_open(const char *path);
+
+/* Bracket every update of the page's fields */
+void status_write_begin(status_page_t *page);
+void status_write_end(status_page_t *page);
+
+/* Mark the page stopped and unmap it */
+void status_close(status_page_t *page);
+
+/* --- Reader side --- */
+
+/* Consistent copy of a live daemon's page into *out. Returns false when
+   there is no page, it is from another version, or its daemon is gone. */
+bool status_read(const char *path, status_page_t *out);
+
+#endif /* ABRAXAS_STATUS_H */
@@ -0,0 +1,26 @@
+/*
+ * system.h - System daemon serving every logind session
+ *
+ * `abraxas --system --daemon` runs once per machine, as root, instead of
+ * once per user. It follows logind's sessions (see sessions.h) and keeps
+ * one libmeridian state per target session: the compositor or X server
+ * of a graphical session, reached as that session's user, or DRM for a
+ * seat sitting on a text console. The ephemeris, schedule.bin and the
+ * weather fetch are shared, all from ABRAXAS_SYSTEM_DIR.
+ *
+ * Any user may send --set / --resume / --refresh to ABRAXAS_SYSTEM_SOCKET;
+ * an override is keyed on the sender's uid and steers only that user's
+ * sessions. Root's override applies to every session without one of its
+ * own. Overrides live in memory only, and fades are applied at once.
+ */
+
+#ifndef ABRAXAS_SYSTEM_H
+#define ABRAXAS_SYSTEM_H
+
+#include "abraxas.h"
+
+/* Run until SIGTERM/SIGINT. paths from config_init_system_paths().
+   Returns the process exit status: nonzero if the fetch worker died. */
+int system_run(const abraxas_paths_t *paths, location_t location);
+
+#endif /* ABRAXAS_SYSTEM_H */
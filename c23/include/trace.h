@@ -0,0 +1,75 @@
+/*
+ * trace.h - Hot-path tracepoints and latency histograms
+ *
+ * USDT probes (provider "abraxas") mark the event-loop phases; they are
+ * single nops until a tracer attaches, and compile away entirely when
+ * <sys/sdt.h> is missing or ABRAXAS_NO_USDT is defined:
+ *
+ *   bpftrace -e 'usdt:./abraxas:abraxas:set_done { @[str(arg0)] = hist(arg2); }'
+ *
+ * Independently of any tracer, every phase and every backend's set call
+ * feeds a log-linear histogram (4 buckets per power of two, so a bucket
+ * spans at most 25%) that the daemon dumps to stderr on SIGUSR1.
+ */
+
+#ifndef ABRAXAS_TRACE_H
+#define ABRAXAS_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#if !defined(ABRAXAS_NO_USDT) && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define TRACE_USDT 1
+#define TRACE0(name)             DTRACE_PROBE(abraxas, name)
+#define TRACE1(name, a)          DTRACE_PROBE1(abraxas, name, a)
+#define TRACE2(name, a, b)       DTRACE_PROBE2(abraxas, name, a, b)
+#define TRACE3(name, a, b, c)    DTRACE_PROBE3(abraxas, name, a, b, c)
+#else
+#define TRACE_USDT 0
+#define TRACE0(name)             ((void)0)
+#define TRACE1(name, a)          ((void)(a))
+#define TRACE2(name, a, b)       ((void)(a), (void)(b))
+#define TRACE3(name, a, b, c)    ((void)(a), (void)(b), (void)(c))
+#endif
+
+/* Event-loop phases */
+typedef enum {
+    LAT_TIMER_LATE,     /* deadline -> timeout CQE reaped (timer slack, scheduling) */
+    LAT_CQE,            /* io_uring_enter returned -> CQEs drained (inotify reads) */
+    LAT_UPDATE,         /* CQEs drained -> temperature decided (reloads, weather) */
+    LAT_DISPATCH,       /* backend event dispatch (DBus replies, hotplug reapply) */
+    LAT_SET,            /* meridian_set_temperature(), any backend */
+    LAT_TICK,           /* io_uring_enter returned -> set call returned */
+    LAT_FRAME,          /* one fade frame upload (meridian_set_temperature_frame) */
+    LAT_PHASES
+} lat_phase_t;
+
+#define LAT_SUB_BITS  2                             /* buckets per octave = 4 */
+#define LAT_BUCKETS   (64 << LAT_SUB_BITS)
+#define LAT_BACKENDS  4
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint32_t bucket[LAT_BUCKETS];
+} lat_hist_t;
+
+/* Monotonic nanoseconds, the clock all phase spans use */
+int64_t trace_now_ns(void);
+
+/* Add one span to a phase histogram */
+void trace_record(lat_phase_t phase, int64_t ns);
+
+/* Add one set-call duration under the backend's name (first LAT_BACKENDS
+   names get a histogram each; later ones are folded into the last). */
+void trace_record_backend(const char *backend, int64_t ns);
+
+/* Upper bound of the bucket holding quantile q, in ns */
+uint64_t lat_hist_quantile(const lat_hist_t *h, double q);
+
+/* Every non-empty histogram as a table, one "[latency]" line each */
+void trace_dump(FILE *out);
+
+#endif /* ABRAXAS_TRACE_H */
@@ -3,7 +3,12 @@
  *
  * No liburing dependency. Uses linux/io_uring.h kernel headers and
  * syscall(__NR_io_uring_*) directly. Designed for ABRAXAS's simple
- * use case: poll 2 fds + timeout, single io_uring_enter per tick.
+ * use case: poll a few fds + one long-lived deadline, single
+ * io_uring_enter per event.
+ *
+ * Where the kernel allows it, fds are read directly instead of polled:
+ * a multishot READ on a registered file, with the kernel picking a
+ * buffer from a provided-buffer ring for every completion.
  */
 
 #ifndef ABRAXAS_URING_H
@@ -14,8 +19,11 @@
 #include <stdint.h>
 #include <linux/io_uring.h>
 
+struct msghdr;
+
 typedef struct {
     int ring_fd;
+    uint32_t features;      /* IORING_FEAT_* reported by io_uring_setup */
 
     /* Submission ring */
     void     *sq_ring_ptr;
@@ -38,20 +46,100 @@ typedef struct {
     struct io_uring_cqe *cqes;
 } abraxas_ring_t;
 
+/* IORING_OP_READ_MULTISHOT (kernel 6.7), newer than most installed headers */
+#define URING_OP_READ_MULTISHOT 49
+
+/* Provided-buffer ring: count buffers of size bytes, handed to the kernel
+ * under group bgid and returned to it with uring_bufs_recycle(). */
+typedef struct {
+    struct io_uring_buf_ring *br;
+    char     *base;         /* buffer i is base + i * size */
+    size_t    map_size;
+    uint32_t  count;        /* power of two */
+    uint32_t  size;
+    uint16_t  bgid;
+    uint16_t  tail;
+} uring_bufs_t;
+
 /* Initialize io_uring with given queue depth. Returns false on failure. */
 bool uring_init(abraxas_ring_t *ring, uint32_t entries);
 
 /* Tear down io_uring (munmap + close). */
 void uring_destroy(abraxas_ring_t *ring);
 
+/* True if the kernel implements opcode op (IORING_REGISTER_PROBE). */
+bool uring_probe_op(abraxas_ring_t *ring, uint8_t op);
+
+/* Register n fixed-file slots; -1 leaves a slot empty. SQEs address a
+ * slot by index with IOSQE_FIXED_FILE, saving the fd lookup per request. */
+bool uring_register_files(abraxas_ring_t *ring, const int *fds, uint32_t n);
+
+/* Map and register a provided-buffer ring (kernel 5.19) with every buffer
+ * available. Returns false on failure; *bufs is then unusable. */
+bool uring_bufs_init(abraxas_ring_t *ring, uring_bufs_t *bufs, uint16_t bgid,
+                     uint32_t count, uint32_t size);
+
+/* Unregister and unmap. */
+void uring_bufs_destroy(abraxas_ring_t *ring, uring_bufs_t *bufs);
+
+/* The buffer a completion was delivered in, or nullptr if it carries none. */
+const char *uring_bufs_data(const uring_bufs_t *bufs, const struct io_uring_cqe *cqe);
+
+/* Give a completion's buffer back to the kernel once its data is consumed. */
+void uring_bufs_recycle(uring_bufs_t *bufs, const struct io_uring_cqe *cqe);
+
+/* Prepare a multishot READ on fixed-file slot, one CQE per chunk in a
+ * buffer from group bgid. res 0 is EOF; -ENOBUFS ends it when the group
+ * runs dry. With install_fd non-null the read is linked behind a
+ * FILES_UPDATE putting *install_fd into the slot (-ECANCELED if that
+ * fails); *install_fd must stay valid until the next submit. */
+void uring_prep_read_multishot(abraxas_ring_t *ring, uint32_t slot, uint16_t bgid,
+                               uint64_t user_data, const int *install_fd);
+
+/* Prepare a FILES_UPDATE of one fixed-file slot (-1 empties it), completing
+ * silently on success where IOSQE_CQE_SKIP_SUCCESS is supported. */
+void uring_prep_files_update(abraxas_ring_t *ring, uint32_t slot, const int *fd,
+                             uint64_t user_data);
+
 /* Prepare a multi-shot POLL_ADD SQE. fd stays monitored until closed/cancelled. */
 void uring_prep_poll(abraxas_ring_t *ring, int fd, uint64_t user_data);
 
-/* Prepare a TIMEOUT SQE. ts is relative time. user_data identifies the event. */
-void uring_prep_timeout(abraxas_ring_t *ring,
-                        struct __kernel_timespec *ts, uint64_t user_data);
+/* Prepare a TIMEOUT SQE. flags: 0 for relative, or IORING_TIMEOUT_ABS with an
+ * optional clock (IORING_TIMEOUT_BOOTTIME). user_data identifies the event. */
+void uring_prep_timeout(abraxas_ring_t *ring, struct __kernel_timespec *ts,
+                        uint32_t flags, uint64_t user_data);
+
+/* Move a pending TIMEOUT (matched by target_user_data) to ts in place via
+ * IORING_TIMEOUT_UPDATE. flags as for uring_prep_timeout. Success completes
+ * silently when the kernel supports IOSQE_CQE_SKIP_SUCCESS; failure (e.g.
+ * -ENOENT: the timeout already fired) always posts a CQE with user_data. */
+void uring_prep_timeout_update(abraxas_ring_t *ring, struct __kernel_timespec *ts,
+                               uint64_t target_user_data, uint32_t flags,
+                               uint64_t user_data);
+
+/* Prepare a single-shot ACCEPT on a listening socket; the CQE result is
+ * the new fd (SOCK_CLOEXEC) or -errno. */
+void uring_prep_accept(abraxas_ring_t *ring, int fd, uint64_t user_data);
+
+/* Prepare a RECV into buf. With timeout non-null the receive is linked to
+ * a relative LINK_TIMEOUT (posting its own CQE as timeout_user_data) and
+ * fails with -ECANCELED if it has not completed in time. */
+void uring_prep_recv(abraxas_ring_t *ring, int fd, void *buf, size_t len,
+                     uint64_t user_data, struct __kernel_timespec *timeout,
+                     uint64_t timeout_user_data);
+
+/* Prepare a single-shot RECVMSG into msg; flags as for recvmsg(2)
+ * (MSG_CMSG_CLOEXEC for passed descriptors). msg must stay valid until
+ * the CQE is reaped. */
+void uring_prep_recvmsg(abraxas_ring_t *ring, int fd, struct msghdr *msg,
+                        uint32_t flags, uint64_t user_data);
+
+/* Prepare a SEND of buf (MSG_NOSIGNAL: a vanished peer is -EPIPE, not SIGPIPE). */
+void uring_prep_send(abraxas_ring_t *ring, int fd, const void *buf, size_t len,
+                     uint64_t user_data);
 
-/* Submit all prepared SQEs and wait for at least 1 completion. Returns CQE count or -1. */
+/* Submit all prepared SQEs (possibly none) and wait for at least 1 completion.
+ * Returns submitted count, 0 on EINTR, or -1. */
 int uring_submit_and_wait(abraxas_ring_t *ring);
 
 /* Peek at next CQE without consuming. Returns false if no CQEs available. */
@@ -1,28 +1,49 @@
 /*
  * weather.h - NOAA weather API client
  *
- * HTTP via exec'ing curl(1) -- no libcurl linkage. When NOAA_DISABLED
- * is defined (non-US builds), init/cleanup are no-ops and fetch returns
- * has_error=true.
+ * HTTP via exec'ing curl(1) -- no libcurl linkage; the async fetch has a
+ * worker process do the exec. When NOAA_DISABLED is defined (non-US
+ * builds), init/cleanup are no-ops and fetch returns has_error=true.
  */
 
 #ifndef WEATHER_H
 #define WEATHER_H
 
 #include "abraxas.h"
-#include <sys/types.h>   /* pid_t */
+#include <sys/socket.h>  /* struct msghdr */
+#include <sys/types.h>   /* ssize_t */
 
-/* No-op (kept for API compatibility). */
+/* Fork the fetch worker that runs curl for the async fetch. Call before
+   the sandbox is installed: the daemon itself may not spawn afterwards. */
 void weather_init(void);
 
-/* No-op (kept for API compatibility). */
+/* Close the worker's socket; it exits on its own. */
 void weather_cleanup(void);
 
 /* Fetch current weather from NOAA api.weather.gov.
-   Fills weather_data_t with cloud_cover, forecast, temperature, is_day.
+   Fills weather_data_t with cloud_cover, forecast, temperature, is_day
+   and the hourly cloud timeline.
    Sets has_error=true on network/parse failure (or when NOAA_DISABLED). */
 weather_data_t weather_fetch(double lat, double lon);
 
+#ifndef NOAA_DISABLED
+/* Response parsers (also driven by the benchmark). weather_parse_points()
+   extracts properties.forecastHourly; weather_parse_hourly() fills the
+   first period's fields and the cloud timeline. Both return false if
+   the field/period is missing. */
+bool weather_parse_points(const char *body, char *url, size_t cap);
+bool weather_parse_hourly(const char *body, weather_data_t *wd);
+#endif
+
+/* Cloud cover (%) forecast for 'when': the timeline hour containing it,
+   clamped to the timeline ends, or cloud_cover if there is no timeline.
+   0 when wd holds an error. */
+int    weather_cloud_at(const weather_data_t *wd, time_t when);
+
+/* First forecast hour boundary after 'now' at which cloud cover crosses
+   CLOUD_THRESHOLD, or 0 if the rest of the timeline stays on one side. */
+time_t weather_next_dark_change(const weather_data_t *wd, time_t now);
+
 /* --- Async weather fetch (non-blocking, io_uring integrated) --- */
 
 #ifndef NOAA_DISABLED
@@ -35,25 +56,62 @@ typedef enum {
 
 typedef struct {
     weather_phase_t phase;
-    pid_t           child_pid;
+    unsigned        request;       /* fetch worker request in flight, 0 = none */
+    bool            started;       /* its "S" reply is in: pipe_fd, or a failure */
+    bool            exited;        /* its "X" reply is in */
+    int             exit_code;     /* curl's, -1 if it failed to run or was killed */
     int             pipe_fd;       /* read end, O_NONBLOCK */
-    char           *buf;
+    char           *buf;           /* one fixed-size response buffer, reused */
     size_t          buf_size;
-    size_t          buf_cap;
+    int             stream_end;    /* 0 while reading, 1 at EOF, -1 on error */
+    bool            fed;           /* the caller reads pipe_fd, see _feed() */
     double          lat;
     double          lon;
-    char            forecast_url[512];
+    gridpoint_cache_t grid;        /* resolved forecast URL + validators */
+    bool            grid_dirty;    /* grid changed; caller should persist it */
+    bool            conditional;   /* in-flight forecast GET carries validators */
 } weather_fetch_state_t;
 
-void weather_async_init(weather_fetch_state_t *wfs);
-
-/* Start async fetch if IDLE. Returns pipe_fd to poll, or -1. */
-int  weather_async_start(weather_fetch_state_t *wfs, double lat, double lon);
-
-/* Call when POLLIN on pipe_fd. Returns:
- *   0  = EAGAIN (re-poll next iteration)
- *   1  = phase complete, new pipe_fd in wfs->pipe_fd (re-poll)
- *  -1  = done or error (result in *out if phase == IDLE) */
+/* 'grid' (may be nullptr) seeds the gridpoint cache, typically from
+   config_load_gridpoint(). */
+void weather_async_init(weather_fetch_state_t *wfs, const gridpoint_cache_t *grid);
+
+/* Start async fetch if IDLE. A cached gridpoint for (lat, lon) skips the
+   points request. 'current' is the data the caller holds; if it is valid
+   the forecast GET is made conditional on it. Returns 0 once the request
+   is with the fetch worker, or -1. pipe_fd is set when the worker
+   replies (see weather_async_reply()); poll it from then on. */
+int  weather_async_start(weather_fetch_state_t *wfs, double lat, double lon,
+                         const weather_data_t *current);
+
+/* For callers that read pipe_fd themselves (e.g. an io_uring multishot
+   READ): hand over a chunk (n > 0), EOF (n == 0) or a read error (n < 0).
+   weather_async_read() then stops reading the pipe until the next phase
+   and should be called once the stream has ended. */
+void weather_async_feed(weather_fetch_state_t *wfs, const void *data, ssize_t n);
+
+/* The fetch worker's socket, -1 without one. The caller keeps one
+   recvmsg of weather_worker_msghdr() posted on it (MSG_CMSG_CLOEXEC)
+   and hands each result to weather_async_reply(). */
+int            weather_worker_fd(void);
+struct msghdr *weather_worker_msghdr(void);
+
+/* The worker has died. None can be forked under the sandbox, so the
+   daemon should shut down with a nonzero status and be restarted. */
+bool weather_worker_lost(void);
+
+/* A reply of n bytes (or -errno / 0 for a lost worker) has landed in
+   weather_worker_msghdr(). Sets pipe_fd once curl runs. Returns true if
+   the fetch can advance: call weather_async_read(). */
+bool weather_async_reply(weather_fetch_state_t *wfs, ssize_t n);
+
+/* Call when POLLIN on pipe_fd or weather_async_reply() returned true.
+ * Returns:
+ *   0  = EAGAIN, or waiting on the worker (re-poll next iteration)
+ *   1  = phase complete, next request with the worker (new pipe_fd to come)
+ *   2  = forecast unchanged (HTTP 304), *out untouched
+ *  -1  = done or error (result in *out if phase == IDLE)
+ * Check wfs->grid_dirty once the fetch is over. */
 int  weather_async_read(weather_fetch_state_t *wfs, weather_data_t *out);
 
 void weather_async_cleanup(weather_fetch_state_t *wfs);
@@ -61,12 +119,21 @@ void weather_async_cleanup(weather_fetch_state_t *wfs);
 #else /* NOAA_DISABLED */
 
 typedef struct { int phase; } weather_fetch_state_t;
-static inline void weather_async_init(weather_fetch_state_t *wfs) { wfs->phase = 0; }
-static inline int  weather_async_start(weather_fetch_state_t *wfs, double lat, double lon)
-    { (void)wfs; (void)lat; (void)lon; return -1; }
+static inline void weather_async_init(weather_fetch_state_t *wfs, const gridpoint_cache_t *grid)
+    { (void)grid; wfs->phase = 0; }
+static inline int  weather_async_start(weather_fetch_state_t *wfs, double lat, double lon,
+                                       const weather_data_t *current)
+    { (void)wfs; (void)lat; (void)lon; (void)current; return -1; }
+static inline void weather_async_feed(weather_fetch_state_t *wfs, const void *data, ssize_t n)
+    { (void)wfs; (void)data; (void)n; }
 static inline int  weather_async_read(weather_fetch_state_t *wfs, weather_data_t *out)
     { (void)wfs; (void)out; return -1; }
 static inline void weather_async_cleanup(weather_fetch_state_t *wfs) { (void)wfs; }
+static inline int  weather_worker_fd(void) { return -1; }
+static inline struct msghdr *weather_worker_msghdr(void) { return nullptr; }
+static inline bool weather_worker_lost(void) { return false; }
+static inline bool weather_async_reply(weather_fetch_state_t *wfs, ssize_t n)
+    { (void)wfs; (void)n; return false; }
 
 #endif /* !NOAA_DISABLED */
 
@@ -1,17 +1,59 @@
 /*
  * zipdb.h - ZIP code database lookup
  *
- * Binary search on mmap'd us_zipcodes.bin.
- * Format: u32 count, then count * 13-byte entries (5 ASCII + float32 lat + float32 lon).
+ * mmap'd us_zipcodes.bin, two on-disk formats:
+ *   v1: u32 count, then count * 13-byte entries (5 ASCII + float32 lat +
+ *       float32 lon), sorted -- binary search.
+ *   v2: 16-byte header, then ZIPDB_SLOTS 8-byte records (float32 lat,
+ *       float32 lon) indexed by the ZIP's numeric value; NaN marks an
+ *       unused slot -- one load per lookup.
+ * All fields little-endian.
  */
 
 #ifndef ZIPDB_H
 #define ZIPDB_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-/* Look up coordinates for a 5-digit US ZIP code.
+#define ZIPDB_MAGIC   "ABZD"
+#define ZIPDB_VERSION 2
+#define ZIPDB_SLOTS   100000
+
+/* v2 header; records follow at offset sizeof(zipdb_header_t) */
+typedef struct {
+    char     magic[4];      /* ZIPDB_MAGIC */
+    uint16_t version;       /* ZIPDB_VERSION */
+    uint16_t record_size;   /* sizeof(zipdb_record_t) */
+    uint32_t slots;         /* ZIPDB_SLOTS */
+    uint32_t count;         /* populated slots */
+} zipdb_header_t;
+
+typedef struct {
+    float lat;
+    float lon;
+} zipdb_record_t;
+
+/* An open database; keep it across lookups to pay the mmap once. */
+typedef struct {
+    const uint8_t *map;
+    size_t         size;
+    int            version;     /* 1 or 2 */
+    uint32_t       count;       /* entries (v1) / populated slots (v2) */
+} zipdb_t;
+
+/* Map 'db_path' read-only. Returns false if missing or malformed. */
+bool zipdb_open(zipdb_t *db, const char *db_path);
+
+/* Unmap; safe on a closed or failed db. */
+void zipdb_close(zipdb_t *db);
+
+/* Look up a ZIP (up to 5 digits, zero-padded on the left) in an open db.
    Returns true on success, writing lat/lon. */
+bool zipdb_find(const zipdb_t *db, const char *zipcode, float *lat, float *lon);
+
+/* One-shot open + find + close. */
 bool zipdb_lookup(const char *db_path, const char *zipcode,
                   float *lat, float *lon);
 
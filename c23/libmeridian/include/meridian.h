@@ -8,6 +8,7 @@
  *   - GNOME:   Mutter DBus (GNOME Wayland via org.gnome.Mutter.DisplayConfig)
  *   - DRM:     Direct kernel ioctl (always compiled, no dependencies)
  *   - X11:     RandR (NVIDIA proprietary, etc.)
+ *   - Null:    no display, records applied ramps (meridian_init_null)
  *
  * Optional compile flags:
  *   -DMERIDIAN_HAS_WAYLAND  + link -lwayland-client   (Wayland backend)
@@ -47,6 +48,7 @@ typedef enum {
     MERIDIAN_ERR_WAYLAND_CONNECT = -8,
     MERIDIAN_ERR_WAYLAND_PROTOCOL = -9,
     MERIDIAN_ERR_GNOME_DBUS = -10,
+    MERIDIAN_ERR_BUSY = -11,
 } meridian_error_t;
 
 /* Opaque handles */
@@ -55,6 +57,7 @@ typedef struct meridian_drm_state meridian_drm_state_t;     /* DRM backend */
 typedef struct meridian_x11_state meridian_x11_state_t;     /* X11 backend */
 typedef struct meridian_wl_state meridian_wl_state_t;       /* Wayland backend */
 typedef struct meridian_gnome_state meridian_gnome_state_t; /* GNOME backend */
+typedef struct meridian_null_state meridian_null_state_t;   /* Null backend */
 
 /* RGB color (0.0 - 1.0 range) */
 typedef struct {
@@ -71,7 +74,8 @@ typedef struct {
  * Convert color temperature to RGB multipliers.
  *
  * temp: Color temperature in Kelvin (1000-25000)
- * rgb:  Output RGB values (0.0-1.0 range)
+ * rgb:  Output RGB values (0.0-1.0 range), the Q16 multipliers the
+ *       ramp fill uses
  *
  * Returns: MERIDIAN_OK on success, MERIDIAN_ERR_INVALID_TEMP if out of range
  */
@@ -82,7 +86,7 @@ meridian_error_t meridian_temp_to_rgb(int temp, meridian_rgb_t *rgb);
  * Fill a gamma ramp array for the given temperature.
  *
  * temp:       Color temperature in Kelvin
- * gamma_size: Size of each ramp array (typically 256 or 1024)
+ * gamma_size: Size of each ramp array (2-65536, typically 256 or 1024)
  * r, g, b:    Output arrays (must be gamma_size * sizeof(uint16_t))
  *             restrict: arrays must not overlap
  * brightness: Brightness multiplier (0.0-1.0, typically 1.0)
@@ -96,13 +100,114 @@ meridian_error_t meridian_fill_gamma_ramps(int temp, int gamma_size,
                                             uint16_t *restrict b,
                                             float brightness);
 
+/* One ramp fill request for meridian_fill_gamma_ramps_batch() */
+typedef struct {
+    int temp;           /* Color temperature in Kelvin */
+    int gamma_size;     /* Entries per channel */
+    float brightness;   /* Brightness multiplier (0.0-1.0) */
+    uint16_t *r;        /* Output arrays, gamma_size entries each; */
+    uint16_t *g;        /* must not overlap any other job's arrays */
+    uint16_t *b;
+} meridian_ramp_job_t;
+
+/*
+ * Fill gamma ramps for several temperatures or CRTCs in one call.
+ *
+ * jobs:  Array of fill requests
+ * count: Number of jobs
+ *
+ * Consecutive jobs with identical parameters are copied from the previous
+ * result rather than recomputed. A failing job does not stop the batch.
+ *
+ * Returns: MERIDIAN_OK if every job succeeded, otherwise the first error
+ */
+[[nodiscard]]
+meridian_error_t meridian_fill_gamma_ramps_batch(const meridian_ramp_job_t *jobs,
+                                                  int count);
+
+/*
+ * Get name of the ramp fill kernel selected for this CPU
+ * ("avx2", "sse4.1", "neon", or "scalar"). Ramps are integer-only, so
+ * all kernels, and the Rust port, produce bit-identical output.
+ */
+const char *meridian_ramp_kernel_name(void);
+
+/* Number of entries held by the ramp cache */
+#define MERIDIAN_RAMP_CACHE_SLOTS 4
+
+/* Read-only view of a cached ramp set (gamma_size entries per channel) */
+typedef struct {
+    const uint16_t *r;
+    const uint16_t *g;
+    const uint16_t *b;
+} meridian_ramp_t;
+
+/*
+ * Get gamma ramps for the given temperature from the ramp cache.
+ *
+ * Ramps are computed with meridian_fill_gamma_ramps() on a miss and
+ * reused on later calls with the same (temp, gamma_size, brightness).
+ * Least recently used entries are evicted; their buffers are recycled,
+ * so lookups stop allocating once every gamma size in use has been seen.
+ *
+ * temp:       Color temperature in Kelvin
+ * gamma_size: Size of each ramp array
+ * brightness: Brightness multiplier (clamped to 0.0-1.0)
+ * out:        Receives pointers into cache-owned storage. Valid until the
+ *             next meridian_ramp_cache_get() or meridian_ramp_cache_clear().
+ *
+ * Not thread-safe: the cache is shared by all backends in the process.
+ *
+ * Returns: MERIDIAN_OK on success, MERIDIAN_ERR_RESOURCES on allocation failure
+ */
+[[nodiscard]]
+meridian_error_t meridian_ramp_cache_get(int temp, int gamma_size,
+                                          float brightness,
+                                          meridian_ramp_t *out);
+
+/*
+ * Drop all cached ramps and release their storage. The pinned set stays.
+ * Called by meridian_free() of the last live state; safe to call at any time.
+ */
+void meridian_ramp_cache_clear(void);
+
+/* Upper bound on the storage one meridian_ramp_pin() may take */
+#define MERIDIAN_RAMP_PIN_MAX_BYTES (16u << 20)
+
+/*
+ * Precompute ramps for a sequence of temperatures known in advance.
+ *
+ * Until meridian_ramp_unpin(), meridian_ramp_cache_get() answers these
+ * (temp, gamma_size, brightness) keys from the pinned set without
+ * touching the LRU, so walking the sequence neither recomputes nor
+ * allocates. Duplicates are stored once. Replaces any earlier pin.
+ *
+ * temps:      Temperatures in any order
+ * count:      Number of entries in temps
+ * gamma_size: Size of each ramp array; other sizes still use the LRU
+ * brightness: Brightness multiplier (clamped to 0.0-1.0)
+ *
+ * Returns: MERIDIAN_OK on success, MERIDIAN_ERR_INVALID_TEMP if a temp is
+ *          out of range, MERIDIAN_ERR_RESOURCES past MERIDIAN_RAMP_PIN_MAX_BYTES
+ */
+[[nodiscard]]
+meridian_error_t meridian_ramp_pin(const int *temps, int count, int gamma_size,
+                                    float brightness);
+
+/*
+ * Release the pinned set. The pin belongs to the caller: meridian_free()
+ * leaves it, so a fade outlives its backend being re-initialized.
+ */
+void meridian_ramp_unpin(void);
+
 /* ============================================================
  * Unified Gamma Control (Auto-select DRM or X11)
  * ============================================================ */
 
 /*
  * Initialize gamma control with automatic backend selection.
- * Tries DRM first, falls back to X11 if DRM gamma unavailable.
+ * Tries DRM first, falls back to X11 if DRM gamma unavailable
+ * (Wayland and GNOME come first in a Wayland session).
  *
  * state: Output pointer to allocated state
  *
@@ -116,17 +221,89 @@ meridian_error_t meridian_init(meridian_state_t **state);
  *
  * card_num: Graphics card number (0 for /dev/dri/card0)
  * state:    Output pointer to allocated state
+ *
+ * Backends are tried one at a time on the calling thread.
  */
 [[nodiscard]]
 meridian_error_t meridian_init_card(int card_num, meridian_state_t **state);
 
+/* Outputs a probe record keeps */
+#define MERIDIAN_PROBE_MAX_OUTPUTS 16
+
 /*
- * Free state and restore original gamma.
+ * What a successful init found, for the caller to persist. backend is a
+ * meridian_get_backend_name() value; session records $WAYLAND_DISPLAY and
+ * $DISPLAY, so a record is only reused in the session it was made in.
+ */
+typedef struct {
+    char backend[16];
+    char session[96];
+    int  card_num;
+    int  output_count;
+    int  gamma_size[MERIDIAN_PROBE_MAX_OUTPUTS];
+} meridian_probe_t;
+
+/*
+ * Initialize, trying the backend in hint alone first.
+ *
+ * hint:      Record from meridian_get_probe() on an earlier start, or
+ *            nullptr. Ignored when taken in another session or for
+ *            another card.
+ * from_hint: Set to whether the hinted backend was used (may be nullptr)
+ *
+ * When the hinted backend does not come up, the others are probed in
+ * meridian_init_card() order but concurrently where the probes are
+ * independent, one thread per backend; the threads are joined before
+ * this returns.
+ */
+[[nodiscard]]
+meridian_error_t meridian_init_probed(int card_num, const meridian_probe_t *hint,
+                                      meridian_state_t **state, bool *from_hint);
+
+/*
+ * Describe the active backend and its outputs for the next
+ * meridian_init_probed().
+ */
+void meridian_get_probe(const meridian_state_t *state, meridian_probe_t *probe);
+
+/*
+ * Called by the null backend for every ramp it applies, once per output.
+ * meridian_restore() reports temp 0 and a nullptr ramp. The ramp points
+ * into the ramp cache and is only valid during the call.
+ */
+typedef void (*meridian_null_record_fn)(void *ctx, int crtc_idx, int temp,
+                                        float brightness,
+                                        const meridian_ramp_t *ramp, int gamma_size);
+
+/* Virtual outputs of the null backend */
+typedef struct {
+    int outputs;                    /* 1..MERIDIAN_PROBE_MAX_OUTPUTS, 0 = 1 */
+    int gamma_size;                 /* Entries per channel, 0 = MERIDIAN_GAMMA_RAMP_SIZE */
+    meridian_null_record_fn record; /* May be nullptr: ramps are not even filled */
+    void *ctx;                      /* Passed to record */
+} meridian_null_config_t;
+
+/*
+ * Initialize on the null backend ("null"): no device is opened and
+ * nothing is shown, but every set and restore goes through the same
+ * unified calls as on a display. Never chosen by the probing inits.
+ *
+ * config: Outputs and recorder, or nullptr for one silent output
+ *
+ * Returns: MERIDIAN_OK on success, MERIDIAN_ERR_NO_CRTC for a bad config
+ */
+[[nodiscard]]
+meridian_error_t meridian_init_null(const meridian_null_config_t *config,
+                                    meridian_state_t **state);
+
+/*
+ * Free state and restore original gamma. The ramp cache is emptied once
+ * no state is left; a pin made with meridian_ramp_pin() stays either way.
  */
 void meridian_free(meridian_state_t *state);
 
 /*
- * Get name of active backend ("wayland", "gnome", "drm", or "x11").
+ * Get name of active backend ("wayland", "gnome", "drm", "x11", or "null").
  */
 const char *meridian_get_backend_name(const meridian_state_t *state);
 
@@ -161,12 +338,93 @@ meridian_error_t meridian_set_temperature_crtc(meridian_state_t *state,
                                                 int crtc_idx, int temp,
                                                 float brightness);
 
+/*
+ * Stage the ramps for a temperature expected to be set soon.
+ *
+ * Call while idle with the next scheduled temperature. Wayland writes
+ * and seals the per-output memfds ahead of time so the next
+ * meridian_set_temperature() with the same arguments only sends them;
+ * other backends warm the ramp cache. A hint only: skipping it, or
+ * setting a different temperature, is always correct.
+ *
+ * Returns: MERIDIAN_OK on success
+ */
+[[nodiscard]]
+meridian_error_t meridian_prepare_temperature(meridian_state_t *state,
+                                               int temp, float brightness);
+
+/*
+ * Set color temperature as one frame of an animation.
+ *
+ * DRM with atomic color management queues the commit without waiting
+ * for vblank and asks for a page-flip event, which meridian_dispatch()
+ * consumes from the card fd. Until then meridian_frame_pending() is true
+ * and further frames are refused, so a slow frame is dropped instead of
+ * stacking up behind the display. Other backends, and DRM without
+ * atomic, behave like meridian_set_temperature().
+ *
+ * Returns: MERIDIAN_OK on success, MERIDIAN_ERR_BUSY if the previous
+ *          frame has not been latched yet (nothing was changed)
+ */
+[[nodiscard]]
+meridian_error_t meridian_set_temperature_frame(meridian_state_t *state,
+                                                 int temp, float brightness);
+
+/*
+ * True if meridian_set_temperature_frame() commits are completed by
+ * display events: the caller can step on those instead of a timer.
+ */
+bool meridian_frame_paced(const meridian_state_t *state);
+
+/*
+ * True while a frame from meridian_set_temperature_frame() waits for
+ * its vblank. Always false when frames are not paced.
+ */
+bool meridian_frame_pending(const meridian_state_t *state);
+
+/*
+ * Refresh rate of the fastest active display in millihertz,
+ * or 0 if the backend does not know it (only DRM reports one).
+ */
+int meridian_get_refresh_mhz(const meridian_state_t *state);
+
 /*
  * Restore original gamma ramps on all CRTCs.
  */
 [[nodiscard]]
 meridian_error_t meridian_restore(meridian_state_t *state);
 
+/* Upper bound on the fds meridian_get_fds() reports */
+#define MERIDIAN_MAX_FDS 4
+
+/*
+ * Event fds of the active backend.
+ *
+ * DRM: netlink uevent socket (connector hotplug), then the card fd
+ *      (page-flip events for meridian_set_temperature_frame()).
+ * X11: display connection (RandR screen/CRTC change notifications).
+ * Wayland: display fd (new/removed outputs, gamma_control events).
+ * GNOME: DBus connection (pipelined replies, MonitorsChanged).
+ *
+ * Poll each for readability and call meridian_dispatch() when one fires;
+ * nothing in libmeridian blocks waiting for them. The set stays fixed
+ * for the lifetime of the state.
+ *
+ * Returns: number of fds written to fds (at most max), 0 if none
+ */
+int meridian_get_fds(const meridian_state_t *state, int *fds, int max);
+
+/*
+ * Process pending backend events without blocking.
+ *
+ * When outputs were added or changed, the last meridian_set_temperature()
+ * setting is reapplied to all of them before returning.
+ *
+ * Returns: MERIDIAN_OK on success (also when there was nothing to do)
+ */
+[[nodiscard]]
+meridian_error_t meridian_dispatch(meridian_state_t *state);
+
 /*
  * Get error message string.
  */
@@ -190,6 +448,37 @@ meridian_error_t meridian_drm_set_temperature_crtc(meridian_drm_state_t *state,
                                                     float brightness);
 [[nodiscard]]
 meridian_error_t meridian_drm_restore(meridian_drm_state_t *state);
+int meridian_drm_get_fd(const meridian_drm_state_t *state);
+int meridian_drm_get_event_fd(const meridian_drm_state_t *state);
+[[nodiscard]]
+meridian_error_t meridian_drm_dispatch(meridian_drm_state_t *state,
+                                        bool *outputs_changed);
+[[nodiscard]]
+meridian_error_t meridian_drm_set_temperature_frame(meridian_drm_state_t *state,
+                                                     int temp, float brightness);
+bool meridian_drm_frame_paced(const meridian_drm_state_t *state);
+bool meridian_drm_frame_pending(const meridian_drm_state_t *state);
+int meridian_drm_get_refresh_mhz(const meridian_drm_state_t *state);
+
+/* ============================================================
+ * Null Backend (recording, no display)
+ * ============================================================ */
+
+[[nodiscard]]
+meridian_error_t meridian_null_init(const meridian_null_config_t *config,
+                                     meridian_null_state_t **state);
+void meridian_null_free(meridian_null_state_t *state);
+int meridian_null_get_crtc_count(const meridian_null_state_t *state);
+int meridian_null_get_gamma_size(const meridian_null_state_t *state, int crtc_idx);
+[[nodiscard]]
+meridian_error_t meridian_null_set_temperature(meridian_null_state_t *state,
+                                                int temp, float brightness);
+[[nodiscard]]
+meridian_error_t meridian_null_set_temperature_crtc(meridian_null_state_t *state,
+                                                     int crtc_idx, int temp,
+                                                     float brightness);
+[[nodiscard]]
+meridian_error_t meridian_null_restore(meridian_null_state_t *state);
 
 /* ============================================================
  * X11 Backend (RandR)
@@ -210,6 +499,10 @@ meridian_error_t meridian_x11_set_temperature_crtc(meridian_x11_state_t *state,
                                                     float brightness);
 [[nodiscard]]
 meridian_error_t meridian_x11_restore(meridian_x11_state_t *state);
+int meridian_x11_get_fd(const meridian_x11_state_t *state);
+[[nodiscard]]
+meridian_error_t meridian_x11_dispatch(meridian_x11_state_t *state,
+                                        bool *outputs_changed);
 #endif
 
 /* ============================================================
@@ -230,7 +523,14 @@ meridian_error_t meridian_wl_set_temperature_crtc(meridian_wl_state_t *state,
                                                    int crtc_idx, int temp,
                                                    float brightness);
 [[nodiscard]]
+meridian_error_t meridian_wl_prepare_temperature(meridian_wl_state_t *state,
+                                                  int temp, float brightness);
+[[nodiscard]]
 meridian_error_t meridian_wl_restore(meridian_wl_state_t *state);
+int meridian_wl_get_fd(const meridian_wl_state_t *state);
+[[nodiscard]]
+meridian_error_t meridian_wl_dispatch(meridian_wl_state_t *state,
+                                       bool *outputs_changed);
 #endif
 
 /* ============================================================
@@ -243,6 +543,9 @@ meridian_error_t meridian_gnome_init(meridian_gnome_state_t **state);
 void meridian_gnome_free(meridian_gnome_state_t *state);
 int meridian_gnome_get_crtc_count(const meridian_gnome_state_t *state);
 int meridian_gnome_get_gamma_size(const meridian_gnome_state_t *state, int crtc_idx);
+int meridian_gnome_get_fd(const meridian_gnome_state_t *state);
+[[nodiscard]]
+meridian_error_t meridian_gnome_dispatch(meridian_gnome_state_t *state);
 [[nodiscard]]
 meridian_error_t meridian_gnome_set_temperature(meridian_gnome_state_t *state,
                                                  int temp, float brightness);
@@ -2,266 +2,76 @@
  * colorramp.c - Blackbody color temperature to RGB conversion
  *
  * Based on data from Ingo Thies (2013) and redshift project.
+ * All ramp math is fixed point: channel multipliers and brightness are
+ * Q16, and a ramp is an integer add-and-shift per entry, so the result
+ * is the same on every CPU, kernel and port.
  * C23 compliant.
  */
 
 #include "meridian.h"
-#include <math.h>
-
-/* Whitepoint values for temperatures at 100K intervals (1000K - 25000K).
- * Each entry is RGB, interpolated for actual temperature.
- * Table from Ingo Thies, 2013.
- * constexpr ensures compile-time evaluation (C23). */
-static constexpr float blackbody_color[] = {
-    1.00000000f, 0.18172716f, 0.00000000f, /* 1000K */
-    1.00000000f, 0.25503671f, 0.00000000f, /* 1100K */
-    1.00000000f, 0.30942099f, 0.00000000f, /* 1200K */
-    1.00000000f, 0.35357379f, 0.00000000f,
-    1.00000000f, 0.39091524f, 0.00000000f,
-    1.00000000f, 0.42322816f, 0.00000000f,
-    1.00000000f, 0.45159884f, 0.00000000f,
-    1.00000000f, 0.47675916f, 0.00000000f,
-    1.00000000f, 0.49923747f, 0.00000000f,
-    1.00000000f, 0.51943421f, 0.00000000f, /* 2000K */
-    1.00000000f, 0.54360078f, 0.08679949f,
-    1.00000000f, 0.56618736f, 0.14065513f,
-    1.00000000f, 0.58734976f, 0.18362641f,
-    1.00000000f, 0.60724493f, 0.22137978f,
-    1.00000000f, 0.62600248f, 0.25591950f,
-    1.00000000f, 0.64373109f, 0.28819679f,
-    1.00000000f, 0.66052319f, 0.31873863f,
-    1.00000000f, 0.67645822f, 0.34786758f,
-    1.00000000f, 0.69160518f, 0.37579588f,
-    1.00000000f, 0.70602449f, 0.40267128f, /* 3000K */
-    1.00000000f, 0.71976951f, 0.42860152f,
-    1.00000000f, 0.73288760f, 0.45366838f,
-    1.00000000f, 0.74542112f, 0.47793608f,
-    1.00000000f, 0.75740814f, 0.50145662f,
-    1.00000000f, 0.76888303f, 0.52427322f,
-    1.00000000f, 0.77987699f, 0.54642268f,
-    1.00000000f, 0.79041843f, 0.56793692f,
-    1.00000000f, 0.80053332f, 0.58884417f,
-    1.00000000f, 0.81024551f, 0.60916971f,
-    1.00000000f, 0.81957693f, 0.62893653f, /* 4000K */
-    1.00000000f, 0.82854786f, 0.64816570f,
-    1.00000000f, 0.83717703f, 0.66687674f,
-    1.00000000f, 0.84548188f, 0.68508786f,
-    1.00000000f, 0.85347859f, 0.70281616f,
-    1.00000000f, 0.86118227f, 0.72007777f,
-    1.00000000f, 0.86860704f, 0.73688797f,
-    1.00000000f, 0.87576611f, 0.75326132f,
-    1.00000000f, 0.88267187f, 0.76921169f,
-    1.00000000f, 0.88933596f, 0.78475236f,
-    1.00000000f, 0.89576933f, 0.79989606f, /* 5000K */
-    1.00000000f, 0.90198230f, 0.81465502f,
-    1.00000000f, 0.90963069f, 0.82838210f,
-    1.00000000f, 0.91710889f, 0.84190889f,
-    1.00000000f, 0.92441842f, 0.85523742f,
-    1.00000000f, 0.93156127f, 0.86836903f,
-    1.00000000f, 0.93853986f, 0.88130458f,
-    1.00000000f, 0.94535695f, 0.89404470f,
-    1.00000000f, 0.95201559f, 0.90658983f,
-    1.00000000f, 0.95851906f, 0.91894041f,
-    1.00000000f, 0.96487079f, 0.93109690f, /* 6000K */
-    1.00000000f, 0.97107439f, 0.94305985f,
-    1.00000000f, 0.97713351f, 0.95482993f,
-    1.00000000f, 0.98305189f, 0.96640795f,
-    1.00000000f, 0.98883326f, 0.97779486f,
-    1.00000000f, 0.99448139f, 0.98899179f,
-    1.00000000f, 1.00000000f, 1.00000000f, /* 6600K - D65 white point */
-    0.98947904f, 0.99348723f, 1.00000000f,
-    0.97940448f, 0.98722715f, 1.00000000f,
-    0.96975025f, 0.98120637f, 1.00000000f,
-    0.96049223f, 0.97541240f, 1.00000000f, /* 7000K */
-    0.95160805f, 0.96983355f, 1.00000000f,
-    0.94303638f, 0.96443333f, 1.00000000f,
-    0.93480451f, 0.95923080f, 1.00000000f,
-    0.92689056f, 0.95421394f, 1.00000000f,
-    0.91927697f, 0.94937330f, 1.00000000f,
-    0.91194747f, 0.94470005f, 1.00000000f,
-    0.90488690f, 0.94018594f, 1.00000000f,
-    0.89808115f, 0.93582323f, 1.00000000f,
-    0.89151710f, 0.93160469f, 1.00000000f,
-    0.88518247f, 0.92752354f, 1.00000000f, /* 8000K */
-    0.87906581f, 0.92357340f, 1.00000000f,
-    0.87315640f, 0.91974827f, 1.00000000f,
-    0.86744421f, 0.91604254f, 1.00000000f,
-    0.86191983f, 0.91245088f, 1.00000000f,
-    0.85657444f, 0.90896831f, 1.00000000f,
-    0.85139976f, 0.90559011f, 1.00000000f,
-    0.84638799f, 0.90231183f, 1.00000000f,
-    0.84153180f, 0.89912926f, 1.00000000f,
-    0.83682430f, 0.89603843f, 1.00000000f,
-    0.83225897f, 0.89303558f, 1.00000000f, /* 9000K */
-    0.82782969f, 0.89011714f, 1.00000000f,
-    0.82353066f, 0.88727974f, 1.00000000f,
-    0.81935641f, 0.88452017f, 1.00000000f,
-    0.81530175f, 0.88183541f, 1.00000000f,
-    0.81136180f, 0.87922257f, 1.00000000f,
-    0.80753191f, 0.87667891f, 1.00000000f,
-    0.80380769f, 0.87420182f, 1.00000000f,
-    0.80018497f, 0.87178882f, 1.00000000f,
-    0.79665980f, 0.86943756f, 1.00000000f,
-    0.79322843f, 0.86714579f, 1.00000000f, /* 10000K */
-    0.78988728f, 0.86491137f, 1.00000000f,
-    0.78663296f, 0.86273225f, 1.00000000f,
-    0.78346225f, 0.86060650f, 1.00000000f,
-    0.78037207f, 0.85853224f, 1.00000000f,
-    0.77735950f, 0.85650771f, 1.00000000f,
-    0.77442176f, 0.85453121f, 1.00000000f,
-    0.77155617f, 0.85260112f, 1.00000000f,
-    0.76876022f, 0.85071588f, 1.00000000f,
-    0.76603147f, 0.84887402f, 1.00000000f,
-    0.76336762f, 0.84707411f, 1.00000000f, /* 11000K */
-    0.76076645f, 0.84531479f, 1.00000000f,
-    0.75822586f, 0.84359476f, 1.00000000f,
-    0.75574383f, 0.84191277f, 1.00000000f,
-    0.75331843f, 0.84026762f, 1.00000000f,
-    0.75094780f, 0.83865816f, 1.00000000f,
-    0.74863017f, 0.83708329f, 1.00000000f,
-    0.74636386f, 0.83554194f, 1.00000000f,
-    0.74414722f, 0.83403311f, 1.00000000f,
-    0.74197871f, 0.83255582f, 1.00000000f,
-    0.73985682f, 0.83110912f, 1.00000000f, /* 12000K */
-    0.73778012f, 0.82969211f, 1.00000000f,
-    0.73574723f, 0.82830393f, 1.00000000f,
-    0.73375683f, 0.82694373f, 1.00000000f,
-    0.73180765f, 0.82561071f, 1.00000000f,
-    0.72989845f, 0.82430410f, 1.00000000f,
-    0.72802807f, 0.82302316f, 1.00000000f,
-    0.72619537f, 0.82176715f, 1.00000000f,
-    0.72439927f, 0.82053539f, 1.00000000f,
-    0.72263872f, 0.81932722f, 1.00000000f,
-    0.72091270f, 0.81814197f, 1.00000000f, /* 13000K */
-    0.71922025f, 0.81697905f, 1.00000000f,
-    0.71756043f, 0.81583783f, 1.00000000f,
-    0.71593234f, 0.81471775f, 1.00000000f,
-    0.71433510f, 0.81361825f, 1.00000000f,
-    0.71276788f, 0.81253878f, 1.00000000f,
-    0.71122987f, 0.81147883f, 1.00000000f,
-    0.70972029f, 0.81043789f, 1.00000000f,
-    0.70823838f, 0.80941546f, 1.00000000f,
-    0.70678342f, 0.80841109f, 1.00000000f,
-    0.70535469f, 0.80742432f, 1.00000000f, /* 14000K */
-    0.70395153f, 0.80645469f, 1.00000000f,
-    0.70257327f, 0.80550180f, 1.00000000f,
-    0.70121928f, 0.80456522f, 1.00000000f,
-    0.69988894f, 0.80364455f, 1.00000000f,
-    0.69858167f, 0.80273941f, 1.00000000f,
-    0.69729688f, 0.80184943f, 1.00000000f,
-    0.69603402f, 0.80097423f, 1.00000000f,
-    0.69479255f, 0.80011347f, 1.00000000f,
-    0.69357196f, 0.79926681f, 1.00000000f,
-    0.69237173f, 0.79843391f, 1.00000000f, /* 15000K */
-    0.69119138f, 0.79761446f, 1.00000000f,
-    0.69003044f, 0.79680814f, 1.00000000f,
-    0.68888844f, 0.79601466f, 1.00000000f,
-    0.68776494f, 0.79523371f, 1.00000000f,
-    0.68665951f, 0.79446502f, 1.00000000f,
-    0.68557173f, 0.79370830f, 1.00000000f,
-    0.68450119f, 0.79296330f, 1.00000000f,
-    0.68344751f, 0.79222975f, 1.00000000f,
-    0.68241029f, 0.79150740f, 1.00000000f,
-    0.68138918f, 0.79079600f, 1.00000000f, /* 16000K */
-    0.68038380f, 0.79009531f, 1.00000000f,
-    0.67939381f, 0.78940511f, 1.00000000f,
-    0.67841888f, 0.78872517f, 1.00000000f,
-    0.67745866f, 0.78805526f, 1.00000000f,
-    0.67651284f, 0.78739518f, 1.00000000f,
-    0.67558112f, 0.78674472f, 1.00000000f,
-    0.67466317f, 0.78610368f, 1.00000000f,
-    0.67375872f, 0.78547186f, 1.00000000f,
-    0.67286748f, 0.78484907f, 1.00000000f,
-    0.67198916f, 0.78423512f, 1.00000000f, /* 17000K */
-    0.67112350f, 0.78362984f, 1.00000000f,
-    0.67027024f, 0.78303305f, 1.00000000f,
-    0.66942911f, 0.78244457f, 1.00000000f,
-    0.66859988f, 0.78186425f, 1.00000000f,
-    0.66778228f, 0.78129191f, 1.00000000f,
-    0.66697610f, 0.78072740f, 1.00000000f,
-    0.66618110f, 0.78017057f, 1.00000000f,
-    0.66539706f, 0.77962127f, 1.00000000f,
-    0.66462376f, 0.77907934f, 1.00000000f,
-    0.66386098f, 0.77854465f, 1.00000000f, /* 18000K */
-    0.66310852f, 0.77801705f, 1.00000000f,
-    0.66236618f, 0.77749642f, 1.00000000f,
-    0.66163375f, 0.77698261f, 1.00000000f,
-    0.66091106f, 0.77647551f, 1.00000000f,
-    0.66019791f, 0.77597498f, 1.00000000f,
-    0.65949412f, 0.77548090f, 1.00000000f,
-    0.65879952f, 0.77499315f, 1.00000000f,
-    0.65811392f, 0.77451161f, 1.00000000f,
-    0.65743716f, 0.77403618f, 1.00000000f,
-    0.65676908f, 0.77356673f, 1.00000000f, /* 19000K */
-    0.65610952f, 0.77310316f, 1.00000000f,
-    0.65545831f, 0.77264537f, 1.00000000f,
-    0.65481530f, 0.77219324f, 1.00000000f,
-    0.65418036f, 0.77174669f, 1.00000000f,
-    0.65355332f, 0.77130560f, 1.00000000f,
-    0.65293404f, 0.77086988f, 1.00000000f,
-    0.65232240f, 0.77043944f, 1.00000000f,
-    0.65171824f, 0.77001419f, 1.00000000f,
-    0.65112144f, 0.76959404f, 1.00000000f,
-    0.65053187f, 0.76917889f, 1.00000000f, /* 20000K */
-    0.64994941f, 0.76876866f, 1.00000000f,
-    0.64937392f, 0.76836326f, 1.00000000f,
-    0.64880528f, 0.76796263f, 1.00000000f,
-    0.64824339f, 0.76756666f, 1.00000000f,
-    0.64768812f, 0.76717529f, 1.00000000f,
-    0.64713935f, 0.76678844f, 1.00000000f,
-    0.64659699f, 0.76640603f, 1.00000000f,
-    0.64606092f, 0.76602798f, 1.00000000f,
-    0.64553103f, 0.76565424f, 1.00000000f,
-    0.64500722f, 0.76528472f, 1.00000000f, /* 21000K */
-    0.64448939f, 0.76491935f, 1.00000000f,
-    0.64397745f, 0.76455808f, 1.00000000f,
-    0.64347129f, 0.76420082f, 1.00000000f,
-    0.64297081f, 0.76384753f, 1.00000000f,
-    0.64247594f, 0.76349813f, 1.00000000f,
-    0.64198657f, 0.76315256f, 1.00000000f,
-    0.64150261f, 0.76281076f, 1.00000000f,
-    0.64102399f, 0.76247267f, 1.00000000f,
-    0.64055061f, 0.76213824f, 1.00000000f,
-    0.64008239f, 0.76180740f, 1.00000000f, /* 22000K */
-    0.63961926f, 0.76148010f, 1.00000000f,
-    0.63916112f, 0.76115628f, 1.00000000f,
-    0.63870790f, 0.76083590f, 1.00000000f,
-    0.63825953f, 0.76051890f, 1.00000000f,
-    0.63781592f, 0.76020522f, 1.00000000f,
-    0.63737701f, 0.75989482f, 1.00000000f,
-    0.63694273f, 0.75958764f, 1.00000000f,
-    0.63651299f, 0.75928365f, 1.00000000f,
-    0.63608774f, 0.75898278f, 1.00000000f,
-    0.63566691f, 0.75868499f, 1.00000000f, /* 23000K */
-    0.63525042f, 0.75839025f, 1.00000000f,
-    0.63483822f, 0.75809849f, 1.00000000f,
-    0.63443023f, 0.75780969f, 1.00000000f,
-    0.63402641f, 0.75752379f, 1.00000000f,
-    0.63362667f, 0.75724075f, 1.00000000f,
-    0.63323097f, 0.75696053f, 1.00000000f,
-    0.63283925f, 0.75668310f, 1.00000000f,
-    0.63245144f, 0.75640840f, 1.00000000f,
-    0.63206749f, 0.75613641f, 1.00000000f,
-    0.63168735f, 0.75586707f, 1.00000000f, /* 24000K */
-    0.63131096f, 0.75560036f, 1.00000000f,
-    0.63093826f, 0.75533624f, 1.00000000f,
-    0.63056920f, 0.75507467f, 1.00000000f,
-    0.63020374f, 0.75481562f, 1.00000000f,
-    0.62984181f, 0.75455904f, 1.00000000f,
-    0.62948337f, 0.75430491f, 1.00000000f,
-    0.62912838f, 0.75405319f, 1.00000000f,
-    0.62877678f, 0.75380385f, 1.00000000f,
-    0.62842852f, 0.75355685f, 1.00000000f,
-    0.62808356f, 0.75331217f, 1.00000000f, /* 25000K */
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define BLACKBODY_STEP 100       /* Kelvin between table rows */
+#define Q16_ONE        (1u << 16)
+
+/* blackbody.def channels are in 1e-8; round to Q16 */
+#define BLACKBODY_Q16(v) ((uint32_t)(((uint64_t)(v) * Q16_ONE + 50000000u) / 100000000u))
+
+/* Whitepoints at 100K intervals from 1000K, Q16 per channel.
+ * Rounded by the compiler; nothing is converted at runtime. */
+static constexpr uint32_t blackbody_q16[][3] = {
+#define BLACKBODY(kelvin, r, g, b) { BLACKBODY_Q16(r), BLACKBODY_Q16(g), BLACKBODY_Q16(b) },
+#include "../../../blackbody.def"
+#undef BLACKBODY
 };
 
-#define BLACKBODY_TABLE_SIZE (sizeof(blackbody_color) / sizeof(blackbody_color[0]) / 3)
+#define BLACKBODY_TABLE_SIZE ((int)(sizeof(blackbody_q16) / sizeof(blackbody_q16[0])))
+
+/* Row i must be MERIDIAN_TEMP_MIN + i * BLACKBODY_STEP, channels at most 1.0 */
+enum {
+#define BLACKBODY(kelvin, r, g, b) BLACKBODY_ROW_##kelvin,
+#include "../../../blackbody.def"
+#undef BLACKBODY
+};
+#define BLACKBODY(kelvin, r, g, b)                                                  \
+    static_assert(BLACKBODY_ROW_##kelvin * BLACKBODY_STEP + MERIDIAN_TEMP_MIN == (kelvin) && \
+                  (r) <= 100000000 && (g) <= 100000000 && (b) <= 100000000,        \
+                  "blackbody.def: bad row " #kelvin);
+#include "../../../blackbody.def"
+#undef BLACKBODY
 
-/* Compile-time validation: 240 entries for 1000K-24900K at 100K intervals
- * (25000K handled by clamping to last entry for interpolation) */
 static_assert(BLACKBODY_TABLE_SIZE == 240,
               "blackbody table must have 240 entries (1000K-24900K at 100K intervals)");
 
+/*
+ * Q16 multipliers for temp, interpolated per kelvin between rows.
+ * 24900K-25000K use the last row.
+ */
+static void
+blackbody_lookup(int temp, uint32_t rgb[3])
+{
+    int off = temp - MERIDIAN_TEMP_MIN;
+    int idx = off / BLACKBODY_STEP;
+    uint32_t f = (uint32_t)(off % BLACKBODY_STEP);
+
+    if (idx >= BLACKBODY_TABLE_SIZE - 1) {
+        idx = BLACKBODY_TABLE_SIZE - 2;
+        f = BLACKBODY_STEP;
+    }
+
+    const uint32_t *c1 = blackbody_q16[idx];
+    const uint32_t *c2 = blackbody_q16[idx + 1];
+    for (int c = 0; c < 3; c++)
+        rgb[c] = (c1[c] * (BLACKBODY_STEP - f) + c2[c] * f + BLACKBODY_STEP / 2) / BLACKBODY_STEP;
+}
+
 meridian_error_t
 meridian_temp_to_rgb(int temp, meridian_rgb_t *rgb)
 {
@@ -269,26 +79,233 @@ meridian_temp_to_rgb(int temp, meridian_rgb_t *rgb)
         return MERIDIAN_ERR_INVALID_TEMP;
     }
 
-    /* Interpolate from table */
-    float alpha = (temp - MERIDIAN_TEMP_MIN) / 100.0f;
-    int idx = (int)alpha;
-    alpha -= idx;
+    uint32_t q[3];
+    blackbody_lookup(temp, q);
 
-    /* Clamp index */
-    if (idx < 0) idx = 0;
-    if (idx >= (int)BLACKBODY_TABLE_SIZE - 1) {
-        idx = BLACKBODY_TABLE_SIZE - 2;
-        alpha = 1.0f;
+    constexpr float unit = 1.0f / Q16_ONE;
+    rgb->r = q[0] * unit;
+    rgb->g = q[1] * unit;
+    rgb->b = q[2] * unit;
+
+    return MERIDIAN_OK;
+}
+
+/*
+ * Ramp fill kernels.
+ *
+ * A ramp for a channel is out[i] = (i * step) >> 16, where step is the
+ * channel's Q16 multiplier times ramp_index_scale(n). The largest
+ * product, (n - 1) * step, stays below 2^32, so every kernel computes
+ * the same 32-bit values: the scalar one multiplies, the vector ones
+ * start lanes at i * step and add 8 * step per iteration.
+ */
+
+typedef void (*ramp_kernel_fn)(uint16_t *restrict out, int n, uint32_t step);
+
+/* Largest supported ramp: keeps (n - 1) * step within 32 bits */
+constexpr int RAMP_SIZE_MAX = 65536;
+
+/* Output per index step at full scale, Q16: ceil(65535 * 2^16 / (n - 1)).
+ * Rounding up makes a full-scale ramp end exactly at 65535. */
+#define RAMP_INDEX_SCALE(n) \
+    ((uint32_t)(((uint64_t)UINT16_MAX * Q16_ONE + (uint64_t)(n) - 2) / ((uint64_t)(n) - 1)))
+
+static uint32_t
+ramp_index_scale(int n)
+{
+    /* Common sizes fold to constants: no division per fill */
+    switch (n) {
+    case 256:  return RAMP_INDEX_SCALE(256);
+    case 1024: return RAMP_INDEX_SCALE(1024);
+    case 4096: return RAMP_INDEX_SCALE(4096);
+    default:   return RAMP_INDEX_SCALE(n);
+    }
+}
+
+/*
+ * Instantiate a kernel body with a constant entry count for the common
+ * gamma sizes, so those loops are unrolled with no tail; anything else
+ * takes the generic instance.
+ */
+#define RAMP_SPECIALIZE(body, out, n, step)        \
+    switch (n) {                                   \
+    case 256:  body(out, 256, step);  break;       \
+    case 1024: body(out, 1024, step); break;       \
+    case 4096: body(out, 4096, step); break;       \
+    default:   body(out, n, step);    break;       \
+    }
+
+[[gnu::always_inline]]
+static inline void
+ramp_body_scalar(uint16_t *restrict out, int n, uint32_t step)
+{
+    for (int i = 0; i < n; i++)
+        out[i] = (uint16_t)(((uint32_t)i * step) >> 16);
+}
+
+static void
+ramp_kernel_scalar(uint16_t *restrict out, int n, uint32_t step)
+{
+    RAMP_SPECIALIZE(ramp_body_scalar, out, n, step);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+[[gnu::target("avx2"), gnu::always_inline]]
+static inline void
+ramp_body_avx2(uint16_t *restrict out, int n, uint32_t step)
+{
+    const __m256i stride = _mm256_set1_epi32((int)(8 * step));
+    __m256i acc = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                     _mm256_set1_epi32((int)step));
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i q = _mm256_srli_epi32(acc, 16);
+
+        /* Values are 0..65535, so unsigned-saturating pack is exact */
+        __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(q),
+                                          _mm256_extracti128_si256(q, 1));
+        _mm_storeu_si128((__m128i *)(out + i), packed);
+        acc = _mm256_add_epi32(acc, stride);
+    }
+
+    for (; i < n; i++)
+        out[i] = (uint16_t)(((uint32_t)i * step) >> 16);
+}
+
+[[gnu::target("avx2")]]
+static void
+ramp_kernel_avx2(uint16_t *restrict out, int n, uint32_t step)
+{
+    RAMP_SPECIALIZE(ramp_body_avx2, out, n, step);
+}
+
+[[gnu::target("sse4.1"), gnu::always_inline]]
+static inline void
+ramp_body_sse41(uint16_t *restrict out, int n, uint32_t step)
+{
+    const __m128i vstep = _mm_set1_epi32((int)step);
+    const __m128i stride = _mm_set1_epi32((int)(8 * step));
+    __m128i lo = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), vstep);
+    __m128i hi = _mm_mullo_epi32(_mm_setr_epi32(4, 5, 6, 7), vstep);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i packed = _mm_packus_epi32(_mm_srli_epi32(lo, 16),
+                                          _mm_srli_epi32(hi, 16));
+        _mm_storeu_si128((__m128i *)(out + i), packed);
+        lo = _mm_add_epi32(lo, stride);
+        hi = _mm_add_epi32(hi, stride);
+    }
+
+    for (; i < n; i++)
+        out[i] = (uint16_t)(((uint32_t)i * step) >> 16);
+}
+
+[[gnu::target("sse4.1")]]
+static void
+ramp_kernel_sse41(uint16_t *restrict out, int n, uint32_t step)
+{
+    RAMP_SPECIALIZE(ramp_body_sse41, out, n, step);
+}
+
+#elif defined(__aarch64__)
+
+[[gnu::always_inline]]
+static inline void
+ramp_body_neon(uint16_t *restrict out, int n, uint32_t step)
+{
+    static const uint32_t lanes[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+    const uint32x4_t stride = vdupq_n_u32(8 * step);
+    uint32x4_t lo = vmulq_n_u32(vld1q_u32(lanes), step);
+    uint32x4_t hi = vmulq_n_u32(vld1q_u32(lanes + 4), step);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint16x8_t packed = vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+        vst1q_u16(out + i, packed);
+        lo = vaddq_u32(lo, stride);
+        hi = vaddq_u32(hi, stride);
+    }
+
+    for (; i < n; i++)
+        out[i] = (uint16_t)(((uint32_t)i * step) >> 16);
+}
+
+static void
+ramp_kernel_neon(uint16_t *restrict out, int n, uint32_t step)
+{
+    RAMP_SPECIALIZE(ramp_body_neon, out, n, step);
+}
+
+#endif
+
+/* Kernel dispatch: resolved once from CPU features on first use */
+static struct {
+    ramp_kernel_fn fn;
+    const char *name;
+} ramp_kernel;
+
+static void
+ramp_kernel_resolve(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        ramp_kernel.fn = ramp_kernel_avx2;
+        ramp_kernel.name = "avx2";
+        return;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        ramp_kernel.fn = ramp_kernel_sse41;
+        ramp_kernel.name = "sse4.1";
+        return;
     }
+#elif defined(__aarch64__)
+    /* Advanced SIMD is mandatory on AArch64 */
+    ramp_kernel.fn = ramp_kernel_neon;
+    ramp_kernel.name = "neon";
+    return;
+#endif
+    ramp_kernel.fn = ramp_kernel_scalar;
+    ramp_kernel.name = "scalar";
+}
+
+static inline ramp_kernel_fn
+ramp_kernel_get(void)
+{
+    if (!ramp_kernel.fn) ramp_kernel_resolve();
+    return ramp_kernel.fn;
+}
+
+const char *
+meridian_ramp_kernel_name(void)
+{
+    ramp_kernel_get();
+    return ramp_kernel.name;
+}
 
-    /* Linear interpolation */
-    const float *c1 = &blackbody_color[idx * 3];
-    const float *c2 = &blackbody_color[(idx + 1) * 3];
+/* Validate inputs and compute each channel's per-index step */
+static meridian_error_t
+ramp_steps(int temp, int gamma_size, float brightness, uint32_t step[3])
+{
+    if (gamma_size < 2 || gamma_size > RAMP_SIZE_MAX) return MERIDIAN_ERR_INVALID_TEMP;
+    if (temp < MERIDIAN_TEMP_MIN || temp > MERIDIAN_TEMP_MAX) return MERIDIAN_ERR_INVALID_TEMP;
+
+    /* Clamp brightness to valid range (NaN counts as 0) and take it to Q16 */
+    if (!(brightness > 0.0f)) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+    uint32_t bright = (uint32_t)(brightness * (float)Q16_ONE + 0.5f);
 
-    rgb->r = c1[0] * (1.0f - alpha) + c2[0] * alpha;
-    rgb->g = c1[1] * (1.0f - alpha) + c2[1] * alpha;
-    rgb->b = c1[2] * (1.0f - alpha) + c2[2] * alpha;
+    uint32_t rgb[3];
+    blackbody_lookup(temp, rgb);
 
+    uint64_t index_scale = ramp_index_scale(gamma_size);
+    for (int c = 0; c < 3; c++) {
+        uint64_t scale = ((uint64_t)rgb[c] * bright + Q16_ONE / 2) >> 16;
+        step[c] = (uint32_t)((scale * index_scale) >> 16);
+    }
     return MERIDIAN_OK;
 }
 
@@ -296,31 +313,274 @@ meridian_error_t
 meridian_fill_gamma_ramps(int temp, int gamma_size,
                           uint16_t *restrict r, uint16_t *restrict g, uint16_t *restrict b,
                           float brightness)
+{
+    uint32_t step[3];
+    meridian_error_t err = ramp_steps(temp, gamma_size, brightness, step);
+    if (err != MERIDIAN_OK) return err;
+
+    ramp_kernel_fn fill = ramp_kernel_get();
+    fill(r, gamma_size, step[0]);
+    fill(g, gamma_size, step[1]);
+    fill(b, gamma_size, step[2]);
+
+    return MERIDIAN_OK;
+}
+
+meridian_error_t
+meridian_fill_gamma_ramps_batch(const meridian_ramp_job_t *jobs, int count)
+{
+    if (!jobs || count < 0) return MERIDIAN_ERR_RESOURCES;
+
+    ramp_kernel_fn fill = ramp_kernel_get();
+    meridian_error_t first_err = MERIDIAN_OK;
+    const meridian_ramp_job_t *prev = nullptr;
+
+    for (int i = 0; i < count; i++) {
+        const meridian_ramp_job_t *job = &jobs[i];
+
+        /* Same parameters as the previous good job (N CRTCs, one temp):
+         * copy its output instead of recomputing. */
+        if (prev && job->temp == prev->temp && job->gamma_size == prev->gamma_size &&
+            job->brightness == prev->brightness) {
+            size_t bytes = (size_t)job->gamma_size * sizeof(uint16_t);
+            memcpy(job->r, prev->r, bytes);
+            memcpy(job->g, prev->g, bytes);
+            memcpy(job->b, prev->b, bytes);
+            continue;
+        }
+
+        uint32_t step[3];
+        meridian_error_t err = ramp_steps(job->temp, job->gamma_size,
+                                          job->brightness, step);
+        if (err != MERIDIAN_OK) {
+            if (first_err == MERIDIAN_OK) first_err = err;
+            prev = nullptr;
+            continue;
+        }
+
+        fill(job->r, job->gamma_size, step[0]);
+        fill(job->g, job->gamma_size, step[1]);
+        fill(job->b, job->gamma_size, step[2]);
+        prev = job;
+    }
+
+    return first_err;
+}
+
+/*
+ * Ramp cache: small LRU keyed on (temp, gamma_size, brightness).
+ *
+ * Multi-head setups usually share one gamma size, so a single fill
+ * serves every CRTC; repeated temperatures (restarts of a transition,
+ * re-applies after restore) hit without recomputing. Slot buffers are
+ * kept across evictions and only grow, so steady state never allocates.
+ */
+
+typedef struct {
+    int temp;
+    int gamma_size;
+    float brightness;
+    int capacity;           /* entries per channel in ramps */
+    uint64_t last_used;     /* 0 = empty slot */
+    uint16_t *ramps;        /* R, G, B contiguous, capacity entries each */
+} ramp_cache_slot_t;
+
+static struct {
+    ramp_cache_slot_t slots[MERIDIAN_RAMP_CACHE_SLOTS];
+    uint64_t clock;
+} ramp_cache;
+
+/*
+ * Pinned set: ramps for a sequence known in advance (a fade), filled in
+ * one go and looked up by binary search ahead of the LRU. Sorted unique
+ * temps; entry i's ramps start at ramps + i * gamma_size * 3.
+ */
+static struct {
+    int *temps;
+    int count;
+    int gamma_size;
+    float brightness;
+    uint16_t *ramps;
+} ramp_pin;
+
+static const uint16_t *
+ramp_pin_lookup(int temp, int gamma_size, float brightness)
+{
+    if (!ramp_pin.count || ramp_pin.gamma_size != gamma_size ||
+        ramp_pin.brightness != brightness)
+        return nullptr;
+
+    int lo = 0, hi = ramp_pin.count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (ramp_pin.temps[mid] == temp)
+            return ramp_pin.ramps + (size_t)mid * gamma_size * 3;
+        if (ramp_pin.temps[mid] < temp) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return nullptr;
+}
+
+static int
+cmp_int(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+meridian_error_t
+meridian_ramp_pin(const int *temps, int count, int gamma_size, float brightness)
+{
+    meridian_ramp_unpin();
+    if (gamma_size < 2 || count <= 0) return MERIDIAN_ERR_INVALID_TEMP;
+
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    int *sorted = malloc((size_t)count * sizeof(int));
+    if (!sorted) return MERIDIAN_ERR_RESOURCES;
+    memcpy(sorted, temps, (size_t)count * sizeof(int));
+    qsort(sorted, (size_t)count, sizeof(int), cmp_int);
+
+    int unique = 0;
+    for (int i = 0; i < count; i++) {
+        if (sorted[i] < MERIDIAN_TEMP_MIN || sorted[i] > MERIDIAN_TEMP_MAX) {
+            free(sorted);
+            return MERIDIAN_ERR_INVALID_TEMP;
+        }
+        if (unique == 0 || sorted[unique - 1] != sorted[i])
+            sorted[unique++] = sorted[i];
+    }
+
+    size_t per_temp = (size_t)gamma_size * 3 * sizeof(uint16_t);
+    if ((size_t)unique * per_temp > MERIDIAN_RAMP_PIN_MAX_BYTES) {
+        free(sorted);
+        return MERIDIAN_ERR_RESOURCES;
+    }
+    uint16_t *ramps = malloc((size_t)unique * per_temp);
+    if (!ramps) {
+        free(sorted);
+        return MERIDIAN_ERR_RESOURCES;
+    }
+
+    for (int i = 0; i < unique; i++) {
+        uint16_t *r = ramps + (size_t)i * gamma_size * 3;
+        meridian_error_t err = meridian_fill_gamma_ramps(sorted[i], gamma_size,
+                                                          r, r + gamma_size,
+                                                          r + gamma_size * 2,
+                                                          brightness);
+        if (err != MERIDIAN_OK) {
+            free(ramps);
+            free(sorted);
+            return err;
+        }
+    }
+
+    ramp_pin.temps = sorted;
+    ramp_pin.count = unique;
+    ramp_pin.gamma_size = gamma_size;
+    ramp_pin.brightness = brightness;
+    ramp_pin.ramps = ramps;
+    return MERIDIAN_OK;
+}
+
+void
+meridian_ramp_unpin(void)
+{
+    free(ramp_pin.temps);
+    free(ramp_pin.ramps);
+    memset(&ramp_pin, 0, sizeof(ramp_pin));
+}
+
+static ramp_cache_slot_t *
+ramp_cache_lookup(int temp, int gamma_size, float brightness)
+{
+    for (int i = 0; i < MERIDIAN_RAMP_CACHE_SLOTS; i++) {
+        ramp_cache_slot_t *slot = &ramp_cache.slots[i];
+        if (slot->last_used && slot->temp == temp &&
+            slot->gamma_size == gamma_size && slot->brightness == brightness) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+static ramp_cache_slot_t *
+ramp_cache_victim(void)
+{
+    ramp_cache_slot_t *victim = &ramp_cache.slots[0];
+    for (int i = 1; i < MERIDIAN_RAMP_CACHE_SLOTS; i++) {
+        if (ramp_cache.slots[i].last_used < victim->last_used) {
+            victim = &ramp_cache.slots[i];
+        }
+    }
+    return victim;
+}
+
+meridian_error_t
+meridian_ramp_cache_get(int temp, int gamma_size, float brightness,
+                        meridian_ramp_t *out)
 {
     if (gamma_size < 2) return MERIDIAN_ERR_INVALID_TEMP;
+    if (temp < MERIDIAN_TEMP_MIN || temp > MERIDIAN_TEMP_MAX) {
+        return MERIDIAN_ERR_INVALID_TEMP;
+    }
 
-    /* Clamp brightness to valid range */
+    /* Key on the clamped value so out-of-range callers share entries */
     if (brightness < 0.0f) brightness = 0.0f;
     if (brightness > 1.0f) brightness = 1.0f;
 
-    meridian_rgb_t rgb;
-    meridian_error_t err = meridian_temp_to_rgb(temp, &rgb);
-    if (err != MERIDIAN_OK) return err;
+    const uint16_t *pinned = ramp_pin_lookup(temp, gamma_size, brightness);
+    if (pinned) {
+        out->r = pinned;
+        out->g = pinned + gamma_size;
+        out->b = pinned + gamma_size * 2;
+        return MERIDIAN_OK;
+    }
 
-    /* Apply brightness */
-    rgb.r *= brightness;
-    rgb.g *= brightness;
-    rgb.b *= brightness;
+    ramp_cache_slot_t *slot = ramp_cache_lookup(temp, gamma_size, brightness);
+    if (!slot) {
+        /* Miss: refill the least recently used slot */
+        slot = ramp_cache_victim();
+        if (slot->capacity < gamma_size) {
+            /* Grow every slot at once: later misses refill in place */
+            for (int i = 0; i < MERIDIAN_RAMP_CACHE_SLOTS; i++) {
+                ramp_cache_slot_t *s = &ramp_cache.slots[i];
+                if (s->capacity >= gamma_size) continue;
+                uint16_t *buf = realloc(s->ramps,
+                                        (size_t)gamma_size * 3 * sizeof(uint16_t));
+                if (!buf) return MERIDIAN_ERR_RESOURCES;
+                s->ramps = buf;
+                s->capacity = gamma_size;
+            }
+        }
 
-    /* Fill ramps with gamma-corrected values */
-    for (int i = 0; i < gamma_size; i++) {
-        float v = (float)i / (gamma_size - 1);
+        slot->last_used = 0;
+        meridian_error_t err = meridian_fill_gamma_ramps(temp, gamma_size,
+                                                          slot->ramps,
+                                                          slot->ramps + gamma_size,
+                                                          slot->ramps + gamma_size * 2,
+                                                          brightness);
+        if (err != MERIDIAN_OK) return err;
 
-        /* Apply color adjustment and scale to uint16 */
-        r[i] = (uint16_t)(v * rgb.r * UINT16_MAX);
-        g[i] = (uint16_t)(v * rgb.g * UINT16_MAX);
-        b[i] = (uint16_t)(v * rgb.b * UINT16_MAX);
+        slot->temp = temp;
+        slot->gamma_size = gamma_size;
+        slot->brightness = brightness;
     }
 
+    slot->last_used = ++ramp_cache.clock;
+
+    out->r = slot->ramps;
+    out->g = slot->ramps + gamma_size;
+    out->b = slot->ramps + gamma_size * 2;
     return MERIDIAN_OK;
 }
+
+void
+meridian_ramp_cache_clear(void)
+{
+    for (int i = 0; i < MERIDIAN_RAMP_CACHE_SLOTS; i++) {
+        free(ramp_cache.slots[i].ramps);
+    }
+    memset(&ramp_cache, 0, sizeof(ramp_cache));
+}
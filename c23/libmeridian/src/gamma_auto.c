@@ -8,6 +8,13 @@
  *   2. DRM (kernel ioctl) - always available
  *   3. X11 (RandR) - NVIDIA fallback
  *
+ * The null backend is never probed; only meridian_init_null() selects it.
+ *
+ * The order only picks the winner: independent probes run on their own
+ * threads and the earliest success in the list is kept. A probe record
+ * from the previous start (meridian_init_probed) skips all of it when its
+ * backend still comes up in the same session.
+ *
  * X11 and GNOME backends load their libraries via dlopen (in their own files).
  * Wayland backend is a separate .so plugin (meridian_wl.so) loaded here.
  */
@@ -18,7 +25,19 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <dlfcn.h>
+#include <pthread.h>
+
+/* USDT probes (provider "meridian"), nops unless a tracer attaches */
+#if !defined(MERIDIAN_NO_USDT) && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define MERIDIAN_PROBE2(name, a, b)     DTRACE_PROBE2(meridian, name, a, b)
+#define MERIDIAN_PROBE3(name, a, b, c)  DTRACE_PROBE3(meridian, name, a, b, c)
+#else
+#define MERIDIAN_PROBE2(name, a, b)     ((void)(a), (void)(b))
+#define MERIDIAN_PROBE3(name, a, b, c)  ((void)(a), (void)(b), (void)(c))
+#endif
 
 /* ============================================================
  * Error handling (shared by all backends)
@@ -36,6 +55,7 @@ static const char *error_messages[] = {
     [-MERIDIAN_ERR_WAYLAND_CONNECT] = "Failed to connect to Wayland display",
     [-MERIDIAN_ERR_WAYLAND_PROTOCOL] = "Wayland compositor lacks gamma control protocol",
     [-MERIDIAN_ERR_GNOME_DBUS] = "Failed to communicate with Mutter via DBus",
+    [-MERIDIAN_ERR_BUSY] = "Previous frame not yet displayed",
 };
 
 const char *
@@ -61,7 +81,10 @@ static struct {
     int (*get_gamma_size)(const meridian_wl_state_t *, int);
     meridian_error_t (*set_temperature)(meridian_wl_state_t *, int, float);
     meridian_error_t (*set_temperature_crtc)(meridian_wl_state_t *, int, int, float);
+    meridian_error_t (*prepare_temperature)(meridian_wl_state_t *, int, float);
     meridian_error_t (*restore)(meridian_wl_state_t *);
+    int (*get_fd)(const meridian_wl_state_t *);
+    meridian_error_t (*dispatch)(meridian_wl_state_t *, bool *);
     bool loaded;
 } wl_plugin;
 
@@ -85,7 +108,10 @@ static bool wl_plugin_load(void)
     LOAD_WL(get_gamma_size,     "meridian_wl_get_gamma_size");
     LOAD_WL(set_temperature,    "meridian_wl_set_temperature");
     LOAD_WL(set_temperature_crtc, "meridian_wl_set_temperature_crtc");
+    LOAD_WL(prepare_temperature, "meridian_wl_prepare_temperature");
     LOAD_WL(restore,            "meridian_wl_restore");
+    LOAD_WL(get_fd,             "meridian_wl_get_fd");
+    LOAD_WL(dispatch,           "meridian_wl_dispatch");
     #undef LOAD_WL
     #pragma GCC diagnostic pop
 
@@ -106,6 +132,7 @@ typedef enum {
     BACKEND_X11,
     BACKEND_WAYLAND,
     BACKEND_GNOME,
+    BACKEND_NULL,
 } backend_type_t;
 
 /* Unified state */
@@ -113,6 +140,7 @@ struct meridian_state {
     backend_type_t backend;
     union {
         meridian_drm_state_t *drm;
+        meridian_null_state_t *null;
 #ifdef MERIDIAN_HAS_X11
         meridian_x11_state_t *x11;
 #endif
@@ -123,55 +151,31 @@ struct meridian_state {
         meridian_gnome_state_t *gnome;
 #endif
     };
-};
-
-meridian_error_t
-meridian_init(meridian_state_t **state_out)
-{
-    return meridian_init_card(0, state_out);
-}
 
-meridian_error_t
-meridian_init_card(int card_num, meridian_state_t **state_out)
-{
-    meridian_state_t *state = calloc(1, sizeof(meridian_state_t));
-    if (!state) return MERIDIAN_ERR_RESOURCES;
+    int card_num;
 
-    meridian_error_t err;
+    /* Last whole-screen setting, replayed onto hotplugged outputs */
+    bool have_last;
+    int last_temp;
+    float last_brightness;
+};
 
-#ifndef ABXS_STATIC
-    /* Wayland session: try Wayland backends first */
-    const char *wayland_display = getenv("WAYLAND_DISPLAY");
-    if (wayland_display && wayland_display[0]) {
+/* ============================================================
+ * Backend probing
+ * ============================================================ */
 
-#ifdef MERIDIAN_HAS_WAYLAND
-        /* Try wlr-gamma-control (Sway, Hyprland, river, etc.) */
-        if (wl_plugin_load()) {
-            err = wl_plugin.init(&state->wl);
-            if (err == MERIDIAN_OK) {
-                state->backend = BACKEND_WAYLAND;
-                *state_out = state;
-                return MERIDIAN_OK;
-            }
-        }
-#endif
+/* Bring up one backend in state; DRM also needs a CRTC with usable gamma */
+static meridian_error_t probe_backend(meridian_state_t *state, backend_type_t backend,
+                                      int card_num)
+{
+    meridian_error_t err = MERIDIAN_ERR_NO_CRTC;
+    state->backend = BACKEND_NONE;
 
-#ifdef MERIDIAN_HAS_GNOME
-        /* Try Mutter DBus (GNOME Wayland) */
-        err = meridian_gnome_init(&state->gnome);
-        if (err == MERIDIAN_OK) {
-            state->backend = BACKEND_GNOME;
-            *state_out = state;
-            return MERIDIAN_OK;
-        }
-#endif
-    }
-#endif /* !ABXS_STATIC */
+    switch (backend) {
+    case BACKEND_DRM: {
+        err = meridian_drm_init(card_num, &state->drm);
+        if (err != MERIDIAN_OK) break;
 
-    /* Try DRM */
-    err = meridian_drm_init(card_num, &state->drm);
-    if (err == MERIDIAN_OK) {
-        /* Check if any CRTC has usable gamma */
         int usable = 0;
         int count = meridian_drm_get_crtc_count(state->drm);
         for (int i = 0; i < count; i++) {
@@ -179,42 +183,47 @@ meridian_init_card(int card_num, meridian_state_t **state_out)
                 usable++;
             }
         }
-
-        if (usable > 0) {
-            state->backend = BACKEND_DRM;
-            *state_out = state;
-            return MERIDIAN_OK;
+        if (usable == 0) {
+            /* DRM opened but no usable gamma (NVIDIA, etc.) */
+            meridian_drm_free(state->drm);
+            state->drm = nullptr;
+            err = MERIDIAN_ERR_NO_CRTC;
         }
-
-        /* DRM opened but no usable gamma (NVIDIA, etc.) */
-        meridian_drm_free(state->drm);
-        state->drm = nullptr;
+        break;
     }
-
 #if !defined(ABXS_STATIC) && defined(MERIDIAN_HAS_X11)
-    /* Fall back to X11 */
-    err = meridian_x11_init(&state->x11);
-    if (err == MERIDIAN_OK) {
-        state->backend = BACKEND_X11;
-        *state_out = state;
-        return MERIDIAN_OK;
-    }
+    case BACKEND_X11:
+        err = meridian_x11_init(&state->x11);
+        break;
+#endif
+#if !defined(ABXS_STATIC) && defined(MERIDIAN_HAS_WAYLAND)
+    case BACKEND_WAYLAND:
+        err = wl_plugin_load() ? wl_plugin.init(&state->wl) : MERIDIAN_ERR_WAYLAND_CONNECT;
+        break;
 #endif
+#if !defined(ABXS_STATIC) && defined(MERIDIAN_HAS_GNOME)
+    case BACKEND_GNOME:
+        err = meridian_gnome_init(&state->gnome);
+        break;
+#endif
+    default:
+        break;
+    }
 
-    /* All backends failed */
-    free(state);
-    return MERIDIAN_ERR_NO_CRTC;
+    if (err == MERIDIAN_OK) state->backend = backend;
+    return err;
 }
 
-void
-meridian_free(meridian_state_t *state)
+/* Release the backend without touching the ramp cache */
+static void free_backend(meridian_state_t *state)
 {
-    if (!state) return;
-
     switch (state->backend) {
     case BACKEND_DRM:
         meridian_drm_free(state->drm);
         break;
+    case BACKEND_NULL:
+        meridian_null_free(state->null);
+        break;
 #ifdef MERIDIAN_HAS_X11
     case BACKEND_X11:
         meridian_x11_free(state->x11);
@@ -233,7 +242,260 @@ meridian_free(meridian_state_t *state)
     default:
         break;
     }
+    state->backend = BACKEND_NONE;
+}
+
+static bool wayland_session(void)
+{
+#ifndef ABXS_STATIC
+    const char *wayland_display = getenv("WAYLAND_DISPLAY");
+    return wayland_display && wayland_display[0];
+#else
+    return false;
+#endif
+}
+
+/* Backends this build can bring up */
+static bool probe_compiled(backend_type_t backend)
+{
+    switch (backend) {
+    case BACKEND_DRM:
+        return true;
+#ifndef ABXS_STATIC
+#ifdef MERIDIAN_HAS_X11
+    case BACKEND_X11:
+        return true;
+#endif
+#ifdef MERIDIAN_HAS_WAYLAND
+    case BACKEND_WAYLAND:
+        return true;
+#endif
+#ifdef MERIDIAN_HAS_GNOME
+    case BACKEND_GNOME:
+        return true;
+#endif
+#endif
+    default:
+        return false;
+    }
+}
+
+/* Display environment a probe result belongs to */
+static void probe_session(char *out, size_t cap)
+{
+    const char *wl = getenv("WAYLAND_DISPLAY");
+    const char *x = getenv("DISPLAY");
+    snprintf(out, cap, "wayland=%s x11=%s", wl ? wl : "", x ? x : "");
+}
+
+static backend_type_t backend_from_name(const char *name)
+{
+    static const backend_type_t all[] = {
+        BACKEND_DRM, BACKEND_X11, BACKEND_WAYLAND, BACKEND_GNOME,
+    };
+    for (size_t i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        meridian_state_t named = { .backend = all[i] };
+        if (strcmp(name, meridian_get_backend_name(&named)) == 0) return all[i];
+    }
+    return BACKEND_NONE;
+}
+
+/* One backend probed on its own thread; each writes only its own job */
+typedef struct {
+    meridian_state_t state;
+    backend_type_t   backend;
+    int              card_num;
+    meridian_error_t err;
+    pthread_t        thread;
+    bool             threaded;
+} probe_job_t;
+
+static void *probe_thread(void *arg)
+{
+    probe_job_t *job = arg;
+    job->err = probe_backend(&job->state, job->backend, job->card_num);
+    return nullptr;
+}
+
+/*
+ * Probe jobs[0..n) and keep the first success in list order, so the
+ * winner is the backend a one-by-one probe would have picked. Concurrent:
+ * jobs after the first get their own thread (one that cannot be created
+ * runs inline). Serial: stop at the first success. Every other success
+ * is freed.
+ */
+static int probe_all(probe_job_t *jobs, int n, bool concurrent)
+{
+    if (n <= 0) return -1;
+    if (concurrent)
+        for (int i = 1; i < n; i++)
+            jobs[i].threaded = pthread_create(&jobs[i].thread, nullptr,
+                                              probe_thread, &jobs[i]) == 0;
+    bool found = false;
+    for (int i = 0; i < n; i++) {
+        if (jobs[i].threaded)
+            pthread_join(jobs[i].thread, nullptr);
+        else if (concurrent || !found)
+            (void)probe_thread(&jobs[i]);
+        else
+            jobs[i].err = MERIDIAN_ERR_NO_CRTC;
+        found |= jobs[i].err == MERIDIAN_OK;
+    }
+
+    int winner = -1;
+    for (int i = 0; i < n; i++) {
+        if (jobs[i].err != MERIDIAN_OK) continue;
+        if (winner < 0) winner = i;
+        else free_backend(&jobs[i].state);
+    }
+    return winner;
+}
+
+/* Backends a probe tries, in preference order, skipping one already tried */
+static int probe_candidates(backend_type_t list[static 4], backend_type_t skip)
+{
+    int n = 0;
+    if (wayland_session()) {
+        list[n++] = BACKEND_WAYLAND;
+        list[n++] = BACKEND_GNOME;
+    }
+    list[n++] = BACKEND_DRM;
+    list[n++] = BACKEND_X11;
+
+    int kept = 0;
+    for (int i = 0; i < n; i++)
+        if (list[i] != skip && probe_compiled(list[i])) list[kept++] = list[i];
+    return kept;
+}
+
+/* ============================================================
+ * Init / free
+ * ============================================================ */
+
+/* States not yet freed: the ramp cache is shared by all of them */
+static int live_states = 0;
+
+meridian_error_t
+meridian_init(meridian_state_t **state_out)
+{
+    return meridian_init_card(0, state_out);
+}
+
+static meridian_error_t
+init_state(int card_num, const meridian_probe_t *hint, bool concurrent,
+           meridian_state_t **state_out, bool *from_hint)
+{
+    if (from_hint) *from_hint = false;
+    meridian_state_t *state = calloc(1, sizeof(meridian_state_t));
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    /* The last winner, if it was found in this same session on this card */
+    backend_type_t hinted = BACKEND_NONE;
+    if (hint && hint->card_num == card_num) {
+        char session[sizeof(hint->session)];
+        probe_session(session, sizeof(session));
+        if (strcmp(session, hint->session) == 0)
+            hinted = backend_from_name(hint->backend);
+        if (!probe_compiled(hinted)) hinted = BACKEND_NONE;
+    }
+    if (hinted != BACKEND_NONE &&
+        probe_backend(state, hinted, card_num) == MERIDIAN_OK) {
+        state->card_num = card_num;
+        if (from_hint) *from_hint = true;
+        live_states++;
+        *state_out = state;
+        return MERIDIAN_OK;
+    }
+
+    /*
+     * Full probe. Wayland, GNOME and DRM only look, so they can go
+     * together; X11 joins DRM outside Wayland but in a Wayland session
+     * waits until the rest failed, since connecting can start Xwayland.
+     */
+    backend_type_t list[4];
+    int n = probe_candidates(list, hinted);
+    int first = n;
+    if (wayland_session())
+        for (int i = 0; i < n; i++)
+            if (list[i] == BACKEND_X11) first = i;
+
+    probe_job_t jobs[4] = {0};
+    for (int i = 0; i < n; i++)
+        jobs[i] = (probe_job_t){ .backend = list[i], .card_num = card_num };
+
+    int winner = probe_all(jobs, first, concurrent);
+    if (winner < 0 && first < n) {
+        int late = probe_all(jobs + first, n - first, concurrent);
+        if (late >= 0) winner = first + late;
+    }
+    if (winner < 0) {
+        /* All backends failed */
+        free(state);
+        return MERIDIAN_ERR_NO_CRTC;
+    }
+
+    *state = jobs[winner].state;
+    state->card_num = card_num;
+    live_states++;
+    *state_out = state;
+    return MERIDIAN_OK;
+}
+
+meridian_error_t
+meridian_init_card(int card_num, meridian_state_t **state_out)
+{
+    return init_state(card_num, nullptr, false, state_out, nullptr);
+}
+
+meridian_error_t
+meridian_init_null(const meridian_null_config_t *config, meridian_state_t **state_out)
+{
+    meridian_state_t *state = calloc(1, sizeof(meridian_state_t));
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    meridian_error_t err = meridian_null_init(config, &state->null);
+    if (err != MERIDIAN_OK) {
+        free(state);
+        return err;
+    }
+    state->backend = BACKEND_NULL;
+    state->card_num = -1;
+    live_states++;
+    *state_out = state;
+    return MERIDIAN_OK;
+}
+
+meridian_error_t
+meridian_init_probed(int card_num, const meridian_probe_t *hint,
+                     meridian_state_t **state_out, bool *from_hint)
+{
+    return init_state(card_num, hint, true, state_out, from_hint);
+}
+
+void
+meridian_get_probe(const meridian_state_t *state, meridian_probe_t *probe)
+{
+    *probe = (meridian_probe_t){ .card_num = -1 };
+    if (!state) return;
 
+    snprintf(probe->backend, sizeof(probe->backend), "%s", meridian_get_backend_name(state));
+    probe_session(probe->session, sizeof(probe->session));
+    probe->card_num = state->card_num;
+    int count = meridian_get_crtc_count(state);
+    if (count > MERIDIAN_PROBE_MAX_OUTPUTS) count = MERIDIAN_PROBE_MAX_OUTPUTS;
+    probe->output_count = count > 0 ? count : 0;
+    for (int i = 0; i < probe->output_count; i++)
+        probe->gamma_size[i] = meridian_get_gamma_size(state, i);
+}
+
+void
+meridian_free(meridian_state_t *state)
+{
+    if (!state) return;
+
+    free_backend(state);
+    /* Other states (the system daemon's sessions) still draw from it */
+    if (--live_states == 0) meridian_ramp_cache_clear();
     free(state);
 }
 
@@ -247,6 +509,7 @@ meridian_get_backend_name(const meridian_state_t *state)
     case BACKEND_X11:      return "x11";
     case BACKEND_WAYLAND:  return "wayland";
     case BACKEND_GNOME:    return "gnome";
+    case BACKEND_NULL:     return "null";
     default:               return "none";
     }
 }
@@ -259,6 +522,8 @@ meridian_get_crtc_count(const meridian_state_t *state)
     switch (state->backend) {
     case BACKEND_DRM:
         return meridian_drm_get_crtc_count(state->drm);
+    case BACKEND_NULL:
+        return meridian_null_get_crtc_count(state->null);
 #ifdef MERIDIAN_HAS_X11
     case BACKEND_X11:
         return meridian_x11_get_crtc_count(state->x11);
@@ -284,6 +549,8 @@ meridian_get_gamma_size(const meridian_state_t *state, int crtc_idx)
     switch (state->backend) {
     case BACKEND_DRM:
         return meridian_drm_get_gamma_size(state->drm, crtc_idx);
+    case BACKEND_NULL:
+        return meridian_null_get_gamma_size(state->null, crtc_idx);
 #ifdef MERIDIAN_HAS_X11
     case BACKEND_X11:
         return meridian_x11_get_gamma_size(state->x11, crtc_idx);
@@ -306,24 +573,85 @@ meridian_set_temperature(meridian_state_t *state, int temp, float brightness)
 {
     if (!state) return MERIDIAN_ERR_RESOURCES;
 
+    /* set_start/set_done bracket the backend's own work: ioctl, X11 or
+       Wayland round trip, DBus call */
+    const char *backend = meridian_get_backend_name(state);
+    MERIDIAN_PROBE2(set_start, backend, temp);
+
+    meridian_error_t err;
     switch (state->backend) {
     case BACKEND_DRM:
-        return meridian_drm_set_temperature(state->drm, temp, brightness);
+        err = meridian_drm_set_temperature(state->drm, temp, brightness);
+        break;
+    case BACKEND_NULL:
+        err = meridian_null_set_temperature(state->null, temp, brightness);
+        break;
 #ifdef MERIDIAN_HAS_X11
     case BACKEND_X11:
-        return meridian_x11_set_temperature(state->x11, temp, brightness);
+        err = meridian_x11_set_temperature(state->x11, temp, brightness);
+        break;
 #endif
 #ifdef MERIDIAN_HAS_WAYLAND
     case BACKEND_WAYLAND:
-        return wl_plugin.set_temperature(state->wl, temp, brightness);
+        err = wl_plugin.set_temperature(state->wl, temp, brightness);
+        break;
 #endif
 #ifdef MERIDIAN_HAS_GNOME
     case BACKEND_GNOME:
-        return meridian_gnome_set_temperature(state->gnome, temp, brightness);
+        err = meridian_gnome_set_temperature(state->gnome, temp, brightness);
+        break;
 #endif
     default:
         return MERIDIAN_ERR_NO_CRTC;
     }
+    MERIDIAN_PROBE3(set_done, backend, temp, err);
+
+    /* Remembered even on failure: a new output may accept what an old one refused */
+    if (err != MERIDIAN_ERR_INVALID_TEMP) {
+        state->have_last = true;
+        state->last_temp = temp;
+        state->last_brightness = brightness;
+    }
+    return err;
+}
+
+meridian_error_t
+meridian_set_temperature_frame(meridian_state_t *state, int temp, float brightness)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+    if (state->backend != BACKEND_DRM)
+        return meridian_set_temperature(state, temp, brightness);
+
+    const char *backend = meridian_get_backend_name(state);
+    MERIDIAN_PROBE2(set_start, backend, temp);
+    meridian_error_t err = meridian_drm_set_temperature_frame(state->drm, temp, brightness);
+    MERIDIAN_PROBE3(set_done, backend, temp, err);
+
+    /* A refused frame changed nothing; hotplug reapplies what is shown */
+    if (err != MERIDIAN_ERR_INVALID_TEMP && err != MERIDIAN_ERR_BUSY) {
+        state->have_last = true;
+        state->last_temp = temp;
+        state->last_brightness = brightness;
+    }
+    return err;
+}
+
+bool
+meridian_frame_paced(const meridian_state_t *state)
+{
+    return state && state->backend == BACKEND_DRM && meridian_drm_frame_paced(state->drm);
+}
+
+bool
+meridian_frame_pending(const meridian_state_t *state)
+{
+    return state && state->backend == BACKEND_DRM && meridian_drm_frame_pending(state->drm);
+}
+
+int
+meridian_get_refresh_mhz(const meridian_state_t *state)
+{
+    return state && state->backend == BACKEND_DRM ? meridian_drm_get_refresh_mhz(state->drm) : 0;
 }
 
 meridian_error_t
@@ -335,6 +663,8 @@ meridian_set_temperature_crtc(meridian_state_t *state, int crtc_idx,
     switch (state->backend) {
     case BACKEND_DRM:
         return meridian_drm_set_temperature_crtc(state->drm, crtc_idx, temp, brightness);
+    case BACKEND_NULL:
+        return meridian_null_set_temperature_crtc(state->null, crtc_idx, temp, brightness);
 #ifdef MERIDIAN_HAS_X11
     case BACKEND_X11:
         return meridian_x11_set_temperature_crtc(state->x11, crtc_idx, temp, brightness);
@@ -352,14 +682,41 @@ meridian_set_temperature_crtc(meridian_state_t *state, int crtc_idx,
     }
 }
 
+meridian_error_t
+meridian_prepare_temperature(meridian_state_t *state, int temp, float brightness)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+#ifdef MERIDIAN_HAS_WAYLAND
+    if (state->backend == BACKEND_WAYLAND)
+        return wl_plugin.prepare_temperature(state->wl, temp, brightness);
+#endif
+
+    /* Upload paths read straight from the ramp cache: make it a hit */
+    int count = meridian_get_crtc_count(state);
+    for (int i = 0; i < count; i++) {
+        int size = meridian_get_gamma_size(state, i);
+        if (size <= 0) continue;
+
+        meridian_ramp_t ramp;
+        meridian_error_t err = meridian_ramp_cache_get(temp, size, brightness, &ramp);
+        if (err != MERIDIAN_OK) return err;
+    }
+    return MERIDIAN_OK;
+}
+
 meridian_error_t
 meridian_restore(meridian_state_t *state)
 {
     if (!state) return MERIDIAN_ERR_RESOURCES;
 
+    state->have_last = false;
+
     switch (state->backend) {
     case BACKEND_DRM:
         return meridian_drm_restore(state->drm);
+    case BACKEND_NULL:
+        return meridian_null_restore(state->null);
 #ifdef MERIDIAN_HAS_X11
     case BACKEND_X11:
         return meridian_x11_restore(state->x11);
@@ -376,3 +733,78 @@ meridian_restore(meridian_state_t *state)
         return MERIDIAN_ERR_NO_CRTC;
     }
 }
+
+int
+meridian_get_fds(const meridian_state_t *state, int *fds, int max)
+{
+    if (!state || !fds || max < 1) return 0;
+
+    int fd = -1;
+    switch (state->backend) {
+    case BACKEND_DRM: {
+        int n = 0;
+        int drm_fds[2] = { meridian_drm_get_fd(state->drm),
+                           meridian_drm_get_event_fd(state->drm) };
+        for (int i = 0; i < 2 && n < max; i++)
+            if (drm_fds[i] >= 0) fds[n++] = drm_fds[i];
+        return n;
+    }
+#ifdef MERIDIAN_HAS_X11
+    case BACKEND_X11:
+        fd = meridian_x11_get_fd(state->x11);
+        break;
+#endif
+#ifdef MERIDIAN_HAS_WAYLAND
+    case BACKEND_WAYLAND:
+        fd = wl_plugin.get_fd(state->wl);
+        break;
+#endif
+#ifdef MERIDIAN_HAS_GNOME
+    case BACKEND_GNOME:
+        fd = meridian_gnome_get_fd(state->gnome);
+        break;
+#endif
+    default:
+        break;
+    }
+
+    if (fd < 0) return 0;
+    fds[0] = fd;
+    return 1;
+}
+
+meridian_error_t
+meridian_dispatch(meridian_state_t *state)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    bool changed = false;
+    meridian_error_t err;
+    switch (state->backend) {
+    case BACKEND_DRM:
+        err = meridian_drm_dispatch(state->drm, &changed);
+        break;
+#ifdef MERIDIAN_HAS_X11
+    case BACKEND_X11:
+        err = meridian_x11_dispatch(state->x11, &changed);
+        break;
+#endif
+#ifdef MERIDIAN_HAS_WAYLAND
+    case BACKEND_WAYLAND:
+        err = wl_plugin.dispatch(state->wl, &changed);
+        break;
+#endif
+#ifdef MERIDIAN_HAS_GNOME
+    case BACKEND_GNOME:
+        /* Replays onto the new monitor layout itself, once it has arrived */
+        return meridian_gnome_dispatch(state->gnome);
+#endif
+    default:
+        return MERIDIAN_OK;
+    }
+
+    if (err != MERIDIAN_OK) return err;
+    if (changed && state->have_last)
+        return meridian_set_temperature(state, state->last_temp, state->last_brightness);
+    return MERIDIAN_OK;
+}
@@ -3,6 +3,21 @@
  *
  * Pure kernel interface - no libdrm dependency.
  * Opens /dev/dri/card* directly, no X11 needed.
+ *
+ * Two upload paths:
+ *   atomic: GAMMA_LUT property blobs at full GAMMA_LUT_SIZE resolution,
+ *           every CRTC in one vblank-aligned MODE_ATOMIC commit
+ *   legacy: MODE_SETGAMMA per CRTC (drivers without atomic color mgmt)
+ * The atomic path is preferred and drops to legacy on the first failure.
+ *
+ * Animation frames (meridian_drm_set_temperature_frame) are atomic
+ * commits with NONBLOCK | PAGE_FLIP_EVENT on the lit CRTCs only: the
+ * call returns at once and the flip-complete events, read from the
+ * non-blocking card fd, say when the next frame may go.
+ *
+ * Hotplug: a NETLINK_KOBJECT_UEVENT socket (meridian_drm_get_fd) reports
+ * drm "HOTPLUG=1" events so the caller can reapply. Idle CRTCs are
+ * committed too, so a head that lights up later already has the LUT.
  */
 
 #define _GNU_SOURCE
@@ -15,6 +30,8 @@
 #include <unistd.h>
 #include <errno.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
 
 /* ============================================================
  * DRM ioctl definitions (from linux/drm.h and drm/drm_mode.h)
@@ -28,11 +45,91 @@
 #define DRM_IOW(nr, type)   _IOW(DRM_IOCTL_BASE, nr, type)
 #define DRM_IOWR(nr, type)  _IOWR(DRM_IOCTL_BASE, nr, type)
 
-/* DRM mode command numbers */
+/* DRM command numbers */
+#define DRM_IOCTL_SET_CLIENT_CAP     0x0D
 #define DRM_IOCTL_MODE_GETRESOURCES  0xA0
 #define DRM_IOCTL_MODE_GETCRTC       0xA1
 #define DRM_IOCTL_MODE_GETGAMMA      0xA4
 #define DRM_IOCTL_MODE_SETGAMMA      0xA5
+#define DRM_IOCTL_MODE_GETPROPERTY   0xAA
+#define DRM_IOCTL_MODE_GETPROPBLOB   0xAC
+#define DRM_IOCTL_MODE_OBJ_GETPROPERTIES 0xB9
+#define DRM_IOCTL_MODE_ATOMIC        0xBC
+#define DRM_IOCTL_MODE_CREATEPROPBLOB  0xBD
+#define DRM_IOCTL_MODE_DESTROYPROPBLOB 0xBE
+
+#define DRM_CLIENT_CAP_ATOMIC        3
+#define DRM_MODE_PAGE_FLIP_EVENT     0x01
+#define DRM_MODE_ATOMIC_NONBLOCK     0x0200
+#define DRM_EVENT_FLIP_COMPLETE      0x02
+#define DRM_MODE_FLAG_INTERLACE      (1u << 4)
+#define DRM_MODE_FLAG_DBLSCAN        (1u << 5)
+#define DRM_MODE_OBJECT_CRTC         0xccccccccu
+#define DRM_PROP_NAME_LEN            32
+
+/* drm_set_client_cap - used by SET_CLIENT_CAP */
+struct drm_set_client_cap {
+    uint64_t capability;
+    uint64_t value;
+};
+
+/* drm_mode_obj_get_properties - property ids/values of a KMS object */
+struct drm_mode_obj_get_properties {
+    uint64_t props_ptr;
+    uint64_t prop_values_ptr;
+    uint32_t count_props;
+    uint32_t obj_id;
+    uint32_t obj_type;
+};
+
+/* drm_mode_get_property - property metadata (we only need the name) */
+struct drm_mode_get_property {
+    uint64_t values_ptr;
+    uint64_t enum_blob_ptr;
+    uint32_t prop_id;
+    uint32_t flags;
+    char name[DRM_PROP_NAME_LEN];
+    uint32_t count_values;
+    uint32_t count_enum_blobs;
+};
+
+/* drm_mode_get_blob - read a property blob */
+struct drm_mode_get_blob {
+    uint32_t blob_id;
+    uint32_t length;
+    uint64_t data;
+};
+
+/* drm_mode_create_blob / drm_mode_destroy_blob */
+struct drm_mode_create_blob {
+    uint64_t data;
+    uint32_t length;
+    uint32_t blob_id;
+};
+
+struct drm_mode_destroy_blob {
+    uint32_t blob_id;
+};
+
+/* drm_mode_atomic - one commit over many objects */
+struct drm_mode_atomic {
+    uint32_t flags;
+    uint32_t count_objs;
+    uint64_t objs_ptr;
+    uint64_t count_props_ptr;
+    uint64_t props_ptr;
+    uint64_t prop_values_ptr;
+    uint64_t reserved;
+    uint64_t user_data;
+};
+
+/* drm_color_lut - one GAMMA_LUT entry */
+struct drm_color_lut {
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+    uint16_t reserved;
+};
 
 /* drm_mode_card_res - returned by MODE_GETRESOURCES */
 struct drm_mode_card_res {
@@ -50,6 +147,17 @@ struct drm_mode_card_res {
     uint32_t max_height;
 };
 
+/* drm_mode_modeinfo - the timings we derive the refresh rate from */
+struct drm_mode_modeinfo {
+    uint32_t clock;     /* pixel clock, kHz */
+    uint16_t hdisplay, hsync_start, hsync_end, htotal, hskew;
+    uint16_t vdisplay, vsync_start, vsync_end, vtotal, vscan;
+    uint32_t vrefresh;
+    uint32_t flags;
+    uint32_t type;
+    char name[32];
+};
+
 /* drm_mode_crtc - returned by MODE_GETCRTC */
 struct drm_mode_crtc {
     uint64_t set_connectors_ptr;
@@ -60,8 +168,13 @@ struct drm_mode_crtc {
     uint32_t y;
     uint32_t gamma_size;
     uint32_t mode_valid;
-    /* drm_mode_modeinfo follows but we don't need it */
-    char mode[68];  /* sizeof(struct drm_mode_modeinfo) */
+    struct drm_mode_modeinfo mode;
+};
+
+/* drm_event - header of every record read from the card fd */
+struct drm_event {
+    uint32_t type;
+    uint32_t length;    /* including this header */
 };
 
 /* drm_mode_crtc_lut - used by MODE_GETGAMMA and MODE_SETGAMMA */
@@ -79,10 +192,26 @@ struct drm_mode_crtc_lut {
 
 static_assert(sizeof(struct drm_mode_card_res) == 64,
               "drm_mode_card_res size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_mode_modeinfo) == 68,
+              "drm_mode_modeinfo size mismatch with kernel ABI");
 static_assert(sizeof(struct drm_mode_crtc) == 104,
               "drm_mode_crtc size mismatch with kernel ABI");
 static_assert(sizeof(struct drm_mode_crtc_lut) == 32,
               "drm_mode_crtc_lut size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_set_client_cap) == 16,
+              "drm_set_client_cap size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_mode_obj_get_properties) == 32,
+              "drm_mode_obj_get_properties size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_mode_get_property) == 64,
+              "drm_mode_get_property size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_mode_get_blob) == 16,
+              "drm_mode_get_blob size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_mode_create_blob) == 16,
+              "drm_mode_create_blob size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_mode_atomic) == 56,
+              "drm_mode_atomic size mismatch with kernel ABI");
+static_assert(sizeof(struct drm_color_lut) == 8,
+              "drm_color_lut size mismatch with kernel ABI");
 
 /* ============================================================
  * Internal state structures
@@ -95,15 +224,49 @@ typedef struct {
     uint16_t *saved_r;
     uint16_t *saved_g;
     uint16_t *saved_b;
+
+    /* Atomic color management (lut_size == 0: not available) */
+    uint32_t gamma_lut_prop;
+    uint32_t lut_size;
+    struct drm_color_lut *saved_lut;    /* original GAMMA_LUT, nullptr = none */
+
+    /* Scanning out a mode: only these can deliver page-flip events */
+    bool active;
+    int refresh_mhz;
 } crtc_state_t;
 
+/* Uploaded GAMMA_LUT blob, shared by every CRTC with the same LUT size */
+typedef struct {
+    uint32_t blob_id;
+    uint32_t lut_size;
+    int temp;
+    float brightness;
+} lut_blob_t;
+
 /* DRM state */
 struct meridian_drm_state {
     int fd;
+    int uevent_fd;                  /* kernel hotplug events, -1 if unavailable */
     int card_num;
     int crtc_count;
     uint32_t *crtc_ids;
     crtc_state_t *crtcs;
+
+    bool atomic;
+    lut_blob_t *blobs;              /* one per distinct LUT size */
+    int blob_count;
+    struct drm_color_lut *lut_buf;  /* staging for blob creation */
+    uint32_t lut_buf_size;
+
+    /* Frame commits: flip events still due, false once the driver refuses them */
+    bool flip_events;
+    int flips_pending;
+
+    /* Preallocated MODE_ATOMIC arrays (crtc_count entries each) */
+    uint32_t *commit_objs;
+    uint32_t *commit_count_props;
+    uint32_t *commit_props;
+    uint64_t *commit_values;
 };
 
 /* ============================================================
@@ -135,6 +298,384 @@ drm_set_gamma(int fd, struct drm_mode_crtc_lut *lut)
     return ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_SETGAMMA, struct drm_mode_crtc_lut), lut);
 }
 
+static int
+drm_set_client_cap(int fd, uint64_t cap, uint64_t value)
+{
+    struct drm_set_client_cap req = { .capability = cap, .value = value };
+    return ioctl(fd, DRM_IOW(DRM_IOCTL_SET_CLIENT_CAP, struct drm_set_client_cap), &req);
+}
+
+static int
+drm_get_property(int fd, struct drm_mode_get_property *prop)
+{
+    return ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_GETPROPERTY, struct drm_mode_get_property), prop);
+}
+
+static int
+drm_get_blob(int fd, struct drm_mode_get_blob *blob)
+{
+    return ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_GETPROPBLOB, struct drm_mode_get_blob), blob);
+}
+
+static int
+drm_obj_get_properties(int fd, struct drm_mode_obj_get_properties *props)
+{
+    return ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_OBJ_GETPROPERTIES,
+                              struct drm_mode_obj_get_properties), props);
+}
+
+static int
+drm_atomic_commit(int fd, struct drm_mode_atomic *req)
+{
+    return ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_ATOMIC, struct drm_mode_atomic), req);
+}
+
+static int
+drm_create_blob(int fd, const void *data, uint32_t length, uint32_t *blob_id)
+{
+    struct drm_mode_create_blob req = {
+        .data = (uint64_t)(uintptr_t)data,
+        .length = length,
+    };
+    int ret = ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_CREATEPROPBLOB, struct drm_mode_create_blob), &req);
+    if (ret == 0) *blob_id = req.blob_id;
+    return ret;
+}
+
+static void
+drm_destroy_blob(int fd, uint32_t blob_id)
+{
+    struct drm_mode_destroy_blob req = { .blob_id = blob_id };
+    ioctl(fd, DRM_IOWR(DRM_IOCTL_MODE_DESTROYPROPBLOB, struct drm_mode_destroy_blob), &req);
+}
+
+/* ============================================================
+ * Atomic color management
+ * ============================================================ */
+
+/*
+ * Find GAMMA_LUT / GAMMA_LUT_SIZE on a CRTC and save the current LUT.
+ * Leaves lut_size at 0 if the driver lacks atomic color management.
+ */
+static void
+atomic_probe_crtc(int fd, crtc_state_t *crtc)
+{
+    uint32_t prop_ids[64];
+    uint64_t prop_values[64];
+    struct drm_mode_obj_get_properties props = {
+        .props_ptr = (uint64_t)(uintptr_t)prop_ids,
+        .prop_values_ptr = (uint64_t)(uintptr_t)prop_values,
+        .count_props = 64,
+        .obj_id = crtc->crtc_id,
+        .obj_type = DRM_MODE_OBJECT_CRTC,
+    };
+    if (drm_obj_get_properties(fd, &props) < 0) return;
+    if (props.count_props > 64) props.count_props = 64;
+
+    uint32_t lut_prop = 0, lut_size = 0, cur_blob = 0;
+    for (uint32_t i = 0; i < props.count_props; i++) {
+        struct drm_mode_get_property prop = { .prop_id = prop_ids[i] };
+        if (drm_get_property(fd, &prop) < 0) continue;
+        prop.name[DRM_PROP_NAME_LEN - 1] = '\0';
+
+        if (strcmp(prop.name, "GAMMA_LUT") == 0) {
+            lut_prop = prop_ids[i];
+            cur_blob = (uint32_t)prop_values[i];
+        } else if (strcmp(prop.name, "GAMMA_LUT_SIZE") == 0) {
+            lut_size = (uint32_t)prop_values[i];
+        }
+    }
+    if (!lut_prop || lut_size <= 1) return;
+
+    /* Save the LUT in effect so restore can put it back */
+    if (cur_blob) {
+        size_t bytes = lut_size * sizeof(struct drm_color_lut);
+        crtc->saved_lut = malloc(bytes);
+        if (!crtc->saved_lut) return;
+
+        struct drm_mode_get_blob blob = {
+            .blob_id = cur_blob,
+            .length = (uint32_t)bytes,
+            .data = (uint64_t)(uintptr_t)crtc->saved_lut,
+        };
+        if (drm_get_blob(fd, &blob) < 0 || blob.length != bytes) {
+            free(crtc->saved_lut);
+            crtc->saved_lut = nullptr;
+            return;
+        }
+    }
+
+    crtc->gamma_lut_prop = lut_prop;
+    crtc->lut_size = lut_size;
+}
+
+/* Blob holding the ramp for (lut_size, temp, brightness), reused if current */
+static meridian_error_t
+atomic_blob_for(meridian_drm_state_t *state, uint32_t lut_size,
+                int temp, float brightness, uint32_t *blob_id)
+{
+    lut_blob_t *slot = nullptr;
+    for (int i = 0; i < state->blob_count; i++) {
+        if (state->blobs[i].lut_size == lut_size) {
+            slot = &state->blobs[i];
+            break;
+        }
+    }
+    if (slot && slot->blob_id && slot->temp == temp && slot->brightness == brightness) {
+        *blob_id = slot->blob_id;
+        return MERIDIAN_OK;
+    }
+    if (!slot) {
+        slot = &state->blobs[state->blob_count++];
+        *slot = (lut_blob_t){ .lut_size = lut_size };
+    }
+
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, (int)lut_size, brightness, &ramp);
+    if (err != MERIDIAN_OK) return err;
+
+    if (lut_size > state->lut_buf_size) {
+        struct drm_color_lut *buf = realloc(state->lut_buf, lut_size * sizeof(*buf));
+        if (!buf) return MERIDIAN_ERR_RESOURCES;
+        state->lut_buf = buf;
+        state->lut_buf_size = lut_size;
+    }
+    for (uint32_t i = 0; i < lut_size; i++) {
+        state->lut_buf[i] = (struct drm_color_lut){
+            .red = ramp.r[i], .green = ramp.g[i], .blue = ramp.b[i],
+        };
+    }
+
+    uint32_t id;
+    if (drm_create_blob(state->fd, state->lut_buf,
+                        lut_size * (uint32_t)sizeof(struct drm_color_lut), &id) < 0)
+        return MERIDIAN_ERR_GAMMA;
+
+    /* The committed CRTC state holds its own reference to the old blob */
+    if (slot->blob_id) drm_destroy_blob(state->fd, slot->blob_id);
+    slot->blob_id = id;
+    slot->temp = temp;
+    slot->brightness = brightness;
+    *blob_id = id;
+    return MERIDIAN_OK;
+}
+
+/*
+ * Commit GAMMA_LUT on CRTC 'only' (or every CRTC if only < 0). With
+ * DRM_MODE_PAGE_FLIP_EVENT in flags only lit CRTCs are included, since a
+ * dark one cannot flip; *committed receives how many events to expect.
+ */
+static meridian_error_t
+atomic_set_temperature(meridian_drm_state_t *state, int only,
+                       int temp, float brightness, uint32_t flags,
+                       int *committed)
+{
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    uint32_t count = 0;
+    for (int i = 0; i < state->crtc_count; i++) {
+        crtc_state_t *crtc = &state->crtcs[i];
+        if ((only >= 0 && i != only) || !crtc->lut_size) continue;
+        if ((flags & DRM_MODE_PAGE_FLIP_EVENT) && !crtc->active) continue;
+
+        uint32_t blob_id;
+        meridian_error_t err = atomic_blob_for(state, crtc->lut_size,
+                                               temp, brightness, &blob_id);
+        if (err != MERIDIAN_OK) return err;
+
+        state->commit_objs[count] = crtc->crtc_id;
+        state->commit_count_props[count] = 1;
+        state->commit_props[count] = crtc->gamma_lut_prop;
+        state->commit_values[count] = blob_id;
+        count++;
+    }
+    if (count == 0) return MERIDIAN_ERR_CRTC;
+
+    struct drm_mode_atomic req = {
+        .flags = flags,
+        .count_objs = count,
+        .objs_ptr = (uint64_t)(uintptr_t)state->commit_objs,
+        .count_props_ptr = (uint64_t)(uintptr_t)state->commit_count_props,
+        .props_ptr = (uint64_t)(uintptr_t)state->commit_props,
+        .prop_values_ptr = (uint64_t)(uintptr_t)state->commit_values,
+    };
+    if (drm_atomic_commit(state->fd, &req) < 0)
+        return errno == EBUSY ? MERIDIAN_ERR_BUSY : MERIDIAN_ERR_GAMMA;
+    if (committed) *committed = (int)count;
+    return MERIDIAN_OK;
+}
+
+/* Put back the LUTs saved at init in one commit (blob 0 = no LUT) */
+static meridian_error_t
+atomic_restore(meridian_drm_state_t *state)
+{
+    uint32_t count = 0;
+    for (int i = 0; i < state->crtc_count; i++) {
+        crtc_state_t *crtc = &state->crtcs[i];
+        if (!crtc->lut_size) continue;
+
+        uint32_t blob_id = 0;
+        if (crtc->saved_lut &&
+            drm_create_blob(state->fd, crtc->saved_lut,
+                            crtc->lut_size * (uint32_t)sizeof(struct drm_color_lut),
+                            &blob_id) < 0)
+            blob_id = 0;
+
+        state->commit_objs[count] = crtc->crtc_id;
+        state->commit_count_props[count] = 1;
+        state->commit_props[count] = crtc->gamma_lut_prop;
+        state->commit_values[count] = blob_id;
+        count++;
+    }
+
+    struct drm_mode_atomic req = {
+        .count_objs = count,
+        .objs_ptr = (uint64_t)(uintptr_t)state->commit_objs,
+        .count_props_ptr = (uint64_t)(uintptr_t)state->commit_count_props,
+        .props_ptr = (uint64_t)(uintptr_t)state->commit_props,
+        .prop_values_ptr = (uint64_t)(uintptr_t)state->commit_values,
+    };
+    int ret = count ? drm_atomic_commit(state->fd, &req) : 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (state->commit_values[i])
+            drm_destroy_blob(state->fd, (uint32_t)state->commit_values[i]);
+    }
+
+    /* Uploaded ramps are no longer current */
+    for (int i = 0; i < state->blob_count; i++) {
+        if (state->blobs[i].blob_id)
+            drm_destroy_blob(state->fd, state->blobs[i].blob_id);
+        state->blobs[i].blob_id = 0;
+    }
+
+    return ret < 0 ? MERIDIAN_ERR_GAMMA : MERIDIAN_OK;
+}
+
+/*
+ * Enable atomic color management if the driver supports GAMMA_LUT on
+ * every usable CRTC. Allocation failures just leave the legacy path.
+ */
+static void
+atomic_init(meridian_drm_state_t *state)
+{
+    if (drm_set_client_cap(state->fd, DRM_CLIENT_CAP_ATOMIC, 1) < 0) return;
+
+    int usable = 0;
+    for (int i = 0; i < state->crtc_count; i++) {
+        crtc_state_t *crtc = &state->crtcs[i];
+        if (crtc->gamma_size <= 1) continue;
+        atomic_probe_crtc(state->fd, crtc);
+        if (!crtc->lut_size) return;
+        usable++;
+    }
+    if (usable == 0) return;
+
+    size_t n = (size_t)state->crtc_count;
+    state->blobs = calloc(n, sizeof(lut_blob_t));
+    state->commit_objs = calloc(n, sizeof(uint32_t));
+    state->commit_count_props = calloc(n, sizeof(uint32_t));
+    state->commit_props = calloc(n, sizeof(uint32_t));
+    state->commit_values = calloc(n, sizeof(uint64_t));
+    if (!state->blobs || !state->commit_objs || !state->commit_count_props ||
+        !state->commit_props || !state->commit_values)
+        return;
+
+    state->atomic = true;
+}
+
+/* ============================================================
+ * Hotplug (kernel uevents)
+ * ============================================================ */
+
+/* Kernel uevent multicast group (udev listens on the same one) */
+#define UEVENT_GROUP_KERNEL 1
+
+static int
+uevent_open(void)
+{
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK,
+                    NETLINK_KOBJECT_UEVENT);
+    if (fd < 0) return -1;
+
+    struct sockaddr_nl addr = {
+        .nl_family = AF_NETLINK,
+        .nl_groups = UEVENT_GROUP_KERNEL,
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+ * A uevent is "action@devpath\0KEY=VALUE\0...". We want
+ * SUBSYSTEM=drm with HOTPLUG=1 for our card (connector status change).
+ */
+static bool
+uevent_is_hotplug(const char *buf, size_t len, int card_num)
+{
+    char devname[32];
+    snprintf(devname, sizeof(devname), "DEVNAME=dri/card%d", card_num);
+
+    bool drm = false, hotplug = false, ours = false;
+    for (size_t off = 0; off < len; ) {
+        const char *kv = buf + off;
+        size_t n = strnlen(kv, len - off);
+        if (strcmp(kv, "SUBSYSTEM=drm") == 0) drm = true;
+        else if (strcmp(kv, "HOTPLUG=1") == 0) hotplug = true;
+        else if (strcmp(kv, devname) == 0) ours = true;
+        off += n + 1;
+    }
+    return drm && hotplug && ours;
+}
+
+/* Refresh rate in mHz from the mode timings, 0 if they are incomplete */
+static int
+mode_refresh_mhz(const struct drm_mode_modeinfo *mode)
+{
+    uint64_t total = (uint64_t)mode->htotal * mode->vtotal;
+    if (!mode->clock || !total) return 0;
+    if (mode->flags & DRM_MODE_FLAG_DBLSCAN) total *= 2;
+    if (mode->vscan > 1) total *= mode->vscan;
+    uint64_t mhz = ((uint64_t)mode->clock * 1000000u + total / 2) / total;
+    if (mode->flags & DRM_MODE_FLAG_INTERLACE) mhz *= 2;
+    return (int)mhz;
+}
+
+/* Which CRTCs scan out, and how fast; re-read after hotplug */
+static void
+drm_read_modes(meridian_drm_state_t *state)
+{
+    for (int i = 0; i < state->crtc_count; i++) {
+        crtc_state_t *crtc = &state->crtcs[i];
+        struct drm_mode_crtc info = { .crtc_id = crtc->crtc_id };
+        bool ok = drm_get_crtc(state->fd, &info) == 0 && info.mode_valid;
+        crtc->active = ok;
+        crtc->refresh_mhz = ok ? mode_refresh_mhz(&info.mode) : 0;
+    }
+}
+
+/* Flip-complete records on the card fd; each one retires a frame's CRTC */
+static void
+drm_read_events(meridian_drm_state_t *state)
+{
+    char buf[1024] __attribute__((aligned(8)));
+    ssize_t len;
+    while ((len = read(state->fd, buf, sizeof(buf))) > 0) {
+        for (size_t off = 0; off + sizeof(struct drm_event) <= (size_t)len; ) {
+            struct drm_event ev;
+            memcpy(&ev, buf + off, sizeof(ev));
+            if (ev.length < sizeof(ev)) break;
+            if (ev.type == DRM_EVENT_FLIP_COMPLETE && state->flips_pending > 0)
+                state->flips_pending--;
+            off += ev.length;
+        }
+    }
+}
+
 /* ============================================================
  * Public API
  * ============================================================ */
@@ -147,12 +688,14 @@ meridian_drm_init(int card_num, meridian_drm_state_t **state_out)
 
     state->card_num = card_num;
     state->fd = -1;
+    state->uevent_fd = -1;
 
     /* Open DRM device */
     char path[64];
     snprintf(path, sizeof(path), "/dev/dri/card%d", card_num);
 
-    state->fd = open(path, O_RDWR | O_CLOEXEC);
+    /* Non-blocking only matters for read(): page-flip events */
+    state->fd = open(path, O_RDWR | O_CLOEXEC | O_NONBLOCK);
     if (state->fd < 0) {
         free(state);
         return (errno == EACCES) ? MERIDIAN_ERR_PERMISSION : MERIDIAN_ERR_OPEN;
@@ -252,6 +795,11 @@ meridian_drm_init(int card_num, meridian_drm_state_t **state_out)
         }
     }
 
+    atomic_init(state);
+    state->flip_events = state->atomic;
+    drm_read_modes(state);
+    state->uevent_fd = uevent_open();
+
     *state_out = state;
     return MERIDIAN_OK;
 }
@@ -269,14 +817,24 @@ meridian_drm_free(meridian_drm_state_t *state)
         free(state->crtcs[i].saved_r);
         free(state->crtcs[i].saved_g);
         free(state->crtcs[i].saved_b);
+        free(state->crtcs[i].saved_lut);
     }
     free(state->crtcs);
     free(state->crtc_ids);
+    free(state->blobs);
+    free(state->lut_buf);
+    free(state->commit_objs);
+    free(state->commit_count_props);
+    free(state->commit_props);
+    free(state->commit_values);
 
     /* Close device */
     if (state->fd >= 0) {
         close(state->fd);
     }
+    if (state->uevent_fd >= 0) {
+        close(state->uevent_fd);
+    }
 
     free(state);
 }
@@ -293,7 +851,8 @@ meridian_drm_get_gamma_size(const meridian_drm_state_t *state, int crtc_idx)
     if (!state || crtc_idx < 0 || crtc_idx >= state->crtc_count) {
         return 0;
     }
-    return state->crtcs[crtc_idx].gamma_size;
+    const crtc_state_t *crtc = &state->crtcs[crtc_idx];
+    return state->atomic && crtc->lut_size ? (int)crtc->lut_size : (int)crtc->gamma_size;
 }
 
 meridian_error_t
@@ -309,37 +868,29 @@ meridian_drm_set_temperature_crtc(meridian_drm_state_t *state, int crtc_idx,
         return MERIDIAN_ERR_CRTC;
     }
 
-    /* Allocate temporary ramps */
-    size_t ramp_bytes = crtc->gamma_size * sizeof(uint16_t);
-    uint16_t *r = malloc(ramp_bytes);
-    uint16_t *g = malloc(ramp_bytes);
-    uint16_t *b = malloc(ramp_bytes);
-
-    if (!r || !g || !b) {
-        free(r); free(g); free(b);
-        return MERIDIAN_ERR_RESOURCES;
-    }
+    /* A single head may be inactive; fall back for this call only */
+    if (state->atomic && crtc->lut_size &&
+        atomic_set_temperature(state, crtc_idx, temp, brightness, 0, nullptr) == MERIDIAN_OK)
+        return MERIDIAN_OK;
 
-    /* Fill ramps with color temperature */
-    meridian_error_t err = meridian_fill_gamma_ramps(temp, crtc->gamma_size, r, g, b, brightness);
-    if (err != MERIDIAN_OK) {
-        free(r); free(g); free(b);
-        return err;
-    }
+    /* Ramps come from the shared cache: CRTCs with the same gamma size
+     * upload the same buffers, and the ioctl only reads from them. */
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, crtc->gamma_size,
+                                                   brightness, &ramp);
+    if (err != MERIDIAN_OK) return err;
 
     /* Set gamma via raw kernel ioctl */
     struct drm_mode_crtc_lut lut = {
         .crtc_id = crtc->crtc_id,
         .gamma_size = crtc->gamma_size,
-        .red = (uint64_t)(uintptr_t)r,
-        .green = (uint64_t)(uintptr_t)g,
-        .blue = (uint64_t)(uintptr_t)b,
+        .red = (uint64_t)(uintptr_t)ramp.r,
+        .green = (uint64_t)(uintptr_t)ramp.g,
+        .blue = (uint64_t)(uintptr_t)ramp.b,
     };
 
     int ret = drm_set_gamma(state->fd, &lut);
 
-    free(r); free(g); free(b);
-
     return (ret < 0) ? MERIDIAN_ERR_GAMMA : MERIDIAN_OK;
 }
 
@@ -348,6 +899,16 @@ meridian_drm_set_temperature(meridian_drm_state_t *state, int temp, float bright
 {
     if (!state) return MERIDIAN_ERR_RESOURCES;
 
+    /* A blocking commit waits out any frame still in flight */
+    state->flips_pending = 0;
+
+    /* All heads in one commit, latched together on the next vblank */
+    if (state->atomic) {
+        if (atomic_set_temperature(state, -1, temp, brightness, 0, nullptr) == MERIDIAN_OK)
+            return MERIDIAN_OK;
+        state->atomic = false;  /* not master, or driver rejects it */
+    }
+
     meridian_error_t last_err = MERIDIAN_OK;
     int success_count = 0;
 
@@ -371,6 +932,9 @@ meridian_drm_restore(meridian_drm_state_t *state)
 {
     if (!state) return MERIDIAN_ERR_RESOURCES;
 
+    if (state->atomic && atomic_restore(state) == MERIDIAN_OK)
+        return MERIDIAN_OK;
+
     for (int i = 0; i < state->crtc_count; i++) {
         crtc_state_t *crtc = &state->crtcs[i];
         if (crtc->gamma_size > 1 && crtc->saved_r) {
@@ -388,3 +952,83 @@ meridian_drm_restore(meridian_drm_state_t *state)
 
     return MERIDIAN_OK;
 }
+
+int
+meridian_drm_get_fd(const meridian_drm_state_t *state)
+{
+    return state ? state->uevent_fd : -1;
+}
+
+int
+meridian_drm_get_event_fd(const meridian_drm_state_t *state)
+{
+    return state ? state->fd : -1;
+}
+
+meridian_error_t
+meridian_drm_set_temperature_frame(meridian_drm_state_t *state, int temp, float brightness)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+    if (!meridian_drm_frame_paced(state))
+        return meridian_drm_set_temperature(state, temp, brightness);
+    if (state->flips_pending > 0) return MERIDIAN_ERR_BUSY;
+
+    int committed = 0;
+    meridian_error_t err = atomic_set_temperature(state, -1, temp, brightness,
+                                                  DRM_MODE_ATOMIC_NONBLOCK |
+                                                  DRM_MODE_PAGE_FLIP_EVENT,
+                                                  &committed);
+    if (err == MERIDIAN_OK) {
+        state->flips_pending = committed;
+        return MERIDIAN_OK;
+    }
+    if (err == MERIDIAN_ERR_BUSY || err == MERIDIAN_ERR_INVALID_TEMP) return err;
+
+    /* Driver will not do non-blocking color commits: step by timer instead */
+    state->flip_events = false;
+    return meridian_drm_set_temperature(state, temp, brightness);
+}
+
+bool
+meridian_drm_frame_paced(const meridian_drm_state_t *state)
+{
+    if (!state || !state->atomic || !state->flip_events) return false;
+    for (int i = 0; i < state->crtc_count; i++)
+        if (state->crtcs[i].active && state->crtcs[i].lut_size) return true;
+    return false;
+}
+
+bool
+meridian_drm_frame_pending(const meridian_drm_state_t *state)
+{
+    return state && state->flips_pending > 0;
+}
+
+int
+meridian_drm_get_refresh_mhz(const meridian_drm_state_t *state)
+{
+    int best = 0;
+    if (!state) return 0;
+    for (int i = 0; i < state->crtc_count; i++)
+        if (state->crtcs[i].active && state->crtcs[i].refresh_mhz > best)
+            best = state->crtcs[i].refresh_mhz;
+    return best;
+}
+
+meridian_error_t
+meridian_drm_dispatch(meridian_drm_state_t *state, bool *outputs_changed)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+    drm_read_events(state);
+    if (state->uevent_fd < 0) return MERIDIAN_OK;
+
+    char buf[4096];
+    ssize_t len;
+    while ((len = recv(state->uevent_fd, buf, sizeof(buf) - 1, 0)) > 0) {
+        buf[len] = '\0';
+        if (uevent_is_hotplug(buf, (size_t)len, state->card_num))
+            *outputs_changed = true;
+    }
+    if (*outputs_changed) drm_read_modes(state);
+    return MERIDIAN_OK;
+}
@@ -6,6 +6,11 @@
  *
  * Covers: GNOME on Debian, Ubuntu, Fedora, RHEL, etc.
  * libsystemd loaded at runtime via dlopen -- no link-time dependency.
+ *
+ * SetCrtcGamma calls are pipelined with sd_bus_call_async: every CRTC's
+ * request goes out back to back and replies are consumed later from
+ * meridian_gnome_dispatch(), driven by the caller polling the bus fd.
+ * MonitorsChanged triggers an async GetResources and a re-send.
  */
 
 #ifdef MERIDIAN_HAS_GNOME
@@ -16,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <dlfcn.h>
+#include <poll.h>
 
 #include <systemd/sd-bus.h>
 
@@ -27,8 +33,19 @@ static struct {
     int (*sd_bus_call_method)(sd_bus *, const char *, const char *,
                               const char *, const char *,
                               sd_bus_error *, sd_bus_message **, const char *, ...);
-    int (*sd_bus_call)(sd_bus *, sd_bus_message *, uint64_t,
-                       sd_bus_error *, sd_bus_message **);
+    int (*sd_bus_call_async)(sd_bus *, sd_bus_slot **, sd_bus_message *,
+                             sd_bus_message_handler_t, void *, uint64_t);
+    int (*sd_bus_call_method_async)(sd_bus *, sd_bus_slot **, const char *,
+                                    const char *, const char *, const char *,
+                                    sd_bus_message_handler_t, void *, const char *, ...);
+    int (*sd_bus_match_signal)(sd_bus *, sd_bus_slot **, const char *,
+                               const char *, const char *, const char *,
+                               sd_bus_message_handler_t, void *);
+    int (*sd_bus_get_fd)(sd_bus *);
+    int (*sd_bus_get_events)(sd_bus *);
+    int (*sd_bus_process)(sd_bus *, sd_bus_message **);
+    int (*sd_bus_flush)(sd_bus *);
+    int (*sd_bus_message_is_method_error)(sd_bus_message *, const char *);
     int (*sd_bus_message_read)(sd_bus_message *, const char *, ...);
     int (*sd_bus_message_enter_container)(sd_bus_message *, char, const char *);
     int (*sd_bus_message_exit_container)(sd_bus_message *);
@@ -60,7 +77,14 @@ static bool sdbus_load(void)
     LOAD(sd_bus_open_user);
     LOAD(sd_bus_unref);
     LOAD(sd_bus_call_method);
-    LOAD(sd_bus_call);
+    LOAD(sd_bus_call_async);
+    LOAD(sd_bus_call_method_async);
+    LOAD(sd_bus_match_signal);
+    LOAD(sd_bus_get_fd);
+    LOAD(sd_bus_get_events);
+    LOAD(sd_bus_process);
+    LOAD(sd_bus_flush);
+    LOAD(sd_bus_message_is_method_error);
     LOAD(sd_bus_message_read);
     LOAD(sd_bus_message_enter_container);
     LOAD(sd_bus_message_exit_container);
@@ -106,6 +130,14 @@ struct meridian_gnome_state {
     uint32_t serial;
     int crtc_count;
     gnome_crtc_t *crtcs;
+
+    /* Async bookkeeping */
+    int pending;            /* SetCrtcGamma calls awaiting a reply */
+    int failed_replies;     /* error replies since the last set */
+    bool refreshing;        /* GetResources in flight */
+    bool have_last;         /* re-send after MonitorsChanged */
+    int last_temp;
+    float last_brightness;
 };
 
 /* ============================================================
@@ -118,38 +150,25 @@ struct meridian_gnome_state {
  * We need:
  *   - serial (first 'u')
  *   - crtcs array: a(uxiiiiiuaua{sv}) - we only need the CRTC ID (first 'u' in each struct)
+ *
+ * On success replaces state->serial/crtcs; on failure leaves them intact.
  */
 static meridian_error_t
-gnome_get_resources(struct meridian_gnome_state *state)
+gnome_parse_resources(struct meridian_gnome_state *state, sd_bus_message *reply)
 {
-    sd_bus_error error = SD_BUS_ERROR_NULL;
-    sd_bus_message *reply = nullptr;
-    int r;
-
-    r = sdbus.sd_bus_call_method(state->bus,
-                           MUTTER_DBUS_NAME,
-                           MUTTER_DBUS_PATH,
-                           MUTTER_DBUS_IFACE,
-                           "GetResources",
-                           &error, &reply, "");
-    if (r < 0) {
-        sdbus.sd_bus_error_free(&error);
-        return MERIDIAN_ERR_GNOME_DBUS;
-    }
-
-    /* Read serial */
-    r = sdbus.sd_bus_message_read(reply, "u", &state->serial);
-    if (r < 0) goto fail;
+    uint32_t serial;
+    int r = sdbus.sd_bus_message_read(reply, "u", &serial);
+    if (r < 0) return MERIDIAN_ERR_GNOME_DBUS;
 
     /* Enter CRTC array: a(uxiiiiiuaua{sv}) */
     r = sdbus.sd_bus_message_enter_container(reply, 'a', "(uxiiiiiuaua{sv})");
-    if (r < 0) goto fail;
+    if (r < 0) return MERIDIAN_ERR_GNOME_DBUS;
 
     /* Count and collect CRTC IDs */
     int capacity = 4;
-    state->crtcs = malloc(capacity * sizeof(gnome_crtc_t));
-    if (!state->crtcs) goto fail;
-    state->crtc_count = 0;
+    int count = 0;
+    gnome_crtc_t *crtcs = malloc(capacity * sizeof(gnome_crtc_t));
+    if (!crtcs) return MERIDIAN_ERR_RESOURCES;
 
     while ((r = sdbus.sd_bus_message_enter_container(reply, 'r', "uxiiiiiuaua{sv}")) > 0) {
         uint32_t crtc_id;
@@ -163,32 +182,109 @@ gnome_get_resources(struct meridian_gnome_state *state)
         r = sdbus.sd_bus_message_exit_container(reply);
         if (r < 0) goto fail;
 
-        if (state->crtc_count >= capacity) {
+        if (count >= capacity) {
             capacity *= 2;
-            gnome_crtc_t *new_arr = realloc(state->crtcs, capacity * sizeof(gnome_crtc_t));
+            gnome_crtc_t *new_arr = realloc(crtcs, capacity * sizeof(gnome_crtc_t));
             if (!new_arr) goto fail;
-            state->crtcs = new_arr;
+            crtcs = new_arr;
         }
 
-        state->crtcs[state->crtc_count].crtc_id = crtc_id;
-        state->crtc_count++;
+        crtcs[count++].crtc_id = crtc_id;
     }
 
     /* Exit CRTC array */
     sdbus.sd_bus_message_exit_container(reply);
 
-    sdbus.sd_bus_message_unref(reply);
-    sdbus.sd_bus_error_free(&error);
+    if (count == 0) {
+        free(crtcs);
+        return MERIDIAN_ERR_NO_CRTC;
+    }
 
-    return (state->crtc_count > 0) ? MERIDIAN_OK : MERIDIAN_ERR_NO_CRTC;
+    free(state->crtcs);
+    state->crtcs = crtcs;
+    state->crtc_count = count;
+    state->serial = serial;
+    return MERIDIAN_OK;
 
 fail:
+    free(crtcs);
+    return MERIDIAN_ERR_GNOME_DBUS;
+}
+
+/* Blocking GetResources (init only, before the caller polls the bus) */
+static meridian_error_t
+gnome_get_resources(struct meridian_gnome_state *state)
+{
+    sd_bus_error error = SD_BUS_ERROR_NULL;
+    sd_bus_message *reply = nullptr;
+
+    int r = sdbus.sd_bus_call_method(state->bus,
+                           MUTTER_DBUS_NAME,
+                           MUTTER_DBUS_PATH,
+                           MUTTER_DBUS_IFACE,
+                           "GetResources",
+                           &error, &reply, "");
+    if (r < 0) {
+        sdbus.sd_bus_error_free(&error);
+        return MERIDIAN_ERR_GNOME_DBUS;
+    }
+
+    meridian_error_t err = gnome_parse_resources(state, reply);
+
     sdbus.sd_bus_message_unref(reply);
     sdbus.sd_bus_error_free(&error);
-    free(state->crtcs);
-    state->crtcs = nullptr;
-    state->crtc_count = 0;
-    return MERIDIAN_ERR_GNOME_DBUS;
+    return err;
+}
+
+/* ============================================================
+ * Async reply and signal handlers
+ * ============================================================ */
+
+static meridian_error_t gnome_send_all(struct meridian_gnome_state *state,
+                                       int temp, float brightness);
+
+static int
+gnome_gamma_reply(sd_bus_message *m, void *userdata,
+                  sd_bus_error *ret_error [[maybe_unused]])
+{
+    struct meridian_gnome_state *state = userdata;
+    if (state->pending > 0) state->pending--;
+    if (sdbus.sd_bus_message_is_method_error(m, nullptr))
+        state->failed_replies++;
+    return 0;
+}
+
+static int
+gnome_resources_reply(sd_bus_message *m, void *userdata,
+                      sd_bus_error *ret_error [[maybe_unused]])
+{
+    struct meridian_gnome_state *state = userdata;
+    state->refreshing = false;
+
+    if (sdbus.sd_bus_message_is_method_error(m, nullptr)) return 0;
+    if (gnome_parse_resources(state, m) != MERIDIAN_OK) return 0;
+
+    /* New serial and CRTC set: replay the last temperature onto it */
+    if (state->have_last)
+        (void)gnome_send_all(state, state->last_temp, state->last_brightness);
+    return 0;
+}
+
+static int
+gnome_monitors_changed(sd_bus_message *m [[maybe_unused]], void *userdata,
+                       sd_bus_error *ret_error [[maybe_unused]])
+{
+    struct meridian_gnome_state *state = userdata;
+    if (state->refreshing) return 0;
+
+    int r = sdbus.sd_bus_call_method_async(state->bus, nullptr,
+                                           MUTTER_DBUS_NAME,
+                                           MUTTER_DBUS_PATH,
+                                           MUTTER_DBUS_IFACE,
+                                           "GetResources",
+                                           gnome_resources_reply, state, "");
+    if (r >= 0) state->refreshing = true;
+    return 0;
 }
 
 /* ============================================================
@@ -216,6 +312,15 @@ meridian_gnome_init(meridian_gnome_state_t **state_out)
         return err;
     }
 
+    /* Hotplug and mode changes invalidate the serial; without the match
+     * we only lose automatic re-apply, so failure is not fatal */
+    (void)sdbus.sd_bus_match_signal(state->bus, nullptr,
+                                    MUTTER_DBUS_NAME,
+                                    MUTTER_DBUS_PATH,
+                                    MUTTER_DBUS_IFACE,
+                                    "MonitorsChanged",
+                                    gnome_monitors_changed, state);
+
     *state_out = state;
     return MERIDIAN_OK;
 }
@@ -225,8 +330,10 @@ meridian_gnome_free(meridian_gnome_state_t *state)
 {
     if (!state) return;
 
-    /* Restore linear gamma before shutting down */
+    /* Restore linear gamma before shutting down; make sure it is on the
+     * wire, replies are not awaited */
     (void)meridian_gnome_restore(state);
+    if (state->bus) sdbus.sd_bus_flush(state->bus);
 
     free(state->crtcs);
     if (state->bus) sdbus.sd_bus_unref(state->bus);
@@ -251,6 +358,40 @@ meridian_gnome_get_gamma_size(const meridian_gnome_state_t *state [[maybe_unused
     return GNOME_GAMMA_SIZE;
 }
 
+int
+meridian_gnome_get_fd(const meridian_gnome_state_t *state)
+{
+    if (!state || !state->bus) return -1;
+    return sdbus.sd_bus_get_fd(state->bus);
+}
+
+/* ============================================================
+ * Event processing (caller polls meridian_gnome_get_fd())
+ * ============================================================ */
+
+/* Push out anything sd-bus could not write without blocking */
+static void
+gnome_flush_if_queued(struct meridian_gnome_state *state)
+{
+    int events = sdbus.sd_bus_get_events(state->bus);
+    if (events > 0 && (events & POLLOUT))
+        sdbus.sd_bus_flush(state->bus);
+}
+
+meridian_error_t
+meridian_gnome_dispatch(meridian_gnome_state_t *state)
+{
+    if (!state || !state->bus) return MERIDIAN_ERR_RESOURCES;
+
+    int r;
+    while ((r = sdbus.sd_bus_process(state->bus, nullptr)) > 0)
+        ;
+    if (r < 0) return MERIDIAN_ERR_GNOME_DBUS;
+
+    gnome_flush_if_queued(state);
+    return MERIDIAN_OK;
+}
+
 /* ============================================================
  * Set gamma via SetCrtcGamma DBus call
  *
@@ -262,7 +403,6 @@ static meridian_error_t
 gnome_set_gamma_crtc(struct meridian_gnome_state *state, int crtc_idx,
                      const uint16_t *r, const uint16_t *g, const uint16_t *b)
 {
-    sd_bus_error error = SD_BUS_ERROR_NULL;
     sd_bus_message *msg = nullptr;
     int ret;
 
@@ -288,18 +428,45 @@ gnome_set_gamma_crtc(struct meridian_gnome_state *state, int crtc_idx,
     ret = sdbus.sd_bus_message_append_array(msg, 'q', b, GNOME_GAMMA_SIZE * sizeof(uint16_t));
     if (ret < 0) goto fail;
 
-    ret = sdbus.sd_bus_call(state->bus, msg, 0, &error, nullptr);
+    /* Queue without waiting; the reply lands in gnome_gamma_reply() */
+    ret = sdbus.sd_bus_call_async(state->bus, nullptr, msg,
+                                  gnome_gamma_reply, state, 0);
     sdbus.sd_bus_message_unref(msg);
-    sdbus.sd_bus_error_free(&error);
+    if (ret < 0) return MERIDIAN_ERR_GNOME_DBUS;
 
-    return (ret < 0) ? MERIDIAN_ERR_GNOME_DBUS : MERIDIAN_OK;
+    state->pending++;
+    return MERIDIAN_OK;
 
 fail:
     sdbus.sd_bus_message_unref(msg);
-    sdbus.sd_bus_error_free(&error);
     return MERIDIAN_ERR_GNOME_DBUS;
 }
 
+static meridian_error_t
+gnome_send_all(struct meridian_gnome_state *state, int temp, float brightness)
+{
+    /* All Mutter CRTCs share GNOME_GAMMA_SIZE: one fill serves every call */
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, GNOME_GAMMA_SIZE,
+                                                    brightness, &ramp);
+    if (err != MERIDIAN_OK) return err;
+
+    meridian_error_t last_err = MERIDIAN_OK;
+    int success_count = 0;
+
+    for (int i = 0; i < state->crtc_count; i++) {
+        err = gnome_set_gamma_crtc(state, i, ramp.r, ramp.g, ramp.b);
+        if (err == MERIDIAN_OK) {
+            success_count++;
+        } else {
+            last_err = err;
+        }
+    }
+
+    gnome_flush_if_queued(state);
+    return (success_count > 0) ? MERIDIAN_OK : last_err;
+}
+
 meridian_error_t
 meridian_gnome_set_temperature_crtc(meridian_gnome_state_t *state, int crtc_idx,
                                     int temp, float brightness)
@@ -308,34 +475,37 @@ meridian_gnome_set_temperature_crtc(meridian_gnome_state_t *state, int crtc_idx,
         return MERIDIAN_ERR_GNOME_DBUS;
     }
 
-    uint16_t r[GNOME_GAMMA_SIZE], g[GNOME_GAMMA_SIZE], b[GNOME_GAMMA_SIZE];
-    meridian_error_t err = meridian_fill_gamma_ramps(temp, GNOME_GAMMA_SIZE,
-                                                      r, g, b, brightness);
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, GNOME_GAMMA_SIZE,
+                                                    brightness, &ramp);
     if (err != MERIDIAN_OK) return err;
 
-    return gnome_set_gamma_crtc(state, crtc_idx, r, g, b);
+    err = gnome_set_gamma_crtc(state, crtc_idx, ramp.r, ramp.g, ramp.b);
+    gnome_flush_if_queued(state);
+    return err;
 }
 
+/*
+ * Replies are asynchronous: an error reply (e.g. a stale serial) from
+ * the previous batch is reported by the next call.
+ */
 meridian_error_t
 meridian_gnome_set_temperature(meridian_gnome_state_t *state,
                                int temp, float brightness)
 {
     if (!state) return MERIDIAN_ERR_RESOURCES;
 
-    meridian_error_t last_err = MERIDIAN_OK;
-    int success_count = 0;
+    int failed = state->failed_replies;
+    state->failed_replies = 0;
 
-    for (int i = 0; i < state->crtc_count; i++) {
-        meridian_error_t err = meridian_gnome_set_temperature_crtc(state, i,
-                                                                    temp, brightness);
-        if (err == MERIDIAN_OK) {
-            success_count++;
-        } else {
-            last_err = err;
-        }
-    }
+    state->have_last = true;
+    state->last_temp = temp;
+    state->last_brightness = brightness;
 
-    return (success_count > 0) ? MERIDIAN_OK : last_err;
+    meridian_error_t err = gnome_send_all(state, temp, brightness);
+    if (err != MERIDIAN_OK) return err;
+    return (failed > 0 && failed >= state->crtc_count) ? MERIDIAN_ERR_GNOME_DBUS
+                                                       : MERIDIAN_OK;
 }
 
 /* ============================================================
@@ -354,12 +524,15 @@ meridian_gnome_restore(meridian_gnome_state_t *state)
         r[i] = g[i] = b[i] = val;
     }
 
+    state->have_last = false;
+
     meridian_error_t last_err = MERIDIAN_OK;
     for (int i = 0; i < state->crtc_count; i++) {
         meridian_error_t err = gnome_set_gamma_crtc(state, i, r, g, b);
         if (err != MERIDIAN_OK) last_err = err;
     }
 
+    gnome_flush_if_queued(state);
     return last_err;
 }
 
@@ -0,0 +1,102 @@
+/*
+ * gamma_null.c - Recording backend without a display
+ *
+ * Holds a fixed set of virtual outputs and reports every ramp applied to
+ * them through the caller's record callback; nothing is opened. Used by
+ * simulations and tests that drive the full set_temperature path at CPU
+ * speed. Ramps come from the shared ramp cache, so a recorder sees the
+ * exact values a real backend would upload.
+ */
+
+#define _GNU_SOURCE
+#include "meridian.h"
+
+#include <stdlib.h>
+
+struct meridian_null_state {
+    meridian_null_config_t config;
+};
+
+meridian_error_t
+meridian_null_init(const meridian_null_config_t *config, meridian_null_state_t **state_out)
+{
+    if (!state_out) return MERIDIAN_ERR_RESOURCES;
+    *state_out = nullptr;
+
+    meridian_null_config_t cfg = config ? *config : (meridian_null_config_t){0};
+    if (cfg.outputs == 0) cfg.outputs = 1;
+    if (cfg.gamma_size == 0) cfg.gamma_size = MERIDIAN_GAMMA_RAMP_SIZE;
+    if (cfg.outputs < 0 || cfg.outputs > MERIDIAN_PROBE_MAX_OUTPUTS || cfg.gamma_size < 2)
+        return MERIDIAN_ERR_NO_CRTC;
+
+    meridian_null_state_t *state = calloc(1, sizeof(*state));
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+    state->config = cfg;
+    *state_out = state;
+    return MERIDIAN_OK;
+}
+
+void
+meridian_null_free(meridian_null_state_t *state)
+{
+    free(state);
+}
+
+int
+meridian_null_get_crtc_count(const meridian_null_state_t *state)
+{
+    return state ? state->config.outputs : 0;
+}
+
+int
+meridian_null_get_gamma_size(const meridian_null_state_t *state, int crtc_idx)
+{
+    if (!state || crtc_idx < 0 || crtc_idx >= state->config.outputs) return 0;
+    return state->config.gamma_size;
+}
+
+meridian_error_t
+meridian_null_set_temperature_crtc(meridian_null_state_t *state, int crtc_idx,
+                                   int temp, float brightness)
+{
+    if (!state || crtc_idx < 0 || crtc_idx >= state->config.outputs)
+        return MERIDIAN_ERR_CRTC;
+    if (temp < MERIDIAN_TEMP_MIN || temp > MERIDIAN_TEMP_MAX)
+        return MERIDIAN_ERR_INVALID_TEMP;
+
+    /* Without a recorder there is nobody to hand the ramps to */
+    if (!state->config.record) return MERIDIAN_OK;
+
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, state->config.gamma_size,
+                                                   brightness, &ramp);
+    if (err != MERIDIAN_OK) return err;
+
+    state->config.record(state->config.ctx, crtc_idx, temp, brightness,
+                         &ramp, state->config.gamma_size);
+    return MERIDIAN_OK;
+}
+
+meridian_error_t
+meridian_null_set_temperature(meridian_null_state_t *state, int temp, float brightness)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    for (int i = 0; i < state->config.outputs; i++) {
+        meridian_error_t err = meridian_null_set_temperature_crtc(state, i, temp, brightness);
+        if (err != MERIDIAN_OK) return err;
+    }
+    return MERIDIAN_OK;
+}
+
+meridian_error_t
+meridian_null_restore(meridian_null_state_t *state)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    if (state->config.record)
+        for (int i = 0; i < state->config.outputs; i++)
+            state->config.record(state->config.ctx, i, 0, 1.0f, nullptr,
+                                 state->config.gamma_size);
+    return MERIDIAN_OK;
+}
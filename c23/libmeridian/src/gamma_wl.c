@@ -4,8 +4,14 @@
  * Covers compositors implementing the wlr protocol:
  *   Sway, Hyprland, river, labwc, wayfire, niri
  *
- * Uses memfd for gamma ramp transfer (no tmpfile needed).
+ * Uses memfd for gamma ramp transfer (no tmpfile needed). Each output
+ * keeps a small pool of pre-sized memfds; meridian_wl_prepare_temperature()
+ * writes and seals the next ramp while idle so the set path only sends it.
  * Protocol auto-restores gamma when controls are destroyed.
+ *
+ * After init the registry stays live: meridian_wl_dispatch() picks up
+ * outputs announced later (docking) and drops removed ones. Outputs are
+ * heap-allocated individually because listeners keep pointers to them.
  */
 
 #ifdef MERIDIAN_HAS_WAYLAND
@@ -13,6 +19,8 @@
 #define _GNU_SOURCE
 #include "meridian.h"
 
+#include <errno.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -26,11 +34,28 @@
  * Per-output state
  * ============================================================ */
 
+/*
+ * One staged ramp plus one blank spare. A sealed memfd cannot be
+ * rewritten, and the compositor consumes it through a shared file
+ * offset, so every fd is sent exactly once and then closed.
+ */
+#define WL_POOL_SLOTS 2
+
 typedef struct {
+    int fd;             /* -1 = empty */
+    bool sealed;        /* holds the ramp for (temp, brightness) */
+    int temp;
+    float brightness;
+} wl_memfd_t;
+
+typedef struct {
+    struct meridian_wl_state *state;
+    uint32_t name;                  /* registry global name */
     struct wl_output *wl_output;
     struct zwlr_gamma_control_v1 *gamma_control;
     uint32_t gamma_size;
     bool failed;
+    wl_memfd_t pool[WL_POOL_SLOTS];
 } wl_output_state_t;
 
 /* ============================================================
@@ -43,9 +68,100 @@ struct meridian_wl_state {
     struct zwlr_gamma_control_manager_v1 *gamma_manager;
     int output_count;
     int output_capacity;
-    wl_output_state_t *outputs;
+    wl_output_state_t **outputs;
+    bool ready;                     /* init done: new globals are hotplug */
+    bool outputs_changed;           /* gamma_size arrived since last dispatch */
 };
 
+/* ============================================================
+ * Memfd pool (per-output)
+ * ============================================================ */
+
+static void
+wl_pool_release(wl_memfd_t *slot)
+{
+    if (slot->fd >= 0) close(slot->fd);
+    slot->fd = -1;
+    slot->sealed = false;
+}
+
+/* Close every pooled fd (gamma size changed or output lost) */
+static void
+wl_pool_drop(wl_output_state_t *out)
+{
+    for (int i = 0; i < WL_POOL_SLOTS; i++)
+        wl_pool_release(&out->pool[i]);
+}
+
+static wl_memfd_t *
+wl_pool_find(wl_output_state_t *out, int temp, float brightness)
+{
+    for (int i = 0; i < WL_POOL_SLOTS; i++) {
+        wl_memfd_t *slot = &out->pool[i];
+        if (slot->fd >= 0 && slot->sealed &&
+            slot->temp == temp && slot->brightness == brightness)
+            return slot;
+    }
+    return nullptr;
+}
+
+/* Blank pre-sized slot, creating one (or recycling a stale ramp) if needed */
+static wl_memfd_t *
+wl_pool_blank(wl_output_state_t *out, const wl_memfd_t *keep)
+{
+    wl_memfd_t *victim = nullptr;
+    for (int i = 0; i < WL_POOL_SLOTS; i++) {
+        wl_memfd_t *slot = &out->pool[i];
+        if (slot == keep) continue;
+        if (slot->fd >= 0 && !slot->sealed) return slot;
+        if (!victim || slot->fd < 0) victim = slot;
+    }
+    if (!victim) return nullptr;
+    wl_pool_release(victim);
+
+    size_t total = (size_t)out->gamma_size * sizeof(uint16_t) * 3;
+    int fd = memfd_create("meridian-gamma", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) return nullptr;
+
+    if (ftruncate(fd, (off_t)total) < 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    victim->fd = fd;
+    return victim;
+}
+
+/* Write the ramp into a blank slot and seal it as the protocol requires */
+static meridian_error_t
+wl_pool_fill(wl_output_state_t *out, wl_memfd_t *slot, int temp, float brightness)
+{
+    uint32_t gs = out->gamma_size;
+    size_t ramp_bytes = gs * sizeof(uint16_t);
+    size_t total = ramp_bytes * 3; /* R + G + B contiguous */
+
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, (int)gs, brightness, &ramp);
+    if (err != MERIDIAN_OK) return err;
+
+    uint16_t *map = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, slot->fd, 0);
+    if (map == MAP_FAILED) return MERIDIAN_ERR_RESOURCES;
+
+    memcpy(map, ramp.r, ramp_bytes);
+    memcpy(map + gs, ramp.g, ramp_bytes);
+    memcpy(map + gs * 2, ramp.b, ramp_bytes);
+
+    munmap(map, total);
+
+    if (fcntl(slot->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE) < 0)
+        return MERIDIAN_ERR_RESOURCES;
+
+    slot->sealed = true;
+    slot->temp = temp;
+    slot->brightness = brightness;
+    return MERIDIAN_OK;
+}
+
 /* ============================================================
  * Gamma control listener (per-output)
  * ============================================================ */
@@ -56,7 +172,10 @@ gamma_control_gamma_size(void *data,
                          uint32_t size)
 {
     wl_output_state_t *output = data;
+    if (output->gamma_size != size)
+        wl_pool_drop(output);
     output->gamma_size = size;
+    output->state->outputs_changed = true;
 }
 
 static void
@@ -65,6 +184,7 @@ gamma_control_failed(void *data,
 {
     wl_output_state_t *output = data;
     output->failed = true;
+    wl_pool_drop(output);
     if (output->gamma_control) {
         zwlr_gamma_control_v1_destroy(output->gamma_control);
         output->gamma_control = nullptr;
@@ -80,21 +200,48 @@ static const struct zwlr_gamma_control_v1_listener gamma_control_listener = {
  * Registry listener (globals)
  * ============================================================ */
 
-static void
-add_output(struct meridian_wl_state *state, struct wl_output *output)
+static wl_output_state_t *
+add_output(struct meridian_wl_state *state, uint32_t name, struct wl_output *output)
 {
     if (state->output_count >= state->output_capacity) {
         int new_cap = state->output_capacity ? state->output_capacity * 2 : 4;
-        wl_output_state_t *new_arr = realloc(state->outputs,
-                                              new_cap * sizeof(wl_output_state_t));
-        if (!new_arr) return;
+        wl_output_state_t **new_arr = realloc(state->outputs,
+                                               new_cap * sizeof(*new_arr));
+        if (!new_arr) return nullptr;
         state->outputs = new_arr;
         state->output_capacity = new_cap;
     }
 
-    wl_output_state_t *out = &state->outputs[state->output_count++];
-    memset(out, 0, sizeof(*out));
+    wl_output_state_t *out = calloc(1, sizeof(*out));
+    if (!out) return nullptr;
+    out->state = state;
+    out->name = name;
     out->wl_output = output;
+    for (int i = 0; i < WL_POOL_SLOTS; i++)
+        out->pool[i].fd = -1;
+
+    state->outputs[state->output_count++] = out;
+    return out;
+}
+
+static void
+acquire_gamma_control(struct meridian_wl_state *state, wl_output_state_t *out)
+{
+    out->gamma_control = zwlr_gamma_control_manager_v1_get_gamma_control(
+        state->gamma_manager, out->wl_output);
+    zwlr_gamma_control_v1_add_listener(out->gamma_control,
+                                        &gamma_control_listener, out);
+}
+
+static void
+destroy_output(wl_output_state_t *out)
+{
+    wl_pool_drop(out);
+    if (out->gamma_control)
+        zwlr_gamma_control_v1_destroy(out->gamma_control);
+    if (out->wl_output)
+        wl_output_destroy(out->wl_output);
+    free(out);
 }
 
 static void
@@ -109,18 +256,36 @@ registry_global(void *data, struct wl_registry *registry,
     } else if (strcmp(interface, wl_output_interface.name) == 0) {
         struct wl_output *output = wl_registry_bind(registry, name,
                                                      &wl_output_interface, 1);
-        if (output) {
-            add_output(state, output);
+        if (!output) return;
+
+        wl_output_state_t *out = add_output(state, name, output);
+        if (!out) {
+            wl_output_destroy(output);
+            return;
         }
+
+        /* Hotplugged: its gamma_size event marks the outputs changed */
+        if (state->ready && state->gamma_manager)
+            acquire_gamma_control(state, out);
     }
 }
 
 static void
-registry_global_remove(void *data [[maybe_unused]],
+registry_global_remove(void *data,
                        struct wl_registry *registry [[maybe_unused]],
-                       uint32_t name [[maybe_unused]])
+                       uint32_t name)
 {
-    /* Hot-unplug not handled for gamma control */
+    struct meridian_wl_state *state = data;
+
+    for (int i = 0; i < state->output_count; i++) {
+        if (state->outputs[i]->name != name) continue;
+
+        destroy_output(state->outputs[i]);
+        memmove(&state->outputs[i], &state->outputs[i + 1],
+                (size_t)(state->output_count - i - 1) * sizeof(*state->outputs));
+        state->output_count--;
+        return;
+    }
 }
 
 static const struct wl_registry_listener registry_listener = {
@@ -157,6 +322,8 @@ meridian_wl_init(meridian_wl_state_t **state_out)
 
     if (!state->gamma_manager) {
         /* Compositor doesn't support wlr-gamma-control */
+        for (int i = 0; i < state->output_count; i++)
+            destroy_output(state->outputs[i]);
         if (state->registry) wl_registry_destroy(state->registry);
         wl_display_disconnect(state->display);
         free(state->outputs);
@@ -174,13 +341,8 @@ meridian_wl_init(meridian_wl_state_t **state_out)
     }
 
     /* Acquire gamma control for each output */
-    for (int i = 0; i < state->output_count; i++) {
-        wl_output_state_t *out = &state->outputs[i];
-        out->gamma_control = zwlr_gamma_control_manager_v1_get_gamma_control(
-            state->gamma_manager, out->wl_output);
-        zwlr_gamma_control_v1_add_listener(out->gamma_control,
-                                            &gamma_control_listener, out);
-    }
+    for (int i = 0; i < state->output_count; i++)
+        acquire_gamma_control(state, state->outputs[i]);
 
     /* Second roundtrip: receive gamma_size events (or failed) */
     if (wl_display_roundtrip(state->display) < 0) {
@@ -191,7 +353,7 @@ meridian_wl_init(meridian_wl_state_t **state_out)
     /* Check that at least one output has usable gamma */
     int usable = 0;
     for (int i = 0; i < state->output_count; i++) {
-        if (!state->outputs[i].failed && state->outputs[i].gamma_size > 0) {
+        if (!state->outputs[i]->failed && state->outputs[i]->gamma_size > 0) {
             usable++;
         }
     }
@@ -201,6 +363,9 @@ meridian_wl_init(meridian_wl_state_t **state_out)
         return MERIDIAN_ERR_NO_CRTC;
     }
 
+    state->ready = true;
+    state->outputs_changed = false;
+
     *state_out = state;
     return MERIDIAN_OK;
 }
@@ -211,14 +376,8 @@ meridian_wl_free(meridian_wl_state_t *state)
     if (!state) return;
 
     /* Destroying gamma controls auto-restores original gamma */
-    for (int i = 0; i < state->output_count; i++) {
-        if (state->outputs[i].gamma_control) {
-            zwlr_gamma_control_v1_destroy(state->outputs[i].gamma_control);
-        }
-        if (state->outputs[i].wl_output) {
-            wl_output_destroy(state->outputs[i].wl_output);
-        }
-    }
+    for (int i = 0; i < state->output_count; i++)
+        destroy_output(state->outputs[i]);
 
     if (state->gamma_manager) {
         zwlr_gamma_control_manager_v1_destroy(state->gamma_manager);
@@ -251,8 +410,8 @@ int
 meridian_wl_get_gamma_size(const meridian_wl_state_t *state, int crtc_idx)
 {
     if (!state || crtc_idx < 0 || crtc_idx >= state->output_count) return 0;
-    if (state->outputs[crtc_idx].failed) return 0;
-    return (int)state->outputs[crtc_idx].gamma_size;
+    if (state->outputs[crtc_idx]->failed) return 0;
+    return (int)state->outputs[crtc_idx]->gamma_size;
 }
 
 /* ============================================================
@@ -263,50 +422,31 @@ static meridian_error_t
 wl_set_gamma_crtc(struct meridian_wl_state *state, int crtc_idx,
                   int temp, float brightness)
 {
-    wl_output_state_t *out = &state->outputs[crtc_idx];
+    wl_output_state_t *out = state->outputs[crtc_idx];
     if (out->failed || !out->gamma_control || out->gamma_size == 0) {
         return MERIDIAN_ERR_WAYLAND_PROTOCOL;
     }
 
-    uint32_t gs = out->gamma_size;
-    size_t ramp_bytes = gs * sizeof(uint16_t);
-    size_t total = ramp_bytes * 3; /* R + G + B contiguous */
-
-    /* Create memfd for gamma ramp transfer */
-    int fd = memfd_create("meridian-gamma", MFD_CLOEXEC | MFD_ALLOW_SEALING);
-    if (fd < 0) return MERIDIAN_ERR_RESOURCES;
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
 
-    if (ftruncate(fd, (off_t)total) < 0) {
-        close(fd);
-        return MERIDIAN_ERR_RESOURCES;
-    }
+    /* Staged by meridian_wl_prepare_temperature(): send only */
+    wl_memfd_t *slot = wl_pool_find(out, temp, brightness);
+    if (!slot) {
+        slot = wl_pool_blank(out, nullptr);
+        if (!slot) return MERIDIAN_ERR_RESOURCES;
 
-    uint16_t *map = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (map == MAP_FAILED) {
-        close(fd);
-        return MERIDIAN_ERR_RESOURCES;
-    }
-
-    uint16_t *r = map;
-    uint16_t *g = map + gs;
-    uint16_t *b = map + gs * 2;
-
-    meridian_error_t err = meridian_fill_gamma_ramps(temp, (int)gs, r, g, b, brightness);
-    if (err != MERIDIAN_OK) {
-        munmap(map, total);
-        close(fd);
-        return err;
+        meridian_error_t err = wl_pool_fill(out, slot, temp, brightness);
+        if (err != MERIDIAN_OK) {
+            wl_pool_release(slot);
+            return err;
+        }
     }
 
-    munmap(map, total);
-
-    /* Seal the fd as required by the protocol */
-    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE);
-
-    zwlr_gamma_control_v1_set_gamma(out->gamma_control, fd);
+    zwlr_gamma_control_v1_set_gamma(out->gamma_control, slot->fd);
     wl_display_flush(state->display);
 
-    close(fd);
+    wl_pool_release(slot);
     return MERIDIAN_OK;
 }
 
@@ -329,7 +469,7 @@ meridian_wl_set_temperature(meridian_wl_state_t *state, int temp, float brightne
     int success_count = 0;
 
     for (int i = 0; i < state->output_count; i++) {
-        if (!state->outputs[i].failed && state->outputs[i].gamma_size > 0) {
+        if (!state->outputs[i]->failed && state->outputs[i]->gamma_size > 0) {
             meridian_error_t err = wl_set_gamma_crtc(state, i, temp, brightness);
             if (err == MERIDIAN_OK) {
                 success_count++;
@@ -342,6 +482,43 @@ meridian_wl_set_temperature(meridian_wl_state_t *state, int temp, float brightne
     return (success_count > 0) ? MERIDIAN_OK : last_err;
 }
 
+meridian_error_t
+meridian_wl_prepare_temperature(meridian_wl_state_t *state, int temp, float brightness)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    meridian_error_t last_err = MERIDIAN_OK;
+    for (int i = 0; i < state->output_count; i++) {
+        wl_output_state_t *out = state->outputs[i];
+        if (out->failed || !out->gamma_control || out->gamma_size == 0)
+            continue;
+
+        wl_memfd_t *staged = wl_pool_find(out, temp, brightness);
+        if (!staged) {
+            staged = wl_pool_blank(out, nullptr);
+            if (!staged) {
+                last_err = MERIDIAN_ERR_RESOURCES;
+                continue;
+            }
+            meridian_error_t err = wl_pool_fill(out, staged, temp, brightness);
+            if (err != MERIDIAN_OK) {
+                wl_pool_release(staged);
+                last_err = err;
+                continue;
+            }
+        }
+
+        /* Keep a blank spare for off-schedule temperatures */
+        if (!wl_pool_blank(out, staged))
+            last_err = MERIDIAN_ERR_RESOURCES;
+    }
+
+    return last_err;
+}
+
 /* ============================================================
  * Restore
  * ============================================================ */
@@ -357,7 +534,8 @@ meridian_wl_restore(meridian_wl_state_t *state)
      * so the object can continue to be used for further set calls.
      */
     for (int i = 0; i < state->output_count; i++) {
-        wl_output_state_t *out = &state->outputs[i];
+        wl_output_state_t *out = state->outputs[i];
+        wl_pool_drop(out);
         if (out->gamma_control) {
             zwlr_gamma_control_v1_destroy(out->gamma_control);
             out->gamma_control = nullptr;
@@ -369,16 +547,55 @@ meridian_wl_restore(meridian_wl_state_t *state)
     wl_display_flush(state->display);
 
     /* Re-acquire gamma controls */
-    for (int i = 0; i < state->output_count; i++) {
-        wl_output_state_t *out = &state->outputs[i];
-        out->gamma_control = zwlr_gamma_control_manager_v1_get_gamma_control(
-            state->gamma_manager, out->wl_output);
-        zwlr_gamma_control_v1_add_listener(out->gamma_control,
-                                            &gamma_control_listener, out);
-    }
+    for (int i = 0; i < state->output_count; i++)
+        acquire_gamma_control(state, state->outputs[i]);
 
     if (wl_display_roundtrip(state->display) < 0)
         return MERIDIAN_ERR_WAYLAND_CONNECT;
+    state->outputs_changed = false;
+    return MERIDIAN_OK;
+}
+
+/* ============================================================
+ * Event processing (caller's poll loop)
+ * ============================================================ */
+
+int
+meridian_wl_get_fd(const meridian_wl_state_t *state)
+{
+    return state ? wl_display_get_fd(state->display) : -1;
+}
+
+meridian_error_t
+meridian_wl_dispatch(meridian_wl_state_t *state, bool *outputs_changed)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    /* Drain the socket: the caller's poll only fires on new data */
+    struct pollfd pfd = { .fd = wl_display_get_fd(state->display), .events = POLLIN };
+    for (;;) {
+        while (wl_display_prepare_read(state->display) != 0) {
+            if (wl_display_dispatch_pending(state->display) < 0)
+                return MERIDIAN_ERR_WAYLAND_CONNECT;
+        }
+        if (poll(&pfd, 1, 0) <= 0) {
+            wl_display_cancel_read(state->display);
+            break;
+        }
+        if (wl_display_read_events(state->display) < 0)
+            return MERIDIAN_ERR_WAYLAND_CONNECT;
+        if (wl_display_dispatch_pending(state->display) < 0)
+            return MERIDIAN_ERR_WAYLAND_CONNECT;
+    }
+
+    /* Send get_gamma_control for newly announced outputs */
+    if (wl_display_flush(state->display) < 0 && errno != EAGAIN)
+        return MERIDIAN_ERR_WAYLAND_CONNECT;
+
+    if (state->outputs_changed) {
+        state->outputs_changed = false;
+        *outputs_changed = true;
+    }
     return MERIDIAN_OK;
 }
 
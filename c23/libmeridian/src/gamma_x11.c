@@ -3,6 +3,16 @@
  *
  * Used when DRM gamma fails (NVIDIA proprietary, etc.)
  * Libraries loaded at runtime via dlopen -- no link-time dependency.
+ *
+ * Updates never wait on the server: XRRSetCrtcGamma has no reply, every
+ * CRTC's ramps go into its XRRCrtcGamma allocated at init, and
+ * meridian_x11_set_temperature queues all CRTCs before a single XFlush.
+ *
+ * RandR screen and CRTC change notifications arrive on the display
+ * connection (meridian_x11_get_fd). Screen resources are fetched again
+ * only on RRScreenChangeNotify; a CRTC change re-reads that CRTC's gamma
+ * size alone, so a CRTC lit by a newly connected monitor can be
+ * reapplied without querying the rest.
  */
 
 #ifdef MERIDIAN_HAS_X11
@@ -24,6 +34,10 @@ static struct {
     Display *(*XOpenDisplay)(const char *);
     int (*XCloseDisplay)(Display *);
     int (*XFlush)(Display *);
+    int (*XPending)(Display *);
+    int (*XNextEvent)(Display *, XEvent *);
+    Bool (*XRRQueryExtension)(Display *, int *, int *);
+    void (*XRRSelectInput)(Display *, Window, int);
     XRRScreenResources *(*XRRGetScreenResourcesCurrent)(Display *, Window);
     void (*XRRFreeScreenResources)(XRRScreenResources *);
     int (*XRRGetCrtcGammaSize)(Display *, RRCrtc);
@@ -31,6 +45,7 @@ static struct {
     XRRCrtcGamma *(*XRRAllocGamma)(int);
     void (*XRRSetCrtcGamma)(Display *, RRCrtc, XRRCrtcGamma *);
     void (*XRRFreeGamma)(XRRCrtcGamma *);
+    int (*XRRUpdateConfiguration)(XEvent *);
     bool loaded;
 } x11;
 
@@ -54,6 +69,10 @@ static bool x11_load(void)
     LOAD(libx11, XOpenDisplay);
     LOAD(libx11, XCloseDisplay);
     LOAD(libx11, XFlush);
+    LOAD(libx11, XPending);
+    LOAD(libx11, XNextEvent);
+    LOAD(libxrandr, XRRQueryExtension);
+    LOAD(libxrandr, XRRSelectInput);
     LOAD(libxrandr, XRRGetScreenResourcesCurrent);
     LOAD(libxrandr, XRRFreeScreenResources);
     LOAD(libxrandr, XRRGetCrtcGammaSize);
@@ -61,6 +80,7 @@ static bool x11_load(void)
     LOAD(libxrandr, XRRAllocGamma);
     LOAD(libxrandr, XRRSetCrtcGamma);
     LOAD(libxrandr, XRRFreeGamma);
+    LOAD(libxrandr, XRRUpdateConfiguration);
     #undef LOAD
     #pragma GCC diagnostic pop
 
@@ -78,12 +98,16 @@ struct meridian_x11_state {
     Display *display;
     Window root;
     int screen;
+    int rr_event_base;              /* -1: no change notifications */
+    bool resources_stale;           /* a screen change not yet read back */
     int crtc_count;
     RRCrtc *crtcs;
     int *gamma_sizes;
     XRRScreenResources *resources;
     /* Saved gamma for restore */
     XRRCrtcGamma **saved_gamma;
+    /* Per-CRTC upload buffers, allocated once at init */
+    XRRCrtcGamma **work_gamma;
 };
 
 meridian_error_t
@@ -124,11 +148,14 @@ meridian_x11_init(meridian_x11_state_t **state_out)
     state->crtcs = calloc(state->crtc_count, sizeof(RRCrtc));
     state->gamma_sizes = calloc(state->crtc_count, sizeof(int));
     state->saved_gamma = calloc(state->crtc_count, sizeof(XRRCrtcGamma *));
+    state->work_gamma = calloc(state->crtc_count, sizeof(XRRCrtcGamma *));
 
-    if (!state->crtcs || !state->gamma_sizes || !state->saved_gamma) {
+    if (!state->crtcs || !state->gamma_sizes || !state->saved_gamma ||
+        !state->work_gamma) {
         free(state->crtcs);
         free(state->gamma_sizes);
         free(state->saved_gamma);
+        free(state->work_gamma);
         x11.XRRFreeScreenResources(state->resources);
         x11.XCloseDisplay(state->display);
         free(state);
@@ -140,12 +167,24 @@ meridian_x11_init(meridian_x11_state_t **state_out)
         state->crtcs[i] = state->resources->crtcs[i];
         state->gamma_sizes[i] = x11.XRRGetCrtcGammaSize(state->display, state->crtcs[i]);
 
-        /* Save original gamma */
+        /* Save original gamma and allocate the upload buffer */
         if (state->gamma_sizes[i] > 0) {
             state->saved_gamma[i] = x11.XRRGetCrtcGamma(state->display, state->crtcs[i]);
+            state->work_gamma[i] = x11.XRRAllocGamma(state->gamma_sizes[i]);
         }
     }
 
+    /* Monitor (un)plug and mode changes, delivered on the connection */
+    int rr_error_base;
+    state->rr_event_base = -1;
+    if (x11.XRRQueryExtension(state->display, &state->rr_event_base, &rr_error_base)) {
+        x11.XRRSelectInput(state->display, state->root,
+                           RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask);
+        x11.XFlush(state->display);
+    } else {
+        state->rr_event_base = -1;
+    }
+
     *state_out = state;
     return MERIDIAN_OK;
 }
@@ -158,16 +197,20 @@ meridian_x11_free(meridian_x11_state_t *state)
     /* Restore original gamma (ignore errors during cleanup) */
     (void)meridian_x11_restore(state);
 
-    /* Free saved gamma */
+    /* Free saved and upload gamma */
     for (int i = 0; i < state->crtc_count; i++) {
         if (state->saved_gamma[i]) {
             x11.XRRFreeGamma(state->saved_gamma[i]);
         }
+        if (state->work_gamma[i]) {
+            x11.XRRFreeGamma(state->work_gamma[i]);
+        }
     }
 
     free(state->crtcs);
     free(state->gamma_sizes);
     free(state->saved_gamma);
+    free(state->work_gamma);
 
     if (state->resources) {
         x11.XRRFreeScreenResources(state->resources);
@@ -195,42 +238,52 @@ meridian_x11_get_gamma_size(const meridian_x11_state_t *state, int crtc_idx)
     return state->gamma_sizes[crtc_idx];
 }
 
-meridian_error_t
-meridian_x11_set_temperature_crtc(meridian_x11_state_t *state, int crtc_idx,
-                                int temp, float brightness)
+/* Fill CRTC crtc_idx's upload buffer and queue it; the caller flushes */
+static meridian_error_t
+x11_queue_crtc(meridian_x11_state_t *state, int crtc_idx, int temp, float brightness)
 {
-    if (!state || crtc_idx < 0 || crtc_idx >= state->crtc_count) {
-        return MERIDIAN_ERR_CRTC;
-    }
-
     int gamma_size = state->gamma_sizes[crtc_idx];
     if (gamma_size <= 0) {
         return MERIDIAN_ERR_CRTC;
     }
 
-    /* Allocate XRRCrtcGamma structure */
-    XRRCrtcGamma *gamma = x11.XRRAllocGamma(gamma_size);
+    XRRCrtcGamma *gamma = state->work_gamma[crtc_idx];
     if (!gamma) {
         return MERIDIAN_ERR_RESOURCES;
     }
 
-    /* Fill gamma ramps */
-    meridian_error_t err = meridian_fill_gamma_ramps(temp, gamma_size,
-                                                gamma->red, gamma->green, gamma->blue,
-                                                brightness);
+    /* Copy cached ramps into the preallocated XRRCrtcGamma */
+    meridian_ramp_t ramp;
+    meridian_error_t err = meridian_ramp_cache_get(temp, gamma_size, brightness, &ramp);
     if (err != MERIDIAN_OK) {
-        x11.XRRFreeGamma(gamma);
         return err;
     }
 
-    /* Set gamma */
-    x11.XRRSetCrtcGamma(state->display, state->crtcs[crtc_idx], gamma);
-    x11.XFlush(state->display);
+    size_t ramp_bytes = (size_t)gamma_size * sizeof(uint16_t);
+    memcpy(gamma->red, ramp.r, ramp_bytes);
+    memcpy(gamma->green, ramp.g, ramp_bytes);
+    memcpy(gamma->blue, ramp.b, ramp_bytes);
 
-    x11.XRRFreeGamma(gamma);
+    /* No reply: this only appends to Xlib's output buffer */
+    x11.XRRSetCrtcGamma(state->display, state->crtcs[crtc_idx], gamma);
     return MERIDIAN_OK;
 }
 
+meridian_error_t
+meridian_x11_set_temperature_crtc(meridian_x11_state_t *state, int crtc_idx,
+                                int temp, float brightness)
+{
+    if (!state || crtc_idx < 0 || crtc_idx >= state->crtc_count) {
+        return MERIDIAN_ERR_CRTC;
+    }
+
+    meridian_error_t err = x11_queue_crtc(state, crtc_idx, temp, brightness);
+    if (err == MERIDIAN_OK) {
+        x11.XFlush(state->display);
+    }
+    return err;
+}
+
 meridian_error_t
 meridian_x11_set_temperature(meridian_x11_state_t *state, int temp, float brightness)
 {
@@ -241,7 +294,7 @@ meridian_x11_set_temperature(meridian_x11_state_t *state, int temp, float bright
 
     for (int i = 0; i < state->crtc_count; i++) {
         if (state->gamma_sizes[i] > 0) {
-            meridian_error_t err = meridian_x11_set_temperature_crtc(state, i, temp, brightness);
+            meridian_error_t err = x11_queue_crtc(state, i, temp, brightness);
             if (err == MERIDIAN_OK) {
                 success_count++;
             } else {
@@ -250,6 +303,11 @@ meridian_x11_set_temperature(meridian_x11_state_t *state, int temp, float bright
         }
     }
 
+    /* One write for every CRTC */
+    if (success_count > 0) {
+        x11.XFlush(state->display);
+    }
+
     return (success_count > 0) ? MERIDIAN_OK : last_err;
 }
 
@@ -268,4 +326,139 @@ meridian_x11_restore(meridian_x11_state_t *state)
     return MERIDIAN_OK;
 }
 
+/* Re-read one CRTC's gamma size after a RandR CRTC change */
+static void
+x11_refresh_crtc(meridian_x11_state_t *state, int i)
+{
+    int size = x11.XRRGetCrtcGammaSize(state->display, state->crtcs[i]);
+    if (size == state->gamma_sizes[i]) return;
+
+    /* A resized ramp was reset by the server: that is the new original */
+    if (state->work_gamma[i]) x11.XRRFreeGamma(state->work_gamma[i]);
+    if (state->saved_gamma[i]) x11.XRRFreeGamma(state->saved_gamma[i]);
+    state->work_gamma[i] = size > 0 ? x11.XRRAllocGamma(size) : nullptr;
+    state->saved_gamma[i] = size > 0
+        ? x11.XRRGetCrtcGamma(state->display, state->crtcs[i]) : nullptr;
+    state->gamma_sizes[i] = size;
+}
+
+/*
+ * The screen changed: take the server's current CRTC list. CRTCs that
+ * survive at the same gamma size keep their saved and upload ramps; new
+ * or resized ones are saved now; gone ones are dropped, there is nothing
+ * left to restore them to.
+ */
+static meridian_error_t
+x11_refresh_resources(meridian_x11_state_t *state)
+{
+    XRRScreenResources *res = x11.XRRGetScreenResourcesCurrent(state->display, state->root);
+    if (!res) return MERIDIAN_ERR_RESOURCES;
+
+    int count = res->ncrtc;
+    size_t slots = count > 0 ? (size_t)count : 1;
+    RRCrtc *crtcs = calloc(slots, sizeof(RRCrtc));
+    int *gamma_sizes = calloc(slots, sizeof(int));
+    XRRCrtcGamma **saved_gamma = calloc(slots, sizeof(XRRCrtcGamma *));
+    XRRCrtcGamma **work_gamma = calloc(slots, sizeof(XRRCrtcGamma *));
+
+    if (!crtcs || !gamma_sizes || !saved_gamma || !work_gamma) {
+        free(crtcs);
+        free(gamma_sizes);
+        free(saved_gamma);
+        free(work_gamma);
+        x11.XRRFreeScreenResources(res);
+        return MERIDIAN_ERR_RESOURCES;
+    }
+
+    for (int i = 0; i < count; i++) {
+        crtcs[i] = res->crtcs[i];
+
+        int old = -1;
+        for (int j = 0; j < state->crtc_count && old < 0; j++)
+            if (state->crtcs[j] == crtcs[i]) old = j;
+
+        gamma_sizes[i] = x11.XRRGetCrtcGammaSize(state->display, crtcs[i]);
+        if (old >= 0 && state->gamma_sizes[old] == gamma_sizes[i]) {
+            saved_gamma[i] = state->saved_gamma[old];
+            work_gamma[i] = state->work_gamma[old];
+            state->saved_gamma[old] = nullptr;
+            state->work_gamma[old] = nullptr;
+        } else if (gamma_sizes[i] > 0) {
+            /* New, or resized and so reset by the server */
+            saved_gamma[i] = x11.XRRGetCrtcGamma(state->display, crtcs[i]);
+            work_gamma[i] = x11.XRRAllocGamma(gamma_sizes[i]);
+        }
+    }
+
+    for (int j = 0; j < state->crtc_count; j++) {
+        if (state->saved_gamma[j]) x11.XRRFreeGamma(state->saved_gamma[j]);
+        if (state->work_gamma[j]) x11.XRRFreeGamma(state->work_gamma[j]);
+    }
+    free(state->crtcs);
+    free(state->gamma_sizes);
+    free(state->saved_gamma);
+    free(state->work_gamma);
+    x11.XRRFreeScreenResources(state->resources);
+
+    state->resources = res;
+    state->crtc_count = count;
+    state->crtcs = crtcs;
+    state->gamma_sizes = gamma_sizes;
+    state->saved_gamma = saved_gamma;
+    state->work_gamma = work_gamma;
+    return MERIDIAN_OK;
+}
+
+int
+meridian_x11_get_fd(const meridian_x11_state_t *state)
+{
+    if (!state || state->rr_event_base < 0) return -1;
+    return ConnectionNumber(state->display);
+}
+
+meridian_error_t
+meridian_x11_dispatch(meridian_x11_state_t *state, bool *outputs_changed)
+{
+    if (!state) return MERIDIAN_ERR_RESOURCES;
+
+    bool screen_changed = state->resources_stale;
+    bool changed = false;
+    while (x11.XPending(state->display) > 0) {
+        XEvent ev;
+        x11.XNextEvent(state->display, &ev);
+
+        if (ev.type == state->rr_event_base + RRScreenChangeNotify) {
+            x11.XRRUpdateConfiguration(&ev);
+            screen_changed = true;
+        } else if (ev.type == state->rr_event_base + RRNotify) {
+            /* XEvent has no RandR member; copy rather than pun */
+            XRRCrtcChangeNotifyEvent rr;
+            static_assert(sizeof(rr) <= sizeof(ev), "RandR event fits XEvent");
+            memcpy(&rr, &ev, sizeof(rr));
+            if (rr.subtype != RRNotify_CrtcChange) continue;
+
+            /* Handled below if a screen change already re-reads everything */
+            if (screen_changed) continue;
+            for (int i = 0; i < state->crtc_count; i++) {
+                if (state->crtcs[i] == rr.crtc) {
+                    x11_refresh_crtc(state, i);
+                    break;
+                }
+            }
+            /* Mode set or newly lit: reapply even if the size held */
+            changed = true;
+        }
+    }
+
+    /* A failed read leaves the old CRTC list in place, which still holds
+       across most screen changes; the next event tries again */
+    if (screen_changed) {
+        state->resources_stale = x11_refresh_resources(state) != MERIDIAN_OK;
+        changed = true;
+    }
+
+    if (changed) *outputs_changed = true;
+    return MERIDIAN_OK;
+}
+
 #endif /* MERIDIAN_HAS_X11 */
@@ -0,0 +1,76 @@
+/*
+ * alloccount.c - malloc interposer counting heap allocations
+ *
+ * Built in only with ABXS_ALLOC_CHECK (make ALLOC_CHECK=1); the daemon
+ * that ships never replaces the allocator.
+ *
+ * glibc exports its allocator a second time as __libc_malloc and
+ * friends; defining malloc here takes precedence for the whole process,
+ * libc's own internal callers included, and the wrappers forward after
+ * one relaxed increment. free is forwarded too, as glibc requires of a
+ * replacement. memalign-family calls are left to glibc: they hand out
+ * blocks from the same heap, so forwarding free stays correct.
+ */
+
+#define _GNU_SOURCE
+
+#include "alloccount.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#if defined(ABXS_ALLOC_CHECK) && defined(__GLIBC__) && !defined(ABXS_STATIC)
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void  __libc_free(void *ptr);
+
+static atomic_ulong allocs;
+
+void *malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+unsigned long alloc_count(void)
+{
+    return atomic_load_explicit(&allocs, memory_order_relaxed);
+}
+
+bool alloc_count_available(void)
+{
+    return true;
+}
+
+#else
+
+unsigned long alloc_count(void)
+{
+    return 0;
+}
+
+bool alloc_count_available(void)
+{
+    return false;
+}
+
+#endif
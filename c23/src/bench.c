@@ -0,0 +1,771 @@
+/*
+ * bench.c - Benchmark harness behind --benchmark
+ *
+ * Cases are plain functions over one shared context; the runner owns
+ * warmup, batch calibration, sampling, statistics and the perf counters.
+ * Results are collected first so the JSON document is written in one
+ * piece after the last case.
+ */
+
+#define _GNU_SOURCE
+
+#include "bench.h"
+#include "config.h"
+#include "ephemeris.h"
+#include "json.h"
+#include "sigmoid.h"
+#include "solar.h"
+#include "uring.h"
+#include "weather.h"
+#include "zipdb.h"
+
+#include <linux/perf_event.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <meridian.h>
+
+/* Per-case time budget */
+constexpr uint64_t BENCH_WARMUP_NS = 10000000;    /* 10 ms, also calibrates the batch */
+constexpr uint64_t BENCH_BUDGET_NS = 100000000;   /* 100 ms of samples */
+constexpr uint64_t BENCH_SAMPLE_NS = 20000;       /* target length of one sample */
+
+constexpr int BENCH_SAMPLES_MIN = 30;
+#define BENCH_SAMPLES_MAX 1000
+#define BENCH_CASES_MAX   48
+
+/* Batch solar cases: one ephemeris day of minutes, a fleet of sites */
+#define BENCH_DAY_ROWS    (24 * 60 + 1)
+#define BENCH_SITES       256
+
+typedef void (*bench_fn_t)(void *ctx, uint64_t i);
+
+typedef struct {
+    const char *name;
+    const char *group;
+    bench_fn_t  fn;
+    void       *ctx;
+    int         max_samples;    /* 0 = BENCH_SAMPLES_MAX */
+    bool        single;         /* one call per sample (slow or visible side effects) */
+} bench_case_t;
+
+typedef struct {
+    char        name[48];
+    const char *group;
+    const char *skip;           /* set: case not run, the reason */
+    uint64_t    warmup;         /* calls */
+    int         samples;
+    uint64_t    batch;          /* calls per sample */
+    double      p50, p99, max;  /* ns per call */
+    double      mean;           /* ns per call, outliers excluded */
+    int         outliers;
+    double      cycles;         /* per call, < 0 = no counters */
+    double      instructions;
+} bench_result_t;
+
+typedef struct {
+    bench_result_t results[BENCH_CASES_MAX];
+    int            count;
+    bool           json;
+    int            perf_leader; /* cycles; -1 = no counters */
+    int            perf_member; /* instructions */
+    const char    *perf_scope;
+} bench_t;
+
+/* --- Clock and counters --- */
+
+static inline uint64_t bench_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int perf_open(uint64_t config, int group_fd, bool user_only)
+{
+    struct perf_event_attr attr = {
+        .type           = PERF_TYPE_HARDWARE,
+        .size           = sizeof(attr),
+        .config         = config,
+        .read_format    = PERF_FORMAT_GROUP,
+        .disabled       = group_fd < 0,
+        .exclude_kernel = user_only,
+        .exclude_hv     = 1,
+    };
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, PERF_FLAG_FD_CLOEXEC);
+}
+
+/* Cycles + instructions as one group; kernel time too if paranoia allows */
+static void perf_init(bench_t *b)
+{
+    b->perf_leader = b->perf_member = -1;
+    b->perf_scope = nullptr;
+
+    for (int pass = 0; pass < 2; pass++) {
+        bool user_only = pass == 1;
+        int leader = perf_open(PERF_COUNT_HW_CPU_CYCLES, -1, user_only);
+        if (leader < 0) continue;
+        int member = perf_open(PERF_COUNT_HW_INSTRUCTIONS, leader, user_only);
+        if (member < 0) {
+            close(leader);
+            continue;
+        }
+        b->perf_leader = leader;
+        b->perf_member = member;
+        b->perf_scope = user_only ? "user" : "user+kernel";
+        return;
+    }
+}
+
+static void perf_close(bench_t *b)
+{
+    if (b->perf_member >= 0) close(b->perf_member);
+    if (b->perf_leader >= 0) close(b->perf_leader);
+    b->perf_leader = b->perf_member = -1;
+}
+
+static void perf_start(const bench_t *b)
+{
+    if (b->perf_leader < 0) return;
+    ioctl(b->perf_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(b->perf_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+static bool perf_stop(const bench_t *b, uint64_t *cycles, uint64_t *instructions)
+{
+    if (b->perf_leader < 0) return false;
+    ioctl(b->perf_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    struct { uint64_t nr; uint64_t values[2]; } group;
+    if (read(b->perf_leader, &group, sizeof(group)) != (ssize_t)sizeof(group) || group.nr != 2)
+        return false;
+    *cycles = group.values[0];
+    *instructions = group.values[1];
+    return true;
+}
+
+/* --- Statistics --- */
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted[0..n) */
+static double percentile(const double *sorted, int n, double q)
+{
+    int k = (int)ceil(q * n) - 1;
+    if (k < 0) k = 0;
+    if (k >= n) k = n - 1;
+    return sorted[k];
+}
+
+/* --- Output --- */
+
+static void fmt_ns(char *out, size_t cap, double ns)
+{
+    if (ns < 1000.0)
+        snprintf(out, cap, "%.0f ns", ns);
+    else if (ns < 1000000.0)
+        snprintf(out, cap, "%.2f us", ns / 1000.0);
+    else
+        snprintf(out, cap, "%.2f ms", ns / 1000000.0);
+}
+
+static void bench_print(const bench_t *b, const bench_result_t *r)
+{
+    if (b->json) return;
+
+    if (r == b->results || strcmp(r[-1].group, r->group) != 0)
+        printf("\n%s:\n", r->group);
+
+    if (r->skip) {
+        printf("  %-32s %s\n", r->name, r->skip);
+        return;
+    }
+
+    char p50[16], p99[16], max[16];
+    fmt_ns(p50, sizeof(p50), r->p50);
+    fmt_ns(p99, sizeof(p99), r->p99);
+    fmt_ns(max, sizeof(max), r->max);
+    printf("  %-32s %10s %10s %10s", r->name, p50, p99, max);
+    if (r->cycles >= 0)
+        printf(" %9.0f %9.0f", r->cycles, r->instructions);
+    else
+        printf(" %9s %9s", "-", "-");
+    printf("  %d x %lu", r->samples, (unsigned long)r->batch);
+    if (r->outliers) printf(", %d outliers", r->outliers);
+    printf("\n");
+}
+
+static void json_number_or_null(double v)
+{
+    if (v >= 0) printf("%.1f", v);
+    else printf("null");
+}
+
+static void bench_print_json(const bench_t *b, const char *fixtures)
+{
+    printf("{\n");
+    printf("  \"implementation\": \"c23\",\n");
+    printf("  \"version\": \"8.4.0\",\n");
+    printf("  \"clock\": \"CLOCK_MONOTONIC_RAW\",\n");
+    printf("  \"ramp_kernel\": \"%s\",\n", meridian_ramp_kernel_name());
+    if (b->perf_scope) printf("  \"perf\": \"%s\",\n", b->perf_scope);
+    else printf("  \"perf\": null,\n");
+    if (fixtures) printf("  \"fixtures\": \"%s\",\n", fixtures);
+    else printf("  \"fixtures\": null,\n");
+
+    printf("  \"cases\": [");
+    bool first = true;
+    for (int i = 0; i < b->count; i++) {
+        const bench_result_t *r = &b->results[i];
+        if (r->skip) continue;
+        printf("%s\n    {\"name\": \"%s\", \"group\": \"%s\", \"warmup\": %lu, "
+               "\"samples\": %d, \"batch\": %lu, \"p50_ns\": %.1f, \"p99_ns\": %.1f, "
+               "\"max_ns\": %.1f, \"mean_ns\": %.1f, \"outliers\": %d, \"cycles\": ",
+               first ? "" : ",", r->name, r->group, (unsigned long)r->warmup,
+               r->samples, (unsigned long)r->batch, r->p50, r->p99, r->max, r->mean,
+               r->outliers);
+        json_number_or_null(r->cycles);
+        printf(", \"instructions\": ");
+        json_number_or_null(r->instructions);
+        printf("}");
+        first = false;
+    }
+    printf("\n  ],\n");
+
+    printf("  \"skipped\": [");
+    first = true;
+    for (int i = 0; i < b->count; i++) {
+        const bench_result_t *r = &b->results[i];
+        if (!r->skip) continue;
+        printf("%s\n    {\"name\": \"%s\", \"group\": \"%s\", \"reason\": \"%s\"}",
+               first ? "" : ",", r->name, r->group, r->skip);
+        first = false;
+    }
+    printf("\n  ]\n}\n");
+}
+
+/* --- Runner --- */
+
+static bench_result_t *bench_slot(bench_t *b, const char *name, const char *group)
+{
+    if (b->count >= BENCH_CASES_MAX) return nullptr;
+    bench_result_t *r = &b->results[b->count++];
+    *r = (bench_result_t){ .group = group, .cycles = -1.0, .instructions = -1.0 };
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    return r;
+}
+
+static void bench_skip(bench_t *b, const char *name, const char *group, const char *reason)
+{
+    bench_result_t *r = bench_slot(b, name, group);
+    if (!r) return;
+    r->skip = reason;
+    bench_print(b, r);
+}
+
+static void bench_case(bench_t *b, const bench_case_t *c)
+{
+    bench_result_t *r = bench_slot(b, c->name, c->group);
+    if (!r) return;
+
+    /* Warmup: keep doubling the batch until one takes BENCH_SAMPLE_NS */
+    uint64_t i = 0, calls = 0, batch = 1, last = 0;
+    uint64_t warm_start = bench_ns();
+    do {
+        uint64_t t0 = bench_ns();
+        for (uint64_t k = 0; k < batch; k++) c->fn(c->ctx, i++);
+        last = bench_ns() - t0;
+        calls += batch;
+        if (!c->single && last < BENCH_SAMPLE_NS) batch *= 2;
+    } while (bench_ns() - warm_start < BENCH_WARMUP_NS);
+
+    double per_call = (double)last / (double)(c->single ? 1 : batch);
+    if (c->single || per_call <= 0.0) batch = 1;
+    else batch = per_call >= (double)BENCH_SAMPLE_NS ? 1 : (uint64_t)((double)BENCH_SAMPLE_NS / per_call);
+
+    int max_samples = c->max_samples ? c->max_samples : BENCH_SAMPLES_MAX;
+    double sample_ns = per_call * (double)batch;
+    int samples = sample_ns > 0.0 && (double)BENCH_BUDGET_NS / sample_ns < max_samples
+                ? (int)((double)BENCH_BUDGET_NS / sample_ns) : max_samples;
+    if (samples < BENCH_SAMPLES_MIN) samples = BENCH_SAMPLES_MIN;
+
+    static double v[BENCH_SAMPLES_MAX];
+    perf_start(b);
+    for (int s = 0; s < samples; s++) {
+        uint64_t t0 = bench_ns();
+        for (uint64_t k = 0; k < batch; k++) c->fn(c->ctx, i++);
+        v[s] = (double)(bench_ns() - t0) / (double)batch;
+    }
+    uint64_t cycles, instructions;
+    if (perf_stop(b, &cycles, &instructions)) {
+        double total = (double)samples * (double)batch;
+        r->cycles = (double)cycles / total;
+        r->instructions = (double)instructions / total;
+    }
+
+    qsort(v, (size_t)samples, sizeof(v[0]), cmp_double);
+    r->p50 = percentile(v, samples, 0.50);
+    r->p99 = percentile(v, samples, 0.99);
+    r->max = v[samples - 1];
+
+    /* Tukey's far fence: one preempted batch should not move the mean */
+    double q1 = percentile(v, samples, 0.25);
+    double q3 = percentile(v, samples, 0.75);
+    double fence = q3 + 3.0 * (q3 - q1);
+    double sum = 0.0;
+    int kept = 0;
+    for (int s = 0; s < samples && v[s] <= fence; s++, kept++) sum += v[s];
+    r->mean = kept ? sum / kept : r->p50;
+    r->outliers = samples - kept;
+
+    r->warmup = calls;
+    r->samples = samples;
+    r->batch = batch;
+    bench_print(b, r);
+}
+
+/* Batched case with the default sample budget */
+static void bench_add(bench_t *b, const char *name, const char *group,
+                      bench_fn_t fn, void *ctx)
+{
+    bench_case(b, &(bench_case_t){ .name = name, .group = group, .fn = fn, .ctx = ctx });
+}
+
+/* --- Cases --- */
+
+typedef struct {
+    abraxas_paths_t   fixture;      /* config/cache/override paths inside the corpus */
+    double            lat, lon;
+    time_t            now;
+    double            from_sunrise, to_sunset;
+    ephemeris_t       ephem;
+    time_t            minute[BENCH_DAY_ROWS];
+    double            elevation[BENCH_DAY_ROWS];
+    double            site_lat[BENCH_SITES], site_lon[BENCH_SITES];
+    time_t            sunrise[BENCH_SITES], sunset[BENCH_SITES];
+    bool              sun_valid[BENCH_SITES];
+    weather_data_t    weather;
+    char             *points;       /* NOAA response bodies */
+    char             *hourly;
+    zipdb_t           zdb;
+    const char       *zipdb_file;
+    meridian_state_t *gamma;
+    uint16_t          ramps[4][3][4096];
+    meridian_ramp_job_t jobs[4];
+} bench_ctx_t;
+
+/* A second of the ephemeris day, strided so lookups do not repeat */
+static time_t day_time(const bench_ctx_t *c, uint64_t i)
+{
+    uint64_t span = (uint64_t)c->ephem.minutes * 60;
+    return c->ephem.day_start + (time_t)(i * 37 % span);
+}
+
+static void case_init_paths(void *ctx, uint64_t i)
+{
+    (void)ctx; (void)i;
+    abraxas_paths_t p;
+    (void)config_init_paths(&p);
+}
+
+static void case_load_location(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    (void)config_load_location(&c->fixture);
+}
+
+static void case_sunrise_sunset(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    volatile sun_times_t st = solar_sunrise_sunset(c->now, c->lat, c->lon);
+    (void)st;
+}
+
+static void case_position(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    volatile sun_position_t sp = solar_position(c->now, c->lat, c->lon);
+    (void)sp;
+}
+
+static void case_position_batch(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    solar_position_batch(c->minute, BENCH_DAY_ROWS, c->lat, c->lon, c->elevation);
+}
+
+static void case_sunrise_sunset_batch(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    solar_sunrise_sunset_batch(c->now, c->site_lat, c->site_lon, BENCH_SITES,
+                               c->sunrise, c->sunset, c->sun_valid);
+}
+
+static void case_solar_temp(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    volatile int t = calculate_solar_temp(c->from_sunrise, c->to_sunset, false);
+    (void)t;
+}
+
+static void case_sigmoid(void *ctx, uint64_t i)
+{
+    (void)ctx; (void)i;
+    volatile double s = sigmoid_norm(0.5, SIGMOID_STEEPNESS);
+    (void)s;
+}
+
+static void case_ephem_build(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    ephemeris_build(&c->ephem, c->now, c->lat, c->lon);
+}
+
+static void case_ephem_temp(void *ctx, uint64_t i)
+{
+    bench_ctx_t *c = ctx;
+    volatile int t = ephemeris_temp(&c->ephem, day_time(c, i), false);
+    (void)t;
+}
+
+static void case_ephem_next(void *ctx, uint64_t i)
+{
+    bench_ctx_t *c = ctx;
+    volatile time_t t = ephemeris_next_change(&c->ephem, day_time(c, i), false);
+    (void)t;
+}
+
+static void case_load_override(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    (void)config_load_override(&c->fixture);
+}
+
+static void case_load_weather(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    (void)config_load_weather_cache(&c->fixture);
+}
+
+#ifndef NOAA_DISABLED
+static void case_parse_points(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    char url[512];
+    (void)weather_parse_points(c->points, url, sizeof(url));
+}
+
+static void case_parse_hourly(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    weather_data_t wd = {0};
+    (void)weather_parse_hourly(c->hourly, &wd);
+}
+#endif
+
+static void case_hourly_dom(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    json_arena_t arena;
+    json_arena_init(&arena, nullptr, 0);
+    json_value_t *root = json_parse_arena(c->hourly, &arena);
+    volatile const json_value_t *v = json_path(root, "properties.periods.0.shortForecast");
+    (void)v;
+    json_arena_free(&arena);
+}
+
+static void case_zip_lookup(void *ctx, uint64_t i)
+{
+    bench_ctx_t *c = ctx;
+    char zip[8];
+    float lat, lon;
+    snprintf(zip, sizeof(zip), "%05d", 60000 + (int)(i % 1000));
+    (void)zipdb_lookup(c->zipdb_file, zip, &lat, &lon);
+}
+
+static void case_zip_find(void *ctx, uint64_t i)
+{
+    bench_ctx_t *c = ctx;
+    char zip[8];
+    float lat, lon;
+    snprintf(zip, sizeof(zip), "%05d", 60000 + (int)(i % 1000));
+    (void)zipdb_find(&c->zdb, zip, &lat, &lon);
+}
+
+static void fill(bench_ctx_t *c, uint64_t i, int size)
+{
+    (void)meridian_fill_gamma_ramps(2900 + (int)(i & 63), size, c->ramps[0][0],
+                                    c->ramps[0][1], c->ramps[0][2], 1.0f);
+}
+
+static void case_fill_256(void *ctx, uint64_t i)  { fill(ctx, i, 256); }
+static void case_fill_1024(void *ctx, uint64_t i) { fill(ctx, i, 1024); }
+static void case_fill_4096(void *ctx, uint64_t i) { fill(ctx, i, 4096); }
+
+static void case_fill_batch(void *ctx, uint64_t i)
+{
+    (void)i;
+    bench_ctx_t *c = ctx;
+    (void)meridian_fill_gamma_ramps_batch(c->jobs, 4);
+}
+
+static void case_set_temperature(void *ctx, uint64_t i)
+{
+    bench_ctx_t *c = ctx;
+    (void)meridian_set_temperature(c->gamma, 6500 - (int)(i & 255), 1.0f);
+}
+
+/*
+ * The daemon's per-wakeup work minus the io_uring_enter and the backend
+ * call: ephemeris check, cloud timeline lookup, temperature, next
+ * deadline, and the ramp the backend would be handed.
+ */
+static void case_tick(void *ctx, uint64_t i)
+{
+    bench_ctx_t *c = ctx;
+    time_t now = day_time(c, i);
+
+    (void)ephemeris_refresh(&c->ephem, now, c->lat, c->lon);
+    bool dark = weather_cloud_at(&c->weather, now) >= CLOUD_THRESHOLD;
+    int temp = ephemeris_temp(&c->ephem, now, dark);
+    volatile time_t next = ephemeris_next_change(&c->ephem, now, dark);
+    volatile time_t flip = weather_next_dark_change(&c->weather, now);
+    (void)next; (void)flip;
+    (void)meridian_fill_gamma_ramps(temp, 4096, c->ramps[1][0], c->ramps[1][1],
+                                    c->ramps[1][2], 1.0f);
+}
+
+static void case_uring_setup(void *ctx, uint64_t i)
+{
+    (void)ctx; (void)i;
+    abraxas_ring_t ring;
+    if (uring_init(&ring, 8)) uring_destroy(&ring);
+}
+
+/* --- Fixtures --- */
+
+static char *read_fixture(const char *dir, const char *name)
+{
+    char path[ABRAXAS_PATH_MAX];
+    int n = snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if (n < 0 || (size_t)n >= sizeof(path)) return nullptr;
+
+    FILE *f = fopen(path, "r");
+    if (!f) return nullptr;
+    fseek(f, 0, SEEK_END);
+    long sz = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    char *buf = sz > 0 ? malloc((size_t)sz + 1) : nullptr;
+    if (buf) buf[fread(buf, 1, (size_t)sz, f)] = '\0';
+    fclose(f);
+    return buf;
+}
+
+static const char *find_fixtures(const char *given)
+{
+    static const char *const search[] = { "bench/fixtures", "../bench/fixtures" };
+
+    if (given) return given;
+    for (size_t i = 0; i < sizeof(search) / sizeof(search[0]); i++) {
+        char probe[ABRAXAS_PATH_MAX];
+        snprintf(probe, sizeof(probe), "%s/noaa_hourly.json", search[i]);
+        if (access(probe, R_OK) == 0) return search[i];
+    }
+    return nullptr;
+}
+
+static void fixture_paths(abraxas_paths_t *p, const char *dir)
+{
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+    snprintf(p->config_dir,    sizeof(p->config_dir),    "%s",                   dir);
+    snprintf(p->config_file,   sizeof(p->config_file),   "%s/config.ini",        dir);
+    snprintf(p->cache_file,    sizeof(p->cache_file),    "%s/weather_cache.json", dir);
+    snprintf(p->override_file, sizeof(p->override_file), "%s/override.json",      dir);
+#pragma GCC diagnostic pop
+}
+
+/* --- Entry --- */
+
+int bench_run(const abraxas_paths_t *paths, const bench_options_t *opt)
+{
+    static bench_t b;
+    static bench_ctx_t ctx;
+    bench_ctx_t *c = &ctx;
+
+    b.json = opt->json;
+    perf_init(&b);
+
+    const char *fixtures = find_fixtures(opt->fixtures);
+    char *config = fixtures ? read_fixture(fixtures, "config.ini") : nullptr;
+    c->points = fixtures ? read_fixture(fixtures, "noaa_points.json") : nullptr;
+    c->hourly = fixtures ? read_fixture(fixtures, "noaa_hourly.json") : nullptr;
+    if (fixtures && (!config || !c->points || !c->hourly)) {
+        fprintf(stderr, "Fixture corpus incomplete in %s\n", fixtures);
+        free(config);
+        free(c->points);
+        free(c->hourly);
+        perf_close(&b);
+        return 1;
+    }
+    free(config);
+
+    /* Fixed location and instant from the corpus, so runs compare */
+    location_t loc = { .lat = 34.26, .lon = -88.38, .valid = true };
+    c->now = time(nullptr);
+    if (fixtures) {
+        fixture_paths(&c->fixture, fixtures);
+        loc = config_load_location(&c->fixture);
+        c->weather = config_load_weather_cache(&c->fixture);
+        if (c->weather.timeline_hours > 0)
+            c->now = c->weather.timeline_start + 5 * 3600;
+    }
+    c->lat = loc.lat;
+    c->lon = loc.lon;
+
+    sun_times_t st = solar_sunrise_sunset(c->now, c->lat, c->lon);
+    c->from_sunrise = st.valid ? difftime(c->now, st.sunrise) / 60.0 : 0.0;
+    c->to_sunset    = st.valid ? difftime(st.sunset, c->now)  / 60.0 : 0.0;
+    ephemeris_build(&c->ephem, c->now, c->lat, c->lon);
+    for (int i = 0; i < BENCH_DAY_ROWS; i++)
+        c->minute[i] = c->ephem.day_start + (time_t)i * 60;
+    /* Sites on a 16 x 16 grid spanning 10 x 20 degrees around the corpus location */
+    for (int i = 0; i < BENCH_SITES; i++) {
+        c->site_lat[i] = c->lat - 5.0 + 10.0 * (i % 16) / 16.0;
+        c->site_lon[i] = c->lon - 10.0 + 20.0 * (i / 16) / 16.0;
+    }
+
+    if (!b.json) {
+        printf("ABRAXAS v8.4.0 [C23] -- Kernel-grade benchmark\n");
+        printf("Clock: CLOCK_MONOTONIC_RAW (hardware TSC)\n");
+        printf("Counters: %s%s%s\n", b.perf_scope ? "cycles, instructions (" : "unavailable",
+               b.perf_scope ? b.perf_scope : "", b.perf_scope ? ")" : "");
+        printf("Ramp kernel: %s\n", meridian_ramp_kernel_name());
+        printf("Fixtures: %s\n", fixtures ? fixtures : "not found (--fixtures DIR)");
+        printf("\n  %-32s %10s %10s %10s %9s %9s  samples x batch\n",
+               "per call", "p50", "p99", "max", "cycles", "instr");
+    }
+
+    const char *no_fixtures = "skipped (no fixture corpus)";
+
+    /* Core math and config */
+    bench_add(&b, "config_init_paths()", "core", case_init_paths, c);
+    if (fixtures)
+        bench_add(&b, "config_load_location()", "core", case_load_location, c);
+    else
+        bench_skip(&b, "config_load_location()", "core", no_fixtures);
+    bench_add(&b, "solar_sunrise_sunset()", "core", case_sunrise_sunset, c);
+    bench_add(&b, "solar_position()", "core", case_position, c);
+    bench_add(&b, "solar_position_batch(1441)", "core", case_position_batch, c);
+    bench_add(&b, "solar_sunrise_sunset_batch(256)", "core", case_sunrise_sunset_batch, c);
+    bench_add(&b, "calculate_solar_temp()", "core", case_solar_temp, c);
+    bench_add(&b, "sigmoid_norm()", "core", case_sigmoid, c);
+    bench_add(&b, "ephemeris_build()", "core", case_ephem_build, c);
+    bench_add(&b, "ephemeris_temp()", "core", case_ephem_temp, c);
+    bench_add(&b, "ephemeris_next_change()", "core", case_ephem_next, c);
+
+    /* JSON: small config files and a full NOAA payload */
+    if (fixtures) {
+        bench_add(&b, "config_load_override()", "json", case_load_override, c);
+        bench_add(&b, "config_load_weather_cache()", "json", case_load_weather, c);
+#ifndef NOAA_DISABLED
+        bench_add(&b, "noaa_points_parse()", "json", case_parse_points, c);
+        bench_add(&b, "noaa_hourly_parse()", "json", case_parse_hourly, c);
+#else
+        bench_skip(&b, "noaa_points_parse()", "json", "skipped (NOAA disabled)");
+        bench_skip(&b, "noaa_hourly_parse()", "json", "skipped (NOAA disabled)");
+#endif
+        bench_add(&b, "json_parse_arena(hourly)", "json", case_hourly_dom, c);
+    } else {
+        bench_skip(&b, "config_load_override()", "json", no_fixtures);
+        bench_skip(&b, "config_load_weather_cache()", "json", no_fixtures);
+        bench_skip(&b, "noaa_points_parse()", "json", no_fixtures);
+        bench_skip(&b, "noaa_hourly_parse()", "json", no_fixtures);
+        bench_skip(&b, "json_parse_arena(hourly)", "json", no_fixtures);
+    }
+
+    /* ZIP lookup: one-shot vs. kept mapping */
+    c->zipdb_file = paths->zipdb_file;
+    if (zipdb_open(&c->zdb, c->zipdb_file)) {
+        bench_add(&b, "zipdb_lookup()", "zipdb", case_zip_lookup, c);
+        bench_add(&b, "zipdb_find()", "zipdb", case_zip_find, c);
+        zipdb_close(&c->zdb);
+    } else {
+        bench_skip(&b, "zipdb_lookup()", "zipdb", "skipped (no ZIP database installed)");
+        bench_skip(&b, "zipdb_find()", "zipdb", "skipped (no ZIP database installed)");
+    }
+
+    /* Gamma ramp fill (libmeridian) */
+    bench_add(&b, "fill_gamma_ramps(256)", "gamma", case_fill_256, c);
+    bench_add(&b, "fill_gamma_ramps(1024)", "gamma", case_fill_1024, c);
+    bench_add(&b, "fill_gamma_ramps(4096)", "gamma", case_fill_4096, c);
+    for (int j = 0; j < 4; j++) {
+        c->jobs[j] = (meridian_ramp_job_t){
+            .temp = j < 2 ? 4500 : 6500, .gamma_size = 4096, .brightness = 1.0f,
+            .r = c->ramps[j][0], .g = c->ramps[j][1], .b = c->ramps[j][2],
+        };
+    }
+    bench_add(&b, "fill_gamma_ramps_batch(4x4096)", "gamma", case_fill_batch, c);
+
+    /* Backend set: real ioctl / protocol round trip, restored afterwards */
+    if (meridian_init(&c->gamma) == MERIDIAN_OK) {
+        bench_case(&b, &(bench_case_t){
+            .name = "meridian_set_temperature()", .group = "backend",
+            .fn = case_set_temperature, .ctx = c, .max_samples = 100, .single = true });
+        (void)meridian_restore(c->gamma);
+        meridian_free(c->gamma);
+        c->gamma = nullptr;
+    } else {
+        bench_skip(&b, "meridian_set_temperature()", "backend", "skipped (no gamma backend)");
+    }
+
+    /* Full tick */
+    bench_add(&b, "daemon_tick()", "tick", case_tick, c);
+
+    /* Kernel facilities */
+    abraxas_ring_t ring;
+    if (uring_init(&ring, 8)) {
+        uring_destroy(&ring);
+        bench_case(&b, &(bench_case_t){
+            .name = "io_uring_setup()", .group = "kernel",
+            .fn = case_uring_setup, .ctx = c, .max_samples = 200 });
+    } else {
+        bench_skip(&b, "io_uring_setup()", "kernel", "unavailable");
+    }
+    /* Installing these would restrict the benchmark process itself */
+    bench_skip(&b, "seccomp_install()", "kernel", "not measured -- would restrict process");
+    bench_skip(&b, "landlock_install()", "kernel", "not measured -- would restrict process");
+
+    if (b.json)
+        bench_print_json(&b, fixtures);
+    else
+        printf("\nDone.\n");
+
+    perf_close(&b);
+    free(c->points);
+    free(c->hourly);
+    return 0;
+}
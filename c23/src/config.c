@@ -10,6 +10,7 @@
 #include "config.h"
 #include "json.h"
 
+#include <ctype.h>
 #include <errno.h>
 #include <signal.h>
 #include <stdio.h>
@@ -18,25 +19,30 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
-bool config_init_paths(abraxas_paths_t *paths)
-{
-    const char *home = getenv("HOME");
-    if (!home) return false;
+/* Stack arena for the small config JSON files; overflow spills to heap */
+#define CONFIG_JSON_SCRATCH 4096
 
-    /* Build config dir first, bail if it won't fit */
-    char dir[ABRAXAS_PATH_MAX];
-    int n = snprintf(dir, sizeof(dir), "%s/.config/abraxas", home);
-    if (n < 0 || (size_t)n >= sizeof(dir)) return false;
-    memcpy(paths->config_dir, dir, (size_t)n + 1);
+/* Every file lives in one directory; create it if missing */
+static bool paths_in_dir(abraxas_paths_t *paths, const char *dir)
+{
+    size_t n = strlen(dir);
+    if (n >= sizeof(paths->config_dir)) return false;
+    memcpy(paths->config_dir, dir, n + 1);
 
     /* dir is verified to fit above; GCC can't prove it across calls */
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wformat-truncation"
     snprintf(paths->config_file,   sizeof(paths->config_file),   "%s/config.ini",        dir);
     snprintf(paths->cache_file,    sizeof(paths->cache_file),    "%s/weather_cache.json", dir);
+    snprintf(paths->grid_file,     sizeof(paths->grid_file),     "%s/gridpoint.json",     dir);
     snprintf(paths->override_file, sizeof(paths->override_file), "%s/override.json",      dir);
     snprintf(paths->zipdb_file,    sizeof(paths->zipdb_file),    "%s/us_zipcodes.bin",    dir);
     snprintf(paths->pid_file,      sizeof(paths->pid_file),      "%s/daemon.pid",         dir);
+    snprintf(paths->control_socket, sizeof(paths->control_socket), "%s/control.sock",     dir);
+    snprintf(paths->status_page,   sizeof(paths->status_page),   "%s/status",             dir);
+    snprintf(paths->probe_file,    sizeof(paths->probe_file),    "%s/backend.json",       dir);
+    snprintf(paths->snapshot_file, sizeof(paths->snapshot_file), "%s/state.bin",          dir);
+    snprintf(paths->schedule_file, sizeof(paths->schedule_file), "%s/schedule.bin",       dir);
 #pragma GCC diagnostic pop
 
     /* Create config directory if it doesn't exist */
@@ -46,6 +52,28 @@ bool config_init_paths(abraxas_paths_t *paths)
     return true;
 }
 
+bool config_init_paths(abraxas_paths_t *paths)
+{
+    const char *home = getenv("HOME");
+    if (!home) return false;
+
+    /* Build config dir first, bail if it won't fit */
+    char dir[ABRAXAS_PATH_MAX];
+    int n = snprintf(dir, sizeof(dir), "%s/.config/abraxas", home);
+    if (n < 0 || (size_t)n >= sizeof(dir)) return false;
+    return paths_in_dir(paths, dir);
+}
+
+bool config_init_system_paths(abraxas_paths_t *paths)
+{
+    if (!paths_in_dir(paths, ABRAXAS_SYSTEM_DIR)) return false;
+
+    /* Reachable by every user; the daemon keys requests on the peer uid */
+    snprintf(paths->control_socket, sizeof(paths->control_socket), "%s",
+             ABRAXAS_SYSTEM_SOCKET);
+    return true;
+}
+
 /* --- INI config --- */
 
 location_t config_load_location(const abraxas_paths_t *paths)
@@ -142,9 +170,13 @@ override_state_t config_load_override(const abraxas_paths_t *paths)
     buf[n] = '\0';
     fclose(f);
 
-    json_value_t *root = json_parse(buf);
+    /* A handful of scalars: the whole tree fits in the stack scratch */
+    char scratch[CONFIG_JSON_SCRATCH];
+    json_arena_t arena;
+    json_arena_init(&arena, scratch, sizeof(scratch));
+    json_value_t *root = json_parse_arena(buf, &arena);
     free(buf);
-    if (!root) return ovr;
+    if (!root) { json_arena_free(&arena); return ovr; }
 
     const json_value_t *v;
 
@@ -163,7 +195,10 @@ override_state_t config_load_override(const abraxas_paths_t *paths)
     v = json_get(root, "start_temp");
     if (v) ovr.start_temp = (int)json_number(v);
 
-    json_free(root);
+    v = json_get(root, "fade_ms");
+    if (v) ovr.fade_ms = (int)json_number(v);
+
+    json_arena_free(&arena);
     return ovr;
 }
 
@@ -177,7 +212,8 @@ bool config_save_override(const abraxas_paths_t *paths, const override_state_t *
     fprintf(f, "  \"target_temp\": %d,\n", ovr->target_temp);
     fprintf(f, "  \"duration_minutes\": %d,\n", ovr->duration_minutes);
     fprintf(f, "  \"issued_at\": %ld,\n", (long)ovr->issued_at);
-    fprintf(f, "  \"start_temp\": %d\n", ovr->start_temp);
+    fprintf(f, "  \"start_temp\": %d,\n", ovr->start_temp);
+    fprintf(f, "  \"fade_ms\": %d\n", ovr->fade_ms);
     fprintf(f, "}\n");
     fclose(f);
     return true;
@@ -211,9 +247,12 @@ weather_data_t config_load_weather_cache(const abraxas_paths_t *paths)
     buf[n] = '\0';
     fclose(f);
 
-    json_value_t *root = json_parse(buf);
+    char scratch[CONFIG_JSON_SCRATCH];
+    json_arena_t arena;
+    json_arena_init(&arena, scratch, sizeof(scratch));
+    json_value_t *root = json_parse_arena(buf, &arena);
     free(buf);
-    if (!root) return wd;
+    if (!root) { json_arena_free(&arena); return wd; }
 
     const json_value_t *v;
 
@@ -235,11 +274,27 @@ weather_data_t config_load_weather_cache(const abraxas_paths_t *paths)
     v = json_get(root, "fetched_at");
     if (v) wd.fetched_at = (time_t)json_number(v);
 
+    /* Timeline: two hex digits of cloud % per forecast hour */
+    v = json_get(root, "timeline_start");
+    const json_value_t *hex = json_get(root, "cloud_timeline");
+    if (v && hex && json_string(hex)) {
+        const char *h = json_string(hex);
+        int hours = 0;
+        while (hours < WEATHER_HOURS_MAX && isxdigit((unsigned char)h[0]) &&
+               isxdigit((unsigned char)h[1])) {
+            char pair[3] = { h[0], h[1], '\0' };
+            wd.cloud[hours++] = (uint8_t)strtoul(pair, nullptr, 16);
+            h += 2;
+        }
+        wd.timeline_start = (time_t)json_number(v);
+        wd.timeline_hours = hours;
+    }
+
     /* Check for error key */
     v = json_get(root, "error");
     wd.has_error = (v != nullptr);
 
-    json_free(root);
+    json_arena_free(&arena);
 
     /* If no error key and we have fetched_at, it's valid */
     if (!wd.has_error && wd.fetched_at == 0)
@@ -291,6 +346,13 @@ bool config_save_weather_cache(const abraxas_paths_t *paths, const weather_data_
         fprintf(f, ",\n");
         fprintf(f, "  \"temperature\": %.1f,\n", wd->temperature);
         fprintf(f, "  \"is_day\": %s,\n", wd->is_day ? "true" : "false");
+        if (wd->timeline_hours > 0) {
+            fprintf(f, "  \"timeline_start\": %ld,\n", (long)wd->timeline_start);
+            fprintf(f, "  \"cloud_timeline\": \"");
+            for (int i = 0; i < wd->timeline_hours; i++)
+                fprintf(f, "%02x", wd->cloud[i]);
+            fprintf(f, "\",\n");
+        }
         fprintf(f, "  \"fetched_at\": %ld\n", (long)wd->fetched_at);
         fprintf(f, "}\n");
     }
@@ -299,6 +361,127 @@ bool config_save_weather_cache(const abraxas_paths_t *paths, const weather_data_
     return true;
 }
 
+/* --- Gridpoint cache JSON --- */
+
+gridpoint_cache_t config_load_gridpoint(const abraxas_paths_t *paths)
+{
+    gridpoint_cache_t gp = { .valid = false };
+
+    FILE *f = fopen(paths->grid_file, "r");
+    if (!f) return gp;
+
+    char buf[2048];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    bool truncated = !feof(f);
+    fclose(f);
+    if (n == 0 || truncated) return gp;
+    buf[n] = '\0';
+
+    enum { POINT, URL, ETAG, LAST_MODIFIED, TARGETS };
+    json_target_t t[TARGETS] = {
+        [POINT]         = { .path = "point" },
+        [URL]           = { .path = "forecast_url" },
+        [ETAG]          = { .path = "etag" },
+        [LAST_MODIFIED] = { .path = "last_modified" },
+    };
+    if (json_scan(buf, t, TARGETS) < 0) return gp;
+
+    if (!json_target_string(&t[POINT], gp.point, sizeof(gp.point)) ||
+        !json_target_string(&t[URL], gp.forecast_url, sizeof(gp.forecast_url)) ||
+        gp.point[0] == '\0' || gp.forecast_url[0] == '\0')
+        return (gridpoint_cache_t){ .valid = false };
+
+    /* Validators are optional; a missing one is left empty */
+    (void)json_target_string(&t[ETAG], gp.etag, sizeof(gp.etag));
+    (void)json_target_string(&t[LAST_MODIFIED], gp.last_modified, sizeof(gp.last_modified));
+
+    gp.valid = true;
+    return gp;
+}
+
+bool config_save_gridpoint(const abraxas_paths_t *paths, const gridpoint_cache_t *gp)
+{
+    if (!gp->valid)
+        return unlink(paths->grid_file) == 0 || errno == ENOENT;
+
+    FILE *f = fopen(paths->grid_file, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"point\": ");
+    json_write_string(f, gp->point);
+    fprintf(f, ",\n  \"forecast_url\": ");
+    json_write_string(f, gp->forecast_url);
+    fprintf(f, ",\n  \"etag\": ");
+    json_write_string(f, gp->etag);
+    fprintf(f, ",\n  \"last_modified\": ");
+    json_write_string(f, gp->last_modified);
+    fprintf(f, "\n}\n");
+
+    return fclose(f) == 0;
+}
+
+/* --- Backend probe JSON --- */
+
+bool config_load_probe(const abraxas_paths_t *paths, meridian_probe_t *probe)
+{
+    *probe = (meridian_probe_t){ .card_num = -1 };
+
+    FILE *f = fopen(paths->probe_file, "r");
+    if (!f) return false;
+
+    char buf[1024];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    bool truncated = !feof(f);
+    fclose(f);
+    if (n == 0 || truncated) return false;
+    buf[n] = '\0';
+
+    enum { BACKEND, SESSION, CARD, GAMMA_SIZES, TARGETS };
+    json_target_t t[TARGETS] = {
+        [BACKEND]     = { .path = "backend" },
+        [SESSION]     = { .path = "session" },
+        [CARD]        = { .path = "card" },
+        [GAMMA_SIZES] = { .path = "gamma_sizes" },
+    };
+    if (json_scan(buf, t, TARGETS) < TARGETS ||
+        !json_target_string(&t[BACKEND], probe->backend, sizeof(probe->backend)) ||
+        !json_target_string(&t[SESSION], probe->session, sizeof(probe->session)) ||
+        t[CARD].type != JSON_NUMBER || t[GAMMA_SIZES].type != JSON_ARRAY) {
+        *probe = (meridian_probe_t){ .card_num = -1 };
+        return false;
+    }
+    probe->card_num = (int)json_target_number(&t[CARD]);
+
+    const char *iter = nullptr;
+    json_target_t elem;
+    while (probe->output_count < MERIDIAN_PROBE_MAX_OUTPUTS &&
+           json_target_next(&t[GAMMA_SIZES], &iter, &elem))
+        probe->gamma_size[probe->output_count++] = (int)json_target_number(&elem);
+    return true;
+}
+
+bool config_save_probe(const abraxas_paths_t *paths, const meridian_probe_t *probe)
+{
+    FILE *f = fopen(paths->probe_file, "w");
+    if (!f) return false;
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"backend\": ");
+    json_write_string(f, probe->backend);
+    fprintf(f, ",\n  \"session\": ");
+    json_write_string(f, probe->session);
+    fprintf(f, ",\n  \"card\": %d,\n", probe->card_num);
+    fprintf(f, "  \"gamma_sizes\": [");
+    for (int i = 0; i < probe->output_count; i++)
+        fprintf(f, "%s%d", i ? ", " : "", probe->gamma_size[i]);
+    fprintf(f, "]\n}\n");
+
+    return fclose(f) == 0;
+}
+
+/* --- PID file --- */
+
 bool config_check_daemon_alive(const abraxas_paths_t *paths)
 {
     FILE *f = fopen(paths->pid_file, "r");
@@ -329,11 +512,24 @@ void config_remove_pid(const abraxas_paths_t *paths)
     unlink(paths->pid_file);
 }
 
+time_t config_weather_refresh_at(const weather_data_t *wd)
+{
+    if (wd->has_error || wd->fetched_at == 0)
+        return 0;
+    if (wd->timeline_hours <= 0)
+        return wd->fetched_at + WEATHER_REFRESH_SEC;
+
+    time_t due = wd->fetched_at + WEATHER_MAX_AGE_SEC;
+    time_t horizon = wd->timeline_start + (time_t)wd->timeline_hours * 3600
+                   - WEATHER_MIN_HORIZON_SEC;
+    return horizon < due ? horizon : due;
+}
+
 bool config_weather_needs_refresh(const weather_data_t *wd)
 {
     if (wd->has_error || wd->fetched_at == 0)
         return true;
 
     time_t now = time(nullptr);
-    return difftime(now, wd->fetched_at) > WEATHER_REFRESH_SEC;
+    return now > config_weather_refresh_at(wd);
 }
@@ -0,0 +1,217 @@
+/*
+ * control.c - Daemon control socket
+ *
+ * Protocol encode/decode plus the two socket ends. The daemon only binds
+ * here; accept, recv and send run through its io_uring loop.
+ */
+
+#define _GNU_SOURCE
+
+#include "control.h"
+#include "fade.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/* CLI wait for a reply; refresh covers the daemon's two curl requests */
+constexpr int CONTROL_REPLY_TIMEOUT_SEC   = 2;
+constexpr int CONTROL_REFRESH_TIMEOUT_SEC = 15;
+
+static bool socket_address(const char *path, struct sockaddr_un *addr)
+{
+    size_t len = strlen(path);
+    if (len >= sizeof(addr->sun_path)) return false;
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path, len + 1);
+    return true;
+}
+
+static int connect_to(const struct sockaddr_un *addr)
+{
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+/* --- Daemon side --- */
+
+int control_listen(const char *path)
+{
+    struct sockaddr_un addr;
+    if (!socket_address(path, &addr)) return -1;
+
+    /* Someone answering: a second daemon must not steal the socket */
+    int probe = connect_to(&addr);
+    if (probe >= 0) {
+        close(probe);
+        errno = EADDRINUSE;
+        return -1;
+    }
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    mode_t old_mask = umask(077);
+    int rc = bind(fd, (const struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+
+    if (rc < 0 || listen(fd, 4) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+bool control_parse_request(const char *msg, size_t len, control_request_t *req)
+{
+    char line[CONTROL_MSG_MAX];
+    if (len == 0 || len >= sizeof(line)) return false;
+    memcpy(line, msg, len);
+    line[len] = '\0';
+    line[strcspn(line, "\r\n")] = '\0';
+
+    *req = (control_request_t){0};
+    if (strcmp(line, "resume") == 0) {
+        req->op = CONTROL_RESUME;
+        return true;
+    }
+    if (strcmp(line, "refresh") == 0) {
+        req->op = CONTROL_REFRESH;
+        return true;
+    }
+
+    int temp, minutes, fade = 0, end = 0;
+    int n = sscanf(line, "set %d %d%n %d%n", &temp, &minutes, &end, &fade, &end);
+    if (n >= 2 && line[end] == '\0') {
+        if (temp < TEMP_MIN || temp > TEMP_MAX || minutes < 0) return false;
+        if (fade < 0 || fade > FADE_MAX_MS || (fade > 0 && minutes > 0)) return false;
+        req->op = CONTROL_SET;
+        req->target_temp = temp;
+        req->duration_minutes = minutes;
+        req->fade_ms = fade;
+        return true;
+    }
+    return false;
+}
+
+size_t control_format_reply(const control_reply_t *reply, char *buf, size_t cap)
+{
+    int n;
+    if (!reply->ok)
+        n = snprintf(buf, cap, "err %s\n", reply->error);
+    else
+        n = snprintf(buf, cap,
+                     "ok temp=%d manual=%d target=%d duration=%d resume_at=%lld "
+                     "clouds=%d forecast=%s\n",
+                     reply->temp, reply->manual ? 1 : 0, reply->target_temp,
+                     reply->duration_minutes, (long long)reply->resume_at,
+                     reply->cloud_cover, reply->forecast);
+    if (n < 0) return 0;
+    return (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+/* --- CLI side --- */
+
+static bool parse_reply(char *line, control_reply_t *reply)
+{
+    *reply = (control_reply_t){ .cloud_cover = -1 };
+    line[strcspn(line, "\n")] = '\0';
+
+    if (strncmp(line, "err ", 4) == 0) {
+        snprintf(reply->error, sizeof(reply->error), "%s", line + 4);
+        return true;
+    }
+    if (strncmp(line, "ok ", 3) != 0) return false;
+    reply->ok = true;
+
+    /* forecast= runs to the end of the line; everything before is key=int */
+    char *forecast = strstr(line, " forecast=");
+    if (forecast) {
+        snprintf(reply->forecast, sizeof(reply->forecast), "%s", forecast + 10);
+        *forecast = '\0';
+    }
+
+    char *save = nullptr;
+    for (char *tok = strtok_r(line + 3, " ", &save); tok; tok = strtok_r(nullptr, " ", &save)) {
+        char *eq = strchr(tok, '=');
+        if (!eq) continue;
+        *eq = '\0';
+        long long v = strtoll(eq + 1, nullptr, 10);
+        if (strcmp(tok, "temp") == 0)           reply->temp = (int)v;
+        else if (strcmp(tok, "manual") == 0)    reply->manual = v != 0;
+        else if (strcmp(tok, "target") == 0)    reply->target_temp = (int)v;
+        else if (strcmp(tok, "duration") == 0)  reply->duration_minutes = (int)v;
+        else if (strcmp(tok, "resume_at") == 0) reply->resume_at = (time_t)v;
+        else if (strcmp(tok, "clouds") == 0)    reply->cloud_cover = (int)v;
+    }
+    return true;
+}
+
+int control_send(const abraxas_paths_t *paths, const control_request_t *req,
+                 control_reply_t *reply)
+{
+    struct sockaddr_un addr;
+    if (!socket_address(paths->control_socket, &addr)) return -1;
+
+    int fd = connect_to(&addr);
+    /* No daemon of our own: a system daemon may be serving this session */
+    if (fd < 0 && strcmp(paths->control_socket, ABRAXAS_SYSTEM_SOCKET) != 0 &&
+        socket_address(ABRAXAS_SYSTEM_SOCKET, &addr))
+        fd = connect_to(&addr);
+    if (fd < 0) return -1;   /* ENOENT / ECONNREFUSED: nobody home */
+
+    struct timeval tv = {
+        .tv_sec = req->op == CONTROL_REFRESH ? CONTROL_REFRESH_TIMEOUT_SEC
+                                             : CONTROL_REPLY_TIMEOUT_SEC,
+    };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char msg[CONTROL_MSG_MAX];
+    int n;
+    switch (req->op) {
+    case CONTROL_SET:
+        /* Older daemons only know the two-field form */
+        if (req->fade_ms > 0)
+            n = snprintf(msg, sizeof(msg), "set %d %d %d\n", req->target_temp,
+                         req->duration_minutes, req->fade_ms);
+        else
+            n = snprintf(msg, sizeof(msg), "set %d %d\n", req->target_temp,
+                         req->duration_minutes);
+        break;
+    case CONTROL_RESUME:
+        n = snprintf(msg, sizeof(msg), "resume\n");
+        break;
+    default:
+        n = snprintf(msg, sizeof(msg), "refresh\n");
+        break;
+    }
+
+    int rc = -2;
+    if (send(fd, msg, (size_t)n, MSG_NOSIGNAL) == n) {
+        ssize_t got = recv(fd, msg, sizeof(msg) - 1, 0);
+        if (got > 0) {
+            msg[got] = '\0';
+            if (parse_reply(msg, reply)) rc = 0;
+        }
+    }
+    close(fd);
+    return rc;
+}
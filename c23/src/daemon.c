@@ -2,25 +2,46 @@
  * daemon.c - Main daemon event loop
  *
  * Linux kernel interfaces:
- *   - io_uring: single-syscall event loop (poll + timeout in one enter call)
- *   - inotify: config file change detection
- *   - signalfd: clean shutdown via SIGTERM/SIGINT
+ *   - io_uring: single-syscall event loop (multi-shot polls + one long-lived
+ *     absolute CLOCK_BOOTTIME deadline, moved in place via TIMEOUT_UPDATE);
+ *     inotify, signalfd and the curl pipe are multishot READs into a
+ *     provided-buffer ring on kernels that have them (>= 6.7)
+ *   - inotify: config file change detection, /etc/localtime replacement
+ *   - Unix socket: CLI commands via io_uring accept/recv/send (control.h)
+ *   - mmap: seqlocked status page for --status and monitors (status.h)
+ *   - signalfd: clean shutdown via SIGTERM/SIGINT, SIGUSR1 latency dump
+ *   - timerfd: TFD_TIMER_CANCEL_ON_SET wall-clock change / resume detection
  *   - prctl: timer slack, no_new_privs, dumpable
  *   - seccomp-bpf: syscall whitelist (post-init)
  *   - landlock: filesystem sandbox (post-init)
  *
- * No fallback. Requires kernel >= 5.1 (io_uring).
+ * Second-scale --set fades step once per display frame: DRM page-flip
+ * events gate each upload, and a one-shot CLOCK_MONOTONIC io_uring
+ * timeout paces them on every backend (fade.h).
+ *
+ * No fallback. Requires kernel >= 5.11 (io_uring TIMEOUT_UPDATE);
+ * the deadline uses CLOCK_MONOTONIC on kernels without BOOTTIME (< 5.15).
  * Gamma control via libmeridian (statically linked).
+ *
+ * Each wakeup is split into phases (trace.h): USDT probes mark the
+ * boundaries and every span lands in an in-process histogram.
  */
 
 #define _GNU_SOURCE
 
 #include "daemon.h"
+#include "alloccount.h"
+#include "ephemeris.h"
 #include "config.h"
+#include "control.h"
+#include "fade.h"
 #include "landlock.h"
+#include "schedule.h"
 #include "seccomp.h"
 #include "sigmoid.h"
-#include "solar.h"
+#include "snapshot.h"
+#include "status.h"
+#include "trace.h"
 #include "uring.h"
 #include "weather.h"
 
@@ -36,6 +57,8 @@
 #include <sys/inotify.h>
 #include <sys/prctl.h>
 #include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
 #include <time.h>
 #include <unistd.h>
 
@@ -43,8 +66,18 @@
 constexpr uint64_t EV_INOTIFY = 1;
 constexpr uint64_t EV_SIGNAL  = 2;
 constexpr uint64_t EV_TIMEOUT = 3;
-constexpr uint64_t EV_CANCEL  = 4;
-constexpr uint64_t EV_WEATHER = 5;
+constexpr uint64_t EV_TIMEOUT_UPD = 4;
+constexpr uint64_t EV_WEATHER = 5;    /* low half; direct-read generation in the high half */
+constexpr uint64_t EV_CLOCK   = 6;
+constexpr uint64_t EV_GAMMA   = 7;    /* low half; fd index in the high half */
+constexpr uint64_t EV_CTL_ACCEPT  = 8;
+constexpr uint64_t EV_CTL_RECV    = 9;
+constexpr uint64_t EV_CTL_SEND    = 10;
+constexpr uint64_t EV_CTL_TIMEOUT = 11;
+constexpr uint64_t EV_FRAME       = 12;
+constexpr uint64_t EV_FRAME_UPD   = 13;
+constexpr uint64_t EV_WORKER      = 14;
+constexpr uint64_t EV_TAG_MASK = 0xffffffffULL;
 
 /* Atomic event flag bitmask */
 constexpr uint32_t FLAG_TIMER    = 1u << 0;
@@ -52,11 +85,79 @@ constexpr uint32_t FLAG_SIGNAL   = 1u << 1;
 constexpr uint32_t FLAG_WEATHER  = 1u << 2;
 constexpr uint32_t FLAG_OVERRIDE = 1u << 3;
 constexpr uint32_t FLAG_CONFIG   = 1u << 4;
+constexpr uint32_t FLAG_CLOCK    = 1u << 5;
+constexpr uint32_t FLAG_TZ       = 1u << 6;
+constexpr uint32_t FLAG_GAMMA    = 1u << 7;
+constexpr uint32_t FLAG_CONTROL  = 1u << 8;
+constexpr uint32_t FLAG_DUMP     = 1u << 9;
+constexpr uint32_t FLAG_FRAME    = 1u << 10;
+constexpr uint32_t FLAG_SCHEDULE = 1u << 11;
+
+/* Direct reads: fixed-file slots, and the one buffer group they all use.
+   A buffer fits any inotify event and 32 signalfd records. */
+constexpr uint32_t SLOT_INOTIFY = 0;
+constexpr uint32_t SLOT_SIGNAL  = 1;
+constexpr uint32_t SLOT_WEATHER = 2;
+#define DIRECT_SLOTS 3
+constexpr uint16_t DIRECT_BGID      = 0;
+constexpr uint32_t DIRECT_BUF_COUNT = 16;
+constexpr uint32_t DIRECT_BUF_SIZE  = 4096;
+
+/* A flip event this many frames overdue is not coming: set without it */
+constexpr int FADE_STALL_FRAMES = 4;
+
+/* A snapshot's last_temp is what is on screen only this soon after it */
+constexpr int RESTORE_TEMP_MAX_AGE_SEC = 300;
+
+/* CLOCK_BOOTTIME gaining this much on CLOCK_MONOTONIC means we slept */
+constexpr int64_t RESUME_JUMP_NS = 1000000000LL;
+
+/* --- Cold-start snapshot --- */
+
+/* state.bin as of now: each section is refreshed when its source is
+   re-read or rewritten, and the file is written once per loop pass */
+static snapshot_t snap;
+static bool snap_dirty = false;
+
+static const char *snap_source_path(const abraxas_paths_t *paths, snapshot_source_t src)
+{
+    switch (src) {
+    case SNAP_CONFIG:   return paths->config_file;
+    case SNAP_WEATHER:  return paths->cache_file;
+    case SNAP_OVERRIDE: return paths->override_file;
+    case SNAP_PROBE:    return paths->probe_file;
+    default:            return "";
+    }
+}
+
+/* A section now matches its source file; call after setting it */
+static void snap_took(const abraxas_paths_t *paths, snapshot_source_t src)
+{
+    snap.ident[src] = snapshot_ident(snap_source_path(paths, src));
+    snap_dirty = true;
+}
+
+/* The section for src may stand in for parsing its source file */
+static bool snap_fresh(const abraxas_paths_t *paths, snapshot_source_t src)
+{
+    return snapshot_fresh(&snap, src, snap_source_path(paths, src));
+}
+
+static void snap_flush(const daemon_state_t *state, bool force)
+{
+    if (!snap_dirty && !force) return;
+    if (state->last_temp_valid) snap.last_temp = state->last_temp;
+    if (!snapshot_save(state->paths.snapshot_file, &snap))
+        fprintf(stderr, "[warn] Could not write %s\n", state->paths.snapshot_file);
+    snap_dirty = false;
+}
 
 /* --- Gamma control (libmeridian direct calls) --- */
 
 static meridian_state_t *gamma_state = nullptr;
+static bool gamma_last_ok = false;
 
+/* Backends one at a time: this also runs under seccomp, which has no threads */
 static bool gamma_init(void)
 {
     meridian_error_t err = meridian_init(&gamma_state);
@@ -70,10 +171,56 @@ static bool gamma_init(void)
     return true;
 }
 
+/* Startup: last start's backend alone, else every backend concurrently.
+   backend.json is rewritten whenever the result differs from it. */
+static bool gamma_init_probed(const abraxas_paths_t *paths)
+{
+    meridian_probe_t hint, probe;
+    bool have_hint;
+    if (snap_fresh(paths, SNAP_PROBE)) {
+        hint = snap.probe;
+        have_hint = hint.backend[0] != '\0';
+    } else {
+        have_hint = config_load_probe(paths, &hint);
+    }
+    bool from_hint = false;
+
+    int64_t t0 = trace_now_ns();
+    meridian_error_t err = meridian_init_probed(0, have_hint ? &hint : nullptr,
+                                                &gamma_state, &from_hint);
+    double ms = (double)(trace_now_ns() - t0) / 1e6;
+    if (err != MERIDIAN_OK) {
+        fprintf(stderr, "[libmeridian] Init failed: %s\n", meridian_strerror(err));
+        gamma_state = nullptr;
+        return false;
+    }
+    fprintf(stderr, "[libmeridian] Initialized with %s backend (%s, %.1f ms)\n",
+            meridian_get_backend_name(gamma_state), from_hint ? "cached" : "probed", ms);
+
+    meridian_get_probe(gamma_state, &probe);
+    if (!have_hint || memcmp(&hint, &probe, sizeof(probe)) != 0) {
+        if (from_hint)
+            fprintf(stderr, "[libmeridian] Outputs changed since last start\n");
+        if (!config_save_probe(paths, &probe))
+            fprintf(stderr, "[warn] Could not write %s\n", paths->probe_file);
+    }
+    snap.probe = probe;
+    snap_took(paths, SNAP_PROBE);
+    return true;
+}
+
 static bool gamma_set(int temp)
 {
     if (!gamma_state) return false;
+    const char *backend = meridian_get_backend_name(gamma_state);
+    TRACE2(set_start, backend, temp);
+    int64_t t0 = trace_now_ns();
     meridian_error_t err = meridian_set_temperature(gamma_state, temp, 1.0f);
+    int64_t ns = trace_now_ns() - t0;
+    TRACE3(set_done, backend, temp, ns);
+    trace_record(LAT_SET, ns);
+    trace_record_backend(backend, ns);
+    gamma_last_ok = err == MERIDIAN_OK;
     if (err != MERIDIAN_OK) {
         fprintf(stderr, "[libmeridian] Set temperature failed: %s\n",
                 meridian_strerror(err));
@@ -82,6 +229,88 @@ static bool gamma_set(int temp)
     return true;
 }
 
+/* One fade frame. MERIDIAN_ERR_BUSY: the previous one is still in flight. */
+static meridian_error_t gamma_set_frame(int temp)
+{
+    if (!gamma_state) return MERIDIAN_ERR_NO_CRTC;
+    int64_t t0 = trace_now_ns();
+    meridian_error_t err = meridian_set_temperature_frame(gamma_state, temp, 1.0f);
+    if (err == MERIDIAN_ERR_BUSY) return err;
+    int64_t ns = trace_now_ns() - t0;
+    trace_record(LAT_FRAME, ns);
+    trace_record_backend(meridian_get_backend_name(gamma_state), ns);
+    gamma_last_ok = err == MERIDIAN_OK;
+    if (err != MERIDIAN_OK)
+        fprintf(stderr, "[libmeridian] Set frame failed: %s\n", meridian_strerror(err));
+    return err;
+}
+
+static bool gamma_frame_pending(void)
+{
+    return gamma_state && meridian_frame_pending(gamma_state);
+}
+
+static int gamma_refresh_mhz(void)
+{
+    return gamma_state ? meridian_get_refresh_mhz(gamma_state) : 0;
+}
+
+/* Fill every frame's ramps up front; without the pin frames fill on demand */
+static void gamma_pin_fade(const int *temps, int count)
+{
+    if (!gamma_state) return;
+    int size = meridian_get_gamma_size(gamma_state, 0);
+    if (size > 0 && meridian_ramp_pin(temps, count, size, 1.0f) != MERIDIAN_OK)
+        fprintf(stderr, "[warn] fade: ramps not precomputed, filling per frame\n");
+}
+
+/* Stage the next scheduled temperature so the wakeup only has to send it */
+static void gamma_prepare(int temp)
+{
+    if (gamma_state) (void)meridian_prepare_temperature(gamma_state, temp, 1.0f);
+}
+
+/* Backend event fds (hotplug, compositor events, DBus replies) */
+static int gamma_event_fds(int fds[static MERIDIAN_MAX_FDS])
+{
+    return gamma_state ? meridian_get_fds(gamma_state, fds, MERIDIAN_MAX_FDS) : 0;
+}
+
+/* New outputs get the current temperature inside libmeridian */
+static bool gamma_dispatch(void)
+{
+    if (!gamma_state) return true;
+    int64_t t0 = trace_now_ns();
+    meridian_error_t err = meridian_dispatch(gamma_state);
+    int64_t ns = trace_now_ns() - t0;
+    TRACE2(dispatch_done, err, ns);
+    trace_record(LAT_DISPATCH, ns);
+    if (err != MERIDIAN_OK) {
+        fprintf(stderr, "[libmeridian] Dispatch failed: %s\n", meridian_strerror(err));
+        return false;
+    }
+    return true;
+}
+
+/* Backend name and outputs for the status page */
+static void gamma_describe(status_page_t *page)
+{
+    page->output_count = 0;
+    if (!gamma_state) {
+        snprintf(page->backend, sizeof(page->backend), "none");
+        return;
+    }
+    snprintf(page->backend, sizeof(page->backend), "%s", meridian_get_backend_name(gamma_state));
+    int n = meridian_get_crtc_count(gamma_state);
+    if (n > STATUS_MAX_OUTPUTS) n = STATUS_MAX_OUTPUTS;
+    for (int i = 0; i < n; i++)
+        page->outputs[i] = (status_output_t){
+            .index = (uint32_t)i,
+            .gamma_size = meridian_get_gamma_size(gamma_state, i),
+        };
+    page->output_count = n > 0 ? (uint32_t)n : 0;
+}
+
 static void gamma_restore(void)
 {
     if (gamma_state) (void)meridian_restore(gamma_state);
@@ -97,187 +326,1047 @@ static void gamma_cleanup(void)
 
 /* --- Linux kernel fd helpers --- */
 
+/* timedatectl and friends replace /etc/localtime by rename or symlink */
+static int tz_watch_wd = -1;
+
+/* IN_CLOSE_WRITEs on override.json still due from our own snapshots */
+static int override_self_writes = 0;
+
+/* daemon_simulate() is running: overrides stay in memory */
+static bool simulating = false;
+
+static void save_override_snapshot(const daemon_state_t *state, const override_state_t *od)
+{
+    if (!simulating && config_save_override(&state->paths, od)) override_self_writes++;
+    snap.override = *od;
+    snap_took(&state->paths, SNAP_OVERRIDE);
+}
+
+static void clear_override_file(const daemon_state_t *state)
+{
+    if (!simulating) config_clear_override(&state->paths);
+    snap.override = (override_state_t){ .active = false };
+    snap_took(&state->paths, SNAP_OVERRIDE);
+}
+
+static void save_weather_cache(const daemon_state_t *state)
+{
+    config_save_weather_cache(&state->paths, &state->weather);
+    snap.weather = state->weather;
+    snap_took(&state->paths, SNAP_WEATHER);
+}
+
 static int create_inotify_watch(const char *dir_path)
 {
-    int fd = inotify_init1(IN_CLOEXEC);
+    int fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
     if (fd < 0) return -1;
 
-    int wd = inotify_add_watch(fd, dir_path, IN_CLOSE_WRITE);
+    /* IN_MOVED_TO: schedule.bin is installed by rename */
+    int wd = inotify_add_watch(fd, dir_path, IN_CLOSE_WRITE | IN_MOVED_TO);
     if (wd < 0) {
         close(fd);
         return -1;
     }
 
+    tz_watch_wd = inotify_add_watch(fd, "/etc", IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE);
+
     return fd;
 }
 
+/* With TZ unset, glibc's mktime() re-stats /etc/localtime and strdups
+   its name on every call; an explicit TZ is only re-read when it changes.
+   The /etc watch above replaces glibc's check, so pin the system zone. */
+static void pin_timezone(void)
+{
+    if (!getenv("TZ")) setenv("TZ", ":/etc/localtime", 1);
+    tzset();
+}
+
+/* A changed TZ value forces a re-read */
+static void reload_timezone(void)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    setenv("TZ", ":/etc/localtime", 1);
+    tzset();
+}
+
+/* Arm a realtime timerfd that never expires but is cancelled (reads
+ * -ECANCELED) whenever the wall clock jumps, including on resume.
+ * INT32_MAX would be an absolute expiry in 2038, after which it fires
+ * on every rearm; 2^40 s is some 35000 years out. */
+static bool arm_clock_watch(int fd)
+{
+    struct itimerspec its = {
+        .it_value = { .tv_sec = (time_t)1 << 40, .tv_nsec = 0 }
+    };
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                           &its, nullptr) == 0;
+}
+
+static int create_clock_watch(void)
+{
+    int fd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0) return -1;
+
+    if (!arm_clock_watch(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int64_t clock_ns(clockid_t clk)
+{
+    struct timespec ts;
+    clock_gettime(clk, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Time spent suspended so far (BOOTTIME counts it, MONOTONIC does not) */
+static int64_t suspend_offset_ns(void)
+{
+    return clock_ns(CLOCK_BOOTTIME) - clock_ns(CLOCK_MONOTONIC);
+}
+
 static int create_signalfd_masked(void)
 {
     sigset_t mask;
     sigemptyset(&mask);
     sigaddset(&mask, SIGTERM);
     sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGUSR1);
 
     if (sigprocmask(SIG_BLOCK, &mask, nullptr) < 0) return -1;
 
-    int fd = signalfd(-1, &mask, SFD_CLOEXEC);
+    int fd = signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
     return fd;
 }
 
 /* --- Solar temperature helper --- */
 
+static bool weather_is_dark(const weather_data_t *weather, time_t when)
+{
+    return weather_cloud_at(weather, when) >= CLOUD_THRESHOLD;
+}
+
+/* Today's solar curves; rebuilt lazily on date rollover or location change */
+static ephemeris_t ephem;
+
+/* schedule.bin, mapped while present; days it covers are copied, not computed */
+static schedule_t sched;
+
+static void schedule_load(const daemon_state_t *state)
+{
+    schedule_close(&sched);
+    if (!schedule_open(&sched, state->paths.schedule_file)) return;
+
+    struct tm dt;
+    time_t first = (time_t)sched.day[0].day_start;
+    localtime_r(&first, &dt);
+    if (schedule_matches(&sched, state->location.lat, state->location.lon))
+        fprintf(stderr, "[solar] Schedule: %u days from %04d-%02d-%02d\n",
+                sched.hdr->days, dt.tm_year + 1900, dt.tm_mon + 1, dt.tm_mday);
+    else
+        fprintf(stderr, "[solar] Schedule is for %.4f, %.4f; computing live\n",
+                sched.hdr->lat, sched.hdr->lon);
+}
+
+static const ephemeris_t *solar_ephemeris(time_t now, double lat, double lon)
+{
+    if (!ephemeris_current(&ephem, now, lat, lon)) {
+        bool mapped = schedule_fill(&sched, &ephem, now, lat, lon);
+        if (!mapped) ephemeris_build(&ephem, now, lat, lon);
+        struct tm dt;
+        localtime_r(&ephem.day_start, &dt);
+        fprintf(stderr, "[solar] Ephemeris for %04d-%02d-%02d (%d min%s)\n",
+                dt.tm_year + 1900, dt.tm_mon + 1, dt.tm_mday, ephem.minutes,
+                mapped ? ", from schedule" : "");
+    }
+    return &ephem;
+}
+
 static int solar_temperature(time_t now, double lat, double lon,
                              const weather_data_t *weather)
 {
-    sun_times_t st = solar_sunrise_sunset(now, lat, lon);
-    if (!st.valid) return TEMP_NIGHT;
+    return ephemeris_temp(solar_ephemeris(now, lat, lon), now,
+                          weather_is_dark(weather, now));
+}
 
-    double minutes_from_sunrise = difftime(now, st.sunrise) / 60.0;
-    double minutes_to_sunset    = difftime(st.sunset, now)  / 60.0;
+/* --- Wakeup scheduling --- */
 
-    int cloud_cover = weather ? weather->cloud_cover : 0;
-    bool is_dark = cloud_cover >= CLOUD_THRESHOLD;
+/*
+ * Next second the loop has work to do: the active curve's next Kelvin
+ * step, the forecast hour where the curve flips between clear and dark,
+ * override auto-resume once the override holds, or the weather refresh
+ * deadline. Inotify, signal and curl pipe events wake the loop
+ * independently, so none of them need a deadline here.
+ */
+static time_t next_wakeup(const daemon_state_t *state, bool weather_idle, time_t now)
+{
+    time_t next;
+    if (state->manual_mode) {
+        next = next_manual_change(state->manual_start_temp, state->manual_target_temp,
+                                  state->manual_start_time, state->manual_duration_min, now);
+        /* Holding the target: nothing changes until auto-resume */
+        if (next == 0)
+            next = state->manual_resume_time > now ? state->manual_resume_time
+                                                   : now + 24 * 3600;
+    } else {
+        next = ephemeris_next_change(
+            solar_ephemeris(now, state->location.lat, state->location.lon),
+            now, weather_is_dark(&state->weather, now));
+
+        time_t flip = weather_next_dark_change(&state->weather, now);
+        if (flip > now && flip < next) next = flip;
+    }
 
-    return calculate_solar_temp(minutes_from_sunrise, minutes_to_sunset, is_dark);
+#ifndef NOAA_DISABLED
+    if (weather_idle) {
+        const weather_data_t *w = &state->weather;
+        time_t due = (w->has_error || w->fetched_at == 0)
+            ? now + WEATHER_RETRY_SEC
+            : config_weather_refresh_at(w) + 1;
+        /* Past due means the fetch could not start this tick -- retry later */
+        if (due <= now) due = now + WEATHER_RETRY_SEC;
+        if (due < next) next = due;
+    }
+#else
+    (void)weather_idle;
+#endif
+
+    return next > now ? next : now + 1;
 }
 
-/* --- Inotify event processing (shared by both event loops) --- */
+/* Temperature the active curve will output at 'when', or 0 if unknown */
+static int scheduled_temperature(const daemon_state_t *state, time_t when)
+{
+    if (state->manual_mode)
+        return calculate_manual_temp(state->manual_start_temp, state->manual_target_temp,
+                                     state->manual_start_time, state->manual_duration_min,
+                                     when);
+
+    /* Rolling into tomorrow would rebuild the tables early */
+    if (!ephem.valid || when < ephem.day_start || when >= ephem.day_end) return 0;
+    return ephemeris_temp(&ephem, when, weather_is_dark(&state->weather, when));
+}
 
-static void process_inotify(int inotify_fd, const daemon_state_t *state,
-                            bool *config_changed, bool *override_changed)
+/* Convert a wall-clock deadline into an absolute timespec on the clock
+ * selected by the IORING_TIMEOUT_* flags, aligned to the wall second. */
+static void deadline_to_timespec(time_t deadline, uint32_t timeout_flags,
+                                 struct __kernel_timespec *ts)
 {
-    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
-    ssize_t len = read(inotify_fd, buf, sizeof(buf));
-    if (len <= 0) return;
+    clockid_t clk = (timeout_flags & IORING_TIMEOUT_BOOTTIME) ? CLOCK_BOOTTIME
+                                                             : CLOCK_MONOTONIC;
+    int64_t delta = (int64_t)deadline * 1000000000LL - clock_ns(CLOCK_REALTIME);
+    if (delta < 0) delta = 0;
+
+    int64_t when = clock_ns(clk) + delta;
+    ts->tv_sec  = when / 1000000000LL;
+    ts->tv_nsec = when % 1000000000LL;
+}
+
+/* --- Inotify and signalfd records (read or delivered in a ring buffer) --- */
 
-    for (char *ptr = buf; ptr < buf + len; ) {
-        struct inotify_event *event = (struct inotify_event *)ptr;
-        if (event->len > 0) {
+static void process_inotify(const char *buf, size_t len, const daemon_state_t *state,
+                            bool *config_changed, bool *override_changed,
+                            bool *tz_changed, bool *schedule_changed)
+{
+    for (const char *ptr = buf; ptr < buf + len; ) {
+        const struct inotify_event *event = (const struct inotify_event *)ptr;
+        if (event->len > 0 && event->wd == tz_watch_wd) {
+            if (strcmp(event->name, "localtime") == 0)
+                *tz_changed = true;
+        } else if (event->len > 0) {
             const char *override_name = strrchr(state->paths.override_file, '/');
             override_name = override_name ? override_name + 1 : state->paths.override_file;
 
             const char *config_name = strrchr(state->paths.config_file, '/');
             config_name = config_name ? config_name + 1 : state->paths.config_file;
 
-            if (strcmp(event->name, override_name) == 0)
-                *override_changed = true;
+            if (strcmp(event->name, override_name) == 0) {
+                if (override_self_writes > 0)
+                    override_self_writes--;     /* our snapshot, nothing new */
+                else
+                    *override_changed = true;
+            }
             if (strcmp(event->name, config_name) == 0) {
                 *config_changed = true;
                 fprintf(stderr, "[inotify] %s changed, reloading...\n", event->name);
             }
+
+            const char *schedule_name = strrchr(state->paths.schedule_file, '/');
+            schedule_name = schedule_name ? schedule_name + 1 : state->paths.schedule_file;
+            if (strcmp(event->name, schedule_name) == 0)
+                *schedule_changed = true;
         }
         ptr += sizeof(struct inotify_event) + event->len;
     }
 }
 
-/* Multi-shot poll liveness tracking */
+/* SIGUSR1 only asks for the latency tables, anything else is a shutdown */
+static uint32_t process_signals(const char *buf, size_t len)
+{
+    uint32_t flags = 0;
+    for (size_t off = 0; off + sizeof(struct signalfd_siginfo) <= len;
+         off += sizeof(struct signalfd_siginfo)) {
+        struct signalfd_siginfo si;
+        memcpy(&si, buf + off, sizeof(si));
+        flags |= si.ssi_signo == SIGUSR1 ? FLAG_DUMP : FLAG_SIGNAL;
+    }
+    return flags;
+}
+
+/* Multi-shot poll and deadline liveness tracking */
 typedef struct {
     bool inotify;
     bool signal;
     bool weather;
+    bool worker;            /* fetch worker reply receive posted */
+    bool clock;
+    bool gamma[MERIDIAN_MAX_FDS];
+    bool timeout;           /* deadline armed in the kernel */
+    bool frame;             /* fade frame timer armed */
+    bool timeout_rejected;  /* kernel refused the timeout clock flags */
 } poll_state_t;
 
-/* Unified CQE handler -- used by both main drain and cancel drain. */
+/* Multishot READs on fixed files instead of POLL_ADD + read() */
+typedef struct {
+    bool         enabled;
+    uring_bufs_t bufs;
+    int          weather_fd;    /* FILES_UPDATE argument for SLOT_WEATHER */
+    uint32_t     weather_gen;   /* CQEs of an abandoned pipe carry an older one */
+} direct_reads_t;
+
+static const int no_fd = -1;
+
+/* Control socket: one client at a time, the backlog holds the rest */
+typedef enum {
+    CTL_IDLE,           /* nothing in flight; accept is armed next loop */
+    CTL_ACCEPTING,
+    CTL_CONNECTED,      /* accepted, peer not yet checked */
+    CTL_RECEIVING,
+    CTL_REQUEST,        /* request applied; reply after this tick */
+    CTL_WAIT_WEATHER,   /* refresh: reply once the fetch completes */
+    CTL_SENDING,
+    CTL_CLOSING,
+} ctl_phase_t;
+
+typedef struct {
+    int         listen_fd;
+    int         fd;
+    ctl_phase_t phase;
+    int         failures;       /* accept errors in a row */
+    int         len;            /* received message length */
+    char        buf[CONTROL_MSG_MAX];
+    control_request_t req;
+    control_reply_t   reply;
+    struct __kernel_timespec recv_timeout;
+} control_conn_t;
+
+/* A stuck client must not hold the channel */
+constexpr int CONTROL_RECV_TIMEOUT_SEC = 2;
+constexpr int CONTROL_ACCEPT_MAX_FAILURES = 8;
+
+/* Turn one CQE into event flags and poll-state updates */
 static void process_cqe(const struct io_uring_cqe *cqe,
                          _Atomic uint32_t *events,
-                         poll_state_t *polls,
-                         int inotify_fd, const daemon_state_t *state)
+                         poll_state_t *polls, control_conn_t *ctl,
+                         const direct_reads_t *direct, weather_fetch_state_t *wfs,
+                         int inotify_fd, int signal_fd, const daemon_state_t *state)
 {
     bool more = cqe->flags & IORING_CQE_F_MORE;
-    switch (cqe->user_data) {
+    const char *data = direct->enabled ? uring_bufs_data(&direct->bufs, cqe) : nullptr;
+    switch (cqe->user_data & EV_TAG_MASK) {
+    case EV_CTL_ACCEPT:
+        if (cqe->res >= 0) {
+            ctl->fd = cqe->res;
+            ctl->phase = CTL_CONNECTED;
+            ctl->failures = 0;
+        } else {
+            ctl->phase = CTL_IDLE;
+            if (cqe->res != -EINTR && cqe->res != -ECONNABORTED) ctl->failures++;
+        }
+        break;
+    case EV_CTL_RECV:
+        if (cqe->res > 0) {
+            ctl->len = cqe->res;
+            *events |= FLAG_CONTROL;
+        } else {
+            ctl->phase = CTL_CLOSING;   /* EOF, error, or timed out */
+        }
+        break;
+    case EV_CTL_SEND:
+        ctl->phase = CTL_CLOSING;
+        break;
+    case EV_CTL_TIMEOUT:
+        break;
     case EV_TIMEOUT:
-        *events |= FLAG_TIMER;
+        polls->timeout = false;
+        if (cqe->res == -EINVAL)
+            polls->timeout_rejected = true;
+        else
+            *events |= FLAG_TIMER;
+        break;
+    case EV_TIMEOUT_UPD:
+        /* Only failures post a CQE when CQE_SKIP is supported.
+         * -ENOENT: the deadline fired first; its own CQE re-arms.
+         * Anything else: the old deadline is still pending -- arm a fresh
+         * one and let the stale one expire as a harmless extra tick. */
+        if (cqe->res < 0 && cqe->res != -ENOENT)
+            polls->timeout = false;
         break;
+    case EV_FRAME:
+        polls->frame = false;
+        *events |= FLAG_FRAME;
+        break;
+    case EV_FRAME_UPD:
+        /* As EV_TIMEOUT_UPD: a stale frame timer is only an extra tick */
+        if (cqe->res < 0 && cqe->res != -ENOENT)
+            polls->frame = false;
+        break;
+    case EV_CLOCK:
+        *events |= FLAG_CLOCK;
+        if (!more) polls->clock = false;
+        break;
+    case EV_GAMMA: {
+        uint64_t idx = cqe->user_data >> 32;
+        if (cqe->res > 0) *events |= FLAG_GAMMA;
+        if (!more && idx < MERIDIAN_MAX_FDS) polls->gamma[idx] = false;
+        break;
+    }
     case EV_SIGNAL:
-        *events |= FLAG_SIGNAL;
+        if (data && cqe->res > 0) {
+            *events |= process_signals(data, (size_t)cqe->res);
+        } else if (!direct->enabled && cqe->res > 0) {
+            struct signalfd_siginfo si[4];
+            ssize_t n = read(signal_fd, si, sizeof(si));
+            if (n > 0)
+                *events |= process_signals((const char *)si, (size_t)n);
+            else if (n == 0 || errno != EAGAIN)
+                *events |= FLAG_SIGNAL;
+        }
         if (!more) polls->signal = false;
         break;
-    case EV_INOTIFY:
-        if (cqe->res > 0) {
-            bool cfg = false, ovr = false;
-            process_inotify(inotify_fd, state, &cfg, &ovr);
-            if (cfg) *events |= FLAG_CONFIG;
-            if (ovr) *events |= FLAG_OVERRIDE;
+    case EV_INOTIFY: {
+        bool cfg = false, ovr = false, tz = false, sch = false;
+        if (data && cqe->res > 0) {
+            process_inotify(data, (size_t)cqe->res, state, &cfg, &ovr, &tz, &sch);
+        } else if (!direct->enabled && cqe->res > 0) {
+            char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+            ssize_t len = read(inotify_fd, buf, sizeof(buf));
+            if (len > 0) process_inotify(buf, (size_t)len, state, &cfg, &ovr, &tz, &sch);
         }
+        if (cfg) *events |= FLAG_CONFIG;
+        if (ovr) *events |= FLAG_OVERRIDE;
+        if (tz)  *events |= FLAG_TZ;
+        if (sch) *events |= FLAG_SCHEDULE;
         if (!more) polls->inotify = false;
         break;
+    }
     case EV_WEATHER:
-        if (cqe->res > 0) *events |= FLAG_WEATHER;
+        if (!direct->enabled) {
+            if (cqe->res > 0) *events |= FLAG_WEATHER;
+        } else if ((uint32_t)(cqe->user_data >> 32) == direct->weather_gen) {
+            /* Chunks accumulate in wfs; the loop only hears about the end.
+             * -ENOBUFS just ends this read: the data waits in the pipe. */
+            if (cqe->res > 0 && data)
+                weather_async_feed(wfs, data, cqe->res);
+            else if (cqe->res != -ENOBUFS)
+                weather_async_feed(wfs, nullptr, cqe->res > 0 ? -1 : cqe->res);
+            if (wfs->stream_end) *events |= FLAG_WEATHER;
+        } else {
+            break;      /* abandoned pipe: its slot already holds another */
+        }
         if (!more) polls->weather = false;
         break;
-    case EV_CANCEL:
+    case EV_WORKER:
+        polls->worker = false;
+        if (weather_async_reply(wfs, cqe->res)) *events |= FLAG_WEATHER;
         break;
     }
 }
 
-/* --- io_uring event loop --- */
+/* Probe and register everything direct reads need; any gap keeps the polls */
+static bool direct_reads_init(abraxas_ring_t *ring, direct_reads_t *direct,
+                              int inotify_fd, int signal_fd)
+{
+    *direct = (direct_reads_t){ .weather_fd = -1 };
+    if (!uring_probe_op(ring, URING_OP_READ_MULTISHOT)) return false;
+
+    int fds[DIRECT_SLOTS] = { [SLOT_INOTIFY] = inotify_fd, [SLOT_SIGNAL] = signal_fd,
+                              [SLOT_WEATHER] = -1 };
+    if (!uring_register_files(ring, fds, DIRECT_SLOTS)) return false;
+    if (!uring_bufs_init(ring, &direct->bufs, DIRECT_BGID, DIRECT_BUF_COUNT, DIRECT_BUF_SIZE))
+        return false;
 
-static void event_loop_uring(daemon_state_t *state, abraxas_ring_t *ring,
-                             int inotify_fd, int signal_fd)
+    direct->enabled = true;
+    return true;
+}
+
+/* --- Status page --- */
+
+/* Called once per loop iteration, after the tick has been applied */
+static void status_publish(status_page_t *page, const daemon_state_t *state,
+                           time_t now, time_t next_change)
 {
-    struct __kernel_timespec ts = {
-        .tv_sec  = TEMP_UPDATE_SEC,
-        .tv_nsec = 0
+    const ephemeris_t *e = solar_ephemeris(now, state->location.lat, state->location.lon);
+    const weather_data_t *w = &state->weather;
+
+    status_write_begin(page);
+    page->updated_at = now;
+    page->mode = state->manual_mode ? STATUS_MODE_MANUAL : STATUS_MODE_SOLAR;
+    page->temp = state->last_temp_valid ? state->last_temp : 0;
+    page->set_ok = gamma_last_ok;
+    page->next_change = next_change;
+
+    page->manual_target = state->manual_mode ? state->manual_target_temp : 0;
+    page->manual_duration = state->manual_mode ? state->manual_duration_min : 0;
+    page->manual_start = state->manual_mode ? state->manual_start_time : 0;
+    page->manual_resume = state->manual_mode ? state->manual_resume_time : 0;
+
+    page->lat = state->location.lat;
+    page->lon = state->location.lon;
+    page->elevation = ephemeris_elevation(e, now);
+    page->sunrise = e->sun.valid ? e->sun.sunrise : 0;
+    page->sunset = e->sun.valid ? e->sun.sunset : 0;
+
+    page->weather_ok = !w->has_error;
+    page->cloud_cover = weather_cloud_at(w, now);
+    page->dark = weather_is_dark(w, now);
+    page->weather_fetched_at = w->has_error ? 0 : w->fetched_at;
+    page->next_dark_change = w->has_error ? 0 : weather_next_dark_change(w, now);
+    snprintf(page->forecast, sizeof(page->forecast), "%s", w->has_error ? "" : w->forecast);
+
+    gamma_describe(page);
+    status_write_end(page);
+}
+
+/* --- Frame-rate fades --- */
+
+/* Tabulated once per fade; the frames themselves only upload */
+static fade_t fade;
+static int64_t fade_sent_ns;    /* when the frame in flight was committed */
+
+static void fade_begin(int start_temp, int target_temp, int duration_ms)
+{
+    int mhz = gamma_refresh_mhz();
+    fade_start(&fade, start_temp, target_temp, duration_ms, mhz, trace_now_ns());
+    gamma_pin_fade(fade.temp, fade.frames);
+    fprintf(stderr, "[manual] Fade: %dK -> %dK, %d frames at %.3f Hz (%s)\n",
+            start_temp, target_temp, fade.frames, 1e9 / (double)fade.period_ns,
+            gamma_state && meridian_frame_paced(gamma_state) ? "page-flip events"
+            : mhz ? "timer" : "timer, refresh rate unknown");
+}
+
+static void fade_cancel(void)
+{
+    if (!fade.active) return;
+    fade.active = false;
+    meridian_ramp_unpin();
+}
+
+/* Upload the frame that is due, unless the last one has not latched yet */
+static void fade_tick(daemon_state_t *state)
+{
+    if (!fade.active) return;
+
+    int64_t now = trace_now_ns();
+    int idx = fade_due(&fade, now);
+    if (idx < 0) return;
+
+    /* Ends of the curve move less than 1K a frame: nothing to upload */
+    if (state->last_temp_valid && fade.temp[idx] == state->last_temp) {
+        fade_shown(&fade, idx, 0);
+    } else {
+        bool stalled = now - fade_sent_ns >= FADE_STALL_FRAMES * fade.period_ns;
+        meridian_error_t err;
+        if (!gamma_frame_pending())
+            err = gamma_set_frame(fade.temp[idx]);
+        else if (stalled)
+            err = gamma_set(fade.temp[idx]) ? MERIDIAN_OK : MERIDIAN_ERR_GAMMA;
+        else
+            return;                     /* dropped; the flip event retries */
+        if (err == MERIDIAN_ERR_BUSY) return;
+
+        fade_sent_ns = now;
+        fade_shown(&fade, idx, trace_now_ns() - now);
+        state->last_temp = fade.temp[idx];
+        state->last_temp_valid = true;
+    }
+
+    if (fade_finished(&fade)) {
+        fprintf(stderr, "[manual] Fade done: %dK, %d of %d frames dropped\n",
+                fade.target_temp, fade.dropped, fade.frames);
+        fade_cancel();
+    }
+}
+
+/* --- Manual override --- */
+
+/* Enter manual mode for od. issued_at dedupes re-reads of the same
+   override.json; force applies it regardless (control socket requests). */
+static void apply_override(daemon_state_t *state, override_state_t *od, time_t now, bool force)
+{
+    if (od->active && (force || od->issued_at != state->manual_issued_at)) {
+        state->manual_mode = true;
+        state->manual_issued_at = od->issued_at;
+        state->manual_target_temp = od->target_temp;
+        state->manual_duration_min = od->duration_minutes;
+        state->manual_start_time = od->issued_at;
+        state->manual_start_temp = state->last_temp_valid
+            ? state->last_temp
+            : solar_temperature(now, state->location.lat, state->location.lon, &state->weather);
+
+        if (od->start_temp == 0) {
+            od->start_temp = state->manual_start_temp;
+            save_override_snapshot(state, od);
+        }
+
+        state->manual_resume_time = next_transition_resume(now,
+            state->location.lat, state->location.lon);
+
+        /* From what is on screen now, including mid-way through a fade */
+        fade_cancel();
+        if (od->fade_ms > 0) {
+            state->manual_duration_min = 0;
+            fade_begin(state->manual_start_temp, state->manual_target_temp, od->fade_ms);
+        } else if (state->manual_duration_min > 0)
+            fprintf(stderr, "[manual] Override: %dK -> %dK over %d min\n",
+                   state->manual_start_temp, state->manual_target_temp,
+                   state->manual_duration_min);
+        else
+            fprintf(stderr, "[manual] Override: -> %dK (instant)\n", state->manual_target_temp);
+
+        struct tm rt;
+        localtime_r(&state->manual_resume_time, &rt);
+        fprintf(stderr, "[manual] Auto-resume at: %02d:%02d\n", rt.tm_hour, rt.tm_min);
+
+    } else if (!od->active && state->manual_mode) {
+        fade_cancel();
+        state->manual_mode = false;
+        state->manual_issued_at = 0;
+        clear_override_file(state);
+        fprintf(stderr, "[manual] Override cleared, resuming solar control\n");
+    }
+}
+
+/* --- Control socket --- */
+
+/* Only the user the daemon runs as may steer it */
+static bool control_peer_allowed(int fd)
+{
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) return false;
+    return cred.uid == getuid();
+}
+
+/* Apply a parsed request. Returns false if the reply must wait (refresh). */
+static bool control_apply(daemon_state_t *state, control_conn_t *ctl, time_t now)
+{
+    const control_request_t *req = &ctl->req;
+    switch (req->op) {
+    case CONTROL_SET: {
+        override_state_t od = {
+            .active = true,
+            .target_temp = req->target_temp,
+            .duration_minutes = req->duration_minutes,
+            .issued_at = now,
+            .fade_ms = req->fade_ms,
+        };
+        apply_override(state, &od, now, true);
+        return true;
+    }
+    case CONTROL_RESUME:
+        if (state->manual_mode) {
+            override_state_t od = {0};
+            apply_override(state, &od, now, false);
+        }
+        return true;
+    case CONTROL_REFRESH:
+        return false;
+    }
+    return true;
+}
+
+static void control_fill_reply(const daemon_state_t *state, control_reply_t *reply, bool weather)
+{
+    *reply = (control_reply_t){
+        .ok = true,
+        .temp = state->last_temp_valid ? state->last_temp : 0,
+        .manual = state->manual_mode,
+        .cloud_cover = -1,
     };
+    if (state->manual_mode) {
+        reply->target_temp = state->manual_target_temp;
+        reply->duration_minutes = state->manual_duration_min;
+        reply->resume_at = state->manual_resume_time;
+    }
+    if (weather && !state->weather.has_error) {
+        reply->cloud_cover = state->weather.cloud_cover;
+        snprintf(reply->forecast, sizeof(reply->forecast), "%s", state->weather.forecast);
+    }
+}
+
+static void control_reply_now(abraxas_ring_t *ring, control_conn_t *ctl,
+                              const control_reply_t *reply)
+{
+    size_t n = control_format_reply(reply, ctl->buf, sizeof(ctl->buf));
+    uring_prep_send(ring, ctl->fd, ctl->buf, n, EV_CTL_SEND);
+    ctl->phase = CTL_SENDING;
+}
+
+/* --- Tick --- */
+
+/*
+ * One step of the daemon at 'now', shared by the event loop and
+ * daemon_simulate(): nothing here reads the clock. tick_temperature()
+ * decides, tick_due() says whether the display needs it, tick_log()
+ * and tick_apply() report and set it.
+ */
+
+/* The override curve or the solar curve; ends an override once its
+   auto-resume time has come */
+static int tick_temperature(daemon_state_t *state, time_t now)
+{
+    if (!state->manual_mode)
+        return solar_temperature(now, state->location.lat, state->location.lon,
+                                 &state->weather);
+
+    int temp = calculate_manual_temp(state->manual_start_temp, state->manual_target_temp,
+                                     state->manual_start_time, state->manual_duration_min, now);
+
+    double elapsed = difftime(now, state->manual_start_time) / 60.0;
+    if (elapsed >= (double)state->manual_duration_min &&
+        state->manual_resume_time > 0 && now >= state->manual_resume_time) {
+        state->manual_mode = false;
+        state->manual_issued_at = 0;
+        clear_override_file(state);
+        fade_cancel();
+        fprintf(stderr, "[manual] Auto-resuming solar control (transition window approaching)\n");
+        temp = solar_temperature(now, state->location.lat, state->location.lon,
+                                 &state->weather);
+    }
+    return temp;
+}
+
+/* A fade owns the display until its last frame is up */
+static bool tick_due(const daemon_state_t *state, int temp, bool reapply)
+{
+    return !fade.active && (!state->last_temp_valid || reapply || temp != state->last_temp);
+}
+
+/* Transitions step every few seconds: log at most once a minute,
+ * plus whenever a plateau or override target is reached */
+static void tick_log(const daemon_state_t *state, int temp, time_t now, bool reapply,
+                     time_t *last_log)
+{
+    bool plateau = temp == TEMP_DAY_CLEAR || temp == TEMP_DAY_DARK ||
+                   temp == TEMP_NIGHT ||
+                   (state->manual_mode && temp == state->manual_target_temp);
+    if (state->last_temp_valid && !reapply && !plateau && difftime(now, *last_log) < 60.0)
+        return;
+
+    struct tm nt;
+    localtime_r(&now, &nt);
+    if (state->manual_mode) {
+        double elapsed = difftime(now, state->manual_start_time) / 60.0;
+        if (elapsed < (double)state->manual_duration_min) {
+            int pct = (int)(elapsed / (double)state->manual_duration_min * 100.0);
+            if (pct > 100) pct = 100;
+            fprintf(stderr, "[%02d:%02d:%02d] Manual: %dK (%d%%)\n",
+                   nt.tm_hour, nt.tm_min, nt.tm_sec, temp, pct);
+        } else {
+            fprintf(stderr, "[%02d:%02d:%02d] Manual: %dK (holding)\n",
+                   nt.tm_hour, nt.tm_min, nt.tm_sec, temp);
+        }
+    } else {
+        double elevation = ephemeris_elevation(
+            solar_ephemeris(now, state->location.lat, state->location.lon), now);
+        fprintf(stderr, "[%02d:%02d:%02d] Solar: %dK (sun: %.1f, clouds: %d%%)\n",
+               nt.tm_hour, nt.tm_min, nt.tm_sec, temp, elevation,
+               weather_cloud_at(&state->weather, now));
+    }
+    *last_log = now;
+}
+
+static void tick_apply(daemon_state_t *state, int temp)
+{
+    gamma_set(temp);
+    state->last_temp = temp;
+    state->last_temp_valid = true;
+}
+
+/* --- io_uring event loop --- */
+
+/* Runs until a shutdown signal (returns 0) or a loss it cannot recover
+   from, the display or the fetch worker (returns 1) */
+static int event_loop_uring(daemon_state_t *state, abraxas_ring_t *ring,
+                             int inotify_fd, int signal_fd, int clock_fd, int control_fd,
+                             status_page_t *status)
+{
+    struct __kernel_timespec ts = { .tv_sec = 0, .tv_nsec = 0 };
+    uint32_t timeout_flags = IORING_TIMEOUT_ABS | IORING_TIMEOUT_BOOTTIME;
+    time_t armed_deadline = 0;
+    struct __kernel_timespec frame_ts = { .tv_sec = 0, .tv_nsec = 0 };
+    int64_t armed_frame_ns = 0;
+    int64_t suspend_offset = suspend_offset_ns();
+    int gamma_fds[MERIDIAN_MAX_FDS];
+    int gamma_nfds = gamma_event_fds(gamma_fds);
+    time_t last_log = 0;
+    int exit_status = 0;
+#ifndef NOAA_DISABLED
+    time_t weather_next_try = 0;    /* a failed fetch is not retried at once */
+#endif
+
+    /* abraxas-alloc-check: heap allocations from one timer, frame or flip
+     * wakeup to the next wait. The first wakeup warms up. */
+    unsigned long woke_allocs = 0, steady_allocs = 0;
+    long steady_wakeups = 0;
+    bool steady = false, warm = false;
 
     weather_fetch_state_t wfs;
-    weather_async_init(&wfs);
+    gridpoint_cache_t grid = config_load_gridpoint(&state->paths);
+    weather_async_init(&wfs, &grid);
     poll_state_t polls = {0};
+    direct_reads_t direct;
+    if (direct_reads_init(ring, &direct, inotify_fd, signal_fd))
+        fprintf(stderr, "[kernel] io_uring: multishot reads into %u x %u B provided buffers\n",
+                DIRECT_BUF_COUNT, DIRECT_BUF_SIZE);
+    else
+        fprintf(stderr, "[kernel] io_uring: multishot READ unavailable, polling fds\n");
+    control_conn_t ctl = {
+        .listen_fd = control_fd,
+        .fd = -1,
+        .recv_timeout = { .tv_sec = CONTROL_RECV_TIMEOUT_SEC },
+    };
 
     while (1) {
-        /* Register multi-shot polls only when not alive */
+        /* Control socket: accept -> check peer -> recv -> reply -> close */
+        if (ctl.phase == CTL_CLOSING) {
+            close(ctl.fd);
+            ctl.fd = -1;
+            ctl.phase = CTL_IDLE;
+        }
+        if (ctl.phase == CTL_CONNECTED) {
+            if (!control_peer_allowed(ctl.fd)) {
+                close(ctl.fd);
+                ctl.fd = -1;
+                ctl.phase = CTL_IDLE;
+            } else {
+                uring_prep_recv(ring, ctl.fd, ctl.buf, sizeof(ctl.buf), EV_CTL_RECV,
+                                &ctl.recv_timeout, EV_CTL_TIMEOUT);
+                ctl.phase = CTL_RECEIVING;
+            }
+        }
+        if (ctl.listen_fd >= 0 && ctl.phase == CTL_IDLE) {
+            if (ctl.failures >= CONTROL_ACCEPT_MAX_FAILURES) {
+                fprintf(stderr, "[warn] control socket: accept keeps failing, disabled\n");
+                ctl.listen_fd = -1;
+            } else {
+                uring_prep_accept(ring, ctl.listen_fd, EV_CTL_ACCEPT);
+                ctl.phase = CTL_ACCEPTING;
+            }
+        }
+
+        /* Register multi-shot reads/polls only when not alive */
         if (inotify_fd >= 0 && !polls.inotify) {
-            uring_prep_poll(ring, inotify_fd, EV_INOTIFY);
+            if (direct.enabled)
+                uring_prep_read_multishot(ring, SLOT_INOTIFY, DIRECT_BGID, EV_INOTIFY, nullptr);
+            else
+                uring_prep_poll(ring, inotify_fd, EV_INOTIFY);
             polls.inotify = true;
         }
         if (signal_fd >= 0 && !polls.signal) {
-            uring_prep_poll(ring, signal_fd, EV_SIGNAL);
+            if (direct.enabled)
+                uring_prep_read_multishot(ring, SLOT_SIGNAL, DIRECT_BGID, EV_SIGNAL, nullptr);
+            else
+                uring_prep_poll(ring, signal_fd, EV_SIGNAL);
             polls.signal = true;
         }
         if (wfs.pipe_fd >= 0 && !polls.weather) {
-            uring_prep_poll(ring, wfs.pipe_fd, EV_WEATHER);
+            /* Each arm reinstalls the pipe: its fd number may be reused */
+            if (direct.enabled) {
+                direct.weather_fd = wfs.pipe_fd;
+                direct.weather_gen++;
+                uring_prep_read_multishot(ring, SLOT_WEATHER, DIRECT_BGID,
+                                          EV_WEATHER | (uint64_t)direct.weather_gen << 32,
+                                          &direct.weather_fd);
+            } else {
+                uring_prep_poll(ring, wfs.pipe_fd, EV_WEATHER);
+            }
             polls.weather = true;
         }
+        /* Fetch worker replies: the "S" carries the next pipe */
+        int worker_fd = weather_worker_fd();
+        if (worker_fd >= 0 && !polls.worker) {
+            uring_prep_recvmsg(ring, worker_fd, weather_worker_msghdr(), MSG_CMSG_CLOEXEC,
+                               EV_WORKER);
+            polls.worker = true;
+        }
+        if (clock_fd >= 0 && !polls.clock) {
+            uring_prep_poll(ring, clock_fd, EV_CLOCK);
+            polls.clock = true;
+        }
+        for (int i = 0; i < gamma_nfds; i++) {
+            if (polls.gamma[i]) continue;
+            uring_prep_poll(ring, gamma_fds[i], EV_GAMMA | (uint64_t)i << 32);
+            polls.gamma[i] = true;
+        }
 
-        /* Fresh timeout each iteration (one-shot) */
-        uring_prep_timeout(ring, &ts, EV_TIMEOUT);
+        /* Pre-5.15 kernel: no BOOTTIME timeouts, fall back to MONOTONIC */
+        if (polls.timeout_rejected) {
+            polls.timeout_rejected = false;
+            if (!(timeout_flags & IORING_TIMEOUT_BOOTTIME)) {
+                fprintf(stderr, "[fatal] io_uring absolute timeouts unsupported\n");
+                break;
+            }
+            timeout_flags &= ~IORING_TIMEOUT_BOOTTIME;
+            fprintf(stderr, "[kernel] io_uring: BOOTTIME timeouts unsupported, using MONOTONIC\n");
+        }
 
+        /* One long-lived absolute deadline: arm when idle, otherwise move it
+         * in place. An unchanged deadline costs no SQE at all. */
+        time_t wake_now = time(nullptr);
+        time_t deadline = next_wakeup(state, wfs.phase == WEATHER_IDLE, wake_now);
+        if (!polls.timeout || deadline != armed_deadline) {
+            deadline_to_timespec(deadline, timeout_flags, &ts);
+            if (polls.timeout)
+                uring_prep_timeout_update(ring, &ts, EV_TIMEOUT, timeout_flags,
+                                          EV_TIMEOUT_UPD);
+            else
+                uring_prep_timeout(ring, &ts, timeout_flags, EV_TIMEOUT);
+            polls.timeout = true;
+            armed_deadline = deadline;
+
+            int next_temp = scheduled_temperature(state, deadline);
+            if (next_temp > 0 && (!state->last_temp_valid || next_temp != state->last_temp))
+                gamma_prepare(next_temp);
+        }
+
+        /* Fade frames: one absolute MONOTONIC timer, moved like the deadline.
+         * A frame still waiting for its flip event is retried a quarter
+         * period later rather than spinning on a deadline in the past. */
+        if (fade.active) {
+            int64_t mono = trace_now_ns();
+            int64_t at = fade_next_ns(&fade);
+            if (at <= mono) at = mono + fade.period_ns / 4;
+            if (!polls.frame || at != armed_frame_ns) {
+                frame_ts.tv_sec  = at / 1000000000LL;
+                frame_ts.tv_nsec = at % 1000000000LL;
+                if (polls.frame)
+                    uring_prep_timeout_update(ring, &frame_ts, EV_FRAME, IORING_TIMEOUT_ABS,
+                                              EV_FRAME_UPD);
+                else
+                    uring_prep_timeout(ring, &frame_ts, IORING_TIMEOUT_ABS, EV_FRAME);
+                polls.frame = true;
+                armed_frame_ns = at;
+            }
+        }
+
+        if (status) status_publish(status, state, wake_now, deadline);
+
+        if (steady) {
+            unsigned long n = alloc_count() - woke_allocs;
+            if (n)
+                fprintf(stderr, "[warn] alloc-check: steady-state wakeup made %lu heap "
+                        "allocation(s)\n", n);
+            steady_allocs += n;
+            steady_wakeups++;
+        }
+
+        TRACE1(loop_wait, deadline);
         int ret = uring_submit_and_wait(ring);
         if (ret < 0 && errno != EINTR) break;
+        int64_t wake_ns = trace_now_ns();
+        woke_allocs = alloc_count();
 
         /* Process all CQEs through unified handler */
         _Atomic uint32_t events = 0;
         struct io_uring_cqe *cqe;
         while (uring_peek_cqe(ring, &cqe)) {
-            process_cqe(cqe, &events, &polls, inotify_fd, state);
+            process_cqe(cqe, &events, &polls, &ctl, &direct, &wfs,
+                        inotify_fd, signal_fd, state);
+            if (direct.enabled) uring_bufs_recycle(&direct.bufs, cqe);
             uring_cqe_seen(ring);
         }
 
         uint32_t flags = events;
-
-        /* Cancel timeout if woke early -- drain through same handler */
-        if (!(flags & FLAG_TIMER)) {
-            uring_prep_cancel(ring, EV_TIMEOUT, EV_CANCEL);
-            uring_submit_and_wait(ring);
-            while (uring_peek_cqe(ring, &cqe)) {
-                process_cqe(cqe, &events, &polls, inotify_fd, state);
-                uring_cqe_seen(ring);
-            }
-            flags = events;
+        int64_t drained_ns = trace_now_ns();
+        /* Anything else reads files, parses or talks to a client */
+        steady = warm && !(flags & ~(FLAG_TIMER | FLAG_FRAME | FLAG_GAMMA));
+        warm = true;
+        TRACE2(cqe_done, flags, drained_ns - wake_ns);
+        trace_record(LAT_CQE, drained_ns - wake_ns);
+
+        /* How far past the armed deadline the timeout CQE was reaped */
+        if (flags & FLAG_TIMER) {
+            clockid_t clk = (timeout_flags & IORING_TIMEOUT_BOOTTIME) ? CLOCK_BOOTTIME
+                                                                     : CLOCK_MONOTONIC;
+            int64_t late = clock_ns(clk) - ((int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec);
+            TRACE1(timer_late, late);
+            trace_record(LAT_TIMER_LATE, late);
         }
 
+        if (flags & FLAG_DUMP) trace_dump(stderr);
         if (flags & FLAG_SIGNAL) {
-            /* Drain signalfd so it doesn't refire */
-            if (signal_fd >= 0) {
-                struct signalfd_siginfo si;
-                ssize_t n = read(signal_fd, &si, sizeof(si));
-                (void)n;
-            }
             fprintf(stderr, "\nReceived shutdown signal...\n");
             weather_async_cleanup(&wfs);
             break;
         }
 
+        /* Backend replies and display hotplug, never blocks */
+        bool reapply = false;
+        if ((flags & FLAG_GAMMA) && !gamma_dispatch()) {
+            /* Display connection gone (compositor restart): start over.
+             * Cancelled polls re-arm on the new fds once their CQEs land;
+             * the cancel requests themselves complete untagged. */
+            for (int i = 0; i < gamma_nfds; i++)
+                if (polls.gamma[i])
+                    uring_prep_cancel(ring, EV_GAMMA | (uint64_t)i << 32, 0);
+            steady = false;
+            gamma_cleanup();
+            if (!gamma_init()) {
+                fprintf(stderr, "[fatal] Gamma backend lost\n");
+                weather_async_cleanup(&wfs);
+                exit_status = 1;
+                break;
+            }
+            gamma_nfds = gamma_event_fds(gamma_fds);
+            reapply = true;
+        }
+
+        /* Wall clock jumped or we resumed from suspend: displays may have
+         * lost their ramps and the wall->deadline mapping has moved. */
+        int64_t offset = suspend_offset_ns();
+        bool resumed = offset - suspend_offset >= RESUME_JUMP_NS;
+        if (flags & FLAG_CLOCK) {
+            uint64_t expirations;
+            ssize_t n = read(clock_fd, &expirations, sizeof(expirations));
+            (void)n; /* -ECANCELED is the expected result */
+            arm_clock_watch(clock_fd);
+        }
+        if (resumed || (flags & FLAG_CLOCK)) {
+            if (resumed)
+                fprintf(stderr, "[kernel] Resumed after %.0fs suspend, reapplying\n",
+                        (double)(offset - suspend_offset) / 1e9);
+            else
+                fprintf(stderr, "[kernel] Wall clock changed, reapplying\n");
+            suspend_offset = offset;
+            steady = false;
+            reapply = true;
+            armed_deadline = 0;
+            ephemeris_invalidate(&ephem);
+        }
+
+        if (flags & FLAG_TZ) {
+            reload_timezone();
+            fprintf(stderr, "[inotify] /etc/localtime changed, timezone reloaded\n");
+            ephemeris_invalidate(&ephem);
+            armed_deadline = 0;
+        }
+
         /* --- Common tick processing --- */
 
         time_t now = time(nullptr);
@@ -289,58 +1378,67 @@ static void event_loop_uring(daemon_state_t *state, abraxas_ring_t *ring,
                 fprintf(stderr, "[config] Location updated: %.4f, %.4f\n",
                        state->location.lat, state->location.lon);
             }
-            state->weather = config_load_weather_cache(&state->paths);
+            snap.location = new_loc;
+            snap_took(&state->paths, SNAP_CONFIG);
+            /* Usually our own last write, already held */
+            if (!snap_fresh(&state->paths, SNAP_WEATHER)) {
+                state->weather = config_load_weather_cache(&state->paths);
+                snap.weather = state->weather;
+                snap_took(&state->paths, SNAP_WEATHER);
+            }
+            ephemeris_invalidate(&ephem);
+        }
+
+        if (flags & FLAG_SCHEDULE) {
+            fprintf(stderr, "[inotify] schedule.bin replaced, remapping\n");
+            schedule_load(state);
+            ephemeris_invalidate(&ephem);
         }
 
         if (flags & FLAG_OVERRIDE) {
             override_state_t od = config_load_override(&state->paths);
+            snap.override = od;
+            snap_took(&state->paths, SNAP_OVERRIDE);
+            apply_override(state, &od, now, false);
+        }
 
-            if (od.active && od.issued_at != state->manual_issued_at) {
-                state->manual_mode = true;
-                state->manual_issued_at = od.issued_at;
-                state->manual_target_temp = od.target_temp;
-                state->manual_duration_min = od.duration_minutes;
-                state->manual_start_time = od.issued_at;
-                state->manual_start_temp = state->last_temp_valid
-                    ? state->last_temp
-                    : solar_temperature(now, state->location.lat, state->location.lon, &state->weather);
-
-                if (od.start_temp == 0) {
-                    od.start_temp = state->manual_start_temp;
-                    config_save_override(&state->paths, &od);
-                }
-
-                state->manual_resume_time = next_transition_resume(now,
-                    state->location.lat, state->location.lon);
-
-                if (state->manual_duration_min > 0)
-                    fprintf(stderr, "[manual] Override: %dK -> %dK over %d min\n",
-                           state->manual_start_temp, state->manual_target_temp,
-                           state->manual_duration_min);
-                else
-                    fprintf(stderr, "[manual] Override: -> %dK (instant)\n", state->manual_target_temp);
-
-                struct tm rt;
-                localtime_r(&state->manual_resume_time, &rt);
-                fprintf(stderr, "[manual] Auto-resume at: %02d:%02d\n", rt.tm_hour, rt.tm_min);
-
-            } else if (!od.active && state->manual_mode) {
-                state->manual_mode = false;
-                state->manual_issued_at = 0;
-                config_clear_override(&state->paths);
-                fprintf(stderr, "[manual] Override cleared, resuming solar control\n");
+        [[maybe_unused]] bool ctl_waits_weather = false;
+        if (flags & FLAG_CONTROL) {
+            if (!control_parse_request(ctl.buf, (size_t)ctl.len, &ctl.req)) {
+                ctl.reply = (control_reply_t){ .cloud_cover = -1 };
+                snprintf(ctl.reply.error, sizeof(ctl.reply.error), "bad request");
+                control_reply_now(ring, &ctl, &ctl.reply);
+            } else if (control_apply(state, &ctl, now)) {
+                ctl.phase = CTL_REQUEST;
+            } else {
+#ifndef NOAA_DISABLED
+                ctl.phase = CTL_WAIT_WEATHER;
+                ctl_waits_weather = true;
+#else
+                ctl.reply = (control_reply_t){ .cloud_cover = -1 };
+                snprintf(ctl.reply.error, sizeof(ctl.reply.error), "weather support not built");
+                control_reply_now(ring, &ctl, &ctl.reply);
+#endif
             }
         }
 
 #ifndef NOAA_DISABLED
-        /* Start async weather fetch if needed and not in-flight */
-        if (wfs.phase == WEATHER_IDLE && config_weather_needs_refresh(&state->weather)) {
+        /* Start async weather fetch if needed and not in-flight. A failed
+           fetch still needs a refresh on every wakeup after it, so the next
+           attempt waits WEATHER_RETRY_SEC; --refresh does not wait. */
+        if (wfs.phase == WEATHER_IDLE &&
+            (ctl_waits_weather ||
+             (now >= weather_next_try && config_weather_needs_refresh(&state->weather)))) {
+            weather_next_try = now + WEATHER_RETRY_SEC;
             struct tm nt;
             localtime_r(&now, &nt);
             fprintf(stderr, "[%02d:%02d:%02d] Starting weather fetch...\n",
                     nt.tm_hour, nt.tm_min, nt.tm_sec);
-            (void)weather_async_start(&wfs, state->location.lat, state->location.lon);
-            polls.weather = false; /* new pipe_fd needs registration */
+            (void)weather_async_start(&wfs, state->location.lat, state->location.lon,
+                                      &state->weather);
+            polls.weather = false; /* the worker's reply brings a new pipe_fd */
+            if (wfs.phase == WEATHER_IDLE && ctl.phase == CTL_WAIT_WEATHER)
+                ctl.phase = CTL_REQUEST;    /* could not start: report what we hold */
         }
 
         /* Process async weather data if pipe signaled */
@@ -350,83 +1448,105 @@ static void event_loop_uring(daemon_state_t *state, abraxas_ring_t *ring,
             if (rc == -1) {
                 /* Done (success or error) */
                 state->weather = result;
-                config_save_weather_cache(&state->paths, &state->weather);
+                save_weather_cache(state);
                 if (!state->weather.has_error)
                     fprintf(stderr, "  Weather: %s (%d%% clouds)\n",
                            state->weather.forecast, state->weather.cloud_cover);
                 else
                     fprintf(stderr, "  Weather fetch failed\n");
                 polls.weather = false;
+            } else if (rc == 2) {
+                /* 304: the data we hold is current as of now */
+                state->weather.fetched_at = now;
+                save_weather_cache(state);
+                fprintf(stderr, "  Weather unchanged\n");
+                polls.weather = false;
             }
+            if ((rc < 0 || rc == 2) && wfs.grid_dirty) {
+                config_save_gridpoint(&state->paths, &wfs.grid);
+                wfs.grid_dirty = false;
+            }
+            if ((rc < 0 || rc == 2) && ctl.phase == CTL_WAIT_WEATHER)
+                ctl.phase = CTL_REQUEST;
+            /* Let go of the finished pipe; the slot keeps it open otherwise */
+            if ((rc < 0 || rc == 2) && direct.enabled)
+                uring_prep_files_update(ring, SLOT_WEATHER, &no_fd, 0);
             /* rc==0: EAGAIN, multi-shot poll still alive */
-            if (rc == 1) polls.weather = false; /* phase transition, new pipe_fd */
+            if (rc == 1) polls.weather = false; /* phase transition, next pipe_fd to come */
         }
-#endif
 
-        int temp;
-        if (state->manual_mode) {
-            temp = calculate_manual_temp(state->manual_start_temp, state->manual_target_temp,
-                                         state->manual_start_time, state->manual_duration_min, now);
-
-            double elapsed = difftime(now, state->manual_start_time) / 60.0;
-            if (elapsed >= (double)state->manual_duration_min &&
-                state->manual_resume_time > 0 && now >= state->manual_resume_time) {
-                state->manual_mode = false;
-                state->manual_issued_at = 0;
-                config_clear_override(&state->paths);
-                fprintf(stderr, "[manual] Auto-resuming solar control (transition window approaching)\n");
-                temp = solar_temperature(now, state->location.lat, state->location.lon,
-                                         &state->weather);
-            }
-        } else {
-            temp = solar_temperature(now, state->location.lat, state->location.lon,
-                                     &state->weather);
+        /* No weather without a worker; the service manager brings both back */
+        if (weather_worker_lost()) {
+            weather_async_cleanup(&wfs);
+            exit_status = 1;
+            break;
         }
+#endif
 
-        if (!state->last_temp_valid || temp != state->last_temp) {
-            struct tm nt;
-            localtime_r(&now, &nt);
+        /* Flip events arrive as FLAG_GAMMA, the frame timer as FLAG_FRAME;
+         * either way the clock decides which frame is due */
+        fade_tick(state);
 
-            if (state->manual_mode) {
-                double elapsed = difftime(now, state->manual_start_time) / 60.0;
-                if (elapsed < (double)state->manual_duration_min) {
-                    int pct = (int)(elapsed / (double)state->manual_duration_min * 100.0);
-                    if (pct > 100) pct = 100;
-                    fprintf(stderr, "[%02d:%02d:%02d] Manual: %dK (%d%%)\n",
-                           nt.tm_hour, nt.tm_min, nt.tm_sec, temp, pct);
-                } else {
-                    fprintf(stderr, "[%02d:%02d:%02d] Manual: %dK (holding)\n",
-                           nt.tm_hour, nt.tm_min, nt.tm_sec, temp);
-                }
-            } else {
-                sun_position_t sp = solar_position(now, state->location.lat, state->location.lon);
-                fprintf(stderr, "[%02d:%02d:%02d] Solar: %dK (sun: %.1f, clouds: %d%%)\n",
-                       nt.tm_hour, nt.tm_min, nt.tm_sec, temp, sp.elevation,
-                       state->weather.cloud_cover);
-            }
+        int temp = tick_temperature(state, now);
+        if (tick_due(state, temp, reapply)) {
+            tick_log(state, temp, now, reapply, &last_log);
+
+            int64_t decided_ns = trace_now_ns();
+            trace_record(LAT_UPDATE, decided_ns - drained_ns);
+            TRACE2(tick_start, temp, decided_ns - wake_ns);
 
-            gamma_set(temp);
-            state->last_temp = temp;
-            state->last_temp_valid = true;
+            tick_apply(state, temp);
+
+            int64_t tick_ns = trace_now_ns() - wake_ns;
+            TRACE2(tick_done, temp, tick_ns);
+            trace_record(LAT_TICK, tick_ns);
+        } else {
+            trace_record(LAT_UPDATE, trace_now_ns() - drained_ns);
         }
+
+        /* Reply with what was just applied, so the CLI sees the real outcome */
+        if (ctl.phase == CTL_REQUEST) {
+            control_fill_reply(state, &ctl.reply, ctl.req.op == CONTROL_REFRESH);
+            control_reply_now(ring, &ctl, &ctl.reply);
+        }
+
+        snap_flush(state, false);
     }
+
+    if (alloc_count_available())
+        fprintf(stderr, "[alloc-check] %ld steady-state wakeups, %lu heap allocations\n",
+                steady_wakeups, steady_allocs);
+
+    uring_bufs_destroy(ring, &direct.bufs);
+
+    if (ctl.fd >= 0) close(ctl.fd);
+    return exit_status;
 }
 
 /* --- Main entry point --- */
 
-void daemon_run(daemon_state_t *state)
+int daemon_run(daemon_state_t *state, const snapshot_t *loaded)
 {
+    snap = loaded ? *loaded : (snapshot_t){0};
+    if (!snap_fresh(&state->paths, SNAP_CONFIG)) {
+        snap.location = state->location;
+        snap_took(&state->paths, SNAP_CONFIG);
+    }
+
     fprintf(stderr, "Starting abraxas daemon\n");
     fprintf(stderr, "Location: %.4f, %.4f\n", state->location.lat, state->location.lon);
-    fprintf(stderr, "Weather refresh: every %d min\n", WEATHER_REFRESH_SEC / 60);
-    fprintf(stderr, "Temperature update: every %ds\n", TEMP_UPDATE_SEC);
+    fprintf(stderr, "Weather refresh: forecast older than %dh or under %dh ahead\n",
+            WEATHER_MAX_AGE_SEC / 3600, WEATHER_MIN_HORIZON_SEC / 3600);
+    fprintf(stderr, "Temperature update: on each %dK step (event-driven)\n", TEMP_STEP_K);
+    pin_timezone();
+    schedule_load(state);
 
     /* Block SIGTERM/SIGINT immediately and create signalfd.
      * Must happen before gamma retry so SIGTERM is never lost during init.
      * The signalfd is polled between gamma retries and consumed in the event loop. */
     int signal_fd = create_signalfd_masked();
     if (signal_fd >= 0)
-        fprintf(stderr, "[kernel] signalfd created (fd=%d)\n", signal_fd);
+        fprintf(stderr, "[kernel] signalfd created (fd=%d, SIGUSR1 dumps latency)\n", signal_fd);
     else
         fprintf(stderr, "[warn] signalfd failed\n");
 
@@ -435,7 +1555,7 @@ void daemon_run(daemon_state_t *state)
     constexpr int  GAMMA_INIT_MAX_RETRIES = 60;
     constexpr long GAMMA_INIT_RETRY_NS    = 500000000L; /* 500ms */
     for (int attempt = 0; attempt < GAMMA_INIT_MAX_RETRIES; attempt++) {
-        if (gamma_init()) break;
+        if (gamma_init_probed(&state->paths)) break;
         if (attempt == GAMMA_INIT_MAX_RETRIES - 1) {
             fprintf(stderr, "[fatal] No gamma backend after 30s\n");
             exit(1);
@@ -457,13 +1577,25 @@ void daemon_run(daemon_state_t *state)
     config_write_pid(&state->paths);
 
     /* Load cached data */
-    state->weather = config_load_weather_cache(&state->paths);
+    if (snap_fresh(&state->paths, SNAP_WEATHER)) {
+        state->weather = snap.weather;
+    } else {
+        state->weather = config_load_weather_cache(&state->paths);
+        snap.weather = state->weather;
+        snap_took(&state->paths, SNAP_WEATHER);
+    }
 
-    /* Apply correct temperature immediately at startup */
-    int startup_temp = solar_temperature(time(nullptr),
-        state->location.lat, state->location.lon, &state->weather);
+    /* Apply correct temperature immediately at startup. Right after a
+     * restart the snapshot knows what was on screen, override or fade
+     * included; the first tick corrects it if that has moved on. */
+    time_t started = time(nullptr);
+    bool restored = snap.last_temp > 0 && started - snap.saved_at >= 0 &&
+                    started - snap.saved_at < RESTORE_TEMP_MAX_AGE_SEC;
+    int startup_temp = restored ? snap.last_temp
+        : solar_temperature(started, state->location.lat, state->location.lon, &state->weather);
     gamma_set(startup_temp);
-    fprintf(stderr, "[startup] Applied %dK\n", startup_temp);
+    snap.last_temp = startup_temp;
+    fprintf(stderr, "[startup] Applied %dK%s\n", startup_temp, restored ? " (from snapshot)" : "");
 
     /* Init weather subsystem */
     weather_init();
@@ -475,6 +1607,27 @@ void daemon_run(daemon_state_t *state)
     else
         fprintf(stderr, "[warn] inotify failed, config changes require restart\n");
 
+    int clock_fd = create_clock_watch();
+    if (clock_fd >= 0)
+        fprintf(stderr, "[kernel] timerfd watching wall clock / resume (fd=%d)\n", clock_fd);
+    else
+        fprintf(stderr, "[warn] timerfd failed, resume detected on next wakeup only\n");
+
+    /* Control socket for --set / --resume / --refresh */
+    int control_fd = control_listen(state->paths.control_socket);
+    if (control_fd >= 0)
+        fprintf(stderr, "[kernel] control socket %s (fd=%d)\n", state->paths.control_socket, control_fd);
+    else
+        fprintf(stderr, "[warn] control socket failed (%s), CLI falls back to override.json\n",
+                strerror(errno));
+
+    status_page_t *status = status_open(state->paths.status_page);
+    if (status)
+        fprintf(stderr, "[kernel] status page %s (seqlock, %zu bytes)\n",
+                state->paths.status_page, sizeof(*status));
+    else
+        fprintf(stderr, "[warn] status page failed, --status will recompute\n");
+
     /* prctl hardening */
     prctl(PR_SET_TIMERSLACK, 1);         /* 1ns timer precision (default 50us) */
     prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
@@ -494,11 +1647,18 @@ void daemon_run(daemon_state_t *state)
         fprintf(stderr, "[kernel] seccomp: filter install failed\n");
 
     /* Recover from active override on restart */
-    override_state_t ovr = config_load_override(&state->paths);
+    override_state_t ovr;
+    if (snap_fresh(&state->paths, SNAP_OVERRIDE)) {
+        ovr = snap.override;
+    } else {
+        ovr = config_load_override(&state->paths);
+        snap.override = ovr;
+        snap_took(&state->paths, SNAP_OVERRIDE);
+    }
     if (ovr.active) {
         double elapsed = difftime(time(nullptr), ovr.issued_at) / 60.0;
         if (elapsed >= (double)ovr.duration_minutes) {
-            config_clear_override(&state->paths);
+            clear_override_file(state);
             fprintf(stderr, "[manual] Cleared stale override (completed %.0f min ago)\n",
                    elapsed - (double)ovr.duration_minutes);
         } else {
@@ -512,7 +1672,7 @@ void daemon_run(daemon_state_t *state)
                 state->manual_start_temp = solar_temperature(time(nullptr),
                     state->location.lat, state->location.lon, &state->weather);
                 ovr.start_temp = state->manual_start_temp;
-                config_save_override(&state->paths, &ovr);
+                save_override_snapshot(state, &ovr);
             }
             state->manual_resume_time = next_transition_resume(time(nullptr),
                 state->location.lat, state->location.lon);
@@ -527,21 +1687,182 @@ void daemon_run(daemon_state_t *state)
 
     /* io_uring event loop (no fallback -- requires kernel >= 5.1) */
     abraxas_ring_t ring;
-    if (!uring_init(&ring, 8)) {
+    if (!uring_init(&ring, 16)) {
         fprintf(stderr, "[fatal] io_uring_setup failed (kernel >= 5.1 required)\n");
         exit(1);
     }
     fprintf(stderr, "[kernel] io_uring initialized (multi-shot)\n\n");
-    event_loop_uring(state, &ring, inotify_fd, signal_fd);
+    int result = event_loop_uring(state, &ring, inotify_fd, signal_fd, clock_fd, control_fd,
+                                  status);
     uring_destroy(&ring);
 
     /* Clean shutdown */
     fprintf(stderr, "Shutting down...\n");
+    snap_flush(state, true);
     weather_cleanup();
     gamma_restore();
     gamma_cleanup();
     config_remove_pid(&state->paths);
+    status_close(status);
+    schedule_close(&sched);
 
     if (inotify_fd >= 0) close(inotify_fd);
+    if (clock_fd >= 0)   close(clock_fd);
     if (signal_fd >= 0)  close(signal_fd);
+    if (control_fd >= 0) {
+        close(control_fd);
+        unlink(state->paths.control_socket);
+    }
+    return result;
+}
+
+/* --- Simulation --- */
+
+typedef struct {
+    FILE  *out;
+    time_t now;             /* virtual clock */
+} sim_recorder_t;
+
+/* Null backend callback: one line per output per applied ramp, with the
+   top entry of each channel (the white point it was scaled to) */
+static void sim_record(void *ctx, int crtc_idx, int temp, float brightness,
+                       const meridian_ramp_t *ramp, int gamma_size)
+{
+    const sim_recorder_t *rec = ctx;
+    if (!rec->out) return;
+    struct tm t;
+    localtime_r(&rec->now, &t);
+    fprintf(rec->out, "%04d-%02d-%02dT%02d:%02d:%02d crtc%d ",
+            t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec,
+            crtc_idx);
+    if (!ramp)
+        fprintf(rec->out, "restore\n");
+    else
+        fprintf(rec->out, "%dK %.2f %u %u %u\n", temp, (double)brightness,
+                ramp->r[gamma_size - 1], ramp->g[gamma_size - 1], ramp->b[gamma_size - 1]);
+}
+
+/* What a --set, --resume or forecast change would have done at 'now'.
+   Fades are applied as instant overrides: frames run on the monotonic
+   clock, which a simulation does not move. */
+static void sim_apply_event(daemon_state_t *state, const sim_event_t *ev, time_t now)
+{
+    switch (ev->kind) {
+    case SIM_SET: {
+        override_state_t od = {
+            .active = true,
+            .target_temp = ev->temp,
+            .duration_minutes = ev->minutes,
+            .issued_at = now,
+        };
+        apply_override(state, &od, now, true);
+        break;
+    }
+    case SIM_RESUME:
+        if (state->manual_mode) {
+            override_state_t od = {0};
+            apply_override(state, &od, now, false);
+        }
+        break;
+    case SIM_CLOUDS:
+        state->weather.cloud_cover = ev->clouds;
+        state->weather.fetched_at = now;
+        fprintf(stderr, "[sim] Weather: %d%% clouds\n", ev->clouds);
+        break;
+    }
+}
+
+static void sim_format_date(char *buf, size_t cap, time_t when)
+{
+    struct tm t;
+    localtime_r(&when, &t);
+    snprintf(buf, cap, "%04d-%02d-%02d %02d:%02d",
+             t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min);
+}
+
+int daemon_simulate(daemon_state_t *state, const sim_options_t *opt)
+{
+    /* Tens of thousands of log lines: one write per buffer, not per line */
+    static char log_buf[1 << 16];
+    setvbuf(stderr, log_buf, _IOFBF, sizeof(log_buf));
+
+    static sim_recorder_t rec;
+    rec = (sim_recorder_t){ .out = opt->record, .now = opt->start };
+    meridian_null_config_t cfg = {
+        .outputs = 1,
+        .record = opt->record || opt->alloc_stats ? sim_record : nullptr,
+        .ctx = &rec,
+    };
+    meridian_error_t err = meridian_init_null(&cfg, &gamma_state);
+    if (err != MERIDIAN_OK) {
+        fprintf(stderr, "[libmeridian] Init failed: %s\n", meridian_strerror(err));
+        return 1;
+    }
+    simulating = true;
+
+    /* Clear sky until a clouds event says otherwise */
+    state->weather = (weather_data_t){ .fetched_at = opt->start };
+    snprintf(state->weather.forecast, sizeof(state->weather.forecast), "Simulated");
+
+    char from[64], to[64];
+    sim_format_date(from, sizeof(from), opt->start);
+    sim_format_date(to, sizeof(to), opt->end);
+    fprintf(stderr, "[sim] %s -> %s at %.4f, %.4f (%d events)\n",
+            from, to, state->location.lat, state->location.lon, opt->event_count);
+    pin_timezone();
+    schedule_load(state);
+
+    time_t now = opt->start;
+    time_t last_log = 0;
+    int next_event = 0;
+    long ticks = 0, sets = 0;
+    int64_t t0 = trace_now_ns();
+
+    while (now < opt->end) {
+        rec.now = now;
+        for (; next_event < opt->event_count && opt->events[next_event].at <= now; next_event++)
+            sim_apply_event(state, &opt->events[next_event], now);
+
+        sim_alloc_stats_t *st = now >= opt->count_from ? opt->alloc_stats : nullptr;
+        unsigned long allocs = st ? alloc_count() : 0;
+        bool set = false;
+
+        int temp = tick_temperature(state, now);
+        if (tick_due(state, temp, false)) {
+            tick_log(state, temp, now, false, &last_log);
+            tick_apply(state, temp);
+            set = true;
+            sets++;
+        }
+        ticks++;
+
+        /* The deadline the event loop would have armed, or the next event */
+        time_t next = next_wakeup(state, false, now);
+        if (st) {
+            st->allocs += alloc_count() - allocs;
+            st->sets += set;
+            st->ticks++;
+        }
+        if (next_event < opt->event_count && opt->events[next_event].at < next)
+            next = opt->events[next_event].at;
+        now = next;
+    }
+
+    double secs = (double)(trace_now_ns() - t0) / 1e9;
+    rec.now = opt->end;
+    gamma_restore();
+    gamma_cleanup();
+    schedule_close(&sched);
+    ephemeris_invalidate(&ephem);
+    simulating = false;
+
+    double days = difftime(opt->end, opt->start) / 86400.0;
+    fprintf(stderr, "[sim] %.1f days: %ld ticks, %ld set, %.1f ms (%.0f ticks/s)\n",
+            days, ticks, sets, secs * 1e3, secs > 0 ? (double)ticks / secs : 0.0);
+    fflush(stderr);
+    if (opt->record && fflush(opt->record) != 0) {
+        fprintf(stderr, "[sim] Could not write the ramp record\n");
+        return 1;
+    }
+    return 0;
 }
@@ -0,0 +1,216 @@
+/*
+ * ephemeris.c - Per-day solar ephemeris and minute temperature tables
+ *
+ * Built once per local day: one sunrise/sunset solve, then the clear and
+ * dark sigmoid curves and the sun elevation (one batch solve) sampled at
+ * every minute from local midnight. Each curve is also reduced to the
+ * seconds where calculate_solar_temp() changes, found by bisecting the
+ * minutes whose ends differ, so the tick path (temp, elevation, next
+ * change) is table lookups: no libm, no localtime, nothing cached.
+ */
+
+#define _GNU_SOURCE
+
+#include "ephemeris.h"
+#include "abraxas.h"
+#include "sigmoid.h"
+
+#include <stdlib.h>
+
+/* Start of the local day after 'lt' (23, 24 or 25h later with DST) */
+static time_t next_local_midnight(const struct tm *lt)
+{
+    struct tm base = {
+        .tm_year = lt->tm_year, .tm_mon = lt->tm_mon, .tm_mday = lt->tm_mday + 1,
+        .tm_hour = 0, .tm_min = 0, .tm_sec = 0, .tm_isdst = -1
+    };
+    return mktime(&base);
+}
+
+void ephemeris_day_bounds(time_t now, time_t *day_start, time_t *day_end)
+{
+    struct tm lt;
+    localtime_r(&now, &lt);
+
+    struct tm base = {
+        .tm_year = lt.tm_year, .tm_mon = lt.tm_mon, .tm_mday = lt.tm_mday,
+        .tm_hour = 0, .tm_min = 0, .tm_sec = 0, .tm_isdst = -1
+    };
+    *day_start = mktime(&base);
+    *day_end   = next_local_midnight(&lt);
+}
+
+void ephemeris_build(ephemeris_t *e, time_t now, double lat, double lon)
+{
+    ephemeris_day_bounds(now, &e->day_start, &e->day_end);
+    e->lat = lat;
+    e->lon = lon;
+
+    long minutes = (long)(e->day_end - e->day_start) / 60;
+    if (minutes < 1) minutes = 1;
+    if (minutes > EPHEM_MINUTES_MAX) minutes = EPHEM_MINUTES_MAX;
+    e->minutes = (int)minutes;
+
+    e->sun = solar_sunrise_sunset(now, lat, lon);
+    if (e->sun.valid) {
+        e->dawn_start = e->sun.sunrise + (time_t)(DAWN_OFFSET - DAWN_DURATION / 2) * 60;
+        e->dawn_end   = e->sun.sunrise + (time_t)(DAWN_OFFSET + DAWN_DURATION / 2) * 60;
+        e->dusk_start = e->sun.sunset  - (time_t)(DUSK_OFFSET + DUSK_DURATION / 2) * 60;
+        e->dusk_end   = e->sun.sunset  - (time_t)(DUSK_OFFSET - DUSK_DURATION / 2) * 60;
+    } else {
+        e->dawn_start = e->dawn_end = e->dusk_start = e->dusk_end = 0;
+    }
+
+    time_t when[EPHEM_MINUTES_MAX + 1];
+    double elevation[EPHEM_MINUTES_MAX + 1];
+    for (int i = 0; i <= e->minutes; i++)
+        when[i] = e->day_start + (time_t)i * 60;
+    solar_position_batch(when, (size_t)e->minutes + 1, lat, lon, elevation);
+
+    for (int i = 0; i <= e->minutes; i++) {
+        time_t t = when[i];
+
+        if (e->sun.valid) {
+            double from_sunrise = difftime(t, e->sun.sunrise) / 60.0;
+            double to_sunset    = difftime(e->sun.sunset, t)  / 60.0;
+            e->temp[0][i] = (float)solar_temp_curve(from_sunrise, to_sunset, false);
+            e->temp[1][i] = (float)solar_temp_curve(from_sunrise, to_sunset, true);
+        } else {
+            e->temp[0][i] = (float)TEMP_NIGHT;
+            e->temp[1][i] = (float)TEMP_NIGHT;
+        }
+        e->elevation[i] = (float)elevation[i];
+    }
+
+    ephemeris_build_steps(e);
+    e->valid = true;
+}
+
+/* --- Kelvin steps --- */
+
+static void steps_push(ephemeris_steps_t *s, long sec, int kelvin)
+{
+    if (s->count == EPHEM_STEPS_MAX) return;    /* not reached by the curves */
+    s->sec[s->count]    = (int32_t)sec;
+    s->kelvin[s->count] = (int16_t)kelvin;
+    s->count++;
+}
+
+/* Steps in (lo, hi] given the Kelvin at both ends. The curve is monotone
+   within a minute, so equal ends mean no step in between. */
+static void steps_between(const solar_curve_t *c, time_t day_start, bool is_dark_mode,
+                          ephemeris_steps_t *s, long lo, int k_lo, long hi, int k_hi)
+{
+    if (k_lo == k_hi) return;
+    if (hi - lo == 1) {
+        steps_push(s, hi, k_hi);
+        return;
+    }
+    long mid = lo + (hi - lo) / 2;
+    int k_mid = solar_curve_kelvin(c, day_start + mid, is_dark_mode);
+    steps_between(c, day_start, is_dark_mode, s, lo, k_lo, mid, k_mid);
+    steps_between(c, day_start, is_dark_mode, s, mid, k_mid, hi, k_hi);
+}
+
+void ephemeris_build_steps(ephemeris_t *e)
+{
+    solar_curve_t c;
+    solar_curve_init(&c, e->sun.sunrise, e->sun.sunset);
+
+    for (int dark = 0; dark < 2; dark++) {
+        ephemeris_steps_t *s = &e->steps[dark];
+        s->count = 0;
+
+        if (!e->sun.valid) {
+            steps_push(s, 0, TEMP_NIGHT);
+            for (int i = 0; i <= e->minutes; i++) s->at[i] = 0;
+            continue;
+        }
+
+        int k = solar_curve_kelvin(&c, e->day_start, dark);
+        steps_push(s, 0, k);
+        s->at[0] = 0;
+        for (int i = 0; i < e->minutes; i++) {
+            long lo = (long)i * 60;
+            int next = solar_curve_kelvin(&c, e->day_start + lo + 60, dark);
+            steps_between(&c, e->day_start, dark, s, lo, k, lo + 60, next);
+            s->at[i + 1] = (int16_t)(s->count - 1);
+            k = next;
+        }
+    }
+}
+
+bool ephemeris_current(const ephemeris_t *e, time_t now, double lat, double lon)
+{
+    return e->valid && now >= e->day_start && now < e->day_end &&
+           e->lat == lat && e->lon == lon;
+}
+
+bool ephemeris_refresh(ephemeris_t *e, time_t now, double lat, double lon)
+{
+    if (ephemeris_current(e, now, lat, lon))
+        return false;
+
+    ephemeris_build(e, now, lat, lon);
+    return true;
+}
+
+void ephemeris_invalidate(ephemeris_t *e)
+{
+    e->valid = false;
+}
+
+/* Linear interpolation between the minute samples around day second 'sec' */
+static float table_eval(const ephemeris_t *e, const float *table, long sec)
+{
+    if (sec <= 0) return table[0];
+    if (sec >= (long)e->minutes * 60) return table[e->minutes];
+
+    long i = sec / 60;
+    long r = sec % 60;
+    return table[i] + (table[i + 1] - table[i]) * ((float)r * (1.0f / 60.0f));
+}
+
+/* The step holding at day second 'sec': the last one at or before it,
+   between those holding at the start of its minute and of the next */
+static int step_at(const ephemeris_t *e, const ephemeris_steps_t *s, long sec)
+{
+    if (sec <= 0) return 0;
+    if (sec >= (long)e->minutes * 60) return s->at[e->minutes];
+
+    int lo = s->at[sec / 60], hi = s->at[sec / 60 + 1];
+    while (lo < hi) {
+        int mid = lo + (hi - lo + 1) / 2;
+        if (s->sec[mid] <= sec) lo = mid;
+        else hi = mid - 1;
+    }
+    return lo;
+}
+
+int ephemeris_temp(const ephemeris_t *e, time_t now, bool is_dark_mode)
+{
+    const ephemeris_steps_t *s = &e->steps[is_dark_mode];
+    return s->kelvin[step_at(e, s, (long)(now - e->day_start))];
+}
+
+double ephemeris_elevation(const ephemeris_t *e, time_t now)
+{
+    return table_eval(e, e->elevation, (long)(now - e->day_start));
+}
+
+/* The first later step TEMP_STEP_K from the one holding at 'now' */
+time_t ephemeris_next_change(const ephemeris_t *e, time_t now, bool is_dark_mode)
+{
+    const ephemeris_steps_t *s = &e->steps[is_dark_mode];
+    long end = (long)e->minutes * 60;
+    long sec = (long)(now - e->day_start);
+    if (sec < 0 || sec >= end) return e->day_end > now ? e->day_end : now + 1;
+
+    int j = step_at(e, s, sec);
+    int current = s->kelvin[j];
+    for (int k = j + 1; k < s->count && s->sec[k] < end; k++)
+        if (abs(s->kelvin[k] - current) >= TEMP_STEP_K)
+            return e->day_start + s->sec[k];
+
+    return e->day_end;
+}
@@ -0,0 +1,97 @@
+/*
+ * fade.c - Frame-rate manual override fades
+ *
+ * Frame i is due at start + i * period and shows the sigmoid at
+ * (i + 1) / frames, so the first upload already moves and the last one
+ * lands on the target. The clock decides what is due: a late wakeup jumps
+ * straight to the current frame instead of replaying the ones it missed.
+ */
+
+#define _GNU_SOURCE
+
+#include "fade.h"
+#include "sigmoid.h"
+
+/* A quarter of the frame: the rest belongs to the compositor and the GPU */
+constexpr int FADE_BUDGET_DIV = 4;
+
+/* Never fall below period * FADE_MAX_STRIDE between uploads */
+constexpr int FADE_MAX_STRIDE = 8;
+
+void fade_start(fade_t *f, int start_temp, int target_temp, int duration_ms,
+                int refresh_mhz, int64_t now_ns)
+{
+    if (duration_ms < FADE_MIN_MS) duration_ms = FADE_MIN_MS;
+    if (duration_ms > FADE_MAX_MS) duration_ms = FADE_MAX_MS;
+    if (refresh_mhz <= 0) refresh_mhz = FADE_DEFAULT_MHZ;
+
+    int64_t duration_ns = (int64_t)duration_ms * 1000000LL;
+    int64_t period_ns = 1000000000000LL / refresh_mhz;
+    int64_t frames = (duration_ns + period_ns / 2) / period_ns;
+    if (frames < 1) frames = 1;
+    if (frames > FADE_MAX_FRAMES) {
+        frames = FADE_MAX_FRAMES;
+        period_ns = duration_ns / FADE_MAX_FRAMES;
+    }
+
+    f->active = true;
+    f->start_temp = start_temp;
+    f->target_temp = target_temp;
+    f->frames = (int)frames;
+    f->shown = -1;
+    f->stride = 1;
+    f->dropped = 0;
+    f->start_ns = now_ns;
+    f->period_ns = period_ns;
+    f->budget_ns = period_ns / FADE_BUDGET_DIV;
+
+    for (int i = 0; i < f->frames; i++)
+        f->temp[i] = sigmoid_fade_temp(start_temp, target_temp,
+                                       (double)(i + 1) / (double)f->frames);
+    f->temp[f->frames - 1] = target_temp;
+}
+
+/* Frame the clock says is current, clamped to the last one */
+static int fade_clock_frame(const fade_t *f, int64_t now_ns)
+{
+    int64_t elapsed = now_ns - f->start_ns;
+    if (elapsed < 0) return 0;
+    int64_t i = elapsed / f->period_ns;
+    return i >= f->frames ? f->frames - 1 : (int)i;
+}
+
+/* Earliest frame the stride allows after the one shown */
+static int fade_next_frame(const fade_t *f)
+{
+    if (f->shown < 0) return 0;
+    int next = f->shown + f->stride;
+    return next >= f->frames ? f->frames - 1 : next;
+}
+
+int fade_due(const fade_t *f, int64_t now_ns)
+{
+    if (!f->active || fade_finished(f)) return -1;
+    int due = fade_clock_frame(f, now_ns);
+    return due >= fade_next_frame(f) ? due : -1;
+}
+
+void fade_shown(fade_t *f, int idx, int64_t upload_ns)
+{
+    if (idx > f->shown + 1) f->dropped += idx - f->shown - 1;
+    f->shown = idx;
+
+    if (upload_ns > f->budget_ns && f->stride < FADE_MAX_STRIDE)
+        f->stride++;
+    else if (upload_ns < f->budget_ns / 2 && f->stride > 1)
+        f->stride--;
+}
+
+int64_t fade_next_ns(const fade_t *f)
+{
+    return f->start_ns + (int64_t)fade_next_frame(f) * f->period_ns;
+}
+
+bool fade_finished(const fade_t *f)
+{
+    return f->shown == f->frames - 1;
+}
@@ -1,21 +1,31 @@
 /*
  * json.c - C23 recursive descent JSON parser
  *
- * One production per RFC 8259 grammar rule. Parser state is a single cursor.
- * Douglas Crockford designed JSON as minimal data interchange.
- * This parser honors that: parse, navigate, extract, free. Nothing else.
+ * One production per RFC 8259 grammar rule. Parser state is a cursor plus
+ * an optional arena. Douglas Crockford designed JSON as minimal data
+ * interchange. This parser honors that: parse, navigate, extract, free.
+ *
+ * json_scan() reuses the lexical rules but never builds nodes: it walks
+ * only the containers a target path runs through and bracket-skips the rest.
  */
 
 #include "json.h"
 
 #include <ctype.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 /* Internal capacity for growable arrays */
 constexpr int INITIAL_CAP = 8;
 
+/* Heap chunk size once an arena's first buffer is exhausted */
+constexpr size_t ARENA_CHUNK_SIZE = 16384;
+
+/* Nesting limit for json_scan() recursion */
+constexpr int SCAN_MAX_DEPTH = 128;
+
 /* --- Value representation --- */
 
 typedef struct {
@@ -34,12 +44,98 @@ struct json_value {
     } u;
 };
 
+/* --- Arena --- */
+
+struct json_chunk {
+    json_chunk_t *next;
+    max_align_t   data[];
+};
+
+void json_arena_init(json_arena_t *arena, void *buf, size_t size)
+{
+    arena->buf = buf;
+    arena->used = 0;
+    arena->size = buf ? size : 0;
+    arena->chunks = nullptr;
+}
+
+void json_arena_free(json_arena_t *arena)
+{
+    json_chunk_t *c = arena->chunks;
+    while (c) {
+        json_chunk_t *next = c->next;
+        free(c);
+        c = next;
+    }
+    *arena = (json_arena_t){0};
+}
+
+static void *arena_alloc(json_arena_t *arena, size_t n)
+{
+    constexpr size_t ALIGN = alignof(max_align_t);
+
+    if (arena->buf) {
+        uintptr_t base = (uintptr_t)arena->buf;
+        size_t off = (size_t)(((base + arena->used + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1)) - base);
+        if (off <= arena->size && n <= arena->size - off) {
+            arena->used = off + n;
+            return arena->buf + off;
+        }
+    }
+
+    /* The rest of the current chunk is abandoned; it is at most one node */
+    size_t cap = n > ARENA_CHUNK_SIZE ? n : ARENA_CHUNK_SIZE;
+    json_chunk_t *c = malloc(sizeof(*c) + cap);
+    if (!c) return nullptr;
+    c->next = arena->chunks;
+    arena->chunks = c;
+    arena->buf = (char *)c->data;
+    arena->size = cap;
+    arena->used = n;
+    return c->data;
+}
+
+/* --- Parser state and allocation --- */
+
+typedef struct {
+    const char   *p;
+    json_arena_t *arena;    /* nullptr: heap nodes */
+} parser_t;
+
+static void *mem_alloc(parser_t *ps, size_t n)
+{
+    return ps->arena ? arena_alloc(ps->arena, n) : malloc(n);
+}
+
+static void *mem_grow(parser_t *ps, void *old, size_t old_n, size_t new_n)
+{
+    if (!ps->arena) return realloc(old, new_n);
+
+    void *p = arena_alloc(ps->arena, new_n);
+    if (p && old) memcpy(p, old, old_n);
+    return p;
+}
+
+static void mem_free(parser_t *ps, void *ptr)
+{
+    if (!ps->arena) free(ptr);
+}
+
+/* Drop a partial tree on error; arena nodes go with the arena */
+static void value_release(parser_t *ps, json_value_t *v)
+{
+    if (!ps->arena) json_free(v);
+}
+
 /* --- Helpers --- */
 
-static json_value_t *alloc_value(json_type_t type)
+static json_value_t *alloc_value(parser_t *ps, json_type_t type)
 {
-    json_value_t *v = calloc(1, sizeof(*v));
-    if (v) v->type = type;
+    json_value_t *v = mem_alloc(ps, sizeof(*v));
+    if (v) {
+        memset(v, 0, sizeof(*v));
+        v->type = type;
+    }
     return v;
 }
 
@@ -51,7 +147,7 @@ static void skip_ws(const char **p)
 
 /* --- Forward declarations --- */
 
-static json_value_t *parse_value(const char **p);
+static json_value_t *parse_value(parser_t *ps);
 
 /* --- String parsing (RFC 8259 section 7) --- */
 
@@ -95,12 +191,10 @@ static int utf8_encode(unsigned cp, char *out)
     return 0;
 }
 
-/* Parse a JSON string (opening '"' already consumed). Returns malloc'd string. */
-static char *parse_string_raw(const char **p)
+/* Validate a string body (opening '"' already consumed) and measure its
+   decoded length. *end is left on the closing '"'. */
+static bool string_measure(const char *s, size_t *len_out, const char **end)
 {
-    const char *s = *p;
-
-    /* First pass: measure length */
     size_t len = 0;
     const char *q = s;
     while (*q && *q != '"') {
@@ -108,13 +202,13 @@ static char *parse_string_raw(const char **p)
             q++;
             if (*q == 'u') {
                 int cp = hex4(q + 1);
-                if (cp < 0) return nullptr;
+                if (cp < 0) return false;
                 q += 5;
                 /* Surrogate pair */
                 if (cp >= 0xD800 && cp <= 0xDBFF) {
-                    if (q[0] != '\\' || q[1] != 'u') return nullptr;
+                    if (q[0] != '\\' || q[1] != 'u') return false;
                     int lo = hex4(q + 2);
-                    if (lo < 0 || lo < 0xDC00 || lo > 0xDFFF) return nullptr;
+                    if (lo < 0 || lo < 0xDC00 || lo > 0xDFFF) return false;
                     unsigned full = 0x10000 + ((unsigned)(cp - 0xD800) << 10) + (unsigned)(lo - 0xDC00);
                     q += 6;
                     char tmp[4];
@@ -124,7 +218,7 @@ static char *parse_string_raw(const char **p)
                     len += (size_t)utf8_encode((unsigned)cp, tmp);
                 }
             } else {
-                if (!*q) return nullptr;
+                if (!*q) return false;
                 q++;
                 len++;
             }
@@ -133,26 +227,32 @@ static char *parse_string_raw(const char **p)
             len++;
         }
     }
-    if (*q != '"') return nullptr;
+    if (*q != '"') return false;
 
-    /* Second pass: build string */
-    char *out = malloc(len + 1);
-    if (!out) return nullptr;
+    *len_out = len;
+    *end = q;
+    return true;
+}
 
+/* Decode a string_measure()d body into out, stopping before a character
+   that would not fit in cap bytes. Returns bytes written (no terminator). */
+static size_t string_decode(const char *q, char *out, size_t cap)
+{
     size_t pos = 0;
-    q = s;
     while (*q != '"') {
+        char tmp[4];
+        int n = 1;
         if (*q == '\\') {
             q++;
             switch (*q) {
-            case '"':  out[pos++] = '"';  q++; break;
-            case '\\': out[pos++] = '\\'; q++; break;
-            case '/':  out[pos++] = '/';  q++; break;
-            case 'b':  out[pos++] = '\b'; q++; break;
-            case 'f':  out[pos++] = '\f'; q++; break;
-            case 'n':  out[pos++] = '\n'; q++; break;
-            case 'r':  out[pos++] = '\r'; q++; break;
-            case 't':  out[pos++] = '\t'; q++; break;
+            case '"':  tmp[0] = '"';  q++; break;
+            case '\\': tmp[0] = '\\'; q++; break;
+            case '/':  tmp[0] = '/';  q++; break;
+            case 'b':  tmp[0] = '\b'; q++; break;
+            case 'f':  tmp[0] = '\f'; q++; break;
+            case 'n':  tmp[0] = '\n'; q++; break;
+            case 'r':  tmp[0] = '\r'; q++; break;
+            case 't':  tmp[0] = '\t'; q++; break;
             case 'u': {
                 int cp = hex4(q + 1);
                 q += 5;
@@ -162,223 +262,255 @@ static char *parse_string_raw(const char **p)
                     codepoint = 0x10000 + ((unsigned)(cp - 0xD800) << 10) + (unsigned)(lo - 0xDC00);
                     q += 6;
                 }
-                pos += (size_t)utf8_encode(codepoint, out + pos);
+                n = utf8_encode(codepoint, tmp);
                 break;
             }
-            default: out[pos++] = *q++; break;
+            default: tmp[0] = *q++; break;
             }
         } else {
-            out[pos++] = *q++;
+            tmp[0] = *q++;
         }
+
+        if ((size_t)n > cap - pos) break;
+        memcpy(out + pos, tmp, (size_t)n);
+        pos += (size_t)n;
     }
-    out[pos] = '\0';
-    *p = q + 1; /* skip closing '"' */
+    return pos;
+}
+
+/* Parse a JSON string (opening '"' already consumed). */
+static char *parse_string_raw(parser_t *ps)
+{
+    size_t len;
+    const char *end;
+    if (!string_measure(ps->p, &len, &end)) return nullptr;
+
+    char *out = mem_alloc(ps, len + 1);
+    if (!out) return nullptr;
+
+    out[string_decode(ps->p, out, len)] = '\0';
+    ps->p = end + 1; /* skip closing '"' */
     return out;
 }
 
-static json_value_t *parse_string_value(const char **p)
+static json_value_t *parse_string_value(parser_t *ps)
 {
-    if (**p != '"') return nullptr;
-    ++*p; /* skip opening '"' */
+    if (*ps->p != '"') return nullptr;
+    ps->p++; /* skip opening '"' */
 
-    char *s = parse_string_raw(p);
+    char *s = parse_string_raw(ps);
     if (!s) return nullptr;
 
-    json_value_t *v = alloc_value(JSON_STRING);
-    if (!v) { free(s); return nullptr; }
+    json_value_t *v = alloc_value(ps, JSON_STRING);
+    if (!v) { mem_free(ps, s); return nullptr; }
     v->u.string = s;
     return v;
 }
 
 /* --- Number parsing (RFC 8259 section 6) --- */
 
-static json_value_t *parse_number(const char **p)
+static json_value_t *parse_number(parser_t *ps)
 {
-    const char *start = *p;
+    const char *start = ps->p;
     char *end = nullptr;
     double num = strtod(start, &end);
 
     if (end == start) return nullptr;
 
-    json_value_t *v = alloc_value(JSON_NUMBER);
+    json_value_t *v = alloc_value(ps, JSON_NUMBER);
     if (!v) return nullptr;
     v->u.number = num;
-    *p = end;
+    ps->p = end;
     return v;
 }
 
 /* --- Literal parsing (true, false, null) --- */
 
-static json_value_t *parse_literal(const char **p)
+static json_value_t *parse_literal(parser_t *ps)
 {
-    if (strncmp(*p, "true", 4) == 0) {
-        json_value_t *v = alloc_value(JSON_BOOL);
+    if (strncmp(ps->p, "true", 4) == 0) {
+        json_value_t *v = alloc_value(ps, JSON_BOOL);
         if (v) v->u.boolean = true;
-        *p += 4;
+        ps->p += 4;
         return v;
     }
-    if (strncmp(*p, "false", 5) == 0) {
-        json_value_t *v = alloc_value(JSON_BOOL);
+    if (strncmp(ps->p, "false", 5) == 0) {
+        json_value_t *v = alloc_value(ps, JSON_BOOL);
         if (v) v->u.boolean = false;
-        *p += 5;
+        ps->p += 5;
         return v;
     }
-    if (strncmp(*p, "null", 4) == 0) {
-        *p += 4;
-        return alloc_value(JSON_NULL);
+    if (strncmp(ps->p, "null", 4) == 0) {
+        ps->p += 4;
+        return alloc_value(ps, JSON_NULL);
     }
     return nullptr;
 }
 
 /* --- Object parsing (RFC 8259 section 4) --- */
 
-static json_value_t *parse_object(const char **p)
+static json_value_t *parse_object(parser_t *ps)
 {
-    if (**p != '{') return nullptr;
-    ++*p;
+    if (*ps->p != '{') return nullptr;
+    ps->p++;
 
-    json_value_t *obj = alloc_value(JSON_OBJECT);
+    json_value_t *obj = alloc_value(ps, JSON_OBJECT);
     if (!obj) return nullptr;
     obj->u.object.pairs = nullptr;
     obj->u.object.count = 0;
     obj->u.object.cap = 0;
 
-    skip_ws(p);
+    skip_ws(&ps->p);
 
-    if (**p == '}') {
-        ++*p;
+    if (*ps->p == '}') {
+        ps->p++;
         return obj;
     }
 
     for (;;) {
-        skip_ws(p);
+        skip_ws(&ps->p);
 
         /* Key */
-        if (**p != '"') goto fail;
-        ++*p;
-        char *key = parse_string_raw(p);
+        if (*ps->p != '"') goto fail;
+        ps->p++;
+        char *key = parse_string_raw(ps);
         if (!key) goto fail;
 
-        skip_ws(p);
-        if (**p != ':') { free(key); goto fail; }
-        ++*p;
+        skip_ws(&ps->p);
+        if (*ps->p != ':') { mem_free(ps, key); goto fail; }
+        ps->p++;
 
         /* Value */
-        skip_ws(p);
-        json_value_t *val = parse_value(p);
-        if (!val) { free(key); goto fail; }
+        skip_ws(&ps->p);
+        json_value_t *val = parse_value(ps);
+        if (!val) { mem_free(ps, key); goto fail; }
 
         /* Grow if needed */
         if (obj->u.object.count == obj->u.object.cap) {
             int new_cap = obj->u.object.cap ? obj->u.object.cap * 2 : INITIAL_CAP;
-            json_pair_t *np = realloc(obj->u.object.pairs,
-                                      (size_t)new_cap * sizeof(json_pair_t));
-            if (!np) { free(key); json_free(val); goto fail; }
+            json_pair_t *np = mem_grow(ps, obj->u.object.pairs,
+                                       (size_t)obj->u.object.cap * sizeof(json_pair_t),
+                                       (size_t)new_cap * sizeof(json_pair_t));
+            if (!np) { mem_free(ps, key); value_release(ps, val); goto fail; }
             obj->u.object.pairs = np;
             obj->u.object.cap = new_cap;
         }
 
         obj->u.object.pairs[obj->u.object.count++] = (json_pair_t){ .key = key, .value = val };
 
-        skip_ws(p);
-        if (**p == ',') { ++*p; continue; }
-        if (**p == '}') { ++*p; return obj; }
+        skip_ws(&ps->p);
+        if (*ps->p == ',') { ps->p++; continue; }
+        if (*ps->p == '}') { ps->p++; return obj; }
         goto fail;
     }
 
 fail:
-    json_free(obj);
+    value_release(ps, obj);
     return nullptr;
 }
 
 /* --- Array parsing (RFC 8259 section 5) --- */
 
-static json_value_t *parse_array(const char **p)
+static json_value_t *parse_array(parser_t *ps)
 {
-    if (**p != '[') return nullptr;
-    ++*p;
+    if (*ps->p != '[') return nullptr;
+    ps->p++;
 
-    json_value_t *arr = alloc_value(JSON_ARRAY);
+    json_value_t *arr = alloc_value(ps, JSON_ARRAY);
     if (!arr) return nullptr;
     arr->u.array.elements = nullptr;
     arr->u.array.count = 0;
     arr->u.array.cap = 0;
 
-    skip_ws(p);
+    skip_ws(&ps->p);
 
-    if (**p == ']') {
-        ++*p;
+    if (*ps->p == ']') {
+        ps->p++;
         return arr;
     }
 
     for (;;) {
-        skip_ws(p);
-        json_value_t *val = parse_value(p);
+        skip_ws(&ps->p);
+        json_value_t *val = parse_value(ps);
         if (!val) goto fail;
 
         /* Grow if needed */
         if (arr->u.array.count == arr->u.array.cap) {
             int new_cap = arr->u.array.cap ? arr->u.array.cap * 2 : INITIAL_CAP;
-            json_value_t **ne = realloc(arr->u.array.elements,
-                                        (size_t)new_cap * sizeof(json_value_t *));
-            if (!ne) { json_free(val); goto fail; }
+            json_value_t **ne = mem_grow(ps, arr->u.array.elements,
+                                         (size_t)arr->u.array.cap * sizeof(json_value_t *),
+                                         (size_t)new_cap * sizeof(json_value_t *));
+            if (!ne) { value_release(ps, val); goto fail; }
             arr->u.array.elements = ne;
             arr->u.array.cap = new_cap;
         }
 
         arr->u.array.elements[arr->u.array.count++] = val;
 
-        skip_ws(p);
-        if (**p == ',') { ++*p; continue; }
-        if (**p == ']') { ++*p; return arr; }
+        skip_ws(&ps->p);
+        if (*ps->p == ',') { ps->p++; continue; }
+        if (*ps->p == ']') { ps->p++; return arr; }
         goto fail;
     }
 
 fail:
-    json_free(arr);
+    value_release(ps, arr);
     return nullptr;
 }
 
 /* --- Value parsing (RFC 8259 section 3) --- */
 
-static json_value_t *parse_value(const char **p)
+static json_value_t *parse_value(parser_t *ps)
 {
-    skip_ws(p);
+    skip_ws(&ps->p);
 
-    switch (**p) {
-    case '"': return parse_string_value(p);
-    case '{': return parse_object(p);
-    case '[': return parse_array(p);
+    switch (*ps->p) {
+    case '"': return parse_string_value(ps);
+    case '{': return parse_object(ps);
+    case '[': return parse_array(ps);
     case 't': case 'f': case 'n':
-        return parse_literal(p);
+        return parse_literal(ps);
     default:
         /* Must be a number: digit, minus, or decimal point */
-        if (**p == '-' || (**p >= '0' && **p <= '9'))
-            return parse_number(p);
+        if (*ps->p == '-' || (*ps->p >= '0' && *ps->p <= '9'))
+            return parse_number(ps);
         return nullptr;
     }
 }
 
-/* --- Public API --- */
-
-json_value_t *json_parse(const char *text)
+static json_value_t *parse_document(parser_t *ps)
 {
-    if (!text) return nullptr;
-
-    const char *p = text;
-    json_value_t *root = parse_value(&p);
+    json_value_t *root = parse_value(ps);
     if (!root) return nullptr;
 
     /* Verify no trailing content beyond whitespace */
-    skip_ws(&p);
-    if (*p != '\0') {
-        json_free(root);
+    skip_ws(&ps->p);
+    if (*ps->p != '\0') {
+        value_release(ps, root);
         return nullptr;
     }
 
     return root;
 }
 
+/* --- Public API --- */
+
+json_value_t *json_parse(const char *text)
+{
+    if (!text) return nullptr;
+
+    parser_t ps = { .p = text, .arena = nullptr };
+    return parse_document(&ps);
+}
+
+json_value_t *json_parse_arena(const char *text, json_arena_t *arena)
+{
+    if (!text || !arena) return nullptr;
+
+    parser_t ps = { .p = text, .arena = arena };
+    return parse_document(&ps);
+}
+
 const json_value_t *json_get(const json_value_t *obj, const char *key)
 {
     if (!obj || obj->type != JSON_OBJECT || !key) return nullptr;
@@ -416,7 +548,11 @@ const json_value_t *json_path(const json_value_t *root, const char *dotpath)
         memcpy(key, p, keylen);
         key[keylen] = '\0';
 
-        cur = json_get(cur, key);
+        if (cur->type == JSON_ARRAY && keylen > 0 &&
+            strspn(key, "0123456789") == keylen)
+            cur = json_at(cur, atoi(key));
+        else
+            cur = json_get(cur, key);
         p = dot ? dot + 1 : p + keylen;
     }
 
@@ -454,6 +590,287 @@ int json_count(const json_value_t *val)
     return 0;
 }
 
+/* --- Scan (no DOM) --- */
+
+typedef struct {
+    const char    *p;
+    json_target_t *targets;
+    int            count;
+    int            remaining;
+    bool           done;
+    const char    *seg[JSON_SCAN_MAX];  /* per target: segment at this depth */
+} scanner_t;
+
+/*
+ * Cursor on the opening '"'. Works on a local pointer: stepping through
+ * *p directly makes every byte a store and reload, since a char write
+ * may alias the text.
+ */
+static bool skip_string(const char **p)
+{
+    const char *q = *p + 1;
+    for (;;) {
+        q += strcspn(q, "\"\\");
+        if (*q == '"') break;
+        if (!*q || !q[1]) return false;
+        q += 2;   /* backslash and the escaped char */
+    }
+    *p = q + 1;
+    return true;
+}
+
+/* Step over one value without looking inside containers */
+static bool skip_value(const char **p)
+{
+    skip_ws(p);
+
+    char c = **p;
+    if (c == '"') return skip_string(p);
+
+    if (c == '{' || c == '[') {
+        const char *q = *p;
+        int depth = 0;
+        do {
+            q += strcspn(q, "\"{}[]");
+            c = *q;
+            if (c == '"') {
+                if (!skip_string(&q)) return false;
+                continue;
+            }
+            if (!c) return false;
+            if (c == '{' || c == '[') depth++;
+            else depth--;
+            q++;
+        } while (depth > 0);
+        *p = q;
+        return true;
+    }
+
+    if (strncmp(*p, "true", 4) == 0 || strncmp(*p, "null", 4) == 0) { *p += 4; return true; }
+    if (strncmp(*p, "false", 5) == 0) { *p += 5; return true; }
+
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        char *end;
+        (void)strtod(*p, &end);
+        if (end == *p) return false;
+        *p = end;
+        return true;
+    }
+    return false;
+}
+
+static size_t seg_len(const char *seg)
+{
+    const char *dot = strchr(seg, '.');
+    return dot ? (size_t)(dot - seg) : strlen(seg);
+}
+
+static bool seg_is_key(const char *seg, const char *key, size_t keylen)
+{
+    return seg_len(seg) == keylen && memcmp(seg, key, keylen) == 0;
+}
+
+static bool seg_is_index(const char *seg, int index)
+{
+    size_t n = seg_len(seg);
+    if (n == 0 || n > 9 || strspn(seg, "0123456789") < n) return false;
+
+    int v = 0;
+    for (size_t i = 0; i < n; i++) v = v * 10 + (seg[i] - '0');
+    return v == index;
+}
+
+static json_type_t type_of_text(char c)
+{
+    switch (c) {
+    case '"': return JSON_STRING;
+    case '{': return JSON_OBJECT;
+    case '[': return JSON_ARRAY;
+    case 't': case 'f': return JSON_BOOL;
+    case 'n': return JSON_NULL;
+    default:  return JSON_NUMBER;
+    }
+}
+
+static bool scan_value(scanner_t *sc, uint32_t live, int depth);
+
+/* One object member or array element whose key/index matched 'hits' */
+static bool scan_member(scanner_t *sc, uint32_t hits, int depth)
+{
+    if (!hits) return skip_value(&sc->p);   /* nothing to find in here */
+
+    uint32_t full = 0, child = 0;
+    for (int i = 0; i < sc->count; i++) {
+        if (!(hits & (1u << i))) continue;
+        const char *seg = sc->seg[i];
+        if (seg[seg_len(seg)] == '.') child |= 1u << i;
+        else full |= 1u << i;
+    }
+
+    const char *saved[JSON_SCAN_MAX];
+    for (int i = 0; i < sc->count; i++) {
+        if (!(child & (1u << i))) continue;
+        saved[i] = sc->seg[i];
+        sc->seg[i] += seg_len(sc->seg[i]) + 1;
+    }
+
+    skip_ws(&sc->p);
+    const char *start = sc->p;
+    bool ok = child ? scan_value(sc, child, depth + 1) : skip_value(&sc->p);
+
+    for (int i = 0; i < sc->count; i++)
+        if (child & (1u << i)) sc->seg[i] = saved[i];
+
+    if (!ok) return false;
+    if (sc->done) return true;
+
+    for (int i = 0; i < sc->count; i++) {
+        if (!(full & (1u << i))) continue;
+        json_target_t *t = &sc->targets[i];
+        t->found = true;
+        t->type = type_of_text(*start);
+        t->start = start;
+        t->len = (size_t)(sc->p - start);
+        sc->remaining--;
+    }
+    if (sc->remaining == 0) sc->done = true;
+    return true;
+}
+
+/* Walk a container only as deep as the live targets need */
+static bool scan_value(scanner_t *sc, uint32_t live, int depth)
+{
+    if (depth > SCAN_MAX_DEPTH) return false;
+    skip_ws(&sc->p);
+
+    char open = *sc->p;
+    if (open != '{' && open != '[')
+        return skip_value(&sc->p);   /* path runs into a scalar: no hit */
+
+    char close = open == '{' ? '}' : ']';
+    sc->p++;
+    skip_ws(&sc->p);
+    if (*sc->p == close) {
+        sc->p++;
+        return true;
+    }
+
+    for (int index = 0; ; index++) {
+        skip_ws(&sc->p);
+
+        const char *key = nullptr;
+        size_t keylen = 0;
+        if (open == '{') {
+            if (*sc->p != '"') return false;
+            key = sc->p + 1;
+            if (!skip_string(&sc->p)) return false;
+            keylen = (size_t)(sc->p - key - 1);
+            skip_ws(&sc->p);
+            if (*sc->p != ':') return false;
+            sc->p++;
+        }
+
+        uint32_t hits = 0;
+        for (int i = 0; i < sc->count; i++) {
+            if (!(live & (1u << i)) || sc->targets[i].found) continue;
+            bool match = key ? seg_is_key(sc->seg[i], key, keylen)
+                             : seg_is_index(sc->seg[i], index);
+            if (match) hits |= 1u << i;
+        }
+
+        if (!scan_member(sc, hits, depth)) return false;
+        if (sc->done) return true;
+
+        skip_ws(&sc->p);
+        if (*sc->p == ',') { sc->p++; continue; }
+        if (*sc->p == close) { sc->p++; return true; }
+        return false;
+    }
+}
+
+int json_scan(const char *text, json_target_t *targets, int count)
+{
+    if (!text || !targets || count < 0 || count > JSON_SCAN_MAX) return -1;
+
+    scanner_t sc = { .p = text, .targets = targets, .count = count };
+    uint32_t live = 0;
+    for (int i = 0; i < count; i++) {
+        json_target_t *t = &targets[i];
+        t->found = false;
+        t->type = JSON_NULL;
+        t->start = nullptr;
+        t->len = 0;
+        if (!t->path || !*t->path) continue;
+        sc.seg[i] = t->path;
+        live |= 1u << i;
+        sc.remaining++;
+    }
+    if (!live) return 0;
+
+    bool ok = scan_value(&sc, live, 0);
+
+    int found = 0;
+    for (int i = 0; i < count; i++)
+        if (targets[i].found) found++;
+    return ok || sc.done ? found : -1;
+}
+
+bool json_target_string(const json_target_t *t, char *out, size_t cap)
+{
+    if (!out || cap == 0) return false;
+    out[0] = '\0';
+    if (!t || !t->found || t->type != JSON_STRING) return false;
+
+    size_t len;
+    const char *end;
+    if (!string_measure(t->start + 1, &len, &end)) return false;
+
+    out[string_decode(t->start + 1, out, cap - 1)] = '\0';
+    return true;
+}
+
+double json_target_number(const json_target_t *t)
+{
+    if (!t || !t->found || t->type != JSON_NUMBER) return 0.0;
+    return strtod(t->start, nullptr);
+}
+
+bool json_target_bool(const json_target_t *t)
+{
+    if (!t || !t->found || t->type != JSON_BOOL) return false;
+    return *t->start == 't';
+}
+
+bool json_target_next(const json_target_t *array, const char **iter,
+                      json_target_t *elem)
+{
+    if (!array || !array->found || array->type != JSON_ARRAY) return false;
+
+    const char *p = *iter;
+    if (!p) {
+        p = array->start + 1;
+    } else {
+        skip_ws(&p);
+        if (*p != ',') return false;
+        p++;
+    }
+    skip_ws(&p);
+    if (*p == ']') return false;
+
+    const char *start = p;
+    if (!skip_value(&p)) return false;
+
+    *elem = (json_target_t){
+        .path  = nullptr,
+        .found = true,
+        .type  = type_of_text(*start),
+        .start = start,
+        .len   = (size_t)(p - start),
+    };
+    *iter = p;
+    return true;
+}
+
 void json_free(json_value_t *val)
 {
     if (!val) return;
@@ -125,3 +125,43 @@ bool landlock_install_sandbox(const char *config_dir)
 
     return ret == 0;
 }
+
+bool landlock_install_worker_sandbox(void)
+{
+    if (ll_create_ruleset(nullptr, 0, LANDLOCK_CREATE_RULESET_VERSION) < 0)
+        return false;
+
+    /* Every ABI 1 right is handled; only reading and running are granted */
+    uint64_t read_only = LANDLOCK_ACCESS_FS_READ_FILE | LANDLOCK_ACCESS_FS_READ_DIR;
+    struct landlock_ruleset_attr attr = {
+        .handled_access_fs =
+            read_only |
+            LANDLOCK_ACCESS_FS_EXECUTE |
+            LANDLOCK_ACCESS_FS_WRITE_FILE |
+            LANDLOCK_ACCESS_FS_REMOVE_DIR |
+            LANDLOCK_ACCESS_FS_REMOVE_FILE |
+            LANDLOCK_ACCESS_FS_MAKE_CHAR |
+            LANDLOCK_ACCESS_FS_MAKE_DIR |
+            LANDLOCK_ACCESS_FS_MAKE_REG |
+            LANDLOCK_ACCESS_FS_MAKE_SOCK |
+            LANDLOCK_ACCESS_FS_MAKE_FIFO |
+            LANDLOCK_ACCESS_FS_MAKE_BLOCK |
+            LANDLOCK_ACCESS_FS_MAKE_SYM,
+    };
+
+    int ruleset_fd = ll_create_ruleset(&attr, sizeof(attr), 0);
+    if (ruleset_fd < 0) return false;
+
+    /* curl and its libraries; CA bundle, resolver and TLS config */
+    add_path_rule(ruleset_fd, "/usr", read_only | LANDLOCK_ACCESS_FS_EXECUTE);
+    add_path_rule(ruleset_fd, "/lib", read_only);
+    add_path_rule(ruleset_fd, "/lib64", read_only);
+    add_path_rule(ruleset_fd, "/etc", read_only);
+    /* systemd-resolved's resolv.conf is a symlink into /run */
+    add_path_rule(ruleset_fd, "/run/systemd/resolve", read_only);
+
+    int ret = ll_restrict_self(ruleset_fd, 0);
+    close(ruleset_fd);
+
+    return ret == 0;
+}
@@ -3,23 +3,44 @@
  *
  * Commands:
  *   --daemon         Run as daemon (default)
+ *   --system         System-wide instance: state in /var/lib/abraxas,
+ *                    with --daemon one root daemon for every logind session
  *   --status         Show current status
  *   --set-location   Set location (ZIP or lat,lon)
  *   --refresh        Force weather refresh
- *   --set TEMP [MIN] Manual override to TEMP over MIN minutes
+ *   --set TEMP [MIN] Manual override to TEMP over MIN minutes (or Ns: fade)
  *   --resume         Clear manual override
  *   --reset          Restore gamma and exit
+ *   --benchmark      Benchmark suite (--json, --fixtures DIR)
+ *   --seccomp-verify Replay all syscall numbers through the seccomp filter
+ *   --export-schedule FILE  Write a year of precomputed solar days
+ *   --simulate START END    Replay the daemon on a virtual clock
+ *                           (--events FILE, --record FILE)
+ *   --alloc-check    Fail if the simulated tick touches the heap
  *   --help           Show usage
+ *
+ * --set, --resume and --refresh go to a running daemon over its control
+ * socket and print what it applied; without one they try the system
+ * daemon's, then fall back to files.
+ * --status prints a running daemon's status page rather than recomputing.
  */
 
 #define _GNU_SOURCE
 
 #include "abraxas.h"
+#include "alloccount.h"
+#include "bench.h"
 #include "config.h"
+#include "control.h"
 #include "daemon.h"
-#include "sigmoid.h"
+#include "fade.h"
+#include "ephemeris.h"
+#include "schedule.h"
+#include "seccomp.h"
+#include "snapshot.h"
 #include "solar.h"
-#include "uring.h"
+#include "status.h"
+#include "system.h"
 #include "weather.h"
 #include "zipdb.h"
 
@@ -35,14 +56,81 @@
 
 /* --- Status display --- */
 
+static void print_clock(const char *label, time_t when)
+{
+    struct tm t;
+    localtime_r(&when, &t);
+    printf("%s: %02d:%02d\n", label, t.tm_hour, t.tm_min);
+}
+
+static void print_datetime(const char *label, time_t when)
+{
+    struct tm t;
+    localtime_r(&when, &t);
+    printf("%s: %04d-%02d-%02d %02d:%02d:%02d\n", label,
+           t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+}
+
+/* A running daemon's own view, copied from its status page */
+static bool print_live_status(const abraxas_paths_t *paths)
+{
+    status_page_t sp;
+    if (!status_read(paths->status_page, &sp)) return false;
+
+    printf("ABRAXAS v8.4.0 [C23]\n\n");
+    printf("Location: %.4f, %.4f\n\n", sp.lat, sp.lon);
+
+    print_datetime("Date", (time_t)sp.updated_at);
+    if (sp.sunrise && sp.sunset) {
+        print_clock("Sunrise", (time_t)sp.sunrise);
+        print_clock("Sunset", (time_t)sp.sunset);
+    } else {
+        printf("Sunrise/Sunset: N/A (polar region)\n");
+    }
+    printf("Sun elevation: %.1f degrees\n\n", sp.elevation);
+
+    if (sp.weather_ok) {
+        printf("Weather: %s\n", sp.forecast);
+        printf("Cloud cover: %d%%\n", sp.cloud_cover);
+        if (sp.next_dark_change)
+            print_clock(sp.dark ? "Next clear" : "Next dark", (time_t)sp.next_dark_change);
+        print_datetime("Last updated", (time_t)sp.weather_fetched_at);
+    } else {
+        printf("Weather: Not available\n");
+    }
+    printf("\n");
+
+    if (sp.mode == STATUS_MODE_MANUAL) {
+        printf("Mode: MANUAL OVERRIDE\n");
+        printf("Target: %dK over %d min\n", sp.manual_target, sp.manual_duration);
+        print_datetime("Issued", (time_t)sp.manual_start);
+        if (sp.manual_resume) print_clock("Auto-resume", (time_t)sp.manual_resume);
+    } else {
+        printf("Mode: %s\n", sp.dark ? "DARK" : "CLEAR");
+        printf("Target temperature: %dK\n", sp.temp);
+    }
+
+    printf("Applied: %dK via %s%s\n", sp.temp, sp.backend, sp.set_ok ? "" : " (last set failed)");
+    if (sp.next_change) print_datetime("Next change", (time_t)sp.next_change);
+    printf("Outputs: %u", sp.output_count);
+    for (uint32_t i = 0; i < sp.output_count && i < STATUS_MAX_OUTPUTS; i++)
+        printf("%s%u:%d", i ? ", " : " (", sp.outputs[i].index, sp.outputs[i].gamma_size);
+    printf("%s\n", sp.output_count ? " gamma entries)" : "");
+    printf("Daemon: pid %u\n", sp.pid);
+    return true;
+}
+
 static void cmd_status(double lat, double lon, const abraxas_paths_t *paths)
 {
+    if (print_live_status(paths)) return;
+
     printf("ABRAXAS v8.4.0 [C23]\n\n");
     printf("Location: %.4f, %.4f\n\n", lat, lon);
 
     time_t now = time(nullptr);
-    sun_times_t st = solar_sunrise_sunset(now, lat, lon);
-    sun_position_t sp = solar_position(now, lat, lon);
+    static ephemeris_t ephem;
+    ephemeris_build(&ephem, now, lat, lon);
+    sun_times_t st = ephem.sun;
 
     struct tm nt, srt, sst;
     localtime_r(&now, &nt);
@@ -59,13 +147,23 @@ static void cmd_status(double lat, double lon, const abraxas_paths_t *paths)
     } else {
         printf("Sunrise/Sunset: N/A (polar region)\n");
     }
-    printf("Sun elevation: %.1f degrees\n\n", sp.elevation);
+    printf("Sun elevation: %.1f degrees\n\n", ephemeris_elevation(&ephem, now));
 
     /* Weather */
     weather_data_t weather = config_load_weather_cache(paths);
     if (!weather.has_error) {
         printf("Weather: %s\n", weather.forecast);
-        printf("Cloud cover: %d%%\n", weather.cloud_cover);
+        printf("Cloud cover: %d%%\n", weather_cloud_at(&weather, now));
+        if (weather.timeline_hours > 0) {
+            time_t flip = weather_next_dark_change(&weather, now);
+            if (flip) {
+                struct tm fl;
+                localtime_r(&flip, &fl);
+                printf("Next %s: %02d:%02d\n",
+                       weather_cloud_at(&weather, flip) >= CLOUD_THRESHOLD ? "dark" : "clear",
+                       fl.tm_hour, fl.tm_min);
+            }
+        }
 
         struct tm ft;
         localtime_r(&weather.fetched_at, &ft);
@@ -89,11 +187,8 @@ static void cmd_status(double lat, double lon, const abraxas_paths_t *paths)
                it.tm_year + 1900, it.tm_mon + 1, it.tm_mday,
                it.tm_hour, it.tm_min, it.tm_sec);
     } else {
-        bool is_dark = !weather.has_error && weather.cloud_cover >= CLOUD_THRESHOLD;
-        double min_from_sunrise = st.valid ? difftime(now, st.sunrise) / 60.0 : 0.0;
-        double min_to_sunset    = st.valid ? difftime(st.sunset, now) / 60.0 : 0.0;
-
-        int temp = calculate_solar_temp(min_from_sunrise, min_to_sunset, is_dark);
+        bool is_dark = weather_cloud_at(&weather, now) >= CLOUD_THRESHOLD;
+        int temp = ephemeris_temp(&ephem, now, is_dark);
 
         printf("Mode: %s\n", is_dark ? "DARK" : "CLEAR");
         printf("Target temperature: %dK\n", temp);
@@ -149,9 +244,49 @@ static int cmd_set_location(const char *loc_str, const abraxas_paths_t *paths)
 
 /* --- Refresh weather --- */
 
+/* Shared by the control-socket paths: what the daemon says it did */
+static int print_control_reply(const control_reply_t *reply)
+{
+    if (!reply->ok) {
+        fprintf(stderr, "Daemon rejected request: %s\n", reply->error);
+        return 1;
+    }
+    if (reply->temp > 0)
+        printf("Daemon applied: %dK\n", reply->temp);
+    if (reply->manual) {
+        struct tm rt;
+        localtime_r(&reply->resume_at, &rt);
+        printf("Manual: -> %dK over %d min, auto-resume at %02d:%02d\n",
+               reply->target_temp, reply->duration_minutes, rt.tm_hour, rt.tm_min);
+    } else {
+        printf("Mode: solar\n");
+    }
+    return 0;
+}
+
 static int cmd_refresh(double lat, double lon, const abraxas_paths_t *paths)
 {
     printf("Fetching weather...\n");
+
+    /* A running daemon fetches itself, so its cache and schedule update too */
+    control_request_t req = { .op = CONTROL_REFRESH };
+    control_reply_t reply;
+    int rc = control_send(paths, &req, &reply);
+    if (rc == 0) {
+        if (!reply.ok) return print_control_reply(&reply);
+        if (reply.cloud_cover < 0) {
+            fprintf(stderr, "Weather fetch failed\n");
+            return 1;
+        }
+        printf("Weather: %s\n", reply.forecast);
+        printf("Cloud cover: %d%%\n", reply.cloud_cover);
+        return 0;
+    }
+    if (rc == -2) {
+        fprintf(stderr, "Daemon did not answer the refresh request\n");
+        return 1;
+    }
+
     weather_data_t wd = weather_fetch(lat, lon);
 
     if (wd.has_error) {
@@ -167,7 +302,7 @@ static int cmd_refresh(double lat, double lon, const abraxas_paths_t *paths)
 
 /* --- Set temperature override --- */
 
-static int cmd_set_temp(int target_temp, int duration_min,
+static int cmd_set_temp(int target_temp, int duration_min, int fade_ms,
                         const abraxas_paths_t *paths)
 {
     if (target_temp < TEMP_MIN || target_temp > TEMP_MAX) {
@@ -175,12 +310,35 @@ static int cmd_set_temp(int target_temp, int duration_min,
         return 1;
     }
 
+    if (fade_ms > 0)
+        printf("Override: -> %dK, %.1f s fade at display refresh\n", target_temp, fade_ms / 1000.0);
+    else if (duration_min > 0)
+        printf("Override: -> %dK over %d min (sigmoid)\n", target_temp, duration_min);
+    else
+        printf("Override: -> %dK (instant)\n", target_temp);
+
+    control_request_t req = {
+        .op = CONTROL_SET,
+        .target_temp = target_temp,
+        .duration_minutes = duration_min,
+        .fade_ms = fade_ms,
+    };
+    control_reply_t reply;
+    int rc = control_send(paths, &req, &reply);
+    if (rc == 0) return print_control_reply(&reply);
+    if (rc == -2) {
+        fprintf(stderr, "Daemon did not answer the override request\n");
+        return 1;
+    }
+
+    /* No daemon listening: leave the override for the next start */
     override_state_t ovr = {
         .active = true,
         .target_temp = target_temp,
         .duration_minutes = duration_min,
         .issued_at = time(nullptr),
-        .start_temp = 0  /* daemon fills this */
+        .start_temp = 0, /* daemon fills this */
+        .fade_ms = fade_ms,
     };
 
     if (!config_save_override(paths, &ovr)) {
@@ -188,11 +346,6 @@ static int cmd_set_temp(int target_temp, int duration_min,
         return 1;
     }
 
-    if (duration_min > 0)
-        printf("Override: -> %dK over %d min (sigmoid)\n", target_temp, duration_min);
-    else
-        printf("Override: -> %dK (instant)\n", target_temp);
-
     if (config_check_daemon_alive(paths))
         printf("Daemon will process on next tick (up to 60s).\n");
     else
@@ -204,6 +357,15 @@ static int cmd_set_temp(int target_temp, int duration_min,
 
 static int cmd_resume(const abraxas_paths_t *paths)
 {
+    control_request_t req = { .op = CONTROL_RESUME };
+    control_reply_t reply;
+    int rc = control_send(paths, &req, &reply);
+    if (rc == 0) return print_control_reply(&reply);
+    if (rc == -2) {
+        fprintf(stderr, "Daemon did not answer the resume request\n");
+        return 1;
+    }
+
     override_state_t ovr = { .active = false };
     config_save_override(paths, &ovr);
 
@@ -231,151 +393,173 @@ static int cmd_reset(const abraxas_paths_t *paths)
     return 0;
 }
 
-/* --- Benchmark --- */
+/* --- Export schedule --- */
 
-static inline uint64_t bench_ns(void)
+static int cmd_export_schedule(const char *path, double lat, double lon)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
-    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    time_t now = time(nullptr);
+    if (!schedule_export(path, lat, lon, now, SCHEDULE_DAYS)) {
+        fprintf(stderr, "Could not write %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+
+    struct tm t;
+    localtime_r(&now, &t);
+    printf("Schedule for %.4f, %.4f: %d days from %04d-%02d-%02d -> %s\n",
+           lat, lon, SCHEDULE_DAYS, t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, path);
+    printf("Install as ~/.config/abraxas/schedule.bin (by rename) for the daemon to use it.\n");
+    return 0;
 }
 
-static void bench_print(const char *label, uint64_t ns, int iterations)
+/* --- Simulate --- */
+
+/* Local "YYYY-MM-DD", "YYYY-MM-DDTHH:MM" or "YYYY-MM-DD HH:MM".
+   Returns the unparsed rest, or nullptr. */
+static const char *parse_local_time(const char *s, time_t *out)
 {
-    if (iterations > 1) {
-        uint64_t per = ns / (uint64_t)iterations;
-        if (ns >= 1000000)
-            printf("  %-30s %8lu us  (%lu ns/call, %d calls)\n",
-                   label, ns / 1000, per, iterations);
-        else if (ns >= 1000)
-            printf("  %-30s %8lu us  (%lu ns/call, %d calls)\n",
-                   label, ns / 1000, per, iterations);
-        else
-            printf("  %-30s %8lu ns  (%lu ns/call, %d calls)\n",
-                   label, ns, per, iterations);
-    } else {
-        if (ns >= 1000000)
-            printf("  %-30s %8lu us\n", label, ns / 1000);
-        else if (ns >= 1000)
-            printf("  %-30s %8lu us\n", label, ns / 1000);
-        else
-            printf("  %-30s %8lu ns\n", label, ns);
+    static const char *const formats[] = { "%Y-%m-%dT%H:%M", "%Y-%m-%d %H:%M", "%Y-%m-%d" };
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+        struct tm t = { .tm_isdst = -1 };
+        const char *rest = strptime(s, formats[i], &t);
+        if (!rest || (*rest != '\0' && *rest != ' ' && *rest != '\t' && *rest != '\n'))
+            continue;
+        t.tm_isdst = -1;
+        *out = mktime(&t);
+        return *out == (time_t)-1 ? nullptr : rest;
     }
+    return nullptr;
 }
 
-static int cmd_benchmark(const abraxas_paths_t *paths)
+/*
+ * Event script, one per line, in time order; '#' starts a comment:
+ *   2026-06-21 14:00 set 3000 [MIN]
+ *   2026-06-21 15:30 resume
+ *   2026-06-22 08:00 clouds 80
+ */
+static int load_sim_events(const char *path, sim_event_t *events, int max)
 {
-    printf("ABRAXAS v8.4.0 [C23] -- Kernel-grade benchmark\n");
-    printf("Clock: CLOCK_MONOTONIC_RAW (hardware TSC)\n\n");
-
-    constexpr int N = 1000;
-    uint64_t t0, t1;
-
-    /* config_init_paths */
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        abraxas_paths_t p;
-        config_init_paths(&p);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+        return -1;
     }
-    t1 = bench_ns();
-    bench_print("config_init_paths()", t1 - t0, N);
 
-    /* config_load_location */
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        (void)config_load_location(paths);
+    char line[256];
+    int n = 0, lineno = 0;
+    while (fgets(line, sizeof(line), f)) {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        if (strspn(line, " \t\r\n") == strlen(line)) continue;
+
+        sim_event_t ev = {0};
+        char verb[16];
+        int a = 0, b = 0;
+        const char *rest = parse_local_time(line, &ev.at);
+        int fields = rest ? sscanf(rest, " %15s %d %d", verb, &a, &b) : 0;
+        bool ok = fields >= 1;
+        if (ok && strcmp(verb, "set") == 0) {
+            ev.kind = SIM_SET;
+            ev.temp = a;
+            ev.minutes = fields >= 3 ? b : 0;
+            ok = fields >= 2 && a >= TEMP_MIN && a <= TEMP_MAX && ev.minutes >= 0;
+        } else if (ok && strcmp(verb, "resume") == 0) {
+            ev.kind = SIM_RESUME;
+            ok = fields == 1;
+        } else if (ok && strcmp(verb, "clouds") == 0) {
+            ev.kind = SIM_CLOUDS;
+            ev.clouds = a;
+            ok = fields == 2 && a >= 0 && a <= 100;
+        } else {
+            ok = false;
+        }
+        if (ok && n > 0 && ev.at < events[n - 1].at) {
+            fprintf(stderr, "%s:%d: events must be in time order\n", path, lineno);
+            n = -1;
+            break;
+        }
+        if (!ok || n == max) {
+            fprintf(stderr, ok ? "%s:%d: more than %d events\n" : "%s:%d: bad event\n",
+                    path, lineno, max);
+            n = -1;
+            break;
+        }
+        events[n++] = ev;
     }
-    t1 = bench_ns();
-    bench_print("config_load_location()", t1 - t0, N);
+    fclose(f);
+    return n;
+}
 
-    /* Load location for solar tests */
-    location_t loc = config_load_location(paths);
-    if (!loc.valid) {
-        loc.lat = 34.26;
-        loc.lon = -88.38;
-    }
-    time_t now = time(nullptr);
+static int cmd_simulate(const char *start, const char *end, const char *events_path,
+                        const char *record_path, const location_t *loc,
+                        const abraxas_paths_t *paths)
+{
+    static sim_event_t events[SIM_EVENTS_MAX];
+    sim_options_t opt = { .events = events };
 
-    /* solar_sunrise_sunset */
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        volatile sun_times_t st = solar_sunrise_sunset(now, loc.lat, loc.lon);
-        (void)st;
+    const char *rest;
+    if (!(rest = parse_local_time(start, &opt.start)) || *rest != '\0' ||
+        !(rest = parse_local_time(end, &opt.end)) || *rest != '\0') {
+        fprintf(stderr, "Invalid time: use YYYY-MM-DD or YYYY-MM-DDTHH:MM (local)\n");
+        return 1;
     }
-    t1 = bench_ns();
-    bench_print("solar_sunrise_sunset()", t1 - t0, N);
-
-    /* solar_position */
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        volatile sun_position_t sp = solar_position(now, loc.lat, loc.lon);
-        (void)sp;
+    if (opt.end <= opt.start) {
+        fprintf(stderr, "Simulation must end after it starts\n");
+        return 1;
     }
-    t1 = bench_ns();
-    bench_print("solar_position()", t1 - t0, N);
-
-    /* calculate_solar_temp */
-    sun_times_t st = solar_sunrise_sunset(now, loc.lat, loc.lon);
-    double min_from_sr = st.valid ? difftime(now, st.sunrise) / 60.0 : 0.0;
-    double min_to_ss   = st.valid ? difftime(st.sunset, now)  / 60.0 : 0.0;
-
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        volatile int t = calculate_solar_temp(min_from_sr, min_to_ss, false);
-        (void)t;
+    if (events_path) {
+        opt.event_count = load_sim_events(events_path, events, SIM_EVENTS_MAX);
+        if (opt.event_count < 0) return 1;
     }
-    t1 = bench_ns();
-    bench_print("calculate_solar_temp()", t1 - t0, N);
 
-    /* sigmoid_norm */
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        volatile double s = sigmoid_norm(0.5, SIGMOID_STEEPNESS);
-        (void)s;
+    FILE *record = nullptr;
+    if (record_path) {
+        record = strcmp(record_path, "-") == 0 ? stdout : fopen(record_path, "w");
+        if (!record) {
+            fprintf(stderr, "Could not open %s: %s\n", record_path, strerror(errno));
+            return 1;
+        }
+        opt.record = record;
     }
-    t1 = bench_ns();
-    bench_print("sigmoid_norm()", t1 - t0, N);
 
-    /* JSON parse (override) */
-    override_state_t ovr = config_load_override(paths);
-    (void)ovr;
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        (void)config_load_override(paths);
-    }
-    t1 = bench_ns();
-    bench_print("config_load_override()", t1 - t0, N);
-
-    /* JSON parse (weather cache) */
-    t0 = bench_ns();
-    for (int i = 0; i < N; i++) {
-        (void)config_load_weather_cache(paths);
-    }
-    t1 = bench_ns();
-    bench_print("config_load_weather_cache()", t1 - t0, N);
-
-    printf("\nKernel facilities:\n");
-
-    /* io_uring setup + teardown */
-    {
-        abraxas_ring_t ring;
-        t0 = bench_ns();
-        bool ok = uring_init(&ring, 8);
-        t1 = bench_ns();
-        if (ok) {
-            bench_print("io_uring_setup()", t1 - t0, 1);
-            uring_destroy(&ring);
-        } else {
-            printf("  %-30s unavailable\n", "io_uring_setup()");
-        }
+    daemon_state_t state = { .location = *loc, .paths = *paths };
+    int rc = daemon_simulate(&state, &opt);
+    if (record && record != stdout && fclose(record) != 0) rc = 1;
+    return rc;
+}
+
+/* Three simulated days around an equinox: the first warms the ramp cache
+   and glibc's time zone state, the other two are counted. They cover both
+   solar transitions under clear and overcast skies and a manual fade. */
+static int cmd_alloc_check(const location_t *loc, const abraxas_paths_t *paths)
+{
+    if (!alloc_count_available()) {
+        fprintf(stderr, "alloc-check: no allocation counter in this build "
+                        "(make ALLOC_CHECK=1 builds abraxas-alloc-check)\n");
+        return 1;
     }
 
-    /* seccomp (can't actually install in benchmark -- would restrict us) */
-    printf("  %-30s (not measured -- would restrict process)\n", "seccomp_install()");
-    printf("  %-30s (not measured -- would restrict process)\n", "landlock_install()");
+    sim_alloc_stats_t stats = {0};
+    sim_options_t opt = { .alloc_stats = &stats };
+    parse_local_time("2026-03-19", &opt.start);
+    opt.count_from = opt.start + 86400;
+    opt.end = opt.start + 3 * 86400;
+
+    time_t day2 = opt.count_from;
+    const sim_event_t events[] = {
+        { .at = day2 + 12 * 3600, .kind = SIM_SET, .temp = 3500, .minutes = 45 },
+        { .at = day2 + 14 * 3600, .kind = SIM_RESUME },
+        { .at = day2 + 86400,     .kind = SIM_CLOUDS, .clouds = 90 },
+    };
+    opt.events = events;
+    opt.event_count = (int)(sizeof(events) / sizeof(events[0]));
+
+    daemon_state_t state = { .location = *loc, .paths = *paths };
+    if (daemon_simulate(&state, &opt) != 0) return 1;
 
-    printf("\nDone.\n");
-    return 0;
+    printf("alloc-check: %ld ticks, %ld transition steps, %lu heap allocations\n",
+           stats.ticks, stats.sets, stats.allocs);
+    return stats.allocs == 0 ? 0 : 1;
 }
 
 /* --- Usage --- */
@@ -386,13 +570,23 @@ static void usage(void)
     printf("Usage: abraxas [OPTIONS]\n\n");
     printf("Options:\n");
     printf("  --daemon              Run as daemon (default)\n");
+    printf("  --system              Use system-wide state; with --daemon, serve every session\n");
     printf("  --status              Show current status\n");
     printf("  --set-location LOC    Set location (ZIP code or LAT,LON)\n");
     printf("  --refresh             Force weather refresh\n");
     printf("  --set TEMP [MIN]      Override to TEMP (Kelvin) over MIN minutes (default 3)\n");
+    printf("  --set TEMP SECs       ... or fade over 0.1-5 seconds at display refresh (e.g. 2s)\n");
     printf("  --resume              Clear override, resume solar control\n");
     printf("  --reset               Restore gamma and exit\n");
     printf("  --benchmark           Nanosecond performance benchmark\n");
+    printf("    --json              Emit benchmark results as JSON\n");
+    printf("    --fixtures DIR      Benchmark fixture corpus (default bench/fixtures)\n");
+    printf("  --seccomp-verify      Check the compiled seccomp filter against syscalls.def\n");
+    printf("  --export-schedule FILE  Precompute a year of solar days for this location\n");
+    printf("  --simulate START END  Replay the daemon from START to END (YYYY-MM-DD[THH:MM])\n");
+    printf("    --events FILE       Timed set/resume/clouds events to replay\n");
+    printf("    --record FILE       Log every applied ramp to FILE (- for stdout)\n");
+    printf("  --alloc-check         Count heap allocations in the steady-state tick\n");
     printf("  --help                Show this help\n");
 }
 
@@ -400,6 +594,7 @@ static void usage(void)
 
 static struct option long_opts[] = {
     { "daemon",       no_argument,       nullptr, 'd' },
+    { "system",       no_argument,       nullptr, 'Y' },
     { "status",       no_argument,       nullptr, 's' },
     { "set-location", required_argument, nullptr, 'l' },
     { "refresh",      no_argument,       nullptr, 'r' },
@@ -407,28 +602,38 @@ static struct option long_opts[] = {
     { "resume",       no_argument,       nullptr, 'R' },
     { "reset",        no_argument,       nullptr, 'x' },
     { "benchmark",    no_argument,       nullptr, 'B' },
+    { "json",         no_argument,       nullptr, 'j' },
+    { "fixtures",     required_argument, nullptr, 'F' },
+    { "seccomp-verify", no_argument,     nullptr, 'V' },
+    { "export-schedule", required_argument, nullptr, 'E' },
+    { "simulate",     required_argument, nullptr, 'M' },
+    { "events",       required_argument, nullptr, 'e' },
+    { "record",       required_argument, nullptr, 'O' },
+    { "alloc-check",  no_argument,       nullptr, 'A' },
     { "help",         no_argument,       nullptr, 'h' },
     { nullptr, 0, nullptr, 0 }
 };
 
 int main(int argc, char **argv)
 {
-    abraxas_paths_t paths;
-    if (!config_init_paths(&paths)) {
-        fprintf(stderr, "Failed to initialize paths (is $HOME set?)\n");
-        return 1;
-    }
-
     enum { CMD_DAEMON, CMD_STATUS, CMD_SET_LOC, CMD_REFRESH,
-           CMD_SET_TEMP, CMD_RESUME, CMD_RESET, CMD_BENCHMARK } command = CMD_DAEMON;
+           CMD_SET_TEMP, CMD_RESUME, CMD_RESET, CMD_BENCHMARK,
+           CMD_SECCOMP_VERIFY, CMD_EXPORT_SCHEDULE, CMD_SIMULATE, CMD_ALLOC_CHECK } command = CMD_DAEMON;
     const char *loc_arg = nullptr;
+    const char *schedule_path = nullptr;
+    const char *sim_start = nullptr, *sim_end = nullptr;
+    const char *sim_events = nullptr, *sim_record = nullptr;
     int set_temp_val = 0;
     int set_temp_dur = 3;
+    int set_temp_fade = 0;
+    bench_options_t bench_opt = {0};
+    bool system_mode = false;
 
     int opt;
     while ((opt = getopt_long(argc, argv, "", long_opts, nullptr)) != -1) {
         switch (opt) {
         case 'd': command = CMD_DAEMON;   break;
+        case 'Y': system_mode = true;     break;
         case 's': command = CMD_STATUS;   break;
         case 'l': command = CMD_SET_LOC;  loc_arg = optarg; break;
         case 'r': command = CMD_REFRESH;  break;
@@ -444,8 +649,22 @@ int main(int argc, char **argv)
                 return 1;
             }
             set_temp_val = (int)val;
-            /* Check for optional duration in next arg */
-            if (optind < argc && argv[optind][0] != '-') {
+            /* Check for optional duration in next arg: minutes, or seconds with 's' */
+            if (optind < argc && argv[optind][0] != '-' && argv[optind][0] != '\0' &&
+                argv[optind][strlen(argv[optind]) - 1] == 's') {
+                errno = 0;
+                double sec = strtod(argv[optind], &end);
+                if (end == argv[optind] || strcmp(end, "s") != 0 || errno == ERANGE ||
+                    !(sec * 1000.0 >= FADE_MIN_MS && sec * 1000.0 <= FADE_MAX_MS)) {
+                    fprintf(stderr, "Invalid fade: %s (%.1f-%.0fs)\n", argv[optind],
+                            FADE_MIN_MS / 1000.0, FADE_MAX_MS / 1000.0);
+                    usage();
+                    return 1;
+                }
+                set_temp_fade = (int)(sec * 1000.0 + 0.5);
+                set_temp_dur = 0;
+                optind++;
+            } else if (optind < argc && argv[optind][0] != '-') {
                 errno = 0;
                 val = strtol(argv[optind], &end, 10);
                 if (*end != '\0' || end == argv[optind] || errno == ERANGE
@@ -462,11 +681,37 @@ int main(int argc, char **argv)
         case 'R': command = CMD_RESUME;   break;
         case 'x': command = CMD_RESET;    break;
         case 'B': command = CMD_BENCHMARK; break;
+        case 'j': bench_opt.json = true; break;
+        case 'F': bench_opt.fixtures = optarg; break;
+        case 'V': command = CMD_SECCOMP_VERIFY; break;
+        case 'E': command = CMD_EXPORT_SCHEDULE; schedule_path = optarg; break;
+        case 'M':
+            command = CMD_SIMULATE;
+            sim_start = optarg;
+            if (optind >= argc || argv[optind][0] == '-') {
+                fprintf(stderr, "--simulate needs START and END\n");
+                usage();
+                return 1;
+            }
+            sim_end = argv[optind++];
+            break;
+        case 'e': sim_events = optarg; break;
+        case 'O': sim_record = optarg; break;
+        case 'A': command = CMD_ALLOC_CHECK; break;
         case 'h': usage(); return 0;
         default:  usage(); return 1;
         }
     }
 
+    abraxas_paths_t paths;
+    if (system_mode ? !config_init_system_paths(&paths) : !config_init_paths(&paths)) {
+        if (system_mode)
+            fprintf(stderr, "Failed to initialize %s\n", ABRAXAS_SYSTEM_DIR);
+        else
+            fprintf(stderr, "Failed to initialize paths (is $HOME set?)\n");
+        return 1;
+    }
+
     /* Commands that don't need location */
     if (command == CMD_RESET)
         return cmd_reset(&paths);
@@ -475,12 +720,19 @@ int main(int argc, char **argv)
     if (command == CMD_SET_LOC)
         return cmd_set_location(loc_arg, &paths);
     if (command == CMD_SET_TEMP)
-        return cmd_set_temp(set_temp_val, set_temp_dur, &paths);
+        return cmd_set_temp(set_temp_val, set_temp_dur, set_temp_fade, &paths);
     if (command == CMD_BENCHMARK)
-        return cmd_benchmark(&paths);
-
-    /* Remaining commands need location */
-    location_t loc = config_load_location(&paths);
+        return bench_run(&paths, &bench_opt);
+    if (command == CMD_SECCOMP_VERIFY)
+        return seccomp_verify();
+
+    /* Remaining commands need location; the daemon's snapshot has it
+       parsed already while config.ini is unchanged */
+    static snapshot_t snap;
+    bool have_snap = command == CMD_DAEMON && !system_mode &&
+                     snapshot_load(paths.snapshot_file, &snap);
+    location_t loc = have_snap && snapshot_fresh(&snap, SNAP_CONFIG, paths.config_file)
+                   ? snap.location : config_load_location(&paths);
     if (!loc.valid) {
         fprintf(stderr, "No location configured. Use --set-location first.\n");
         fprintf(stderr, "  Example: abraxas --set-location 60614\n");
@@ -497,15 +749,28 @@ int main(int argc, char **argv)
         result = cmd_refresh(loc.lat, loc.lon, &paths);
         break;
     case CMD_SET_TEMP:
-        result = cmd_set_temp(set_temp_val, set_temp_dur, &paths);
+        result = cmd_set_temp(set_temp_val, set_temp_dur, set_temp_fade, &paths);
+        break;
+    case CMD_EXPORT_SCHEDULE:
+        result = cmd_export_schedule(schedule_path, loc.lat, loc.lon);
+        break;
+    case CMD_SIMULATE:
+        result = cmd_simulate(sim_start, sim_end, sim_events, sim_record, &loc, &paths);
+        break;
+    case CMD_ALLOC_CHECK:
+        result = cmd_alloc_check(&loc, &paths);
         break;
     case CMD_DAEMON: {
+        if (system_mode) {
+            result = system_run(&paths, loc);
+            break;
+        }
         daemon_state_t state = {
             .location = loc,
             .paths = paths,
             .last_temp_valid = false
         };
-        daemon_run(&state);
+        result = daemon_run(&state, have_snap ? &snap : nullptr);
         break;
     }
     default:
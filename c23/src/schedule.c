@@ -0,0 +1,249 @@
+/*
+ * schedule.c - Precomputed solar schedule file
+ *
+ * The exporter runs ephemeris_build() for each day, so a schedule holds
+ * exactly what the daemon would have computed, rounded to the stored
+ * precision. Filling a day touches three pages of the mapping; the rest
+ * of the year stays on disk.
+ */
+
+#define _GNU_SOURCE
+
+#include "schedule.h"
+#include "abraxas.h"
+#include "sigmoid.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(schedule_header_t) == 64, "schedule header is 64 bytes");
+static_assert(sizeof(schedule_day_t) % 8 == 0, "schedule records keep 8-byte alignment");
+
+constexpr uint32_t FNV_OFFSET = 2166136261u;
+constexpr uint32_t FNV_PRIME  = 16777619u;
+
+/* Same location as the exporter: config.ini keeps six decimals */
+constexpr double LOCATION_EPSILON = 1e-6;
+
+/* Curve samples hashed into the id, in minutes either side of sunrise/sunset */
+constexpr int CURVE_SPAN_MIN = 360;
+constexpr int CURVE_STEP_MIN = 3;
+
+static uint32_t fnv_int(uint32_t h, int64_t v)
+{
+    for (int i = 0; i < 8; i++) {
+        h ^= (uint8_t)(v >> (i * 8));
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+/*
+ * The window constants plus the sigmoid itself, sampled across both
+ * transitions at the stored precision: a build whose curve would give
+ * different tables gets a different id and ignores the file.
+ */
+uint32_t schedule_curve_id(void)
+{
+    static uint32_t id;
+    if (id) return id;
+
+    uint32_t h = FNV_OFFSET;
+    const int constants[] = {
+        TEMP_DAY_CLEAR, TEMP_DAY_DARK, TEMP_NIGHT,
+        DAWN_OFFSET, DAWN_DURATION, DUSK_OFFSET, DUSK_DURATION,
+        SCHEDULE_TEMP_SCALE, SCHEDULE_ELEV_SCALE,
+    };
+    for (size_t i = 0; i < sizeof(constants) / sizeof(constants[0]); i++)
+        h = fnv_int(h, constants[i]);
+
+    for (int dark = 0; dark < 2; dark++) {
+        for (int m = -CURVE_SPAN_MIN; m <= CURVE_SPAN_MIN; m += CURVE_STEP_MIN) {
+            h = fnv_int(h, lrint(solar_temp_curve(m, 2 * CURVE_SPAN_MIN, dark)
+                                 * SCHEDULE_TEMP_SCALE));
+            h = fnv_int(h, lrint(solar_temp_curve(2 * CURVE_SPAN_MIN, m, dark)
+                                 * SCHEDULE_TEMP_SCALE));
+        }
+    }
+
+    id = h ? h : 1;
+    return id;
+}
+
+/* --- Export --- */
+
+static void encode_day(schedule_day_t *d, const ephemeris_t *e)
+{
+    *d = (schedule_day_t){
+        .day_start  = e->day_start,
+        .day_end    = e->day_end,
+        .sunrise    = e->sun.sunrise,
+        .sunset     = e->sun.sunset,
+        .dawn_start = e->dawn_start,
+        .dawn_end   = e->dawn_end,
+        .dusk_start = e->dusk_start,
+        .dusk_end   = e->dusk_end,
+        .minutes    = e->minutes,
+        .sun_valid  = e->sun.valid,
+    };
+    for (int i = 0; i <= e->minutes; i++) {
+        d->temp[0][i] = (uint16_t)lrintf(e->temp[0][i] * SCHEDULE_TEMP_SCALE);
+        d->temp[1][i] = (uint16_t)lrintf(e->temp[1][i] * SCHEDULE_TEMP_SCALE);
+        d->elevation[i] = (int16_t)lrintf(e->elevation[i] * SCHEDULE_ELEV_SCALE);
+    }
+}
+
+bool schedule_export(const char *path, double lat, double lon, time_t from, int days)
+{
+    char tmp[ABRAXAS_PATH_MAX + 8];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) return false;
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) return false;
+
+    schedule_header_t hdr = {
+        .version     = SCHEDULE_VERSION,
+        .header_size = sizeof(schedule_header_t),
+        .day_size    = sizeof(schedule_day_t),
+        .days        = (uint32_t)days,
+        .minutes_max = EPHEM_MINUTES_MAX,
+        .curve_id    = schedule_curve_id(),
+        .temp_scale  = SCHEDULE_TEMP_SCALE,
+        .elev_scale  = SCHEDULE_ELEV_SCALE,
+        .lat         = lat,
+        .lon         = lon,
+        .created_at  = (int64_t)time(nullptr),
+    };
+    memcpy(hdr.magic, SCHEDULE_MAGIC, 4);
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+    static ephemeris_t e;
+    static schedule_day_t day;
+    time_t t = from;
+    for (int i = 0; ok && i < days; i++) {
+        ephemeris_build(&e, t, lat, lon);
+        encode_day(&day, &e);
+        ok = fwrite(&day, sizeof(day), 1, f) == 1;
+        t = e.day_end;
+    }
+
+    ok = fclose(f) == 0 && ok;
+    if (ok) ok = rename(tmp, path) == 0;
+    if (!ok) unlink(tmp);
+    return ok;
+}
+
+/* --- Lookup --- */
+
+static bool header_valid(const schedule_header_t *hdr, size_t size)
+{
+    return memcmp(hdr->magic, SCHEDULE_MAGIC, 4) == 0 &&
+           hdr->version == SCHEDULE_VERSION &&
+           hdr->header_size == sizeof(schedule_header_t) &&
+           hdr->day_size == sizeof(schedule_day_t) &&
+           hdr->minutes_max == EPHEM_MINUTES_MAX &&
+           hdr->temp_scale == SCHEDULE_TEMP_SCALE &&
+           hdr->elev_scale == SCHEDULE_ELEV_SCALE &&
+           hdr->curve_id == schedule_curve_id() &&
+           hdr->days > 0 &&
+           (size - sizeof(*hdr)) / sizeof(schedule_day_t) >= hdr->days;
+}
+
+bool schedule_open(schedule_t *s, const char *path)
+{
+    *s = (schedule_t){0};
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(schedule_header_t)) {
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    const schedule_header_t *hdr = map;
+    if (!header_valid(hdr, (size_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        return false;
+    }
+    /* One day is read at a time, once a day */
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+
+    s->map  = map;
+    s->size = (size_t)st.st_size;
+    s->hdr  = hdr;
+    s->day  = (const schedule_day_t *)((const uint8_t *)map + sizeof(*hdr));
+    return true;
+}
+
+void schedule_close(schedule_t *s)
+{
+    if (s->map) munmap((void *)s->map, s->size);
+    *s = (schedule_t){0};
+}
+
+bool schedule_matches(const schedule_t *s, double lat, double lon)
+{
+    return s->map && fabs(s->hdr->lat - lat) <= LOCATION_EPSILON &&
+           fabs(s->hdr->lon - lon) <= LOCATION_EPSILON;
+}
+
+bool schedule_fill(const schedule_t *s, ephemeris_t *e, time_t now,
+                   double lat, double lon)
+{
+    if (!schedule_matches(s, lat, lon)) return false;
+
+    time_t day_start, day_end;
+    ephemeris_day_bounds(now, &day_start, &day_end);
+
+    /* First record starting at or after local midnight */
+    uint32_t lo = 0, hi = s->hdr->days;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (s->day[mid].day_start < (int64_t)day_start) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == s->hdr->days) return false;
+
+    /* Exported in another timezone, or a DST rule changed since */
+    const schedule_day_t *d = &s->day[lo];
+    if (d->day_start != (int64_t)day_start || d->day_end != (int64_t)day_end ||
+        d->minutes < 1 || d->minutes > EPHEM_MINUTES_MAX)
+        return false;
+
+    e->day_start  = day_start;
+    e->day_end    = day_end;
+    e->lat        = lat;
+    e->lon        = lon;
+    e->minutes    = d->minutes;
+    e->sun        = (sun_times_t){
+        .sunrise = (time_t)d->sunrise, .sunset = (time_t)d->sunset,
+        .valid = d->sun_valid != 0,
+    };
+    e->dawn_start = (time_t)d->dawn_start;
+    e->dawn_end   = (time_t)d->dawn_end;
+    e->dusk_start = (time_t)d->dusk_start;
+    e->dusk_end   = (time_t)d->dusk_end;
+
+    constexpr float temp_step = 1.0f / SCHEDULE_TEMP_SCALE;
+    constexpr float elev_step = 1.0f / SCHEDULE_ELEV_SCALE;
+    for (int i = 0; i <= d->minutes; i++) {
+        e->temp[0][i]   = d->temp[0][i] * temp_step;
+        e->temp[1][i]   = d->temp[1][i] * temp_step;
+        e->elevation[i] = d->elevation[i] * elev_step;
+    }
+
+    ephemeris_build_steps(e);
+    e->valid = true;
+    return true;
+}
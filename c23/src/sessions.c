@@ -0,0 +1,169 @@
+/*
+ * sessions.c - logind session and seat tracking
+ *
+ * The session files are logind's own state serialization, the same ones
+ * sd_session_get_*() read. Only the handful of keys deciding whether and
+ * how to reach the session's display are kept.
+ */
+
+#define _GNU_SOURCE
+
+#include "sessions.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static session_type_t parse_type(const char *v)
+{
+    if (strcmp(v, "tty") == 0)     return SESSION_TTY;
+    if (strcmp(v, "x11") == 0)     return SESSION_X11;
+    if (strcmp(v, "wayland") == 0) return SESSION_WAYLAND;
+    return SESSION_OTHER;
+}
+
+static void copy_value(char *dst, size_t cap, const char *v)
+{
+    snprintf(dst, cap, "%s", v);
+}
+
+bool session_parse(const char *path, const char *id, session_info_t *s)
+{
+    *s = (session_info_t){ .type = SESSION_OTHER };
+    copy_value(s->id, sizeof(s->id), id);
+
+    FILE *f = fopen(path, "re");
+    if (!f) return false;
+
+    bool has_uid = false;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\n")] = '\0';
+        char *eq = strchr(line, '=');
+        if (!eq || line[0] == '#') continue;
+        *eq = '\0';
+        const char *key = line, *v = eq + 1;
+
+        if (strcmp(key, "UID") == 0) {
+            char *end;
+            unsigned long uid = strtoul(v, &end, 10);
+            has_uid = end != v && *end == '\0';
+            s->uid = (uid_t)uid;
+        } else if (strcmp(key, "USER") == 0) {
+            copy_value(s->user, sizeof(s->user), v);
+        } else if (strcmp(key, "SEAT") == 0) {
+            copy_value(s->seat, sizeof(s->seat), v);
+        } else if (strcmp(key, "DISPLAY") == 0) {
+            copy_value(s->display, sizeof(s->display), v);
+        } else if (strcmp(key, "TYPE") == 0) {
+            s->type = parse_type(v);
+        } else if (strcmp(key, "ACTIVE") == 0) {
+            s->active = strcmp(v, "1") == 0;
+        } else if (strcmp(key, "REMOTE") == 0) {
+            s->remote = strcmp(v, "1") == 0;
+        } else if (strcmp(key, "STATE") == 0) {
+            s->closing = strcmp(v, "closing") == 0;
+        }
+    }
+    fclose(f);
+    return has_uid;
+}
+
+bool session_is_target(const session_info_t *s)
+{
+    if (s->remote || s->closing) return false;
+    if (s->seat[0]) return s->active;
+    return s->type == SESSION_X11 && s->display[0];
+}
+
+static int compare_id(const void *a, const void *b)
+{
+    return strcmp(((const session_info_t *)a)->id, ((const session_info_t *)b)->id);
+}
+
+int sessions_scan(const char *dir, session_info_t *out, int max)
+{
+    DIR *d = opendir(dir);
+    if (!d) return 0;
+
+    int n = 0;
+    const struct dirent *de;
+    while (n < max && (de = readdir(d))) {
+        /* logind writes .#<id>XXXXXX and renames it into place */
+        if (de->d_name[0] == '.') continue;
+
+        char path[512];
+        if (snprintf(path, sizeof(path), "%s/%s", dir, de->d_name) >= (int)sizeof(path))
+            continue;
+        if (session_parse(path, de->d_name, &out[n]) && session_is_target(&out[n]))
+            n++;
+    }
+    closedir(d);
+
+    qsort(out, (size_t)n, sizeof(*out), compare_id);
+    return n;
+}
+
+bool session_same_target(const session_info_t *a, const session_info_t *b)
+{
+    return strcmp(a->id, b->id) == 0 && a->uid == b->uid && a->type == b->type &&
+           strcmp(a->display, b->display) == 0;
+}
+
+/* --- Seats --- */
+
+/* The seat udev assigned the device major:minor to */
+static void device_seat(const char *udev_dir, const char *devnum, char *seat, size_t cap)
+{
+    copy_value(seat, cap, "seat0");
+
+    char path[512];
+    if (snprintf(path, sizeof(path), "%s/c%s", udev_dir, devnum) >= (int)sizeof(path))
+        return;
+    FILE *f = fopen(path, "re");
+    if (!f) return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "E:ID_SEAT=", 10) != 0) continue;
+        line[strcspn(line, "\n")] = '\0';
+        if (line[10]) copy_value(seat, cap, line + 10);
+        break;
+    }
+    fclose(f);
+}
+
+int seat_drm_card(const char *drm_dir, const char *udev_dir, const char *seat)
+{
+    if (!seat[0]) return -1;
+
+    DIR *d = opendir(drm_dir);
+    if (!d) return -1;
+
+    int best = -1;
+    const struct dirent *de;
+    while ((de = readdir(d))) {
+        /* cardN only: not its connectors (cardN-HDMI-A-1) or render nodes */
+        int card, len = 0;
+        if (sscanf(de->d_name, "card%d%n", &card, &len) != 1 || de->d_name[len] || card < 0)
+            continue;
+        if (best >= 0 && card > best) continue;
+
+        char path[512], devnum[32];
+        if (snprintf(path, sizeof(path), "%s/%s/dev", drm_dir, de->d_name) >= (int)sizeof(path))
+            continue;
+        FILE *f = fopen(path, "re");
+        if (!f) continue;
+        bool ok = fgets(devnum, sizeof(devnum), f) != nullptr;
+        fclose(f);
+        if (!ok) continue;
+        devnum[strcspn(devnum, "\n")] = '\0';
+
+        char owner[32];
+        device_seat(udev_dir, devnum, owner, sizeof(owner));
+        if (strcmp(owner, seat) == 0) best = card;
+    }
+    closedir(d);
+    return best;
+}
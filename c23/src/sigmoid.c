@@ -3,7 +3,13 @@
  *
  * Dusk is canonical: day -> night over DUSK_DURATION centered on sunset.
  * Dawn is its inverse: night -> day over DAWN_DURATION centered on sunrise.
- * Manual overrides use the same sigmoid over [0, duration].
+ * Manual overrides use the same sigmoid over [0, duration], and second-
+ * scale fades (fade.c) over [0, 1] of their frame sequence.
+ *
+ * next_manual_change() inverts the sigmoid to find the exact second the
+ * integer Kelvin output next moves, so the daemon can sleep through the
+ * override instead of polling. Solar curves are tabulated per day in
+ * ephemeris.c.
  */
 
 #include "sigmoid.h"
@@ -19,16 +25,66 @@ static double sigmoid_raw(double x, double steepness)
     return 1.0 / (1.0 + exp(-steepness * x));
 }
 
-double sigmoid_norm(double x, double steepness)
+/* sigmoid_norm with sigmoid_raw(-1) and sigmoid_raw(1) already known */
+static double norm_between(double x, double steepness, double low, double high)
 {
     double raw  = sigmoid_raw(x, steepness);
+    return (raw - low) / (high - low);
+}
+
+double sigmoid_norm(double x, double steepness)
+{
+    return norm_between(x, steepness, sigmoid_raw(-1.0, steepness),
+                        sigmoid_raw(1.0, steepness));
+}
+
+/* Inverse of sigmoid_norm: x in [-1,1] such that sigmoid_norm(x) == y. */
+static double sigmoid_norm_inverse(double y, double steepness)
+{
     double low  = sigmoid_raw(-1.0, steepness);
     double high = sigmoid_raw(1.0, steepness);
-    return (raw - low) / (high - low);
+    double raw  = low + y * (high - low);
+    return -log(1.0 / raw - 1.0) / steepness;
 }
 
-int calculate_solar_temp(double minutes_from_sunrise, double minutes_to_sunset,
-                         bool is_dark_mode)
+/*
+ * Next second after 'now' at which (int)(base + span * sigmoid_norm(x))
+ * has moved TEMP_STEP_K from its current value, where x runs linearly
+ * from x0 at t0 to x1 at t1 (x0, x1 = +/-1). Returns ceil(t1) once no
+ * further step occurs inside the window.
+ */
+static time_t sigmoid_next_change(int base, int span, double x0, double x1,
+                                  double t0, double t1, time_t now)
+{
+    time_t end = (time_t)ceil(t1);
+    if (span == 0) return end;
+
+    double x_now = x0 + (x1 - x0) * ((double)now - t0) / (t1 - t0);
+    int current = (int)(base + span * sigmoid_norm(x_now, SIGMOID_STEEPNESS));
+
+    /* Output rises if span and the direction of x agree */
+    bool f_rising = x1 > x0;
+    bool rising = (span > 0) == f_rising;
+
+    /* sigmoid_norm value at which the output reaches the next step;
+     * falling output must pass strictly below current - TEMP_STEP_K + 1 */
+    int target = rising ? current + TEMP_STEP_K : current - TEMP_STEP_K + 1;
+    double y = (double)(target - base) / span;
+    if (f_rising ? (y >= 1.0) : (y <= 0.0)) return end;
+    if (y < 0.0) y = 0.0;
+    if (y > 1.0) y = 1.0;
+
+    double x = sigmoid_norm_inverse(y, SIGMOID_STEEPNESS);
+    double t = t0 + (x - x0) / (x1 - x0) * (t1 - t0);
+
+    /* Rising reaches current+1 at t; falling must pass strictly below */
+    time_t next = rising ? (time_t)ceil(t) : (time_t)floor(t) + 1;
+    if (next <= now) next = now + 1;
+    return next < end ? next : end;
+}
+
+static double curve_between(double minutes_from_sunrise, double minutes_to_sunset,
+                            bool is_dark_mode, double low, double high)
 {
     int day_temp   = is_dark_mode ? TEMP_DAY_DARK : TEMP_DAY_CLEAR;
     int night_temp = TEMP_NIGHT;
@@ -40,16 +96,16 @@ int calculate_solar_temp(double minutes_from_sunrise, double minutes_to_sunset,
     double dawn_shifted = minutes_from_sunrise - DAWN_OFFSET;
     if (fabs(dawn_shifted) < dawn_half) {
         double x = dawn_shifted / dawn_half;              /* [-1, 1] */
-        double factor = sigmoid_norm(x, SIGMOID_STEEPNESS);
-        return (int)(night_temp + (day_temp - night_temp) * factor);
+        double factor = norm_between(x, SIGMOID_STEEPNESS, low, high);
+        return night_temp + (day_temp - night_temp) * factor;
     }
 
     /* Dusk: day -> night (canonical, midpoint offset before sunset) */
     double dusk_shifted = minutes_to_sunset - DUSK_OFFSET;
     if (fabs(dusk_shifted) < dusk_half) {
         double x = dusk_shifted / dusk_half;              /* [1, -1] */
-        double factor = sigmoid_norm(x, SIGMOID_STEEPNESS);
-        return (int)(night_temp + (day_temp - night_temp) * factor);
+        double factor = norm_between(x, SIGMOID_STEEPNESS, low, high);
+        return night_temp + (day_temp - night_temp) * factor;
     }
 
     /* Daytime (between windows) */
@@ -60,6 +116,42 @@ int calculate_solar_temp(double minutes_from_sunrise, double minutes_to_sunset,
     return night_temp;
 }
 
+double solar_temp_curve(double minutes_from_sunrise, double minutes_to_sunset,
+                        bool is_dark_mode)
+{
+    return curve_between(minutes_from_sunrise, minutes_to_sunset, is_dark_mode,
+                         sigmoid_raw(-1.0, SIGMOID_STEEPNESS),
+                         sigmoid_raw(1.0, SIGMOID_STEEPNESS));
+}
+
+int calculate_solar_temp(double minutes_from_sunrise, double minutes_to_sunset,
+                         bool is_dark_mode)
+{
+    return (int)solar_temp_curve(minutes_from_sunrise, minutes_to_sunset, is_dark_mode);
+}
+
+void solar_curve_init(solar_curve_t *c, time_t sunrise, time_t sunset)
+{
+    c->sunrise = sunrise;
+    c->sunset  = sunset;
+    c->low     = sigmoid_raw(-1.0, SIGMOID_STEEPNESS);
+    c->high    = sigmoid_raw(1.0, SIGMOID_STEEPNESS);
+}
+
+int solar_curve_kelvin(const solar_curve_t *c, time_t t, bool is_dark_mode)
+{
+    return (int)curve_between(difftime(t, c->sunrise) / 60.0, difftime(c->sunset, t) / 60.0,
+                              is_dark_mode, c->low, c->high);
+}
+
+int sigmoid_fade_temp(int start_temp, int target_temp, double progress)
+{
+    /* Map [0, 1] -> [-1, 1] */
+    double x = 2.0 * progress - 1.0;
+    double factor = sigmoid_norm(x, SIGMOID_STEEPNESS);
+    return (int)(start_temp + (target_temp - start_temp) * factor);
+}
+
 int calculate_manual_temp(int start_temp, int target_temp,
                           time_t start_time, int duration_min, time_t now)
 {
@@ -71,10 +163,7 @@ int calculate_manual_temp(int start_temp, int target_temp,
     if (elapsed_min >= (double)duration_min)
         return target_temp;
 
-    /* Map [0, duration] -> [-1, 1] */
-    double x = 2.0 * (elapsed_min / (double)duration_min) - 1.0;
-    double factor = sigmoid_norm(x, SIGMOID_STEEPNESS);
-    return (int)(start_temp + (target_temp - start_temp) * factor);
+    return sigmoid_fade_temp(start_temp, target_temp, elapsed_min / (double)duration_min);
 }
 
 time_t next_transition_resume(time_t now, double lat, double lon)
@@ -101,3 +190,20 @@ time_t next_transition_resume(time_t now, double lat, double lon)
     if (!st2.valid) return now + SECONDS_PER_DAY;
     return st2.sunrise - (time_t)(DAWN_DURATION / 2 - DAWN_OFFSET + 15) * 60;
 }
+
+time_t next_manual_change(int start_temp, int target_temp,
+                          time_t start_time, int duration_min, time_t now)
+{
+    if (duration_min <= 0) return 0;
+
+    double t0 = (double)start_time;
+    double t1 = t0 + duration_min * 60.0;
+    if ((double)now >= t1) return 0;
+
+    /* calculate_manual_temp maps [0, duration] -> [-1, 1]; before the
+     * start it extrapolates, so wake at the start in that case */
+    if ((double)now < t0) return start_time;
+
+    return sigmoid_next_change(start_temp, target_temp - start_temp,
+                               -1.0, 1.0, t0, t1, now);
+}
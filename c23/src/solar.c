@@ -4,6 +4,12 @@
  * Port of the Python NOAA solar equations from the original ABRAXAS daemon.
  * Julian day -> Julian century -> geometric mean longitude/anomaly ->
  * equation of center -> apparent longitude -> declination -> hour angle.
+ *
+ * The batch forms pay the timezone lookup once per call and the solar
+ * parameters once per local day: sunrise/sunset reuses one solve for
+ * every location, and positions interpolate declination and equation of
+ * time through three solves per day, leaving a cosine and an arccosine
+ * per row.
  */
 
 #define _GNU_SOURCE  /* tm_gmtoff */
@@ -146,21 +152,31 @@ sun_position_t solar_position(time_t when, double lat, double lon)
     return (sun_position_t){ .elevation = 90.0 - zenith };
 }
 
-sun_times_t solar_sunrise_sunset(time_t when, double lat, double lon)
+/* Solar parameters at noon of the local date in 'lt' */
+static solar_params_t noon_params(const struct tm *lt)
 {
-    struct tm lt;
-    localtime_r(&when, &lt);
-
-    /* Use noon of the given day */
-    double jd = julian_day(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday, 12.0);
-    double jc = (jd - 2451545.0) / 36525.0;
+    double jd = julian_day(lt->tm_year + 1900, lt->tm_mon + 1, lt->tm_mday, 12.0);
+    return compute_solar_params((jd - 2451545.0) / 36525.0);
+}
 
-    solar_params_t sp = compute_solar_params(jc);
+/* Base midnight of the local date in 'lt' */
+static time_t local_midnight(const struct tm *lt, int day_offset)
+{
+    struct tm base = {
+        .tm_year = lt->tm_year, .tm_mon = lt->tm_mon, .tm_mday = lt->tm_mday + day_offset,
+        .tm_hour = 0, .tm_min = 0, .tm_sec = 0, .tm_isdst = -1
+    };
+    return mktime(&base);
+}
 
+/* Rise and set at one location, given the day's parameters */
+static sun_times_t rise_set(const solar_params_t *sp, double tz_offset, time_t midnight,
+                            double lat, double lon)
+{
     /* Hour angle for sunrise/sunset (zenith 90.833 degrees) */
     constexpr double zenith = 90.833;
     double lat_rad = deg2rad(lat);
-    double declin_rad = deg2rad(sp.sun_declin);
+    double declin_rad = deg2rad(sp->sun_declin);
 
     double cos_ha = cos(deg2rad(zenith)) / (cos(lat_rad) * cos(declin_rad))
                   - tan(lat_rad) * tan(declin_rad);
@@ -171,17 +187,9 @@ sun_times_t solar_sunrise_sunset(time_t when, double lat, double lon)
     }
 
     double ha = rad2deg(acos(cos_ha));
-    double tz_offset = get_tz_offset_hours();
-
-    double sunrise_min = 720.0 - 4.0 * (lon + ha) - sp.eq_time + tz_offset * 60.0;
-    double sunset_min  = 720.0 - 4.0 * (lon - ha) - sp.eq_time + tz_offset * 60.0;
 
-    /* Base midnight of the given day */
-    struct tm base = {
-        .tm_year = lt.tm_year, .tm_mon = lt.tm_mon, .tm_mday = lt.tm_mday,
-        .tm_hour = 0, .tm_min = 0, .tm_sec = 0, .tm_isdst = -1
-    };
-    time_t midnight = mktime(&base);
+    double sunrise_min = 720.0 - 4.0 * (lon + ha) - sp->eq_time + tz_offset * 60.0;
+    double sunset_min  = 720.0 - 4.0 * (lon - ha) - sp->eq_time + tz_offset * 60.0;
 
     return (sun_times_t){
         .sunrise = midnight + (time_t)(sunrise_min * 60.0),
@@ -189,3 +197,126 @@ sun_times_t solar_sunrise_sunset(time_t when, double lat, double lon)
         .valid   = true
     };
 }
+
+sun_times_t solar_sunrise_sunset(time_t when, double lat, double lon)
+{
+    struct tm lt;
+    localtime_r(&when, &lt);
+
+    /* Use noon of the given day */
+    solar_params_t sp = noon_params(&lt);
+    return rise_set(&sp, get_tz_offset_hours(), local_midnight(&lt, 0), lat, lon);
+}
+
+/* --- Batch --- */
+
+void solar_sunrise_sunset_batch(time_t when, const double *lat, const double *lon,
+                                size_t n, time_t *sunrise, time_t *sunset, bool *valid)
+{
+    struct tm lt;
+    localtime_r(&when, &lt);
+
+    solar_params_t sp = noon_params(&lt);
+    double tz_offset = get_tz_offset_hours();
+    time_t midnight = local_midnight(&lt, 0);
+
+    for (size_t i = 0; i < n; i++) {
+        sun_times_t st = rise_set(&sp, tz_offset, midnight, lat[i], lon[i]);
+        sunrise[i] = st.sunrise;
+        sunset[i]  = st.sunset;
+        valid[i]   = st.valid;
+    }
+}
+
+/*
+ * Rows [i, end) on the local date and UTC offset of row i, which 'lt'
+ * receives. A run also ends where 'when' steps backwards. A DST change
+ * inside the day is found by bisection, so it costs a few localtime_r()
+ * calls rather than one per row.
+ */
+static size_t local_run(const time_t *when, size_t i, size_t n, struct tm *lt)
+{
+    localtime_r(&when[i], lt);
+    time_t day_end = local_midnight(lt, 1);
+
+    size_t end = i + 1;
+    while (end < n && when[end] >= when[end - 1] && when[end] < day_end) end++;
+
+    struct tm probe;
+    localtime_r(&when[end - 1], &probe);
+    if (probe.tm_gmtoff != lt->tm_gmtoff) {
+        size_t lo = i, hi = end - 1;    /* lo has lt's offset, hi does not */
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            localtime_r(&when[mid], &probe);
+            if (probe.tm_gmtoff == lt->tm_gmtoff) lo = mid;
+            else hi = mid;
+        }
+        end = hi;
+    }
+    return end;
+}
+
+/* f(u) = f0 + u * (b + u * c) through (0, f0), (1/2, f1), (1, f2) */
+typedef struct { double f0, b, c; } quad_t;
+
+static quad_t quad_fit(double f0, double f1, double f2)
+{
+    return (quad_t){ .f0 = f0, .b = 4.0 * f1 - 3.0 * f0 - f2,
+                     .c = 2.0 * (f0 - 2.0 * f1 + f2) };
+}
+
+void solar_position_batch(const time_t *when, size_t n, double lat, double lon,
+                          double *elevation)
+{
+    double tz_offset = get_tz_offset_hours();
+    double lat_rad = deg2rad(lat);
+    double sin_lat = sin(lat_rad);
+    double cos_lat = cos(lat_rad);
+
+    for (size_t i = 0; i < n; ) {
+        struct tm lt;
+        size_t end = local_run(when, i, n, &lt);
+
+        /* Julian century of the local wall clock, as solar_position() reads it */
+        time_t local_base = when[i] + lt.tm_gmtoff
+                          - (lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
+        double jd_base = julian_day(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday, 0.0);
+
+        time_t t0 = when[i];
+        double span = (double)(when[end - 1] - t0);
+        double sec0 = (double)(t0 + lt.tm_gmtoff - local_base);
+        double jc[3];
+        for (int k = 0; k < 3; k++)
+            jc[k] = (jd_base + (sec0 + span * 0.5 * k) / 86400.0 - 2451545.0) / 36525.0;
+
+        solar_params_t sp[3] = {
+            compute_solar_params(jc[0]), compute_solar_params(jc[1]), compute_solar_params(jc[2])
+        };
+        quad_t sin_d = quad_fit(sin(deg2rad(sp[0].sun_declin)), sin(deg2rad(sp[1].sun_declin)),
+                                sin(deg2rad(sp[2].sun_declin)));
+        quad_t cos_d = quad_fit(cos(deg2rad(sp[0].sun_declin)), cos(deg2rad(sp[1].sun_declin)),
+                                cos(deg2rad(sp[2].sun_declin)));
+        quad_t eq    = quad_fit(sp[0].eq_time, sp[1].eq_time, sp[2].eq_time);
+
+        double inv_span = span > 0.0 ? 1.0 / span : 0.0;
+        double time_offset = 4.0 * lon - 60.0 * tz_offset;
+
+        for (size_t k = i; k < end; k++) {
+            double u = (double)(when[k] - t0) * inv_span;
+            double sd = sin_d.f0 + u * (sin_d.b + u * sin_d.c);
+            double cd = cos_d.f0 + u * (cos_d.b + u * cos_d.c);
+            double et = eq.f0 + u * (eq.b + u * eq.c);
+
+            /* True solar time and hour angle */
+            double tst = (double)(when[k] + lt.tm_gmtoff - local_base) / 60.0 + et + time_offset;
+            double hour_angle = tst / 4.0 - 180.0;
+            if (hour_angle < -180.0) hour_angle += 360.0;
+
+            double cos_zenith = sin_lat * sd + cos_lat * cd * cos(deg2rad(hour_angle));
+            cos_zenith = fmin(1.0, fmax(-1.0, cos_zenith));
+            elevation[k] = 90.0 - rad2deg(acos(cos_zenith));
+        }
+        i = end;
+    }
+}
@@ -0,0 +1,123 @@
+/*
+ * status.c - Shared-memory status page
+ *
+ * Single writer (the daemon loop), any number of readers. The page is
+ * never unlinked: a clean shutdown clears `running`, a crash leaves a
+ * pid that kill(0) no longer finds.
+ */
+
+#define _GNU_SOURCE
+
+#include "status.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(status_page_t) <= 4096, "status page must fit one page");
+
+/* A writer is a few stores; readers give up rather than spin forever */
+constexpr int STATUS_READ_RETRIES = 1000;
+
+static _Atomic uint32_t *page_seq(status_page_t *page)
+{
+    return (_Atomic uint32_t *)&page->seq;
+}
+
+/* --- Daemon side --- */
+
+status_page_t *status_open(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) return nullptr;
+
+    if (ftruncate(fd, (off_t)sizeof(status_page_t)) < 0) {
+        close(fd);
+        return nullptr;
+    }
+    void *map = mmap(nullptr, sizeof(status_page_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return nullptr;
+
+    /* seq is left alone so it stays monotonic across restarts: a reader
+       racing the previous daemon's last write can't match it by luck */
+    status_page_t *page = map;
+    status_page_t init = {
+        .magic = STATUS_MAGIC,
+        .version = STATUS_VERSION,
+        .pid = (uint32_t)getpid(),
+        .running = 1,
+    };
+    constexpr size_t tail = offsetof(status_page_t, seq) + sizeof(page->seq);
+
+    status_write_begin(page);
+    memcpy(page, &init, offsetof(status_page_t, seq));
+    memcpy((char *)page + tail, (const char *)&init + tail, sizeof(init) - tail);
+    status_write_end(page);
+    return page;
+}
+
+void status_write_begin(status_page_t *page)
+{
+    /* Odd already only if a previous daemon died mid-write */
+    uint32_t seq = atomic_load_explicit(page_seq(page), memory_order_relaxed);
+    atomic_store_explicit(page_seq(page), (seq + 1) | 1u, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+void status_write_end(status_page_t *page)
+{
+    uint32_t seq = atomic_load_explicit(page_seq(page), memory_order_relaxed);
+    atomic_store_explicit(page_seq(page), seq + 1, memory_order_release);
+}
+
+void status_close(status_page_t *page)
+{
+    if (!page) return;
+    status_write_begin(page);
+    page->running = 0;
+    status_write_end(page);
+    munmap(page, sizeof(*page));
+}
+
+/* --- Reader side --- */
+
+bool status_read(const char *path, status_page_t *out)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(status_page_t)) {
+        close(fd);
+        return false;
+    }
+    void *map = mmap(nullptr, sizeof(status_page_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    status_page_t *page = map;
+    bool ok = false;
+    for (int i = 0; i < STATUS_READ_RETRIES; i++) {
+        uint32_t before = atomic_load_explicit(page_seq(page), memory_order_acquire);
+        if (before & 1u) continue;
+        memcpy(out, page, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(page_seq(page), memory_order_relaxed) == before) {
+            ok = true;
+            break;
+        }
+    }
+    munmap(map, sizeof(status_page_t));
+
+    if (!ok || out->magic != STATUS_MAGIC || out->version != STATUS_VERSION || !out->running)
+        return false;
+    /* EPERM still means the pid exists */
+    return kill((pid_t)out->pid, 0) == 0 || errno == EPERM;
+}
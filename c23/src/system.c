@@ -0,0 +1,1196 @@
+/*
+ * system.c - System daemon serving every logind session
+ *
+ * Same shape as daemon.c's loop -- one io_uring, one absolute deadline,
+ * polls on everything else -- with a target table in place of the single
+ * gamma state. Targets occupy fixed slots so a poll's tag can name its
+ * slot; a generation in the tag drops completions that belong to an
+ * agent already let go.
+ *
+ * Each target's display is held by an agent process of its own. A
+ * graphical session's agent runs with that user's credentials and
+ * environment, so its compositor, X server or session bus sees an
+ * ordinary client of its own user, and a display that never answers
+ * holds up nothing but that agent.
+ */
+
+#define _GNU_SOURCE
+
+#include "system.h"
+#include "config.h"
+#include "control.h"
+#include "ephemeris.h"
+#include "schedule.h"
+#include "sessions.h"
+#include "sigmoid.h"
+#include "uring.h"
+#include "weather.h"
+
+#include <meridian.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <grp.h>
+#include <poll.h>
+#include <pwd.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* io_uring user_data tags (low half); EV_AGENT carries its target in the high half */
+constexpr uint64_t EV_SIGNAL      = 1;
+constexpr uint64_t EV_INOTIFY     = 2;
+constexpr uint64_t EV_TIMEOUT     = 3;
+constexpr uint64_t EV_TIMEOUT_UPD = 4;
+constexpr uint64_t EV_WEATHER     = 5;
+constexpr uint64_t EV_AGENT       = 6;
+constexpr uint64_t EV_CTL_ACCEPT  = 7;
+constexpr uint64_t EV_CTL_RECV    = 8;
+constexpr uint64_t EV_CTL_SEND    = 9;
+constexpr uint64_t EV_CTL_TIMEOUT = 10;
+constexpr uint64_t EV_WORKER      = 11;
+constexpr uint64_t EV_CLOCK       = 12;
+constexpr uint64_t EV_TAG_MASK    = 0xffffffffULL;
+
+/* Every target's channel plus the fixed ones, all re-armed in one pass */
+constexpr uint32_t SYSTEM_RING_ENTRIES = 128;
+
+/* A session whose display is not up yet (or went away) is retried this often */
+constexpr int TARGET_RETRY_SEC = 5;
+
+/* A display that has not let its agent in by then is given up on */
+constexpr int TARGET_CONNECT_TIMEOUT_SEC = 10;
+
+constexpr int CONTROL_RECV_TIMEOUT_SEC = 2;
+
+/* Suspend time gained across one wait that counts as a resume */
+constexpr int64_t RESUME_JUMP_NS = 1000000000LL;
+
+/* --- Targets --- */
+
+/* Each target's display is driven by an agent process; the daemon holds
+   only the agent's end of a socketpair */
+typedef struct {
+    bool              used;
+    session_info_t    info;
+    pid_t             agent;        /* 0: none, see retry_at */
+    int               chan;         /* SEQPACKET to the agent while there is one */
+    bool              ready;        /* the agent has its display open */
+    time_t            connect_by;   /* an agent not ready by then is killed */
+    time_t            retry_at;
+    bool              warned;       /* connect failure already logged */
+    uint16_t          gen;          /* bumped per agent, tags its poll */
+    bool              polled;
+    bool              readable;     /* the poll fired; read after the drain */
+    int               last_temp;    /* 0 = nothing applied by this agent */
+} target_t;
+
+static target_t targets[SESSIONS_MAX];
+
+/* A user's override: the daemon's manual_* fields, one set per uid */
+typedef struct {
+    bool   active;
+    uid_t  uid;
+    int    start_temp;
+    int    target_temp;
+    time_t start_time;
+    int    duration_min;
+    time_t resume_time;
+} user_override_t;
+
+/* Every user with a session, plus root */
+static user_override_t overrides[SESSIONS_MAX + 1];
+
+static ephemeris_t ephem;
+static schedule_t sched;
+
+static uint64_t agent_tag(int slot, uint16_t gen)
+{
+    return EV_AGENT | (uint64_t)slot << 32 | (uint64_t)gen << 48;
+}
+
+static const char *session_type_name(session_type_t type)
+{
+    switch (type) {
+    case SESSION_TTY:     return "tty";
+    case SESSION_X11:     return "x11";
+    case SESSION_WAYLAND: return "wayland";
+    case SESSION_OTHER:   break;
+    }
+    return "other";
+}
+
+/* --- Session environment --- */
+
+static const char *const session_vars[] = {
+    "XDG_RUNTIME_DIR", "WAYLAND_DISPLAY", "DISPLAY",
+    "DBUS_SESSION_BUS_ADDRESS", "XAUTHORITY", "HOME",
+};
+#define SESSION_VAR_COUNT (sizeof(session_vars) / sizeof(session_vars[0]))
+
+static bool path_is(const char *path, mode_t type)
+{
+    struct stat st;
+    return stat(path, &st) == 0 && (st.st_mode & S_IFMT) == type;
+}
+
+/* Lowest-numbered wayland-N socket in the runtime dir: the session's compositor */
+static bool find_wayland_socket(const char *runtime, char *name, size_t cap)
+{
+    DIR *d = opendir(runtime);
+    if (!d) return false;
+
+    long best = -1;
+    const struct dirent *de;
+    while ((de = readdir(d))) {
+        if (strncmp(de->d_name, "wayland-", 8) != 0) continue;
+        char *end;
+        long n = strtol(de->d_name + 8, &end, 10);
+        if (end == de->d_name + 8 || *end != '\0' || (best >= 0 && n >= best)) continue;
+
+        char path[ABRAXAS_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", runtime, de->d_name);
+        if (path_is(path, S_IFSOCK)) best = n;
+    }
+    closedir(d);
+
+    if (best < 0) return false;
+    snprintf(name, cap, "wayland-%ld", best);
+    return true;
+}
+
+/* The variables a client of the session would have. Returns false if the
+   display is not reachable (yet). */
+static bool env_enter(const session_info_t *s, const struct passwd *pw)
+{
+    for (size_t i = 0; i < SESSION_VAR_COUNT; i++) unsetenv(session_vars[i]);
+
+    char runtime[64], buf[ABRAXAS_PATH_MAX];
+    snprintf(runtime, sizeof(runtime), "/run/user/%u", (unsigned)s->uid);
+    setenv("XDG_RUNTIME_DIR", runtime, 1);
+    setenv("HOME", pw->pw_dir, 1);
+
+    snprintf(buf, sizeof(buf), "%s/bus", runtime);
+    if (path_is(buf, S_IFSOCK)) {
+        char addr[ABRAXAS_PATH_MAX + 16];
+        snprintf(addr, sizeof(addr), "unix:path=%s", buf);
+        setenv("DBUS_SESSION_BUS_ADDRESS", addr, 1);
+    }
+
+    if (s->display[0]) {
+        setenv("DISPLAY", s->display, 1);
+        /* gdm keeps the cookie in the runtime dir, others in ~/.Xauthority */
+        snprintf(buf, sizeof(buf), "%s/gdm/Xauthority", runtime);
+        if (path_is(buf, S_IFREG)) setenv("XAUTHORITY", buf, 1);
+    }
+
+    if (s->type == SESSION_WAYLAND) {
+        char name[32];
+        if (!find_wayland_socket(runtime, name, sizeof(name))) return false;
+        setenv("WAYLAND_DISPLAY", name, 1);
+    }
+    return s->type != SESSION_X11 || s->display[0];
+}
+
+static bool session_graphical(const session_info_t *s)
+{
+    return s->type == SESSION_X11 || s->type == SESSION_WAYLAND;
+}
+
+/* Open the session's display as its user: every credential one of its
+   own clients has, supplementary groups included, dropped for good.
+   Text consoles (and anything without a display server) get DRM on
+   their seat's card and keep root for it. */
+static meridian_error_t session_open(const session_info_t *s, int card,
+                                     meridian_state_t **gamma)
+{
+    if (!session_graphical(s)) return meridian_init_card(card, gamma);
+
+    char pwbuf[1024];
+    struct passwd pwd, *pw = nullptr;
+    if (getpwuid_r(s->uid, &pwd, pwbuf, sizeof(pwbuf), &pw) != 0 || !pw)
+        return MERIDIAN_ERR_PERMISSION;
+    if (initgroups(pw->pw_name, pw->pw_gid) != 0 ||
+        setresgid(pw->pw_gid, pw->pw_gid, pw->pw_gid) != 0 ||
+        setresuid(s->uid, s->uid, s->uid) != 0)
+        return MERIDIAN_ERR_PERMISSION;
+    prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+
+    if (!env_enter(s, pw)) return MERIDIAN_ERR_NO_CRTC;
+    return meridian_init(gamma);
+}
+
+/* --- Session agents --- */
+
+/*
+ * One process per target, forked from the daemon like the weather
+ * worker. It opens the display, answers "C <err> <outputs> <backend>",
+ * then applies each "T <kelvin>" and dispatches display events. A display
+ * that hangs stalls its own agent only. On EOF the agent frees its
+ * state, which restores the session's original ramps; when the display
+ * goes away it just exits, and the daemon sees EOF in turn.
+ */
+
+#define AGENT_MSG_MAX 64
+
+static void agent_main(int sock, const session_info_t *s, int card)
+{
+    /* Only the channel and stdio: no other session's display, no uring */
+    if (dup2(sock, 3) < 0) _exit(1);
+    sock = 3;
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, 4u, ~0u, 0u) != 0)
+#endif
+        for (int fd = 4; fd < 1024; fd++) close(fd);
+
+    /* The daemon blocks these for its signalfd */
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+
+    meridian_state_t *gamma = nullptr;
+    meridian_error_t err = session_open(s, card, &gamma);
+    char msg[AGENT_MSG_MAX];
+    int len = err == MERIDIAN_OK
+        ? snprintf(msg, sizeof(msg), "C 0 %d %s", meridian_get_crtc_count(gamma),
+                   meridian_get_backend_name(gamma))
+        : snprintf(msg, sizeof(msg), "C %d 0 -", (int)err);
+    if (send(sock, msg, (size_t)len, MSG_NOSIGNAL) < 0 || err != MERIDIAN_OK) _exit(0);
+
+    int fds[MERIDIAN_MAX_FDS];
+    int nfds = meridian_get_fds(gamma, fds, MERIDIAN_MAX_FDS);
+    if (nfds < 0) nfds = 0;
+    struct pollfd pfd[1 + MERIDIAN_MAX_FDS] = { { .fd = sock, .events = POLLIN } };
+    for (int i = 0; i < nfds; i++) pfd[1 + i] = (struct pollfd){ .fd = fds[i], .events = POLLIN };
+
+    for (;;) {
+        if (poll(pfd, (nfds_t)(1 + nfds), -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        bool events = false;
+        for (int i = 0; i < nfds; i++) events |= pfd[1 + i].revents != 0;
+        if (events && meridian_dispatch(gamma) != MERIDIAN_OK) _exit(1);
+        if (!pfd[0].revents) continue;
+
+        ssize_t n = recv(sock, msg, sizeof(msg) - 1, 0);
+        if (n <= 0) break;
+        msg[n] = '\0';
+        int temp;
+        if (sscanf(msg, "T %d", &temp) != 1) continue;
+        err = meridian_set_temperature(gamma, temp, 1.0f);
+        if (err != MERIDIAN_OK)
+            fprintf(stderr, "[session] %s: set %dK failed: %s\n",
+                    s->id, temp, meridian_strerror(err));
+    }
+    meridian_free(gamma);
+    _exit(0);
+}
+
+static void target_disconnect(abraxas_ring_t *ring, target_t *t, int slot)
+{
+    if (t->polled) uring_prep_cancel(ring, agent_tag(slot, t->gen), 0);
+    /* One that never opened its display may be stuck in it */
+    if (t->agent > 0 && !t->ready) kill(t->agent, SIGKILL);
+    if (t->agent > 0) close(t->chan);
+    t->agent = 0;
+    t->chan = -1;
+    t->ready = false;
+    t->polled = false;
+    t->readable = false;
+    t->last_temp = 0;
+}
+
+static void target_connect(target_t *t, time_t now)
+{
+    /* A console on a seat without a card of its own has nothing to drive;
+       another seat's card is not its screen */
+    int card = -1;
+    if (!session_graphical(&t->info)) {
+        card = seat_drm_card(DRM_CLASS_DIR, UDEV_DATA_DIR, t->info.seat);
+        if (card < 0) {
+            if (!t->warned)
+                fprintf(stderr, "[session] %s (%s, %s on %s): seat has no DRM card, skipped\n",
+                        t->info.id, t->info.user, session_type_name(t->info.type),
+                        t->info.seat[0] ? t->info.seat : "no seat");
+            t->warned = true;
+            t->retry_at = now + TARGET_RETRY_SEC;
+            return;
+        }
+    }
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) {
+        t->retry_at = now + TARGET_RETRY_SEC;
+        return;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(sv[0]);
+        agent_main(sv[1], &t->info, card);
+    }
+    close(sv[1]);
+    if (pid < 0) {
+        fprintf(stderr, "[session] %s: fork: %s\n", t->info.id, strerror(errno));
+        close(sv[0]);
+        t->retry_at = now + TARGET_RETRY_SEC;
+        return;
+    }
+
+    t->agent = pid;
+    t->chan = sv[0];
+    t->ready = false;
+    t->connect_by = now + TARGET_CONNECT_TIMEOUT_SEC;
+    t->gen++;
+}
+
+static void target_lost(abraxas_ring_t *ring, target_t *t, int slot, time_t now)
+{
+    target_disconnect(ring, t, slot);
+    t->retry_at = now + TARGET_RETRY_SEC;
+}
+
+/* The agent's hello, or EOF once its display is gone */
+static void target_read(abraxas_ring_t *ring, target_t *t, int slot, time_t now)
+{
+    char msg[AGENT_MSG_MAX];
+    ssize_t n;
+    while ((n = recv(t->chan, msg, sizeof(msg) - 1, MSG_DONTWAIT)) > 0) {
+        msg[n] = '\0';
+        int err, outputs;
+        char backend[16];
+        if (t->ready || sscanf(msg, "C %d %d %15s", &err, &outputs, backend) != 3) continue;
+        if (err != MERIDIAN_OK) {
+            if (!t->warned)
+                fprintf(stderr, "[session] %s (%s, %s): no display yet (%s), retrying every %ds\n",
+                        t->info.id, t->info.user, session_type_name(t->info.type),
+                        meridian_strerror((meridian_error_t)err), TARGET_RETRY_SEC);
+            t->warned = true;
+            target_lost(ring, t, slot, now);
+            return;
+        }
+        t->ready = true;
+        t->warned = false;
+        fprintf(stderr, "[session] %s (%s, %s%s%s): %s backend, %d outputs\n",
+                t->info.id, t->info.user, session_type_name(t->info.type),
+                t->info.seat[0] ? " on " : "", t->info.seat, backend, outputs);
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+
+    if (t->ready) fprintf(stderr, "[session] %s: display connection lost\n", t->info.id);
+    target_lost(ring, t, slot, now);
+}
+
+/* Follow logind: keep targets that are still there, drop the rest,
+   connect the new ones */
+static void targets_rescan(abraxas_ring_t *ring, time_t now)
+{
+    session_info_t found[SESSIONS_MAX];
+    int n = sessions_scan(SESSIONS_DIR, found, SESSIONS_MAX);
+    bool kept[SESSIONS_MAX] = {0};
+
+    for (int slot = 0; slot < SESSIONS_MAX; slot++) {
+        target_t *t = &targets[slot];
+        if (!t->used) continue;
+        int match = -1;
+        for (int j = 0; j < n && match < 0; j++)
+            if (!kept[j] && session_same_target(&found[j], &t->info)) match = j;
+        if (match >= 0) {
+            kept[match] = true;
+            t->info = found[match];
+            continue;
+        }
+        fprintf(stderr, "[session] %s (%s) no longer active\n", t->info.id, t->info.user);
+        target_disconnect(ring, t, slot);
+        t->used = false;
+    }
+
+    for (int j = 0; j < n; j++) {
+        if (kept[j]) continue;
+        int slot = 0;
+        while (slot < SESSIONS_MAX && targets[slot].used) slot++;
+        if (slot == SESSIONS_MAX) break;    /* found[] holds at most as many */
+
+        target_t *t = &targets[slot];
+        uint16_t gen = t->gen;
+        *t = (target_t){ .used = true, .info = found[j], .chan = -1, .gen = gen };
+        target_connect(t, now);
+    }
+}
+
+/* --- Temperature --- */
+
+static const ephemeris_t *solar_ephemeris(time_t now, location_t loc)
+{
+    if (!ephemeris_current(&ephem, now, loc.lat, loc.lon)) {
+        bool mapped = schedule_fill(&sched, &ephem, now, loc.lat, loc.lon);
+        if (!mapped) ephemeris_build(&ephem, now, loc.lat, loc.lon);
+        struct tm dt;
+        localtime_r(&ephem.day_start, &dt);
+        fprintf(stderr, "[solar] Ephemeris for %04d-%02d-%02d (%d min%s)\n",
+                dt.tm_year + 1900, dt.tm_mon + 1, dt.tm_mday, ephem.minutes,
+                mapped ? ", from schedule" : "");
+    }
+    return &ephem;
+}
+
+static bool weather_is_dark(const weather_data_t *weather, time_t when)
+{
+    return weather_cloud_at(weather, when) >= CLOUD_THRESHOLD;
+}
+
+static user_override_t *override_slot(uid_t uid, bool create)
+{
+    user_override_t *unused = nullptr;
+    for (size_t i = 0; i < sizeof(overrides) / sizeof(overrides[0]); i++) {
+        if (overrides[i].active && overrides[i].uid == uid) return &overrides[i];
+        if (!overrides[i].active && !unused) unused = &overrides[i];
+    }
+    return create ? unused : nullptr;
+}
+
+/* The user's own override, else root's */
+static const user_override_t *override_for(uid_t uid)
+{
+    const user_override_t *o = override_slot(uid, false);
+    return o ? o : override_slot(0, false);
+}
+
+static int override_temp(const user_override_t *o, time_t now)
+{
+    return calculate_manual_temp(o->start_temp, o->target_temp, o->start_time,
+                                 o->duration_min, now);
+}
+
+/* As the daemon's tick: a held override ends at its auto-resume time */
+static void overrides_expire(time_t now)
+{
+    for (size_t i = 0; i < sizeof(overrides) / sizeof(overrides[0]); i++) {
+        user_override_t *o = &overrides[i];
+        if (!o->active) continue;
+        double elapsed = difftime(now, o->start_time) / 60.0;
+        if (elapsed >= (double)o->duration_min && o->resume_time > 0 && now >= o->resume_time) {
+            o->active = false;
+            fprintf(stderr, "[manual] uid %u: auto-resuming solar control\n", (unsigned)o->uid);
+        }
+    }
+}
+
+/* First connected target of uid; any target for root */
+static const target_t *target_of(uid_t uid)
+{
+    for (int i = 0; i < SESSIONS_MAX; i++)
+        if (targets[i].used && targets[i].ready && (uid == 0 || targets[i].info.uid == uid))
+            return &targets[i];
+    return nullptr;
+}
+
+/* Next second anything changes: the solar curve or its clear/dark flip,
+   each override's next step or resume, a target retry or connect timeout,
+   a weather refresh */
+static time_t next_wakeup(location_t loc, const weather_data_t *weather,
+                          bool weather_idle, time_t weather_next_try, time_t now)
+{
+    time_t next = ephemeris_next_change(solar_ephemeris(now, loc), now,
+                                        weather_is_dark(weather, now));
+    time_t flip = weather_next_dark_change(weather, now);
+    if (flip > now && flip < next) next = flip;
+
+    for (size_t i = 0; i < sizeof(overrides) / sizeof(overrides[0]); i++) {
+        const user_override_t *o = &overrides[i];
+        if (!o->active) continue;
+        time_t at = next_manual_change(o->start_temp, o->target_temp, o->start_time,
+                                       o->duration_min, now);
+        if (at == 0) at = o->resume_time;
+        if (at > now && at < next) next = at;
+    }
+
+    for (int i = 0; i < SESSIONS_MAX; i++) {
+        const target_t *t = &targets[i];
+        if (!t->used) continue;
+        if (!t->agent && t->retry_at < next) next = t->retry_at;
+        if (t->agent && !t->ready && t->connect_by < next) next = t->connect_by;
+    }
+
+#ifndef NOAA_DISABLED
+    if (weather_idle) {
+        time_t due = (weather->has_error || weather->fetched_at == 0)
+            ? now + WEATHER_RETRY_SEC
+            : config_weather_refresh_at(weather) + 1;
+        if (due <= now) due = now + WEATHER_RETRY_SEC;
+        if (due < weather_next_try) due = weather_next_try;
+        if (due < next) next = due;
+    }
+#else
+    (void)weather_idle;
+    (void)weather_next_try;
+#endif
+
+    return next > now ? next : now + 1;
+}
+
+static void deadline_to_timespec(time_t deadline, struct __kernel_timespec *ts)
+{
+    struct timespec real, boot;
+    clock_gettime(CLOCK_REALTIME, &real);
+    clock_gettime(CLOCK_BOOTTIME, &boot);
+    int64_t delta = (int64_t)deadline * 1000000000LL -
+                    ((int64_t)real.tv_sec * 1000000000LL + real.tv_nsec);
+    if (delta < 0) delta = 0;
+
+    int64_t when = (int64_t)boot.tv_sec * 1000000000LL + boot.tv_nsec + delta;
+    ts->tv_sec  = when / 1000000000LL;
+    ts->tv_nsec = when % 1000000000LL;
+}
+
+/* --- Control socket --- */
+
+typedef enum {
+    CTL_IDLE,
+    CTL_ACCEPTING,
+    CTL_CONNECTED,
+    CTL_RECEIVING,
+    CTL_REQUEST,
+    CTL_WAIT_WEATHER,
+    CTL_SENDING,
+    CTL_CLOSING,
+} ctl_phase_t;
+
+typedef struct {
+    int         listen_fd;
+    int         fd;
+    uid_t       uid;            /* SO_PEERCRED of the connected client */
+    ctl_phase_t phase;
+    int         len;
+    char        buf[CONTROL_MSG_MAX];
+    control_request_t req;
+    control_reply_t   reply;
+    struct __kernel_timespec recv_timeout;
+} control_conn_t;
+
+static bool peer_uid(int fd, uid_t *uid)
+{
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0) return false;
+    *uid = cred.uid;
+    return true;
+}
+
+static void control_reply_now(abraxas_ring_t *ring, control_conn_t *ctl)
+{
+    size_t n = control_format_reply(&ctl->reply, ctl->buf, sizeof(ctl->buf));
+    uring_prep_send(ring, ctl->fd, ctl->buf, n, EV_CTL_SEND);
+    ctl->phase = CTL_SENDING;
+}
+
+static void control_error(abraxas_ring_t *ring, control_conn_t *ctl, const char *msg)
+{
+    ctl->reply = (control_reply_t){ .cloud_cover = -1 };
+    snprintf(ctl->reply.error, sizeof(ctl->reply.error), "%s", msg);
+    control_reply_now(ring, ctl);
+}
+
+/* Apply a parsed request from ctl->uid. Returns false if the reply waits
+   for the weather fetch; errors are answered here. */
+static bool control_apply(abraxas_ring_t *ring, control_conn_t *ctl, location_t loc,
+                          const weather_data_t *weather, time_t now)
+{
+    const control_request_t *req = &ctl->req;
+    const target_t *t = target_of(ctl->uid);
+    if (!t && ctl->uid != 0 && req->op != CONTROL_REFRESH) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "no active session for uid %u", (unsigned)ctl->uid);
+        control_error(ring, ctl, msg);
+        return true;
+    }
+
+    switch (req->op) {
+    case CONTROL_SET: {
+        user_override_t *o = override_slot(ctl->uid, true);
+        if (!o) {
+            control_error(ring, ctl, "too many overrides");
+            return true;
+        }
+        int start = t && t->last_temp > 0
+            ? t->last_temp
+            : ephemeris_temp(solar_ephemeris(now, loc), now, weather_is_dark(weather, now));
+        *o = (user_override_t){
+            .active = true,
+            .uid = ctl->uid,
+            .start_temp = start,
+            .target_temp = req->target_temp,
+            .start_time = now,
+            .duration_min = req->fade_ms > 0 ? 0 : req->duration_minutes,
+            .resume_time = next_transition_resume(now, loc.lat, loc.lon),
+        };
+        fprintf(stderr, "[manual] uid %u: %dK -> %dK over %d min\n", (unsigned)ctl->uid,
+                o->start_temp, o->target_temp, o->duration_min);
+        break;
+    }
+    case CONTROL_RESUME: {
+        user_override_t *o = override_slot(ctl->uid, false);
+        if (o) {
+            o->active = false;
+            fprintf(stderr, "[manual] uid %u: override cleared\n", (unsigned)ctl->uid);
+        }
+        break;
+    }
+    case CONTROL_REFRESH:
+        return false;
+    }
+    ctl->phase = CTL_REQUEST;
+    return true;
+}
+
+static void control_fill_reply(const control_conn_t *ctl, const weather_data_t *weather,
+                               control_reply_t *reply)
+{
+    const target_t *t = target_of(ctl->uid);
+    const user_override_t *o = override_for(ctl->uid);
+    *reply = (control_reply_t){
+        .ok = true,
+        .temp = t ? t->last_temp : 0,
+        .manual = o != nullptr,
+        .cloud_cover = -1,
+    };
+    if (o) {
+        reply->target_temp = o->target_temp;
+        reply->duration_minutes = o->duration_min;
+        reply->resume_at = o->resume_time;
+    }
+    if (ctl->req.op == CONTROL_REFRESH && !weather->has_error) {
+        reply->cloud_cover = weather->cloud_cover;
+        snprintf(reply->forecast, sizeof(reply->forecast), "%s", weather->forecast);
+    }
+}
+
+/* --- Event loop --- */
+
+static int create_signalfd_masked(void)
+{
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGCHLD);      /* an agent exited */
+    if (sigprocmask(SIG_BLOCK, &mask, nullptr) < 0) return -1;
+    return signalfd(-1, &mask, SFD_CLOEXEC | SFD_NONBLOCK);
+}
+
+/* As daemon.c: the /etc watch stands in for glibc's per-call stat of
+   /etc/localtime, and a changed TZ value forces the re-read */
+static void pin_timezone(void)
+{
+    if (!getenv("TZ")) setenv("TZ", ":/etc/localtime", 1);
+    tzset();
+}
+
+static void reload_timezone(void)
+{
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    setenv("TZ", ":/etc/localtime", 1);
+    tzset();
+}
+
+/* A realtime timerfd that never expires (2^40 s out) but is cancelled
+   whenever the wall clock jumps, including on resume */
+static bool arm_clock_watch(int fd)
+{
+    struct itimerspec its = {
+        .it_value = { .tv_sec = (time_t)1 << 40, .tv_nsec = 0 }
+    };
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET,
+                           &its, nullptr) == 0;
+}
+
+static int create_clock_watch(void)
+{
+    int fd = timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd >= 0 && !arm_clock_watch(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Time spent suspended so far (BOOTTIME counts it, MONOTONIC does not) */
+static int64_t suspend_offset_ns(void)
+{
+    struct timespec boot, mono;
+    clock_gettime(CLOCK_BOOTTIME, &boot);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    return (int64_t)(boot.tv_sec - mono.tv_sec) * 1000000000LL + (boot.tv_nsec - mono.tv_nsec);
+}
+
+static int listen_system_socket(const char *path)
+{
+    /* RuntimeDirectory= normally made it; a manual start makes it here */
+    char dir[ABRAXAS_PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash) {
+        *slash = '\0';
+        if (mkdir(dir, 0755) < 0 && errno != EEXIST) return -1;
+    }
+
+    int fd = control_listen(path);
+    if (fd >= 0 && chmod(path, 0666) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int system_run(const abraxas_paths_t *paths, location_t location)
+{
+    if (geteuid() != 0) {
+        fprintf(stderr, "[fatal] --system runs as root: it opens each session as its user\n");
+        return 1;
+    }
+
+    fprintf(stderr, "Starting abraxas system daemon\n");
+    fprintf(stderr, "Location: %.4f, %.4f\n", location.lat, location.lon);
+    fprintf(stderr, "State: %s\n", paths->config_dir);
+
+    /* A display server going away must not kill the daemon over a write */
+    signal(SIGPIPE, SIG_IGN);
+    int signal_fd = create_signalfd_masked();
+    pin_timezone();
+
+    if (schedule_open(&sched, paths->schedule_file) &&
+        !schedule_matches(&sched, location.lat, location.lon))
+        fprintf(stderr, "[solar] Schedule is for %.4f, %.4f; computing live\n",
+                sched.hdr->lat, sched.hdr->lon);
+
+    weather_data_t weather = config_load_weather_cache(paths);
+    weather_init();
+
+    const char *config_name = strrchr(paths->config_file, '/') + 1;
+    const char *schedule_name = strrchr(paths->schedule_file, '/') + 1;
+    int inotify_fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    int sessions_wd = -1, tz_wd = -1;
+    if (inotify_fd >= 0) {
+        sessions_wd = inotify_add_watch(inotify_fd, SESSIONS_DIR,
+                                        IN_MOVED_TO | IN_CLOSE_WRITE | IN_DELETE);
+        inotify_add_watch(inotify_fd, paths->config_dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+        tz_wd = inotify_add_watch(inotify_fd, "/etc", IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE);
+    }
+    if (sessions_wd < 0)
+        fprintf(stderr, "[warn] cannot watch %s (%s), sessions picked up on retry only\n",
+                SESSIONS_DIR, strerror(errno));
+
+    /* A resume loses DRM ramps and moves the wall->boottime mapping of the deadline */
+    int clock_fd = create_clock_watch();
+    if (clock_fd < 0)
+        fprintf(stderr, "[warn] timerfd failed, resume detected on next wakeup only\n");
+
+    int control_fd = listen_system_socket(paths->control_socket);
+    if (control_fd >= 0)
+        fprintf(stderr, "[kernel] control socket %s (fd=%d, all users)\n",
+                paths->control_socket, control_fd);
+    else
+        fprintf(stderr, "[warn] control socket failed (%s)\n", strerror(errno));
+
+    abraxas_ring_t ring;
+    if (!uring_init(&ring, SYSTEM_RING_ENTRIES)) {
+        fprintf(stderr, "[fatal] io_uring_setup failed (kernel >= 5.1 required)\n");
+        return 1;
+    }
+    config_write_pid(paths);
+
+    weather_fetch_state_t wfs;
+    gridpoint_cache_t grid = config_load_gridpoint(paths);
+    weather_async_init(&wfs, &grid);
+
+    control_conn_t ctl = {
+        .listen_fd = control_fd,
+        .fd = -1,
+        .recv_timeout = { .tv_sec = CONTROL_RECV_TIMEOUT_SEC },
+    };
+    bool signal_polled = false, inotify_polled = false, weather_polled = false;
+    bool worker_polled = false, clock_polled = false;
+    bool timeout_armed = false;
+    time_t armed_deadline = 0;
+    struct __kernel_timespec ts = {0};
+    constexpr uint32_t timeout_flags = IORING_TIMEOUT_ABS | IORING_TIMEOUT_BOOTTIME;
+    time_t last_log = 0;
+    time_t weather_next_try = 0;    /* a failed fetch is not retried at once */
+    int exit_status = 0;
+    int64_t suspend_offset = suspend_offset_ns();
+
+    targets_rescan(&ring, time(nullptr));
+
+    while (1) {
+        if (ctl.phase == CTL_CLOSING) {
+            close(ctl.fd);
+            ctl.fd = -1;
+            ctl.phase = CTL_IDLE;
+        }
+        if (ctl.phase == CTL_CONNECTED) {
+            if (!peer_uid(ctl.fd, &ctl.uid)) {
+                close(ctl.fd);
+                ctl.fd = -1;
+                ctl.phase = CTL_IDLE;
+            } else {
+                uring_prep_recv(&ring, ctl.fd, ctl.buf, sizeof(ctl.buf), EV_CTL_RECV,
+                                &ctl.recv_timeout, EV_CTL_TIMEOUT);
+                ctl.phase = CTL_RECEIVING;
+            }
+        }
+        if (ctl.listen_fd >= 0 && ctl.phase == CTL_IDLE) {
+            uring_prep_accept(&ring, ctl.listen_fd, EV_CTL_ACCEPT);
+            ctl.phase = CTL_ACCEPTING;
+        }
+
+        if (signal_fd >= 0 && !signal_polled) {
+            uring_prep_poll(&ring, signal_fd, EV_SIGNAL);
+            signal_polled = true;
+        }
+        if (inotify_fd >= 0 && !inotify_polled) {
+            uring_prep_poll(&ring, inotify_fd, EV_INOTIFY);
+            inotify_polled = true;
+        }
+        if (clock_fd >= 0 && !clock_polled) {
+            uring_prep_poll(&ring, clock_fd, EV_CLOCK);
+            clock_polled = true;
+        }
+#ifndef NOAA_DISABLED
+        bool weather_idle = wfs.phase == WEATHER_IDLE;
+        if (wfs.pipe_fd >= 0 && !weather_idle && !weather_polled) {
+            uring_prep_poll(&ring, wfs.pipe_fd, EV_WEATHER);
+            weather_polled = true;
+        }
+        if (weather_worker_fd() >= 0 && !worker_polled) {
+            uring_prep_recvmsg(&ring, weather_worker_fd(), weather_worker_msghdr(),
+                               MSG_CMSG_CLOEXEC, EV_WORKER);
+            worker_polled = true;
+        }
+#else
+        bool weather_idle = true;
+#endif
+        for (int slot = 0; slot < SESSIONS_MAX; slot++) {
+            target_t *t = &targets[slot];
+            if (!t->used || !t->agent || t->polled) continue;
+            uring_prep_poll(&ring, t->chan, agent_tag(slot, t->gen));
+            t->polled = true;
+        }
+
+        time_t wake_now = time(nullptr);
+        time_t deadline = next_wakeup(location, &weather, weather_idle,
+                                      weather_next_try, wake_now);
+        if (!timeout_armed || deadline != armed_deadline) {
+            deadline_to_timespec(deadline, &ts);
+            if (timeout_armed)
+                uring_prep_timeout_update(&ring, &ts, EV_TIMEOUT, timeout_flags, EV_TIMEOUT_UPD);
+            else
+                uring_prep_timeout(&ring, &ts, timeout_flags, EV_TIMEOUT);
+            timeout_armed = true;
+            armed_deadline = deadline;
+        }
+
+        int ret = uring_submit_and_wait(&ring);
+        if (ret < 0 && errno != EINTR) break;
+
+        bool shutdown = false, reap = false, rescan = false, config_changed = false;
+        bool schedule_changed = false, control_ready = false;
+        bool clock_changed = false, tz_changed = false;
+        [[maybe_unused]] bool weather_ready = false;
+        struct io_uring_cqe *cqe;
+        while (uring_peek_cqe(&ring, &cqe)) {
+            bool more = cqe->flags & IORING_CQE_F_MORE;
+            switch (cqe->user_data & EV_TAG_MASK) {
+            case EV_SIGNAL: {
+                struct signalfd_siginfo si;
+                while (read(signal_fd, &si, sizeof(si)) > 0) {
+                    if (si.ssi_signo == SIGCHLD) reap = true;
+                    else shutdown = true;
+                }
+                if (!more) signal_polled = false;
+                break;
+            }
+            case EV_INOTIFY: {
+                char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+                ssize_t len = read(inotify_fd, buf, sizeof(buf));
+                for (const char *p = buf; len > 0 && p < buf + len; ) {
+                    const struct inotify_event *ev = (const struct inotify_event *)p;
+                    if (ev->wd == sessions_wd || (ev->mask & IN_Q_OVERFLOW))
+                        rescan = true;
+                    else if (ev->wd == tz_wd)
+                        tz_changed |= ev->len > 0 && strcmp(ev->name, "localtime") == 0;
+                    else if (ev->len > 0 && strcmp(ev->name, config_name) == 0)
+                        config_changed = true;
+                    else if (ev->len > 0 && strcmp(ev->name, schedule_name) == 0)
+                        schedule_changed = true;
+                    p += sizeof(*ev) + ev->len;
+                }
+                if (!more) inotify_polled = false;
+                break;
+            }
+            case EV_CLOCK:
+                clock_changed = true;
+                if (!more) clock_polled = false;
+                break;
+            case EV_TIMEOUT:
+                timeout_armed = false;
+                break;
+            case EV_TIMEOUT_UPD:
+                if (cqe->res < 0 && cqe->res != -ENOENT) timeout_armed = false;
+                break;
+            case EV_WEATHER:
+                if (cqe->res > 0) weather_ready = true;
+                if (!more) weather_polled = false;
+                break;
+            case EV_WORKER:
+                worker_polled = false;
+                if (weather_async_reply(&wfs, cqe->res)) weather_ready = true;
+                break;
+            case EV_AGENT: {
+                int slot = (int)(cqe->user_data >> 32 & 0xff);
+                uint16_t gen = (uint16_t)(cqe->user_data >> 48);
+                target_t *t = slot < SESSIONS_MAX ? &targets[slot] : nullptr;
+                if (!t || !t->used || !t->agent || t->gen != gen)
+                    break;      /* an agent already let go */
+                if (cqe->res > 0) t->readable = true;
+                if (!more) t->polled = false;
+                break;
+            }
+            case EV_CTL_ACCEPT:
+                if (cqe->res >= 0) {
+                    ctl.fd = cqe->res;
+                    ctl.phase = CTL_CONNECTED;
+                } else {
+                    ctl.phase = CTL_IDLE;
+                }
+                break;
+            case EV_CTL_RECV:
+                if (cqe->res > 0) {
+                    ctl.len = cqe->res;
+                    control_ready = true;
+                } else {
+                    ctl.phase = CTL_CLOSING;
+                }
+                break;
+            case EV_CTL_SEND:
+                ctl.phase = CTL_CLOSING;
+                break;
+            default:
+                break;      /* link timeouts, cancels */
+            }
+            uring_cqe_seen(&ring);
+        }
+
+        if (shutdown) {
+            fprintf(stderr, "\nReceived shutdown signal...\n");
+            weather_async_cleanup(&wfs);
+            break;
+        }
+
+        /* Wall clock jumped or we resumed: every ramp is reapplied, and the
+           deadline is re-armed against the new wall->boottime mapping */
+        int64_t offset = suspend_offset_ns();
+        bool resumed = offset - suspend_offset >= RESUME_JUMP_NS;
+        if (clock_changed) {
+            uint64_t expirations;
+            ssize_t n = read(clock_fd, &expirations, sizeof(expirations));
+            (void)n; /* -ECANCELED is the expected result */
+            arm_clock_watch(clock_fd);
+        }
+        if (resumed || clock_changed) {
+            if (resumed)
+                fprintf(stderr, "[kernel] Resumed after %.0fs suspend, reapplying\n",
+                        (double)(offset - suspend_offset) / 1e9);
+            else
+                fprintf(stderr, "[kernel] Wall clock changed, reapplying\n");
+            suspend_offset = offset;
+            for (int slot = 0; slot < SESSIONS_MAX; slot++) targets[slot].last_temp = 0;
+            ephemeris_invalidate(&ephem);
+            armed_deadline = 0;
+        }
+        if (tz_changed) {
+            reload_timezone();
+            fprintf(stderr, "[inotify] /etc/localtime changed, timezone reloaded\n");
+            ephemeris_invalidate(&ephem);
+            armed_deadline = 0;
+        }
+
+        time_t now = time(nullptr);
+
+        /* Agents' hellos and exits; a lost display is reopened later */
+        for (int slot = 0; slot < SESSIONS_MAX; slot++) {
+            target_t *t = &targets[slot];
+            if (!t->used || !t->agent) continue;
+            if (t->readable) {
+                t->readable = false;
+                target_read(&ring, t, slot, now);
+            }
+            if (t->agent && !t->ready && now >= t->connect_by) {
+                if (!t->warned)
+                    fprintf(stderr, "[session] %s (%s): display did not answer in %ds, "
+                            "retrying every %ds\n", t->info.id, t->info.user,
+                            TARGET_CONNECT_TIMEOUT_SEC, TARGET_RETRY_SEC);
+                t->warned = true;
+                target_lost(&ring, t, slot, now);
+            }
+        }
+        if (reap)
+            while (waitpid(-1, nullptr, WNOHANG) > 0) {}
+
+        if (rescan) targets_rescan(&ring, now);
+        for (int slot = 0; slot < SESSIONS_MAX; slot++) {
+            target_t *t = &targets[slot];
+            if (t->used && !t->agent && t->retry_at <= now) target_connect(t, now);
+        }
+
+        if (config_changed) {
+            location_t loc = config_load_location(paths);
+            if (loc.valid && (loc.lat != location.lat || loc.lon != location.lon)) {
+                location = loc;
+                fprintf(stderr, "[config] Location updated: %.4f, %.4f\n", loc.lat, loc.lon);
+                ephemeris_invalidate(&ephem);
+            }
+        }
+        if (schedule_changed) {
+            fprintf(stderr, "[inotify] schedule.bin replaced, remapping\n");
+            schedule_close(&sched);
+            schedule_open(&sched, paths->schedule_file);
+            ephemeris_invalidate(&ephem);
+        }
+
+        [[maybe_unused]] bool waits_weather = false;
+        if (control_ready) {
+            if (!control_parse_request(ctl.buf, (size_t)ctl.len, &ctl.req))
+                control_error(&ring, &ctl, "bad request");
+            else if (!control_apply(&ring, &ctl, location, &weather, now)) {
+#ifndef NOAA_DISABLED
+                ctl.phase = CTL_WAIT_WEATHER;
+                waits_weather = true;
+#else
+                control_error(&ring, &ctl, "weather support not built");
+#endif
+            }
+        }
+
+#ifndef NOAA_DISABLED
+        /* One fetch for every session. Any user may --refresh, so within
+           WEATHER_RETRY_SEC of the last fetch the reply is the cached weather. */
+        if (waits_weather && wfs.phase == WEATHER_IDLE && now < weather_next_try)
+            ctl.phase = CTL_REQUEST;
+        if (wfs.phase == WEATHER_IDLE && now >= weather_next_try &&
+            (waits_weather || config_weather_needs_refresh(&weather))) {
+            fprintf(stderr, "[weather] Starting fetch...\n");
+            weather_next_try = now + WEATHER_RETRY_SEC;
+            (void)weather_async_start(&wfs, location.lat, location.lon, &weather);
+            weather_polled = false;
+            if (wfs.phase == WEATHER_IDLE && ctl.phase == CTL_WAIT_WEATHER)
+                ctl.phase = CTL_REQUEST;
+        }
+        if (weather_ready && wfs.phase != WEATHER_IDLE) {
+            weather_data_t result;
+            int rc = weather_async_read(&wfs, &result);
+            if (rc == -1) {
+                weather = result;
+                config_save_weather_cache(paths, &weather);
+                if (!weather.has_error)
+                    fprintf(stderr, "  Weather: %s (%d%% clouds)\n",
+                            weather.forecast, weather.cloud_cover);
+                else
+                    fprintf(stderr, "  Weather fetch failed\n");
+            } else if (rc == 2) {
+                weather.fetched_at = now;
+                config_save_weather_cache(paths, &weather);
+                fprintf(stderr, "  Weather unchanged\n");
+            }
+            if ((rc < 0 || rc == 2) && wfs.grid_dirty) {
+                config_save_gridpoint(paths, &wfs.grid);
+                wfs.grid_dirty = false;
+            }
+            if ((rc < 0 || rc == 2) && ctl.phase == CTL_WAIT_WEATHER)
+                ctl.phase = CTL_REQUEST;
+            if (rc != 0) weather_polled = false;
+        }
+
+        /* No weather without a worker; the service manager brings both back */
+        if (weather_worker_lost()) {
+            weather_async_cleanup(&wfs);
+            exit_status = 1;
+            break;
+        }
+#endif
+
+        /* --- Tick: one solar value, each target's override on top --- */
+
+        overrides_expire(now);
+        int solar = ephemeris_temp(solar_ephemeris(now, location), now,
+                                   weather_is_dark(&weather, now));
+        int changed = 0;
+        for (int slot = 0; slot < SESSIONS_MAX; slot++) {
+            target_t *t = &targets[slot];
+            if (!t->used || !t->ready) continue;
+            const user_override_t *o = override_for(t->info.uid);
+            int temp = o ? override_temp(o, now) : solar;
+            if (temp == t->last_temp) continue;
+
+            /* The agent applies it; a full channel means it is stuck in its
+               display, and the next tick tries again */
+            char msg[AGENT_MSG_MAX];
+            int len = snprintf(msg, sizeof(msg), "T %d", temp);
+            if (send(t->chan, msg, (size_t)len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) continue;
+            if (t->last_temp == 0 || o)
+                fprintf(stderr, "[session] %s (%s): %dK%s\n", t->info.id, t->info.user,
+                        temp, o ? " (manual)" : "");
+            t->last_temp = temp;
+            changed++;
+        }
+        if (changed && (difftime(now, last_log) >= 60.0 || solar == TEMP_DAY_CLEAR ||
+                        solar == TEMP_DAY_DARK || solar == TEMP_NIGHT)) {
+            struct tm nt;
+            localtime_r(&now, &nt);
+            fprintf(stderr, "[%02d:%02d:%02d] Solar: %dK (sun: %.1f, clouds: %d%%), "
+                    "%d session%s updated\n", nt.tm_hour, nt.tm_min, nt.tm_sec, solar,
+                    ephemeris_elevation(&ephem, now), weather_cloud_at(&weather, now),
+                    changed, changed == 1 ? "" : "s");
+            last_log = now;
+        }
+
+        if (ctl.phase == CTL_REQUEST) {
+            control_fill_reply(&ctl, &weather, &ctl.reply);
+            control_reply_now(&ring, &ctl);
+        }
+    }
+
+    uring_destroy(&ring);
+
+    fprintf(stderr, "Shutting down...\n");
+    /* EOF has each agent restore its session's ramps; they outlive us */
+    for (int slot = 0; slot < SESSIONS_MAX; slot++) {
+        target_t *t = &targets[slot];
+        if (t->used && t->agent) close(t->chan);
+        *t = (target_t){0};
+    }
+    weather_cleanup();
+    schedule_close(&sched);
+    config_remove_pid(paths);
+
+    if (ctl.fd >= 0) close(ctl.fd);
+    if (inotify_fd >= 0) close(inotify_fd);
+    if (clock_fd >= 0) close(clock_fd);
+    if (signal_fd >= 0) close(signal_fd);
+    if (control_fd >= 0) {
+        close(control_fd);
+        unlink(paths->control_socket);
+    }
+    return exit_status;
+}
@@ -0,0 +1,146 @@
+/*
+ * trace.c - Latency histograms for the daemon hot path
+ *
+ * Log-linear buckets: values below 4 ns map to themselves, above that
+ * each power of two is split into 4 equal buckets. Recording is a clz,
+ * a shift and three adds; no locking, the loop is single-threaded.
+ */
+
+#define _GNU_SOURCE
+
+#include "trace.h"
+
+#include <string.h>
+#include <time.h>
+
+static const char *const phase_names[LAT_PHASES] = {
+    [LAT_TIMER_LATE] = "timer_late",
+    [LAT_CQE]        = "cqe",
+    [LAT_UPDATE]     = "update",
+    [LAT_DISPATCH]   = "dispatch",
+    [LAT_SET]        = "set",
+    [LAT_TICK]       = "tick",
+    [LAT_FRAME]      = "frame",
+};
+
+static lat_hist_t phases[LAT_PHASES];
+
+static struct {
+    char       name[16];
+    lat_hist_t hist;
+} backends[LAT_BACKENDS];
+static int backend_count;
+
+int64_t trace_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static unsigned bucket_index(uint64_t v)
+{
+    constexpr uint64_t linear = 1u << LAT_SUB_BITS;
+    if (v < linear) return (unsigned)v;
+
+    unsigned e = 63u - (unsigned)__builtin_clzll(v);
+    unsigned sub = (unsigned)(v >> (e - LAT_SUB_BITS)) & (linear - 1);
+    return ((e - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + sub;
+}
+
+static uint64_t bucket_upper(unsigned idx)
+{
+    constexpr unsigned linear = 1u << LAT_SUB_BITS;
+    if (idx < linear) return idx;
+
+    unsigned e = (idx >> LAT_SUB_BITS) + LAT_SUB_BITS - 1;
+    uint64_t step = 1ULL << (e - LAT_SUB_BITS);
+    uint64_t lower = (uint64_t)(linear + (idx & (linear - 1))) << (e - LAT_SUB_BITS);
+    return lower + step - 1;
+}
+
+static void hist_add(lat_hist_t *h, int64_t ns)
+{
+    uint64_t v = ns > 0 ? (uint64_t)ns : 0;
+    h->count++;
+    h->sum_ns += v;
+    if (v > h->max_ns) h->max_ns = v;
+    h->bucket[bucket_index(v)]++;
+}
+
+void trace_record(lat_phase_t phase, int64_t ns)
+{
+    if (phase < LAT_PHASES) hist_add(&phases[phase], ns);
+}
+
+void trace_record_backend(const char *backend, int64_t ns)
+{
+    if (!backend) backend = "none";
+
+    int i = 0;
+    while (i < backend_count && strcmp(backends[i].name, backend) != 0) i++;
+    if (i == backend_count) {
+        if (backend_count < LAT_BACKENDS)
+            snprintf(backends[backend_count++].name, sizeof(backends[0].name), "%s", backend);
+        else
+            i = LAT_BACKENDS - 1;
+    }
+    hist_add(&backends[i].hist, ns);
+}
+
+uint64_t lat_hist_quantile(const lat_hist_t *h, double q)
+{
+    if (!h->count) return 0;
+
+    /* Nearest rank: the smallest value with at least q of the samples at or below it */
+    double want = q * (double)h->count;
+    uint64_t rank = (uint64_t)want;
+    if ((double)rank < want || rank == 0) rank++;
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < LAT_BUCKETS; i++) {
+        seen += h->bucket[i];
+        if (seen >= rank) {
+            uint64_t upper = bucket_upper(i);
+            return upper < h->max_ns ? upper : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+/* --- Dump --- */
+
+static void fmt_ns(char *out, size_t cap, uint64_t ns)
+{
+    if (ns < 1000)
+        snprintf(out, cap, "%lu ns", (unsigned long)ns);
+    else if (ns < 1000000)
+        snprintf(out, cap, "%.1f us", (double)ns / 1e3);
+    else if (ns < 1000000000)
+        snprintf(out, cap, "%.1f ms", (double)ns / 1e6);
+    else
+        snprintf(out, cap, "%.2f s", (double)ns / 1e9);
+}
+
+static void dump_row(FILE *out, const char *kind, const char *name, const lat_hist_t *h)
+{
+    char p50[16], p90[16], p99[16], max[16], mean[16];
+    fmt_ns(p50, sizeof(p50), lat_hist_quantile(h, 0.50));
+    fmt_ns(p90, sizeof(p90), lat_hist_quantile(h, 0.90));
+    fmt_ns(p99, sizeof(p99), lat_hist_quantile(h, 0.99));
+    fmt_ns(max, sizeof(max), h->max_ns);
+    fmt_ns(mean, sizeof(mean), h->sum_ns / h->count);
+    fprintf(out, "[latency] %-7s %-10s %8lu %10s %10s %10s %10s %10s\n", kind, name,
+            (unsigned long)h->count, p50, p90, p99, max, mean);
+}
+
+void trace_dump(FILE *out)
+{
+    fprintf(out, "[latency] %-7s %-10s %8s %10s %10s %10s %10s %10s\n",
+            "kind", "name", "count", "p50", "p90", "p99", "max", "mean");
+    for (int i = 0; i < LAT_PHASES; i++)
+        if (phases[i].count) dump_row(out, "phase", phase_names[i], &phases[i]);
+    for (int i = 0; i < backend_count; i++)
+        if (backends[i].hist.count) dump_row(out, "backend", backends[i].name, &backends[i].hist);
+    fprintf(out, "[latency] USDT probes: %s\n", TRACE_USDT ? "compiled in" : "not built");
+    fflush(out);
+}
@@ -4,6 +4,8 @@
  * No liburing dependency. Talks directly to the kernel through:
  *   - syscall(__NR_io_uring_setup, entries, &params)
  *   - syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, ...)
+ *   - syscall(__NR_io_uring_register, ...) for probing, fixed files and
+ *     provided-buffer rings
  *   - mmap for SQ/CQ ring buffers and SQE array
  *
  * Memory ordering: read_barrier/write_barrier around shared ring indices.
@@ -19,6 +21,7 @@
 #include <stdatomic.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/socket.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 
@@ -40,6 +43,12 @@ static inline int sys_io_uring_enter(int fd, uint32_t to_submit,
                         flags, sig, sigsz);
 }
 
+static inline int sys_io_uring_register(int fd, uint32_t opcode, void *arg,
+                                        uint32_t nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
 bool uring_init(abraxas_ring_t *ring, uint32_t entries)
 {
     memset(ring, 0, sizeof(*ring));
@@ -52,6 +61,7 @@ bool uring_init(abraxas_ring_t *ring, uint32_t entries)
     if (fd < 0) return false;
 
     ring->ring_fd = fd;
+    ring->features = params.features;
     ring->sq_entries = params.sq_entries;
     ring->cq_entries = params.cq_entries;
 
@@ -115,6 +125,102 @@ void uring_destroy(abraxas_ring_t *ring)
     ring->ring_fd = -1;
 }
 
+/* --- Registration --- */
+
+bool uring_probe_op(abraxas_ring_t *ring, uint8_t op)
+{
+    constexpr uint32_t nops = 256;
+    alignas(struct io_uring_probe)
+    unsigned char buf[sizeof(struct io_uring_probe) + nops * sizeof(struct io_uring_probe_op)];
+    memset(buf, 0, sizeof(buf));
+
+    struct io_uring_probe *probe = (struct io_uring_probe *)buf;
+    if (sys_io_uring_register(ring->ring_fd, IORING_REGISTER_PROBE, probe, nops) < 0)
+        return false;
+    return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+}
+
+bool uring_register_files(abraxas_ring_t *ring, const int *fds, uint32_t n)
+{
+    return sys_io_uring_register(ring->ring_fd, IORING_REGISTER_FILES, (void *)fds, n) == 0;
+}
+
+bool uring_bufs_init(abraxas_ring_t *ring, uring_bufs_t *bufs, uint16_t bgid,
+                     uint32_t count, uint32_t size)
+{
+    memset(bufs, 0, sizeof(*bufs));
+    if (count == 0 || count > 32768 || (count & (count - 1))) return false;
+
+    /* The ring must be page aligned; the buffers follow it in one mapping */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t ring_size = (count * sizeof(struct io_uring_buf) + page - 1) & ~(page - 1);
+    size_t map_size = ring_size + (size_t)count * size;
+    void *map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (map == MAP_FAILED) return false;
+
+    struct io_uring_buf_reg reg = {
+        .ring_addr    = (uint64_t)(uintptr_t)map,
+        .ring_entries = count,
+        .bgid         = bgid,
+    };
+    if (sys_io_uring_register(ring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        munmap(map, map_size);
+        return false;
+    }
+
+    bufs->br       = map;
+    bufs->base     = (char *)map + ring_size;
+    bufs->map_size = map_size;
+    bufs->count    = count;
+    bufs->size     = size;
+    bufs->bgid     = bgid;
+    for (uint32_t i = 0; i < count; i++) {
+        struct io_uring_buf *b = &bufs->br->bufs[i];
+        b->addr = (uint64_t)(uintptr_t)(bufs->base + (size_t)i * size);
+        b->len  = size;
+        b->bid  = (uint16_t)i;
+    }
+    bufs->tail = (uint16_t)count;
+    atomic_store_explicit((_Atomic uint16_t *)&bufs->br->tail, bufs->tail,
+                          memory_order_release);
+    return true;
+}
+
+void uring_bufs_destroy(abraxas_ring_t *ring, uring_bufs_t *bufs)
+{
+    if (!bufs->br) return;
+    struct io_uring_buf_reg reg = { .bgid = bufs->bgid };
+    sys_io_uring_register(ring->ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    munmap(bufs->br, bufs->map_size);
+    memset(bufs, 0, sizeof(*bufs));
+}
+
+const char *uring_bufs_data(const uring_bufs_t *bufs, const struct io_uring_cqe *cqe)
+{
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) return nullptr;
+    uint32_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    if (bid >= bufs->count) return nullptr;
+    return bufs->base + (size_t)bid * bufs->size;
+}
+
+void uring_bufs_recycle(uring_bufs_t *bufs, const struct io_uring_cqe *cqe)
+{
+    if (!(cqe->flags & IORING_CQE_F_BUFFER)) return;
+    uint32_t bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    if (bid >= bufs->count) return;
+
+    struct io_uring_buf *b = &bufs->br->bufs[bufs->tail & (bufs->count - 1)];
+    b->addr = (uint64_t)(uintptr_t)(bufs->base + (size_t)bid * bufs->size);
+    b->len  = bufs->size;
+    b->bid  = (uint16_t)bid;
+    bufs->tail++;
+    atomic_store_explicit((_Atomic uint16_t *)&bufs->br->tail, bufs->tail,
+                          memory_order_release);
+}
+
+/* --- Submission --- */
+
 /* Get next SQE slot */
 static struct io_uring_sqe *get_sqe(abraxas_ring_t *ring)
 {
@@ -157,16 +263,160 @@ void uring_prep_poll(abraxas_ring_t *ring, int fd, uint64_t user_data)
     commit_sqe(ring);
 }
 
-void uring_prep_timeout(abraxas_ring_t *ring,
-                        struct __kernel_timespec *ts, uint64_t user_data)
+/* A pipe, inotify fd or signalfd is a stream: the offset is ignored */
+void uring_prep_read_multishot(abraxas_ring_t *ring, uint32_t slot, uint16_t bgid,
+                               uint64_t user_data, const int *install_fd)
+{
+    /* Both SQEs or neither, as for uring_prep_recv */
+    uint32_t need = install_fd ? 2 : 1;
+    if (*ring->sq_tail - *ring->sq_head + need > ring->sq_entries) return;
+
+    struct io_uring_sqe *sqe;
+    if (install_fd) {
+        sqe = get_sqe(ring);
+        sqe->opcode    = IORING_OP_FILES_UPDATE;
+        sqe->fd        = -1;
+        sqe->addr      = (uint64_t)(uintptr_t)install_fd;
+        sqe->len       = 1;
+        sqe->off       = slot;
+        sqe->flags     = IOSQE_IO_LINK;
+        if (ring->features & IORING_FEAT_CQE_SKIP)
+            sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+        commit_sqe(ring);
+    }
+
+    sqe = get_sqe(ring);
+    sqe->opcode    = URING_OP_READ_MULTISHOT;
+    sqe->fd        = (int)slot;
+    sqe->flags     = IOSQE_FIXED_FILE | IOSQE_BUFFER_SELECT;
+    sqe->buf_group = bgid;
+    sqe->user_data = user_data;
+    commit_sqe(ring);
+}
+
+void uring_prep_files_update(abraxas_ring_t *ring, uint32_t slot, const int *fd,
+                             uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return;
+
+    sqe->opcode    = IORING_OP_FILES_UPDATE;
+    sqe->fd        = -1;
+    sqe->addr      = (uint64_t)(uintptr_t)fd;
+    sqe->len       = 1;
+    sqe->off       = slot;
+    sqe->user_data = user_data;
+    if (ring->features & IORING_FEAT_CQE_SKIP)
+        sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+
+    commit_sqe(ring);
+}
+
+void uring_prep_timeout(abraxas_ring_t *ring, struct __kernel_timespec *ts,
+                        uint32_t flags, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return;
+
+    sqe->opcode        = IORING_OP_TIMEOUT;
+    sqe->fd            = -1;
+    sqe->addr          = (uint64_t)(uintptr_t)ts;
+    sqe->len           = 1;  /* 1 timespec entry; event count is sqe->off (0 = pure timeout) */
+    sqe->timeout_flags = flags;
+    sqe->user_data     = user_data;
+
+    commit_sqe(ring);
+}
+
+/* TIMEOUT_REMOVE with IORING_TIMEOUT_UPDATE: addr = target, addr2 = new ts */
+void uring_prep_timeout_update(abraxas_ring_t *ring, struct __kernel_timespec *ts,
+                               uint64_t target_user_data, uint32_t flags,
+                               uint64_t user_data)
 {
     struct io_uring_sqe *sqe = get_sqe(ring);
     if (!sqe) return;
 
-    sqe->opcode    = IORING_OP_TIMEOUT;
+    sqe->opcode        = IORING_OP_TIMEOUT_REMOVE;
+    sqe->fd            = -1;
+    sqe->addr          = target_user_data;
+    sqe->addr2         = (uint64_t)(uintptr_t)ts;
+    sqe->timeout_flags = flags | IORING_TIMEOUT_UPDATE;
+    sqe->user_data     = user_data;
+
+    /* No wakeup for the common (successful) case */
+    if (ring->features & IORING_FEAT_CQE_SKIP)
+        sqe->flags |= IOSQE_CQE_SKIP_SUCCESS;
+
+    commit_sqe(ring);
+}
+
+void uring_prep_accept(abraxas_ring_t *ring, int fd, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return;
+
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->fd           = fd;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data    = user_data;
+
+    commit_sqe(ring);
+}
+
+void uring_prep_recv(abraxas_ring_t *ring, int fd, void *buf, size_t len,
+                     uint64_t user_data, struct __kernel_timespec *timeout,
+                     uint64_t timeout_user_data)
+{
+    /* Both SQEs or neither: an IO_LINK with nothing after it links nothing */
+    uint32_t need = timeout ? 2 : 1;
+    if (*ring->sq_tail - *ring->sq_head + need > ring->sq_entries) return;
+
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t)(uintptr_t)buf;
+    sqe->len       = (uint32_t)len;
+    sqe->user_data = user_data;
+    if (timeout) sqe->flags |= IOSQE_IO_LINK;
+    commit_sqe(ring);
+
+    if (!timeout) return;
+    sqe = get_sqe(ring);
+    sqe->opcode    = IORING_OP_LINK_TIMEOUT;
     sqe->fd        = -1;
-    sqe->addr      = (uint64_t)(uintptr_t)ts;
-    sqe->len       = 1;  /* 1 timespec entry; event count is sqe->off (0 = pure timeout) */
+    sqe->addr      = (uint64_t)(uintptr_t)timeout;
+    sqe->len       = 1;
+    sqe->user_data = timeout_user_data;
+    commit_sqe(ring);
+}
+
+void uring_prep_recvmsg(abraxas_ring_t *ring, int fd, struct msghdr *msg,
+                        uint32_t flags, uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return;
+
+    sqe->opcode    = IORING_OP_RECVMSG;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t)(uintptr_t)msg;
+    sqe->len       = 1;
+    sqe->msg_flags = flags;
+    sqe->user_data = user_data;
+
+    commit_sqe(ring);
+}
+
+void uring_prep_send(abraxas_ring_t *ring, int fd, const void *buf, size_t len,
+                     uint64_t user_data)
+{
+    struct io_uring_sqe *sqe = get_sqe(ring);
+    if (!sqe) return;
+
+    sqe->opcode    = IORING_OP_SEND;
+    sqe->fd        = fd;
+    sqe->addr      = (uint64_t)(uintptr_t)buf;
+    sqe->len       = (uint32_t)len;
+    sqe->msg_flags = MSG_NOSIGNAL;
     sqe->user_data = user_data;
 
     commit_sqe(ring);
@@ -193,8 +443,9 @@ int uring_submit_and_wait(abraxas_ring_t *ring)
     read_barrier();
     head = *ring->sq_head;
 
+    /* Nothing new to submit still waits: the long-lived timeout and
+     * multi-shot polls are already in the kernel */
     uint32_t to_submit = tail - head;
-    if (to_submit == 0) return 0;
 
     int ret = sys_io_uring_enter(ring->ring_fd, to_submit, 1,
                                  IORING_ENTER_GETEVENTS, nullptr, 0);
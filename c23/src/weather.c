@@ -5,13 +5,24 @@
  *   1. GET https://api.weather.gov/points/{lat},{lon}
  *      -> extract properties.forecastHourly URL
  *   2. GET that URL
- *      -> extract first period's shortForecast, temperature, isDaytime
+ *      -> extract first period's shortForecast, temperature, isDaytime,
+ *         and a cloud cover value per hourly period (the timeline)
+ *
+ * Both responses go through json_scan(): only the target paths are
+ * visited and nothing is allocated per node.
+ *
+ * The async path caches step 1 (the gridpoint never moves for a fixed
+ * location) and sends step 2 with If-None-Match / If-Modified-Since from
+ * the last parsed response, so an unchanged forecast is one 304 with
+ * no body.
  *
  * Cloud cover is derived from forecast keyword heuristic (no direct cloud %
  * in the hourly forecast -- NOAA provides probabilityOfPrecipitation instead).
  *
- * HTTP is handled by exec'ing the curl(1) binary via posix_spawnp.
- * No libcurl linkage -- zero shared library overhead for CLI commands.
+ * HTTP is handled by exec'ing the curl(1) binary via posix_spawnp: the
+ * async path through a worker process forked before the sandbox (see
+ * Fetch worker), weather_fetch() directly. No libcurl linkage -- zero
+ * shared library overhead for CLI commands.
  * When NOAA_DISABLED is defined (non-US builds), all three public functions
  * compile to no-ops/stubs.
  */
@@ -22,20 +33,35 @@
 
 #ifndef NOAA_DISABLED
 
+#include "landlock.h"
+#include "seccomp.h"
+
 #include <ctype.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <grp.h>
+#include <poll.h>
+#include <pwd.h>
 #include <signal.h>
 #include <spawn.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
 #include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
 extern char **environ;
 
+/* Every request's curl options; the URL (and any -D/-H) follow */
+#define CURL_ARGS "curl", "-s", "-f", "-L", "--max-time", "5", \
+    "-H", "User-Agent: abraxas/7.0 (weather color temp daemon)", \
+    "-H", "Accept: application/geo+json"
+
 /* Dynamic response buffer */
 typedef struct {
     char   *data;
@@ -74,12 +100,7 @@ static bool http_get(const char *url, response_buf_t *resp)
     posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDOUT_FILENO);
     posix_spawn_file_actions_addclose(&actions, pipefd[0]);
 
-    char *argv[] = {
-        "curl", "-s", "-f", "-L", "--max-time", "5",
-        "-H", "User-Agent: abraxas/7.0 (weather color temp daemon)",
-        "-H", "Accept: application/geo+json",
-        (char *)url, nullptr
-    };
+    char *argv[] = { CURL_ARGS, (char *)url, nullptr };
 
     pid_t pid;
     int err = posix_spawnp(&pid, "curl", &actions, nullptr, argv, environ);
@@ -165,8 +186,95 @@ static int cloud_cover_from_forecast(const char *forecast)
     return 0;
 }
 
-void weather_init(void)  {}
-void weather_cleanup(void) {}
+/* --- Response extraction (skip-scan, no DOM) --- */
+
+/* points response -> properties.forecastHourly */
+bool weather_parse_points(const char *body, char *url, size_t cap)
+{
+    json_target_t t = { .path = "properties.forecastHourly" };
+    if (json_scan(body, &t, 1) != 1) return false;
+    return json_target_string(&t, url, cap);
+}
+
+/* ISO 8601 with numeric offset ("2026-10-14T14:00:00-06:00") -> epoch, 0 if malformed */
+static time_t iso8601_epoch(const char *s)
+{
+    struct tm tm = {0};
+    int consumed = 0;
+    if (sscanf(s, "%4d-%2d-%2dT%2d:%2d:%2d%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+               &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed) != 6)
+        return 0;
+    tm.tm_year -= 1900;
+    tm.tm_mon  -= 1;
+
+    const char *z = s + consumed;
+    long offset = 0;
+    if (*z == '+' || *z == '-') {
+        int oh = 0, om = 0;
+        if (sscanf(z + 1, "%2d:%2d", &oh, &om) != 2) return 0;
+        offset = (*z == '-' ? -1 : 1) * (oh * 3600L + om * 60L);
+    } else if (*z != 'Z') {
+        return 0;
+    }
+    return timegm(&tm) - offset;
+}
+
+/*
+ * hourly response -> first period's fields plus the cloud timeline into
+ * wd. periods is walked element by element with json_target_next(), each
+ * period scanned for its few keys; nothing is allocated.
+ * Returns false if there is no usable first period.
+ */
+bool weather_parse_hourly(const char *body, weather_data_t *wd)
+{
+    json_target_t periods = { .path = "properties.periods" };
+    if (json_scan(body, &periods, 1) != 1) return false;
+
+    enum { START_TIME, SHORT_FORECAST, TEMPERATURE, IS_DAYTIME, TARGETS };
+    const char *iter = nullptr;
+    json_target_t period;
+    int hours = 0;
+
+    while (json_target_next(&periods, &iter, &period)) {
+        json_target_t t[TARGETS] = {
+            [START_TIME]     = { .path = "startTime" },
+            [SHORT_FORECAST] = { .path = "shortForecast" },
+            [TEMPERATURE]    = { .path = "temperature" },
+            [IS_DAYTIME]     = { .path = "isDaytime" },
+        };
+        (void)json_scan(period.start, t, TARGETS);
+
+        char text[sizeof(wd->forecast)];
+        char stamp[40];
+        bool have_text = json_target_string(&t[SHORT_FORECAST], text, sizeof(text));
+        (void)json_target_string(&t[START_TIME], stamp, sizeof(stamp));
+        time_t start = iso8601_epoch(stamp);
+
+        if (hours == 0) {
+            if (have_text) memcpy(wd->forecast, text, sizeof(text));
+            if (t[TEMPERATURE].found) wd->temperature = json_target_number(&t[TEMPERATURE]);
+            if (t[IS_DAYTIME].found)  wd->is_day = json_target_bool(&t[IS_DAYTIME]);
+            wd->cloud_cover = cloud_cover_from_forecast(wd->forecast);
+            if (start == 0) return true;   /* no timeline, first period only */
+
+            wd->timeline_start = start;
+            wd->cloud[0] = (uint8_t)wd->cloud_cover;
+            wd->timeline_hours = hours = 1;
+            continue;
+        }
+
+        /* Slot by start time; a gap repeats the previous hour */
+        if (start < wd->timeline_start) break;
+        long slot = (long)(start - wd->timeline_start) / 3600;
+        if (slot < hours) continue;
+        if (slot >= WEATHER_HOURS_MAX) break;
+        for (; hours < slot; hours++) wd->cloud[hours] = wd->cloud[hours - 1];
+        wd->cloud[hours++] = (uint8_t)cloud_cover_from_forecast(text);
+        wd->timeline_hours = hours;
+    }
+
+    return hours > 0;
+}
 
 weather_data_t weather_fetch(double lat, double lon)
 {
@@ -186,111 +294,468 @@ weather_data_t weather_fetch(double lat, double lon)
     response_buf_t resp;
     if (!http_get(url, &resp)) return wd;
 
-    json_value_t *root = json_parse(resp.data);
-    free(resp.data);
-    if (!root) return wd;
-
-    const char *forecast_url = json_string(json_path(root, "properties.forecastHourly"));
-    if (!forecast_url) {
-        json_free(root);
-        return wd;
-    }
-
-    /* Copy URL before freeing root */
     char hourly_url[512];
-    snprintf(hourly_url, sizeof(hourly_url), "%s", forecast_url);
-    json_free(root);
+    bool have_url = weather_parse_points(resp.data, hourly_url, sizeof(hourly_url));
+    free(resp.data);
+    if (!have_url) return wd;
 
     /* Step 2: Get hourly forecast */
     if (!http_get(hourly_url, &resp)) return wd;
 
-    root = json_parse(resp.data);
+    bool have_period = weather_parse_hourly(resp.data, &wd);
     free(resp.data);
-    if (!root) return wd;
+    if (!have_period) return wd;
 
-    const json_value_t *periods = json_path(root, "properties.periods");
-    const json_value_t *period = json_at(periods, 0);
+    wd.has_error = false;
+    return wd;
+}
 
-    if (!period) {
-        json_free(root);
-        return wd;
-    }
+/* --- Async weather fetch (non-blocking, io_uring integrated) --- */
 
-    /* Extract forecast data */
-    const char *short_forecast = json_string(json_get(period, "shortForecast"));
-    if (short_forecast) {
-        strncpy(wd.forecast, short_forecast, sizeof(wd.forecast) - 1);
-        wd.forecast[sizeof(wd.forecast) - 1] = '\0';
-    }
+/* curl exit code for an HTTP status >= 400 under -f */
+constexpr int CURL_HTTP_ERROR = 22;
 
-    const json_value_t *temp_val = json_get(period, "temperature");
-    if (temp_val) wd.temperature = json_number(temp_val);
+/* Response buffer, allocated once: pages are only touched as a response
+   fills it, and an hourly forecast is a few hundred KB */
+constexpr size_t WEATHER_RESPONSE_MAX = 4u << 20;
 
-    const json_value_t *day_val = json_get(period, "isDaytime");
-    if (day_val) wd.is_day = json_bool(day_val);
+/* --- Fetch worker --- */
 
-    /* Cloud cover from keyword heuristic */
-    wd.cloud_cover = cloud_cover_from_forecast(wd.forecast);
+/*
+ * weather_init() forks one worker before the daemon's sandbox goes up;
+ * after that the daemon never creates a process, and seccomp has no
+ * clone or execve. The worker execs curl for each request and hands
+ * curl's stdout pipe back with SCM_RIGHTS, so the daemon reads a
+ * response exactly as it read its own child's. SOCK_SEQPACKET keeps
+ * one message per datagram:
+ *
+ *   daemon -> worker  "G <seq> <dump>\n<url>\n<header>\n..."  fetch
+ *   daemon -> worker  "K <seq>"           SIGKILL that request's curl
+ *   worker -> daemon  "S <seq> <errno>"   started; carries the pipe if 0
+ *   worker -> daemon  "X <seq> <code>"    curl's exit code, -1 if killed
+ *
+ * The worker serves one request at a time and exits when the socket
+ * closes. It cannot be restarted under seccomp: once it is gone, the
+ * daemon exits nonzero and its service manager restarts the whole thing.
+ *
+ * curl parses whatever the network sends, so the worker has a sandbox of
+ * its own, which every curl inherits: a landlock ruleset with nothing
+ * writable and the daemon's seccomp filter plus what spawning needs.
+ * Under --system it first gives up root for nobody.
+ */
 
-    wd.has_error = false;
-    json_free(root);
-    return wd;
-}
+#define WORKER_MSG_MAX 2048
 
-/* --- Async weather fetch (non-blocking, io_uring integrated) --- */
+static int      worker_fd = -1;
+static unsigned worker_seq;
+static bool     worker_gone;
 
-static bool spawn_curl_async(const char *url, pid_t *out_pid, int *out_pipe_fd)
+static bool worker_send_fd(int sock, const char *msg, int fd)
 {
-    int pipefd[2];
-    if (pipe(pipefd) != 0) return false;
+    struct iovec iov = { .iov_base = (void *)msg, .iov_len = strlen(msg) };
+    union { char buf[CMSG_SPACE(sizeof(int))]; struct cmsghdr align; } ctl;
+    struct msghdr mh = { .msg_iov = &iov, .msg_iovlen = 1 };
+    if (fd >= 0) {
+        mh.msg_control = ctl.buf;
+        mh.msg_controllen = sizeof(ctl.buf);
+        struct cmsghdr *c = CMSG_FIRSTHDR(&mh);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(c), &fd, sizeof(int));
+    }
+    return sendmsg(sock, &mh, MSG_NOSIGNAL) >= 0;
+}
 
-    int flags = fcntl(pipefd[0], F_GETFL, 0);
-    if (flags < 0 || fcntl(pipefd[0], F_SETFL, flags | O_NONBLOCK) < 0) {
-        close(pipefd[0]);
-        close(pipefd[1]);
-        return false;
+/* Run a "G" request: curl with stdout on a fresh pipe, the read end sent
+   back in the "S" reply. Returns curl's pid, or -1. */
+static pid_t worker_spawn(int sock, char *msg)
+{
+    unsigned seq;
+    int dump;
+    char *line = strchr(msg, '\n');
+    if (!line || sscanf(msg, "G %u %d", &seq, &dump) != 2) return -1;
+
+    /* CURL_ARGS, -D -, two validator headers, the url */
+    char *argv[20] = { CURL_ARGS };
+    int argc = 10;
+    if (dump) {
+        argv[argc++] = "-D";
+        argv[argc++] = "-";
+    }
+    char *url = line + 1;
+    for (char *h = strchr(url, '\n'); h; h = strchr(h, '\n')) {
+        *h++ = '\0';
+        if (*h && argc < (int)(sizeof(argv) / sizeof(argv[0])) - 4) {
+            argv[argc++] = "-H";
+            argv[argc++] = h;
+        }
+    }
+    argv[argc++] = url;
+    argv[argc] = nullptr;
+
+    char reply[64];
+    int pipefd[2];
+    if (pipe2(pipefd, O_CLOEXEC) != 0) {
+        snprintf(reply, sizeof(reply), "S %u %d", seq, errno);
+        (void)worker_send_fd(sock, reply, -1);
+        return -1;
     }
 
     posix_spawn_file_actions_t actions;
     posix_spawn_file_actions_init(&actions);
     posix_spawn_file_actions_adddup2(&actions, pipefd[1], STDOUT_FILENO);
-    posix_spawn_file_actions_addclose(&actions, pipefd[0]);
-
-    char *argv[] = {
-        "curl", "-s", "-f", "-L", "--max-time", "5",
-        "-H", "User-Agent: abraxas/7.0 (weather color temp daemon)",
-        "-H", "Accept: application/geo+json",
-        (char *)url, nullptr
-    };
 
     pid_t pid;
     int err = posix_spawnp(&pid, "curl", &actions, nullptr, argv, environ);
     posix_spawn_file_actions_destroy(&actions);
     close(pipefd[1]);
 
-    if (err != 0) {
-        close(pipefd[0]);
-        return false;
+    snprintf(reply, sizeof(reply), "S %u %d", seq, err);
+    (void)worker_send_fd(sock, reply, err == 0 ? pipefd[0] : -1);
+    close(pipefd[0]);
+    return err == 0 ? pid : -1;
+}
+
+/* Reap curl, killing it on a matching "K". Any other message that comes
+   in meanwhile is the next request: it is left in msg, its length in
+   *pending. Exits with the daemon. */
+static int worker_reap(int sock, pid_t pid, unsigned seq, char *msg, ssize_t *pending)
+{
+    int pidfd = (int)syscall(SYS_pidfd_open, pid, 0);
+    while (pidfd >= 0) {
+        struct pollfd fds[2] = { { .fd = pidfd, .events = POLLIN },
+                                 { .fd = sock,  .events = POLLIN } };
+        if (poll(fds, *pending ? 1 : 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;
+        if (!fds[1].revents) continue;
+
+        ssize_t n = recv(sock, msg, WORKER_MSG_MAX - 1, 0);
+        if (n <= 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+            _exit(0);
+        }
+        msg[n] = '\0';
+        unsigned k;
+        if (sscanf(msg, "K %u", &k) == 1) {
+            if (k == seq) kill(pid, SIGKILL);
+        } else {
+            *pending = n;
+        }
     }
+    if (pidfd >= 0) close(pidfd);
 
-    *out_pid = pid;
-    *out_pipe_fd = pipefd[0];
-    return true;
+    int status;
+    if (waitpid(pid, &status, 0) < 0) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
 }
 
-static void wfs_reset(weather_fetch_state_t *wfs)
+/* nobody's uid and gid, with no supplementary groups; a no-op unless root */
+static bool worker_drop_root(void)
 {
-    if (wfs->pipe_fd >= 0) close(wfs->pipe_fd);
-    if (wfs->child_pid > 0) {
-        kill(wfs->child_pid, SIGKILL);
-        waitpid(wfs->child_pid, nullptr, 0);
+    if (getuid() != 0) return true;
+
+    const struct passwd *pw = getpwnam("nobody");
+    uid_t uid = pw ? pw->pw_uid : 65534;
+    gid_t gid = pw ? pw->pw_gid : 65534;
+    return setgroups(0, nullptr) == 0 && setresgid(gid, gid, gid) == 0 &&
+           setresuid(uid, uid, uid) == 0;
+}
+
+static void worker_main(int sock, pid_t parent)
+{
+    /* Ahead of the parent-death signal, which a uid change clears */
+    if (!worker_drop_root()) {
+        fprintf(stderr, "[weather] fetch worker: cannot drop root: %s\n", strerror(errno));
+        _exit(1);
     }
-    free(wfs->buf);
-    wfs->buf = nullptr;
+
+    /* Die with the daemon, even if it was already gone before this */
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+    if (getppid() != parent) _exit(0);
+    prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+
+    /* Only the socket and stdio: no display, uring or control fds */
+    if (dup2(sock, 3) < 0) _exit(1);
+    sock = 3;
+    fcntl(sock, F_SETFD, FD_CLOEXEC);   /* dup2 drops it; curl must not hold it */
+#ifdef SYS_close_range
+    if (syscall(SYS_close_range, 4u, ~0u, 0u) != 0)
+#endif
+        for (int fd = 4; fd < 1024; fd++) close(fd);
+
+    /* The daemon blocks SIGTERM/SIGINT for its signalfd */
+    sigset_t none;
+    sigemptyset(&none);
+    sigprocmask(SIG_SETMASK, &none, nullptr);
+
+    bool landlocked = landlock_install_worker_sandbox();
+    bool filtered = seccomp_install_worker_filter();
+    fprintf(stderr, "[weather] fetch worker: landlock %s, seccomp %s\n",
+            landlocked ? "active" : "unavailable", filtered ? "active" : "failed");
+
+    static char msg[WORKER_MSG_MAX];
+    ssize_t pending = 0;
+    for (;;) {
+        ssize_t n = pending ? pending : recv(sock, msg, sizeof(msg) - 1, 0);
+        if (n <= 0) _exit(0);
+        msg[n] = '\0';
+        pending = 0;
+
+        unsigned seq;
+        if (sscanf(msg, "G %u", &seq) != 1) continue;   /* a late "K" */
+        pid_t pid = worker_spawn(sock, msg);
+        if (pid < 0) continue;
+
+        int code = worker_reap(sock, pid, seq, msg, &pending);
+        char reply[64];
+        snprintf(reply, sizeof(reply), "X %u %d", seq, code);
+        (void)worker_send_fd(sock, reply, -1);
+    }
+}
+
+void weather_init(void)
+{
+    if (worker_fd >= 0) return;
+
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, sv) != 0) {
+        fprintf(stderr, "[weather] fetch worker: socketpair: %s\n", strerror(errno));
+        return;
+    }
+    pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(sv[0]);
+        worker_main(sv[1], parent);
+    }
+    close(sv[1]);
+    if (pid < 0) {
+        fprintf(stderr, "[weather] fetch worker: fork: %s\n", strerror(errno));
+        close(sv[0]);
+        return;
+    }
+    worker_fd = sv[0];
+    fprintf(stderr, "[weather] fetch worker pid %d\n", (int)pid);
+}
+
+/* The worker sees EOF and exits; it is not waited for, as seccomp has no
+   wait4. The daemon is about to exit and init reaps it. */
+void weather_cleanup(void)
+{
+    if (worker_fd < 0) return;
+    close(worker_fd);
+    worker_fd = -1;
+}
+
+/* Nothing can fork a new one under seccomp */
+static void worker_lost(void)
+{
+    if (!worker_gone)
+        fprintf(stderr, "[fatal] weather: fetch worker gone, exiting to be restarted\n");
+    weather_cleanup();
+    worker_gone = true;
+}
+
+bool weather_worker_lost(void)
+{
+    return worker_gone;
+}
+
+int weather_worker_fd(void)
+{
+    return worker_fd;
+}
+
+/* One worker reply, received by the caller's event loop */
+static struct {
+    char          buf[64];
+    union { char buf[CMSG_SPACE(sizeof(int))]; struct cmsghdr align; } ctl;
+    struct iovec  iov;
+    struct msghdr mh;
+} worker_rx;
+
+struct msghdr *weather_worker_msghdr(void)
+{
+    worker_rx.iov = (struct iovec){ .iov_base = worker_rx.buf,
+                                    .iov_len = sizeof(worker_rx.buf) - 1 };
+    worker_rx.mh = (struct msghdr){ .msg_iov = &worker_rx.iov, .msg_iovlen = 1,
+                                    .msg_control = worker_rx.ctl.buf,
+                                    .msg_controllen = sizeof(worker_rx.ctl.buf) };
+    return &worker_rx.mh;
+}
+
+static void fetch_cancel(unsigned seq)
+{
+    char msg[32];
+    int len = snprintf(msg, sizeof(msg), "K %u", seq);
+    if (worker_fd >= 0) (void)send(worker_fd, msg, (size_t)len, MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+/*
+ * Ask the worker to start curl. A non-null 'grid' makes this the forecast
+ * request: response headers are dumped ahead of the body (-D -) and, if
+ * 'conditional', grid's validators are sent. The pipe arrives with the
+ * "S" reply. Returns the request's seq (never 0), or 0.
+ */
+static unsigned fetch_start(const char *url, const gridpoint_cache_t *grid, bool conditional)
+{
+    if (worker_fd < 0) return 0;
+
+    unsigned seq = ++worker_seq ? worker_seq : ++worker_seq;
+    char msg[WORKER_MSG_MAX];
+    int len = snprintf(msg, sizeof(msg), "G %u %d\n%s", seq, grid != nullptr, url);
+    if (grid && conditional && grid->etag[0])
+        len += snprintf(msg + len, sizeof(msg) - (size_t)len,
+                        "\nIf-None-Match: %s", grid->etag);
+    if (grid && conditional && grid->last_modified[0])
+        len += snprintf(msg + len, sizeof(msg) - (size_t)len,
+                        "\nIf-Modified-Since: %s", grid->last_modified);
+    if (len >= (int)sizeof(msg)) return 0;
+
+    /* A few hundred bytes into an idle socket: never would block */
+    if (send(worker_fd, msg, (size_t)len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0) {
+        if (errno == EPIPE || errno == ECONNRESET) worker_lost();
+        return 0;
+    }
+    return seq;
+}
+
+/* The fetch waits on the worker again */
+static void wfs_await(weather_fetch_state_t *wfs, unsigned request)
+{
+    wfs->request = request;
+    wfs->started = false;
+    wfs->exited = false;
+    wfs->exit_code = -1;
+}
+
+bool weather_async_reply(weather_fetch_state_t *wfs, ssize_t n)
+{
+    if (n <= 0) {
+        if (n == -EINTR || n == -ECANCELED) return false;
+        worker_lost();
+        if (!wfs->request) return false;
+        /* Fail the fetch in flight: no pipe now, or no exit code later */
+        wfs->started = wfs->exited = true;
+        wfs->exit_code = -1;
+        return wfs->pipe_fd < 0;
+    }
+    worker_rx.buf[n] = '\0';
+
+    int passed = -1;
+    const struct cmsghdr *c = CMSG_FIRSTHDR(&worker_rx.mh);
+    if (c && c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS)
+        memcpy(&passed, CMSG_DATA(c), sizeof(int));
+
+    char t;
+    unsigned seq;
+    int value;
+    bool ours = sscanf(worker_rx.buf, "%c %u %d", &t, &seq, &value) == 3 &&
+                wfs->request && seq == wfs->request;
+
+    if (ours && t == 'S' && !wfs->started) {
+        wfs->started = true;
+        int flags = passed >= 0 ? fcntl(passed, F_GETFL, 0) : -1;
+        if (value == 0 && flags >= 0 && fcntl(passed, F_SETFL, flags | O_NONBLOCK) == 0) {
+            wfs->pipe_fd = passed;
+            return false;       /* the caller arms the pipe */
+        }
+        if (value > 0) fprintf(stderr, "[weather] curl: %s\n", strerror(value));
+        if (passed >= 0) close(passed);
+        if (value == 0) fetch_cancel(seq);
+        wfs->exited = true;
+        wfs->exit_code = -1;
+        return true;
+    }
+    /* Abandoned requests' replies, with any pipe, end here */
+    if (passed >= 0) close(passed);
+    if (ours && t == 'X') {
+        wfs->exited = true;
+        wfs->exit_code = value;
+        return wfs->started && wfs->pipe_fd < 0;
+    }
+    return false;
+}
+
+/* Copy the value of header 'name' if 'line' (len bytes, no CRLF) is it */
+static void header_value(const char *line, size_t len, const char *name,
+                         char *out, size_t cap)
+{
+    size_t nlen = strlen(name);
+    if (len <= nlen || line[nlen] != ':' || strncasecmp(line, name, nlen) != 0)
+        return;
+
+    const char *v = line + nlen + 1;
+    const char *end = line + len;
+    while (v < end && (*v == ' ' || *v == '\t')) v++;
+    while (end > v && (end[-1] == ' ' || end[-1] == '\t')) end--;
+
+    size_t n = (size_t)(end - v);
+    if (n >= cap) n = cap - 1;
+    memcpy(out, v, n);
+    out[n] = '\0';
+}
+
+/*
+ * Split curl -D - output into the final response's status, validators and
+ * body. Redirects followed by -L and a proxy's CONNECT reply each put a
+ * header block ahead of the final one; the last block wins.
+ * Returns the body start, or nullptr if the headers are missing/truncated.
+ */
+static const char *http_split_headers(const char *p, int *status,
+                                      char *etag, size_t etag_cap,
+                                      char *last_modified, size_t lm_cap)
+{
+    const char *body = nullptr;
+
+    while (strncmp(p, "HTTP/", 5) == 0) {
+        const char *sp = strchr(p, ' ');
+        *status = sp ? atoi(sp + 1) : 0;
+        etag[0] = '\0';
+        last_modified[0] = '\0';
+
+        p = strchr(p, '\n');
+        if (!p) return nullptr;
+        p++;
+
+        for (;;) {
+            const char *eol = strchr(p, '\n');
+            if (!eol) return nullptr;
+            size_t len = (size_t)(eol - p);
+            if (len > 0 && p[len - 1] == '\r') len--;
+            const char *line = p;
+            p = eol + 1;
+            if (len == 0) break;
+
+            header_value(line, len, "ETag", etag, etag_cap);
+            header_value(line, len, "Last-Modified", last_modified, lm_cap);
+        }
+        body = p;
+    }
+
+    return body;
+}
+
+/* Ready for the next response; the buffer itself is kept */
+static void wfs_clear_buf(weather_fetch_state_t *wfs)
+{
     wfs->buf_size = 0;
-    wfs->buf_cap = 0;
+    wfs->stream_end = 0;
+    wfs->fed = false;
+}
+
+static void wfs_reset(weather_fetch_state_t *wfs)
+{
+    if (wfs->pipe_fd >= 0) close(wfs->pipe_fd);
+    if (wfs->request && !wfs->exited) fetch_cancel(wfs->request);
+    wfs_clear_buf(wfs);
     wfs->pipe_fd = -1;
-    wfs->child_pid = 0;
+    wfs->request = 0;
     wfs->phase = WEATHER_IDLE;
 }
 
@@ -307,90 +772,123 @@ static weather_data_t wfs_error_result(void)
     return wd;
 }
 
+/* Account for n bytes landed at buf + buf_size, EOF (0) or an error (< 0) */
+static void wfs_took(weather_fetch_state_t *wfs, ssize_t n)
+{
+    if (n > 0)
+        wfs->buf_size += (size_t)n;
+    else
+        wfs->stream_end = n == 0 ? 1 : -1;
+}
+
 /*
- * Non-blocking drain of pipe.
+ * Non-blocking drain of pipe, straight into the response buffer.
  * Returns: 0 = EAGAIN (more data coming)
  *          1 = EOF (child done)
- *         -1 = error
+ *         -1 = error, or the response outgrew the buffer
  */
 static int wfs_drain_pipe(weather_fetch_state_t *wfs)
 {
-    char chunk[4096];
-    for (;;) {
-        ssize_t n = read(wfs->pipe_fd, chunk, sizeof(chunk));
-        if (n > 0) {
-            size_t needed = wfs->buf_size + (size_t)n + 1;
-            if (needed > wfs->buf_cap) {
-                size_t new_cap = wfs->buf_cap ? wfs->buf_cap * 2 : 4096;
-                while (new_cap < needed) new_cap *= 2;
-                char *nb = realloc(wfs->buf, new_cap);
-                if (!nb) return -1;
-                wfs->buf = nb;
-                wfs->buf_cap = new_cap;
-            }
-            memcpy(wfs->buf + wfs->buf_size, chunk, (size_t)n);
-            wfs->buf_size += (size_t)n;
-            continue;
+    while (!wfs->stream_end) {
+        size_t room = WEATHER_RESPONSE_MAX - 1 - wfs->buf_size;
+        if (room == 0) {
+            wfs->stream_end = -1;
+            break;
         }
-        if (n == 0) return 1;  /* EOF */
-        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
-        return -1;
+        ssize_t n = read(wfs->pipe_fd, wfs->buf + wfs->buf_size, room);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+        wfs_took(wfs, n);
     }
+    return wfs->stream_end;
 }
 
-void weather_async_init(weather_fetch_state_t *wfs)
+void weather_async_feed(weather_fetch_state_t *wfs, const void *data, ssize_t n)
+{
+    wfs->fed = true;
+    if (wfs->stream_end || wfs->phase == WEATHER_IDLE) return;
+    if (n > 0 && (size_t)n > WEATHER_RESPONSE_MAX - 1 - wfs->buf_size) {
+        wfs->stream_end = -1;
+        return;
+    }
+    if (n > 0) memcpy(wfs->buf + wfs->buf_size, data, (size_t)n);
+    wfs_took(wfs, n);
+}
+
+void weather_async_init(weather_fetch_state_t *wfs, const gridpoint_cache_t *grid)
 {
     memset(wfs, 0, sizeof(*wfs));
     wfs->pipe_fd = -1;
     wfs->phase = WEATHER_IDLE;
+    if (grid && grid->valid) wfs->grid = *grid;
 }
 
-int weather_async_start(weather_fetch_state_t *wfs, double lat, double lon)
+int weather_async_start(weather_fetch_state_t *wfs, double lat, double lon,
+                        const weather_data_t *current)
 {
     if (wfs->phase != WEATHER_IDLE) return -1;
+    if (!wfs->buf && !(wfs->buf = malloc(WEATHER_RESPONSE_MAX))) return -1;
 
     wfs->lat = lat;
     wfs->lon = lon;
 
-    char url[256];
-    snprintf(url, sizeof(url), "https://api.weather.gov/points/%.4f,%.4f", lat, lon);
-
-    pid_t pid;
-    int pipe_fd;
-    if (!spawn_curl_async(url, &pid, &pipe_fd)) return -1;
+    char point[sizeof(wfs->grid.point)];
+    snprintf(point, sizeof(point), "%.4f,%.4f", lat, lon);
 
-    wfs->child_pid = pid;
-    wfs->pipe_fd = pipe_fd;
-    wfs->phase = WEATHER_READING_POINTS;
-    wfs->buf = nullptr;
-    wfs->buf_size = 0;
-    wfs->buf_cap = 0;
+    unsigned request;
+    if (wfs->grid.valid && strcmp(wfs->grid.point, point) == 0) {
+        /* Gridpoint cache hit: straight to the forecast */
+        wfs->conditional = current && !current->has_error;
+        request = fetch_start(wfs->grid.forecast_url, &wfs->grid, wfs->conditional);
+        if (!request) return -1;
+        wfs->phase = WEATHER_READING_FORECAST;
+    } else {
+        char url[256];
+        snprintf(url, sizeof(url), "https://api.weather.gov/points/%s", point);
+        request = fetch_start(url, nullptr, false);
+        if (!request) return -1;
+
+        wfs->grid = (gridpoint_cache_t){ .valid = false };
+        memcpy(wfs->grid.point, point, sizeof(point));
+        wfs->conditional = false;
+        wfs->phase = WEATHER_READING_POINTS;
+    }
 
-    return pipe_fd;
+    wfs_await(wfs, request);
+    wfs_clear_buf(wfs);
+    return 0;
 }
 
 int weather_async_read(weather_fetch_state_t *wfs, weather_data_t *out)
 {
-    int drain = wfs_drain_pipe(wfs);
-    if (drain == 0) return 0;  /* EAGAIN */
+    if (!wfs->started) return 0;   /* no "S" reply yet */
 
-    if (drain < 0) {
-        wfs_reset(wfs);
-        *out = wfs_error_result();
-        return -1;
-    }
+    if (wfs->pipe_fd >= 0) {
+        int drain = wfs->fed ? wfs->stream_end : wfs_drain_pipe(wfs);
+        if (drain == 0) return 0;  /* EAGAIN */
 
-    /* EOF: child finished writing */
-    close(wfs->pipe_fd);
-    wfs->pipe_fd = -1;
+        if (drain < 0) {
+            wfs_reset(wfs);
+            *out = wfs_error_result();
+            return -1;
+        }
 
-    int status;
-    waitpid(wfs->child_pid, &status, 0);
-    wfs->child_pid = 0;
+        /* EOF: curl finished writing */
+        close(wfs->pipe_fd);
+        wfs->pipe_fd = -1;
+    }
+    if (!wfs->exited) return 0;    /* its exit code is on the way */
 
-    bool curl_ok = WIFEXITED(status) && WEXITSTATUS(status) == 0
-                   && wfs->buf && wfs->buf_size > 0;
+    int code = wfs->exit_code;
+    wfs->request = 0;
+
+    bool curl_ok = code == 0 && wfs->buf_size > 0;
     if (!curl_ok) {
+        /* 4xx/5xx on a cached URL: NOAA may have re-gridded; re-resolve next time */
+        if (wfs->phase == WEATHER_READING_FORECAST && wfs->grid.valid &&
+            code == CURL_HTTP_ERROR) {
+            wfs->grid.valid = false;
+            wfs->grid_dirty = true;
+        }
         wfs_reset(wfs);
         *out = wfs_error_result();
         return -1;
@@ -399,96 +897,82 @@ int weather_async_read(weather_fetch_state_t *wfs, weather_data_t *out)
     wfs->buf[wfs->buf_size] = '\0';
 
     if (wfs->phase == WEATHER_READING_POINTS) {
-        json_value_t *root = json_parse(wfs->buf);
-        free(wfs->buf);
-        wfs->buf = nullptr;
-        wfs->buf_size = 0;
-        wfs->buf_cap = 0;
+        bool have_url = weather_parse_points(wfs->buf, wfs->grid.forecast_url,
+                                            sizeof(wfs->grid.forecast_url));
+        wfs_clear_buf(wfs);
 
-        if (!root) {
+        if (!have_url) {
             wfs_reset(wfs);
             *out = wfs_error_result();
             return -1;
         }
 
-        const char *forecast_url = json_string(json_path(root, "properties.forecastHourly"));
-        if (!forecast_url) {
-            json_free(root);
-            wfs_reset(wfs);
-            *out = wfs_error_result();
-            return -1;
-        }
-
-        snprintf(wfs->forecast_url, sizeof(wfs->forecast_url), "%s", forecast_url);
-        json_free(root);
+        wfs->grid.etag[0] = '\0';
+        wfs->grid.last_modified[0] = '\0';
+        wfs->grid.valid = true;
+        wfs->grid_dirty = true;
 
-        /* Spawn phase 2: hourly forecast */
-        pid_t pid;
-        int pipe_fd;
-        if (!spawn_curl_async(wfs->forecast_url, &pid, &pipe_fd)) {
+        /* Phase 2: hourly forecast */
+        unsigned request = fetch_start(wfs->grid.forecast_url, &wfs->grid, false);
+        if (!request) {
             wfs_reset(wfs);
             *out = wfs_error_result();
             return -1;
         }
 
-        wfs->child_pid = pid;
-        wfs->pipe_fd = pipe_fd;
+        wfs_await(wfs, request);
         wfs->phase = WEATHER_READING_FORECAST;
-        return 1;  /* new pipe_fd to poll */
+        return 1;  /* next request; its pipe comes with the reply */
     }
 
-    /* WEATHER_READING_FORECAST: parse final result */
-    json_value_t *root = json_parse(wfs->buf);
-    free(wfs->buf);
-    wfs->buf = nullptr;
-    wfs->buf_size = 0;
-    wfs->buf_cap = 0;
-    wfs->phase = WEATHER_IDLE;
+    /* WEATHER_READING_FORECAST: headers first, then the body */
+    int http_status = 0;
+    char etag[sizeof(wfs->grid.etag)];
+    char last_modified[sizeof(wfs->grid.last_modified)];
+    const char *body = http_split_headers(wfs->buf, &http_status, etag, sizeof(etag),
+                                          last_modified, sizeof(last_modified));
 
-    if (!root) {
-        *out = wfs_error_result();
-        return -1;
+    if (body && http_status == 304 && wfs->conditional) {
+        wfs_reset(wfs);
+        return 2;  /* unchanged, nothing to parse */
     }
-
-    const json_value_t *periods = json_path(root, "properties.periods");
-    const json_value_t *period = json_at(periods, 0);
-    if (!period) {
-        json_free(root);
+    if (!body || http_status != 200) {
+        wfs_reset(wfs);
         *out = wfs_error_result();
         return -1;
     }
 
     *out = (weather_data_t){
         .cloud_cover = 0,
+        .forecast = "Unknown",
         .temperature = 0.0,
         .is_day = true,
         .fetched_at = time(nullptr),
         .has_error = false
     };
+    bool have_period = weather_parse_hourly(body, out);
+    wfs_clear_buf(wfs);
+    wfs->phase = WEATHER_IDLE;
 
-    const char *sf = json_string(json_get(period, "shortForecast"));
-    if (sf) {
-        strncpy(out->forecast, sf, sizeof(out->forecast) - 1);
-        out->forecast[sizeof(out->forecast) - 1] = '\0';
-    } else {
-        strncpy(out->forecast, "Unknown", sizeof(out->forecast));
+    if (!have_period) {
+        *out = wfs_error_result();
+        return -1;
     }
 
-    const json_value_t *tv = json_get(period, "temperature");
-    if (tv) out->temperature = json_number(tv);
-
-    const json_value_t *dv = json_get(period, "isDaytime");
-    if (dv) out->is_day = json_bool(dv);
-
-    out->cloud_cover = cloud_cover_from_forecast(out->forecast);
-
-    json_free(root);
+    if (strcmp(etag, wfs->grid.etag) != 0 ||
+        strcmp(last_modified, wfs->grid.last_modified) != 0) {
+        memcpy(wfs->grid.etag, etag, sizeof(etag));
+        memcpy(wfs->grid.last_modified, last_modified, sizeof(last_modified));
+        wfs->grid_dirty = true;
+    }
     return -1;  /* done */
 }
 
 void weather_async_cleanup(weather_fetch_state_t *wfs)
 {
     wfs_reset(wfs);
+    free(wfs->buf);
+    wfs->buf = nullptr;
 }
 
 #else /* NOAA_DISABLED -- non-US build, no libcurl */
@@ -517,3 +1001,27 @@ weather_data_t weather_fetch(double lat, double lon)
 }
 
 #endif /* NOAA_DISABLED */
+
+/* --- Forecast timeline (both builds) --- */
+
+int weather_cloud_at(const weather_data_t *wd, time_t when)
+{
+    if (!wd || wd->has_error) return 0;
+    if (wd->timeline_hours <= 0) return wd->cloud_cover;
+
+    long slot = when < wd->timeline_start ? 0 : (long)(when - wd->timeline_start) / 3600;
+    if (slot >= wd->timeline_hours) slot = wd->timeline_hours - 1;
+    return wd->cloud[slot];
+}
+
+time_t weather_next_dark_change(const weather_data_t *wd, time_t now)
+{
+    if (!wd || wd->has_error || wd->timeline_hours <= 1) return 0;
+
+    bool dark = weather_cloud_at(wd, now) >= CLOUD_THRESHOLD;
+    long slot = now < wd->timeline_start ? 0 : (long)(now - wd->timeline_start) / 3600 + 1;
+    for (; slot < wd->timeline_hours; slot++)
+        if ((wd->cloud[slot] >= CLOUD_THRESHOLD) != dark)
+            return wd->timeline_start + (time_t)slot * 3600;
+    return 0;
+}
@@ -1,9 +1,9 @@
 /*
  * zipdb.c - ZIP code database lookup
  *
- * mmap'd binary search on us_zipcodes.bin.
- * Entry format: 5 bytes ASCII ZIP + 4 bytes float32 lat + 4 bytes float32 lon.
- * File header: 4 bytes uint32_t count (little-endian).
+ * v2 files are a direct-indexed table: the ZIP's numeric value is the
+ * record index, so a lookup is one aligned 8-byte load. v1 files (sorted
+ * 13-byte entries) are still read through the old binary search.
  */
 
 #define _GNU_SOURCE
@@ -11,67 +11,148 @@
 #include "zipdb.h"
 
 #include <fcntl.h>
-#include <stdint.h>
+#include <math.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 static_assert(sizeof(float) == 4, "float must be 32 bits for zipdb format");
+static_assert(sizeof(zipdb_header_t) == 16, "zipdb v2 header is 16 bytes");
+static_assert(sizeof(zipdb_record_t) == 8, "zipdb v2 record is 8 bytes");
 
-constexpr int ENTRY_SIZE = 13;  /* 5 + 4 + 4 */
-constexpr int HEADER_SIZE = 4;  /* uint32_t count */
+constexpr int V1_ENTRY_SIZE = 13;  /* 5 + 4 + 4 */
+constexpr int V1_HEADER_SIZE = 4;  /* uint32_t count */
 
-bool zipdb_lookup(const char *db_path, const char *zipcode,
-                  float *lat, float *lon)
+static bool is_v2(const uint8_t *data, size_t size)
 {
-    if (!db_path || !zipcode || !lat || !lon) return false;
+    if (size < sizeof(zipdb_header_t)) return false;
+
+    zipdb_header_t hdr;
+    memcpy(&hdr, data, sizeof(hdr));
+    return memcmp(hdr.magic, ZIPDB_MAGIC, 4) == 0 &&
+           hdr.version == ZIPDB_VERSION &&
+           hdr.record_size == sizeof(zipdb_record_t) &&
+           hdr.slots == ZIPDB_SLOTS &&
+           size >= sizeof(hdr) + (size_t)ZIPDB_SLOTS * sizeof(zipdb_record_t);
+}
 
-    /* Normalize to exactly 5 digits */
-    char zip5[6];
-    size_t zlen = strlen(zipcode);
-    if (zlen > 5) zlen = 5;
-    memset(zip5, '0', 5);
-    memcpy(zip5 + (5 - zlen), zipcode, zlen);
-    zip5[5] = '\0';
+bool zipdb_open(zipdb_t *db, const char *db_path)
+{
+    if (!db) return false;
+    *db = (zipdb_t){0};
+    if (!db_path) return false;
 
     int fd = open(db_path, O_RDONLY | O_CLOEXEC);
     if (fd < 0) return false;
 
     struct stat st;
-    if (fstat(fd, &st) < 0) { close(fd); return false; }
+    if (fstat(fd, &st) < 0 || st.st_size < V1_HEADER_SIZE) {
+        close(fd);
+        return false;
+    }
 
     void *map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
     close(fd);
     if (map == MAP_FAILED) return false;
 
     const uint8_t *data = map;
+    size_t size = (size_t)st.st_size;
+
+    if (is_v2(data, size)) {
+        zipdb_header_t hdr;
+        memcpy(&hdr, data, sizeof(hdr));
+        db->version = 2;
+        db->count = hdr.count;
+        /* Lookups touch one page each: don't read ahead the whole table */
+        madvise(map, size, MADV_RANDOM);
+    } else {
+        uint32_t count;
+        memcpy(&count, data, sizeof(count));
+        if ((size - V1_HEADER_SIZE) / V1_ENTRY_SIZE < count) {
+            munmap(map, size);
+            return false;
+        }
+        db->version = 1;
+        db->count = count;
+    }
+
+    db->map = data;
+    db->size = size;
+    return true;
+}
 
-    /* Read entry count */
-    uint32_t count;
-    memcpy(&count, data, sizeof(count));
+void zipdb_close(zipdb_t *db)
+{
+    if (!db || !db->map) return;
+    munmap((void *)db->map, db->size);
+    *db = (zipdb_t){0};
+}
 
-    /* Binary search */
-    bool found = false;
-    int low = 0, high = (int)count - 1;
+static bool find_v1(const zipdb_t *db, const char zip5[6], float *lat, float *lon)
+{
+    int low = 0, high = (int)db->count - 1;
 
     while (low <= high) {
         int mid = low + (high - low) / 2;
-        size_t offset = HEADER_SIZE + (size_t)mid * ENTRY_SIZE;
+        const uint8_t *entry = db->map + V1_HEADER_SIZE + (size_t)mid * V1_ENTRY_SIZE;
 
-        int cmp = memcmp(data + offset, zip5, 5);
+        int cmp = memcmp(entry, zip5, 5);
         if (cmp == 0) {
-            memcpy(lat, data + offset + 5, sizeof(float));
-            memcpy(lon, data + offset + 9, sizeof(float));
-            found = true;
-            break;
+            memcpy(lat, entry + 5, sizeof(float));
+            memcpy(lon, entry + 9, sizeof(float));
+            return true;
         } else if (cmp < 0) {
             low = mid + 1;
         } else {
             high = mid - 1;
         }
     }
+    return false;
+}
+
+static bool find_v2(const zipdb_t *db, const char zip5[6], float *lat, float *lon)
+{
+    uint32_t idx = 0;
+    for (int i = 0; i < 5; i++) {
+        if (zip5[i] < '0' || zip5[i] > '9') return false;
+        idx = idx * 10 + (uint32_t)(zip5[i] - '0');
+    }
+
+    /* Header is 16 bytes and the map page-aligned: records are aligned */
+    const zipdb_record_t *records =
+        (const zipdb_record_t *)(db->map + sizeof(zipdb_header_t));
+    zipdb_record_t rec = records[idx];
+    if (isnan(rec.lat)) return false;
+
+    *lat = rec.lat;
+    *lon = rec.lon;
+    return true;
+}
+
+bool zipdb_find(const zipdb_t *db, const char *zipcode, float *lat, float *lon)
+{
+    if (!db || !db->map || !zipcode || !lat || !lon) return false;
+
+    /* Normalize to exactly 5 digits */
+    char zip5[6];
+    size_t zlen = strlen(zipcode);
+    if (zlen > 5) zlen = 5;
+    memset(zip5, '0', 5);
+    memcpy(zip5 + (5 - zlen), zipcode, zlen);
+    zip5[5] = '\0';
+
+    return db->version == 2 ? find_v2(db, zip5, lat, lon)
+                            : find_v1(db, zip5, lat, lon);
+}
+
+bool zipdb_lookup(const char *db_path, const char *zipcode,
+                  float *lat, float *lon)
+{
+    zipdb_t db;
+    if (!zipdb_open(&db, db_path)) return false;
 
-    munmap(map, (size_t)st.st_size);
+    bool found = zipdb_find(&db, zipcode, lat, lon);
+    zipdb_close(&db);
     return found;
 }
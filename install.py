@@ -17,6 +17,7 @@ import os
 import pwd
 import sys
 import shutil
+import struct
 import subprocess
 import time
 from pathlib import Path
@@ -311,6 +312,71 @@ def build_abraxas_rust(source_dir: Path, non_usa: bool = False) -> bool:
     return True
 
 
+# =============================================================================
+# ZIP DATABASE
+# =============================================================================
+
+# v2 layout, mirrored by c23/include/zipdb.h and rust/src/zipdb.rs
+ZIPDB_MAGIC = b"ABZD"
+ZIPDB_VERSION = 2
+ZIPDB_SLOTS = 100000
+ZIPDB_HEADER = struct.Struct("<4sHHII")   # magic, version, record_size, slots, count
+ZIPDB_RECORD = struct.Struct("<ff")       # lat, lon
+ZIPDB_EMPTY = ZIPDB_RECORD.pack(float("nan"), float("nan"))
+
+
+def zipdb_version(path: Path) -> int:
+    """On-disk format of a ZIP database: 1, 2, or 0 if unreadable."""
+    try:
+        with open(path, "rb") as f:
+            head = f.read(ZIPDB_HEADER.size)
+    except OSError:
+        return 0
+    if len(head) == ZIPDB_HEADER.size and head[:4] == ZIPDB_MAGIC:
+        return struct.unpack_from("<H", head, 4)[0]
+    return 1 if len(head) >= 4 else 0
+
+
+def read_zipdb_v1(path: Path) -> list[tuple[int, float, float]]:
+    """Entries of a v1 database (u32 count, then 13-byte records)."""
+    data = path.read_bytes()
+    (count,) = struct.unpack_from("<I", data, 0)
+    if 4 + count * 13 > len(data):
+        raise ValueError(f"{path}: truncated ({count} entries declared)")
+    entries = []
+    for i in range(count):
+        off = 4 + i * 13
+        zip5 = data[off:off + 5].decode("ascii")
+        lat, lon = struct.unpack_from("<ff", data, off + 5)
+        entries.append((int(zip5), lat, lon))
+    return entries
+
+
+def build_zipdb_v2(source: Path, dest: Path) -> bool:
+    """Write a direct-indexed v2 database at dest from a v1 source."""
+    try:
+        entries = read_zipdb_v1(source)
+    except (OSError, ValueError, UnicodeDecodeError) as e:
+        log_error(f"Cannot read ZIP database {source}: {e}")
+        return False
+
+    table = bytearray(ZIPDB_EMPTY * ZIPDB_SLOTS)
+    for zip_num, lat, lon in entries:
+        ZIPDB_RECORD.pack_into(table, zip_num * ZIPDB_RECORD.size, lat, lon)
+
+    header = ZIPDB_HEADER.pack(ZIPDB_MAGIC, ZIPDB_VERSION, ZIPDB_RECORD.size,
+                               ZIPDB_SLOTS, len(entries))
+    tmp = dest.with_name(dest.name + ".tmp")
+    try:
+        tmp.write_bytes(header + table)
+        tmp.replace(dest)
+    except OSError as e:
+        log_error(f"Failed to write {dest}: {e}")
+        tmp.unlink(missing_ok=True)
+        return False
+    return True
+
+
 # =============================================================================
 # COMMANDS
 # =============================================================================
@@ -427,11 +493,17 @@ def cmd_install(args, source_dir: Path) -> bool:
     if not non_usa:
         if source_zipdb.exists():
             dest_zipdb = INSTALL_CONFIG_DIR / "us_zipcodes.bin"
-            if not dest_zipdb.exists():
+            installed = zipdb_version(dest_zipdb)
+            if installed >= ZIPDB_VERSION:
+                log_info("ZIP database already installed")
+            elif zipdb_version(source_zipdb) >= ZIPDB_VERSION:
                 log_info("Installing ZIP database...")
                 shutil.copy2(source_zipdb, dest_zipdb)
             else:
-                log_info("ZIP database already installed")
+                verb = "Upgrading" if installed else "Installing"
+                log_info(f"{verb} ZIP database (v{ZIPDB_VERSION}, direct-indexed)...")
+                if not build_zipdb_v2(source_zipdb, dest_zipdb):
+                    log_warn("ZIP database not installed")
         else:
             log_warn("ZIP database not found in source")
     else:
@@ -537,7 +609,10 @@ def cmd_status(args, source_dir: Path) -> bool:
     print(f"             {'exists' if config_ok else 'NOT FOUND'}")
     print()
     print(f"  ZIP DB:    {INSTALL_CONFIG_DIR / 'us_zipcodes.bin'}")
-    print(f"             {'installed' if zipdb_ok else 'NOT INSTALLED'}")
+    if zipdb_ok:
+        print(f"             installed (v{zipdb_version(INSTALL_CONFIG_DIR / 'us_zipcodes.bin')})")
+    else:
+        print("             NOT INSTALLED")
     print()
 
     # Service status
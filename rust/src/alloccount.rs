@@ -0,0 +1,58 @@
+//! Counting global allocator.
+//!
+//! Forwards to the system allocator after one relaxed increment per
+//! allocation (alloc, alloc_zeroed, realloc). `--alloc-check` reads the
+//! counter around the daemon's tick. Only Rust's heap is seen: libc's
+//! internal mallocs (tzset, stdio) bypass the global allocator. Unit tests
+//! read a per-thread count instead, as libtest runs them side by side.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::sync::atomic::{AtomicU64, Ordering};
+
+static ALLOCS: AtomicU64 = AtomicU64::new(0);
+
+#[cfg(test)]
+thread_local! {
+    static THREAD_ALLOCS: std::cell::Cell<u64> = const { std::cell::Cell::new(0) };
+}
+
+#[inline]
+fn counted() {
+    ALLOCS.fetch_add(1, Ordering::Relaxed);
+    #[cfg(test)]
+    let _ = THREAD_ALLOCS.try_with(|c| c.set(c.get() + 1));
+}
+
+pub struct CountingAlloc;
+
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        counted();
+        System.alloc(layout)
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        counted();
+        System.alloc_zeroed(layout)
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        counted();
+        System.realloc(ptr, layout, new_size)
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        System.dealloc(ptr, layout)
+    }
+}
+
+/// Allocations made so far by the whole process
+pub fn count() -> u64 {
+    ALLOCS.load(Ordering::Relaxed)
+}
+
+/// Allocations made so far by the calling thread
+#[cfg(test)]
+pub fn thread_count() -> u64 {
+    THREAD_ALLOCS.with(|c| c.get())
+}
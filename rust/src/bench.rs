@@ -0,0 +1,639 @@
+//! Benchmark harness behind --benchmark.
+//!
+//! Same runner and report as c23/src/bench.c: each case is warmed up,
+//! timed as samples of a calibrated batch of calls, and reported as
+//! p50/p99/max per call plus the Tukey-fenced mean. Cycles and
+//! instructions come from a perf_event_open group when the kernel allows
+//! it. Case names match the C harness so test.py can pair them up.
+
+use std::hint::black_box;
+use std::path::{Path, PathBuf};
+
+use crate::config::{self, Paths, WeatherData};
+use crate::{daemon, gamma, sigmoid, solar, uring, zipdb, SIGMOID_STEEPNESS};
+
+// Per-case time budget
+const WARMUP_NS: u64 = 10_000_000; // 10 ms, also calibrates the batch
+const BUDGET_NS: u64 = 100_000_000; // 100 ms of samples
+const SAMPLE_NS: u64 = 20_000; // target length of one sample
+
+const SAMPLES_MIN: usize = 30;
+const SAMPLES_MAX: usize = 1000;
+
+// Batch solar cases: a day of minutes, a fleet of sites
+const BENCH_DAY_ROWS: usize = 24 * 60 + 1;
+const BENCH_SITES: usize = 256;
+
+// perf_event_open ABI (linux/perf_event.h)
+const PERF_TYPE_HARDWARE: u32 = 0;
+const PERF_COUNT_HW_CPU_CYCLES: u64 = 0;
+const PERF_COUNT_HW_INSTRUCTIONS: u64 = 1;
+const PERF_FORMAT_GROUP: u64 = 1 << 3;
+const PERF_FLAG_FD_CLOEXEC: libc::c_ulong = 1 << 3;
+const PERF_EVENT_IOC_ENABLE: libc::c_ulong = 0x2400;
+const PERF_EVENT_IOC_DISABLE: libc::c_ulong = 0x2401;
+const PERF_EVENT_IOC_RESET: libc::c_ulong = 0x2403;
+const PERF_IOC_FLAG_GROUP: libc::c_ulong = 1;
+
+// perf_event_attr flag bits
+const ATTR_DISABLED: u64 = 1 << 0;
+const ATTR_EXCLUDE_KERNEL: u64 = 1 << 5;
+const ATTR_EXCLUDE_HV: u64 = 1 << 6;
+
+/// Kernel struct perf_event_attr (PERF_ATTR_SIZE_VER7, 128 bytes).
+/// Only the leading fields are set; the rest stays zero.
+#[repr(C)]
+struct PerfEventAttr {
+    type_: u32,
+    size: u32,
+    config: u64,
+    sample_period: u64,
+    sample_type: u64,
+    read_format: u64,
+    flags: u64,
+    rest: [u64; 10],
+}
+
+/// Options from the command line
+#[derive(Default)]
+pub struct Options {
+    pub json: bool,
+    pub fixtures: Option<PathBuf>,
+}
+
+struct Case {
+    name: &'static str,
+    group: &'static str,
+    max_samples: usize, // 0 = SAMPLES_MAX
+    single: bool,       // one call per sample (slow or visible side effects)
+}
+
+impl Case {
+    fn new(name: &'static str, group: &'static str) -> Self {
+        Self { name, group, max_samples: 0, single: false }
+    }
+}
+
+struct Measured {
+    warmup: u64,
+    samples: usize,
+    batch: u64,
+    p50: f64,
+    p99: f64,
+    max: f64,
+    mean: f64,
+    outliers: usize,
+    counters: Option<(f64, f64)>, // cycles, instructions per call
+}
+
+struct BenchResult {
+    name: &'static str,
+    group: &'static str,
+    outcome: Result<Measured, &'static str>, // Err = skip reason
+}
+
+struct Perf {
+    leader: i32,
+    member: i32,
+    scope: &'static str,
+}
+
+struct Bench {
+    results: Vec<BenchResult>,
+    json: bool,
+    perf: Option<Perf>,
+}
+
+// --- Clock and counters ---
+
+fn bench_ns() -> u64 {
+    let mut ts = libc::timespec { tv_sec: 0, tv_nsec: 0 };
+    unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC_RAW, &mut ts) };
+    ts.tv_sec as u64 * 1_000_000_000 + ts.tv_nsec as u64
+}
+
+fn perf_open(config: u64, group_fd: i32, user_only: bool) -> i32 {
+    let mut flags = ATTR_EXCLUDE_HV;
+    if group_fd < 0 {
+        flags |= ATTR_DISABLED;
+    }
+    if user_only {
+        flags |= ATTR_EXCLUDE_KERNEL;
+    }
+    let attr = PerfEventAttr {
+        type_: PERF_TYPE_HARDWARE,
+        size: std::mem::size_of::<PerfEventAttr>() as u32,
+        config,
+        sample_period: 0,
+        sample_type: 0,
+        read_format: PERF_FORMAT_GROUP,
+        flags,
+        rest: [0; 10],
+    };
+    unsafe {
+        libc::syscall(
+            libc::SYS_perf_event_open,
+            &attr as *const PerfEventAttr,
+            0 as libc::pid_t,
+            -1 as libc::c_int,
+            group_fd,
+            PERF_FLAG_FD_CLOEXEC,
+        ) as i32
+    }
+}
+
+impl Perf {
+    /// Cycles + instructions as one group; kernel time too if paranoia allows
+    fn open() -> Option<Self> {
+        for user_only in [false, true] {
+            let leader = perf_open(PERF_COUNT_HW_CPU_CYCLES, -1, user_only);
+            if leader < 0 {
+                continue;
+            }
+            let member = perf_open(PERF_COUNT_HW_INSTRUCTIONS, leader, user_only);
+            if member < 0 {
+                unsafe { libc::close(leader) };
+                continue;
+            }
+            let scope = if user_only { "user" } else { "user+kernel" };
+            return Some(Self { leader, member, scope });
+        }
+        None
+    }
+
+    fn start(&self) {
+        unsafe {
+            libc::ioctl(self.leader, PERF_EVENT_IOC_RESET as _, PERF_IOC_FLAG_GROUP);
+            libc::ioctl(self.leader, PERF_EVENT_IOC_ENABLE as _, PERF_IOC_FLAG_GROUP);
+        }
+    }
+
+    fn stop(&self) -> Option<(u64, u64)> {
+        unsafe { libc::ioctl(self.leader, PERF_EVENT_IOC_DISABLE as _, PERF_IOC_FLAG_GROUP) };
+
+        let mut group = [0u64; 3]; // nr, cycles, instructions
+        let want = std::mem::size_of_val(&group);
+        let n = unsafe { libc::read(self.leader, group.as_mut_ptr() as *mut libc::c_void, want) };
+        if n != want as isize || group[0] != 2 {
+            return None;
+        }
+        Some((group[1], group[2]))
+    }
+}
+
+impl Drop for Perf {
+    fn drop(&mut self) {
+        unsafe {
+            libc::close(self.member);
+            libc::close(self.leader);
+        }
+    }
+}
+
+// --- Statistics ---
+
+/// Nearest-rank percentile of sorted
+fn percentile(sorted: &[f64], q: f64) -> f64 {
+    let n = sorted.len();
+    let k = ((q * n as f64).ceil() as isize - 1).clamp(0, n as isize - 1);
+    sorted[k as usize]
+}
+
+// --- Output ---
+
+fn fmt_ns(ns: f64) -> String {
+    if ns < 1000.0 {
+        format!("{:.0} ns", ns)
+    } else if ns < 1_000_000.0 {
+        format!("{:.2} us", ns / 1000.0)
+    } else {
+        format!("{:.2} ms", ns / 1_000_000.0)
+    }
+}
+
+fn json_number_or_null(v: Option<f64>) -> String {
+    match v {
+        Some(v) => format!("{:.1}", v),
+        None => "null".to_string(),
+    }
+}
+
+fn json_string_or_null(v: Option<&str>) -> String {
+    match v {
+        Some(v) => format!("{:?}", v),
+        None => "null".to_string(),
+    }
+}
+
+impl Bench {
+    fn print(&self, r: &BenchResult) {
+        if self.json {
+            return;
+        }
+
+        let prev = self.results.len().checked_sub(2).map(|i| self.results[i].group);
+        if prev != Some(r.group) {
+            println!("\n{}:", r.group);
+        }
+
+        let m = match &r.outcome {
+            Ok(m) => m,
+            Err(reason) => {
+                println!("  {:<32} {}", r.name, reason);
+                return;
+            }
+        };
+
+        print!("  {:<32} {:>10} {:>10} {:>10}", r.name, fmt_ns(m.p50), fmt_ns(m.p99), fmt_ns(m.max));
+        match m.counters {
+            Some((cycles, instr)) => print!(" {:>9.0} {:>9.0}", cycles, instr),
+            None => print!(" {:>9} {:>9}", "-", "-"),
+        }
+        print!("  {} x {}", m.samples, m.batch);
+        if m.outliers > 0 {
+            print!(", {} outliers", m.outliers);
+        }
+        println!();
+    }
+
+    fn print_json(&self, fixtures: Option<&Path>) {
+        println!("{{");
+        println!("  \"implementation\": \"rust\",");
+        println!("  \"version\": \"8.4.0\",");
+        println!("  \"clock\": \"CLOCK_MONOTONIC_RAW\",");
+        println!("  \"ramp_kernel\": \"{}\",", gamma::colorramp::kernel_name());
+        println!("  \"perf\": {},", json_string_or_null(self.perf.as_ref().map(|p| p.scope)));
+        let fixtures = fixtures.map(|f| f.to_string_lossy().into_owned());
+        println!("  \"fixtures\": {},", json_string_or_null(fixtures.as_deref()));
+
+        let cases: Vec<String> = self.results.iter()
+            .filter_map(|r| r.outcome.as_ref().ok().map(|m| (r, m)))
+            .map(|(r, m)| format!(
+                "\n    {{\"name\": \"{}\", \"group\": \"{}\", \"warmup\": {}, \
+                 \"samples\": {}, \"batch\": {}, \"p50_ns\": {:.1}, \"p99_ns\": {:.1}, \
+                 \"max_ns\": {:.1}, \"mean_ns\": {:.1}, \"outliers\": {}, \"cycles\": {}, \
+                 \"instructions\": {}}}",
+                r.name, r.group, m.warmup, m.samples, m.batch, m.p50, m.p99, m.max,
+                m.mean, m.outliers, json_number_or_null(m.counters.map(|c| c.0)),
+                json_number_or_null(m.counters.map(|c| c.1))))
+            .collect();
+        println!("  \"cases\": [{}\n  ],", cases.join(","));
+
+        let skipped: Vec<String> = self.results.iter()
+            .filter_map(|r| r.outcome.as_ref().err().map(|reason| (r, reason)))
+            .map(|(r, reason)| format!(
+                "\n    {{\"name\": \"{}\", \"group\": \"{}\", \"reason\": \"{}\"}}",
+                r.name, r.group, reason))
+            .collect();
+        println!("  \"skipped\": [{}\n  ]", skipped.join(","));
+        println!("}}");
+    }
+
+    fn push(&mut self, r: BenchResult) {
+        self.results.push(r);
+        self.print(self.results.last().unwrap());
+    }
+
+    fn skip(&mut self, name: &'static str, group: &'static str, reason: &'static str) {
+        self.push(BenchResult { name, group, outcome: Err(reason) });
+    }
+
+    fn run(&mut self, c: Case, f: &mut dyn FnMut(u64)) {
+        // Warmup: keep doubling the batch until one takes SAMPLE_NS
+        let (mut i, mut calls, mut batch) = (0u64, 0u64, 1u64);
+        let mut last;
+        let warm_start = bench_ns();
+        loop {
+            let t0 = bench_ns();
+            for _ in 0..batch {
+                f(i);
+                i += 1;
+            }
+            last = bench_ns() - t0;
+            calls += batch;
+            if !c.single && last < SAMPLE_NS {
+                batch *= 2;
+            }
+            if bench_ns() - warm_start >= WARMUP_NS {
+                break;
+            }
+        }
+
+        let per_call = last as f64 / if c.single { 1.0 } else { batch as f64 };
+        batch = if c.single || per_call <= 0.0 || per_call >= SAMPLE_NS as f64 {
+            1
+        } else {
+            (SAMPLE_NS as f64 / per_call) as u64
+        };
+
+        let max_samples = if c.max_samples > 0 { c.max_samples } else { SAMPLES_MAX };
+        let sample_ns = per_call * batch as f64;
+        let samples = if sample_ns > 0.0 && BUDGET_NS as f64 / sample_ns < max_samples as f64 {
+            (BUDGET_NS as f64 / sample_ns) as usize
+        } else {
+            max_samples
+        }
+        .max(SAMPLES_MIN);
+
+        let mut v = Vec::with_capacity(samples);
+        if let Some(p) = &self.perf {
+            p.start();
+        }
+        for _ in 0..samples {
+            let t0 = bench_ns();
+            for _ in 0..batch {
+                f(i);
+                i += 1;
+            }
+            v.push((bench_ns() - t0) as f64 / batch as f64);
+        }
+        let total = samples as f64 * batch as f64;
+        let counters = self.perf.as_ref()
+            .and_then(|p| p.stop())
+            .map(|(cy, ins)| (cy as f64 / total, ins as f64 / total));
+
+        v.sort_by(|a, b| a.total_cmp(b));
+
+        // Tukey's far fence: one preempted batch should not move the mean
+        let q1 = percentile(&v, 0.25);
+        let q3 = percentile(&v, 0.75);
+        let fence = q3 + 3.0 * (q3 - q1);
+        let kept: Vec<f64> = v.iter().copied().take_while(|&x| x <= fence).collect();
+        let p50 = percentile(&v, 0.50);
+        let mean = if kept.is_empty() { p50 } else { kept.iter().sum::<f64>() / kept.len() as f64 };
+
+        self.push(BenchResult {
+            name: c.name,
+            group: c.group,
+            outcome: Ok(Measured {
+                warmup: calls,
+                samples,
+                batch,
+                p50,
+                p99: percentile(&v, 0.99),
+                max: v[samples - 1],
+                mean,
+                outliers: samples - kept.len(),
+                counters,
+            }),
+        });
+    }
+
+    /// Batched case with the default sample budget
+    fn add(&mut self, name: &'static str, group: &'static str, f: &mut dyn FnMut(u64)) {
+        self.run(Case::new(name, group), f);
+    }
+}
+
+// --- Fixtures ---
+
+fn find_fixtures(given: Option<&Path>) -> Option<PathBuf> {
+    if let Some(dir) = given {
+        return Some(dir.to_path_buf());
+    }
+    ["bench/fixtures", "../bench/fixtures"].iter()
+        .map(PathBuf::from)
+        .find(|dir| dir.join("noaa_hourly.json").is_file())
+}
+
+/// config/cache/override paths inside the corpus
+fn fixture_paths(base: &Paths, dir: &Path) -> Paths {
+    Paths {
+        config_file: dir.join("config.ini"),
+        cache_file: dir.join("weather_cache.json"),
+        override_file: dir.join("override.json"),
+        ..base.clone()
+    }
+}
+
+/// Fixture "timeline_start" from the weather cache, read directly: the
+/// Rust cache loader does not keep the timeline.
+fn fixture_instant(cache_file: &Path) -> Option<i64> {
+    let content = std::fs::read_to_string(cache_file).ok()?;
+    let v: serde_json::Value = serde_json::from_str(&content).ok()?;
+    v["timeline_start"].as_i64()
+}
+
+// --- Entry ---
+
+/// Run every case. Returns the process exit code.
+pub fn run(paths: &Paths, opt: &Options) -> i32 {
+    let mut b = Bench { results: Vec::new(), json: opt.json, perf: Perf::open() };
+
+    let fixtures = find_fixtures(opt.fixtures.as_deref());
+    let mut points = String::new();
+    let mut hourly = String::new();
+    if let Some(dir) = &fixtures {
+        let read = |name: &str| std::fs::read_to_string(dir.join(name)).ok();
+        match (read("config.ini"), read("noaa_points.json"), read("noaa_hourly.json")) {
+            (Some(_), Some(p), Some(h)) => {
+                points = p;
+                hourly = h;
+            }
+            _ => {
+                eprintln!("Fixture corpus incomplete in {}", dir.display());
+                return 1;
+            }
+        }
+    }
+
+    // Fixed location and instant from the corpus, so runs compare
+    let fixture = fixtures.as_deref().map(|dir| fixture_paths(paths, dir));
+    let (mut lat, mut lon, mut now) = (34.26, -88.38, crate::now_epoch());
+    let mut weather: Option<WeatherData> = None;
+    if let Some(fp) = &fixture {
+        if let Some(loc) = config::load_location(fp) {
+            lat = loc.lat;
+            lon = loc.lon;
+        }
+        weather = config::load_weather_cache(fp);
+        if let Some(start) = fixture_instant(&fp.cache_file) {
+            now = start + 5 * 3600;
+        }
+    }
+
+    let (from_sunrise, to_sunset) = match solar::sunrise_sunset(now, lat, lon) {
+        Some(st) => ((now - st.sunrise) as f64 / 60.0, (st.sunset - now) as f64 / 60.0),
+        None => (0.0, 0.0),
+    };
+
+    if !b.json {
+        println!("ABRAXAS v8.4.0 [Rust] -- Kernel-grade benchmark");
+        println!("Clock: CLOCK_MONOTONIC_RAW (hardware TSC)");
+        match &b.perf {
+            Some(p) => println!("Counters: cycles, instructions ({})", p.scope),
+            None => println!("Counters: unavailable"),
+        }
+        println!("Ramp kernel: {}", gamma::colorramp::kernel_name());
+        match &fixtures {
+            Some(dir) => println!("Fixtures: {}", dir.display()),
+            None => println!("Fixtures: not found (--fixtures DIR)"),
+        }
+        println!("\n  {:<32} {:>10} {:>10} {:>10} {:>9} {:>9}  samples x batch",
+            "per call", "p50", "p99", "max", "cycles", "instr");
+    }
+
+    let no_fixtures = "skipped (no fixture corpus)";
+
+    // Core math and config
+    b.add("config_init_paths()", "core", &mut |_| {
+        let _ = black_box(Paths::init());
+    });
+    match &fixture {
+        Some(fp) => b.add("config_load_location()", "core", &mut |_| {
+            let _ = black_box(config::load_location(fp));
+        }),
+        None => b.skip("config_load_location()", "core", no_fixtures),
+    }
+    b.add("solar_sunrise_sunset()", "core", &mut |_| {
+        black_box(solar::sunrise_sunset(black_box(now), lat, lon));
+    });
+    b.add("solar_position()", "core", &mut |_| {
+        black_box(solar::position(black_box(now), lat, lon));
+    });
+    {
+        // A day of minutes; sites on a 16 x 16 grid spanning 10 x 20
+        // degrees around the corpus location
+        let day_start = now - now.rem_euclid(86400);
+        let minutes: Vec<i64> = (0..BENCH_DAY_ROWS as i64).map(|i| day_start + i * 60).collect();
+        let mut elevation = vec![0.0; BENCH_DAY_ROWS];
+        b.add("solar_position_batch(1441)", "core", &mut |_| {
+            solar::positions(black_box(&minutes), lat, lon, &mut elevation);
+        });
+
+        let site_lat: Vec<f64> = (0..BENCH_SITES).map(|i| lat - 5.0 + 10.0 * (i % 16) as f64 / 16.0).collect();
+        let site_lon: Vec<f64> = (0..BENCH_SITES).map(|i| lon - 10.0 + 20.0 * (i / 16) as f64 / 16.0).collect();
+        let (mut rise, mut set, mut valid) = (vec![0; BENCH_SITES], vec![0; BENCH_SITES], vec![false; BENCH_SITES]);
+        b.add("solar_sunrise_sunset_batch(256)", "core", &mut |_| {
+            solar::sunrise_sunset_batch(black_box(now), &site_lat, &site_lon,
+                                        &mut rise, &mut set, &mut valid);
+        });
+    }
+    b.add("calculate_solar_temp()", "core", &mut |_| {
+        black_box(sigmoid::calculate_solar_temp(black_box(from_sunrise), black_box(to_sunset), false));
+    });
+    b.add("sigmoid_norm()", "core", &mut |_| {
+        black_box(sigmoid::sigmoid_norm(black_box(0.5), black_box(SIGMOID_STEEPNESS)));
+    });
+
+    // JSON: small config files and a full NOAA payload
+    match &fixture {
+        Some(fp) => {
+            b.add("config_load_override()", "json", &mut |_| {
+                let _ = black_box(config::load_override(fp));
+            });
+            b.add("config_load_weather_cache()", "json", &mut |_| {
+                let _ = black_box(config::load_weather_cache(fp));
+            });
+            bench_noaa(&mut b, &points, &hourly);
+        }
+        None => {
+            b.skip("config_load_override()", "json", no_fixtures);
+            b.skip("config_load_weather_cache()", "json", no_fixtures);
+            b.skip("noaa_points_parse()", "json", no_fixtures);
+            b.skip("noaa_hourly_parse()", "json", no_fixtures);
+        }
+    }
+
+    // ZIP lookup: one-shot vs. kept mapping
+    let zip = |i: u64| format!("{:05}", 60000 + i % 1000);
+    match zipdb::ZipDb::open(&paths.zipdb_file) {
+        Some(db) => {
+            b.add("zipdb_lookup()", "zipdb", &mut |i| {
+                black_box(zipdb::lookup(&paths.zipdb_file, &zip(i)));
+            });
+            b.add("zipdb_find()", "zipdb", &mut |i| {
+                black_box(db.find(&zip(i)));
+            });
+        }
+        None => {
+            b.skip("zipdb_lookup()", "zipdb", "skipped (no ZIP database installed)");
+            b.skip("zipdb_find()", "zipdb", "skipped (no ZIP database installed)");
+        }
+    }
+
+    // Gamma ramp fill
+    let mut ramps = vec![[[0u16; 4096]; 3]; 5];
+    for (size, name) in [(256, "fill_gamma_ramps(256)"),
+                         (1024, "fill_gamma_ramps(1024)"),
+                         (4096, "fill_gamma_ramps(4096)")] {
+        let [r, g, bl] = &mut ramps[0];
+        b.add(name, "gamma", &mut |i| {
+            let _ = gamma::colorramp::fill_gamma_ramps(
+                black_box(2900 + (i & 63) as i32), size, r, g, bl, 1.0);
+        });
+    }
+    {
+        let (heads, rest) = ramps.split_at_mut(4);
+        let mut jobs: Vec<gamma::colorramp::RampJob> = heads.iter_mut().enumerate()
+            .map(|(j, [r, g, bl])| gamma::colorramp::RampJob {
+                temp: if j < 2 { 4500 } else { 6500 },
+                gamma_size: 4096,
+                brightness: 1.0,
+                r, g, b: bl,
+            })
+            .collect();
+        b.add("fill_gamma_ramps_batch(4x4096)", "gamma", &mut |_| {
+            let _ = gamma::colorramp::fill_gamma_ramps_batch(black_box(&mut jobs));
+        });
+
+        // Backend set: real ioctl / protocol round trip, restored afterwards
+        match gamma::init() {
+            Ok(mut state) => {
+                let case = Case { max_samples: 100, single: true,
+                                  ..Case::new("meridian_set_temperature()", "backend") };
+                b.run(case, &mut |i| {
+                    let _ = state.set_temperature(6500 - (i & 255) as i32, 1.0);
+                });
+                let _ = state.restore();
+            }
+            Err(_) => b.skip("meridian_set_temperature()", "backend", "skipped (no gamma backend)"),
+        }
+
+        // Full tick: temperature for the wakeup and the ramp the backend
+        // would be handed. This port has no ephemeris tables, so the
+        // solar solve runs every time.
+        let [r, g, bl] = &mut rest[0];
+        b.add("daemon_tick()", "tick", &mut |i| {
+            let t = now + (i * 37 % 86400) as i64;
+            let temp = daemon::solar_temperature(t, lat, lon, &weather);
+            let _ = gamma::colorramp::fill_gamma_ramps(temp, 4096, r, g, bl, 1.0);
+        });
+    }
+
+    // Kernel facilities
+    if uring::AbraxasRing::init(8).is_some() {
+        let case = Case { max_samples: 200, ..Case::new("io_uring_setup()", "kernel") };
+        b.run(case, &mut |_| {
+            drop(black_box(uring::AbraxasRing::init(8)));
+        });
+    } else {
+        b.skip("io_uring_setup()", "kernel", "unavailable");
+    }
+    // Installing these would restrict the benchmark process itself
+    b.skip("seccomp_install()", "kernel", "not measured -- would restrict process");
+    b.skip("landlock_install()", "kernel", "not measured -- would restrict process");
+
+    if b.json {
+        b.print_json(fixtures.as_deref());
+    } else {
+        println!("\nDone.");
+    }
+    0
+}
+
+#[cfg(feature = "noaa")]
+fn bench_noaa(b: &mut Bench, points: &str, hourly: &str) {
+    b.add("noaa_points_parse()", "json", &mut |_| {
+        let _ = black_box(crate::weather::parse_points(black_box(points)));
+    });
+    b.add("noaa_hourly_parse()", "json", &mut |_| {
+        let _ = black_box(crate::weather::parse_hourly(black_box(hourly)));
+    });
+}
+
+#[cfg(not(feature = "noaa"))]
+fn bench_noaa(b: &mut Bench, _points: &str, _hourly: &str) {
+    b.skip("noaa_points_parse()", "json", "skipped (NOAA disabled)");
+    b.skip("noaa_hourly_parse()", "json", "skipped (NOAA disabled)");
+}
@@ -62,6 +62,9 @@ pub struct OverrideState {
     pub duration_minutes: i32,
     pub issued_at: i64,
     pub start_temp: i32,
+    /// C23 daemon's frame-rate fade; this daemon applies such overrides instantly
+    #[serde(default)]
+    pub fade_ms: i32,
 }
 
 /// Load location from INI config
@@ -31,6 +31,8 @@ struct PollState {
     inotify: bool,
     signal: bool,
     weather: bool,
+    #[cfg_attr(not(feature = "noaa"), allow(dead_code))]
+    worker: bool, // fetch worker reply receive posted
 }
 
 /// Full daemon runtime state
@@ -165,7 +167,7 @@ fn local_time(epoch: i64) -> LocalTime {
 }
 
 /// Calculate solar temperature given current state.
-fn solar_temperature(now: i64, lat: f64, lon: f64, weather: &Option<WeatherData>) -> i32 {
+pub(crate) fn solar_temperature(now: i64, lat: f64, lon: f64, weather: &Option<WeatherData>) -> i32 {
     let st = solar::sunrise_sunset(now, lat, lon);
     let is_dark = weather
         .as_ref()
@@ -200,6 +202,7 @@ fn process_cqe(
     cqe: &uring::IoUringCqe,
     events: &AtomicU32,
     polls: &mut PollState,
+    #[cfg_attr(not(feature = "noaa"), allow(unused_variables))] wfs: &mut FetchState,
     ino_fd: i32,
     paths: &Paths,
 ) {
@@ -225,28 +228,38 @@ fn process_cqe(
             }
             if !more { polls.weather = false; }
         }
+        #[cfg(feature = "noaa")]
+        uring::EV_WORKER => {
+            polls.worker = false;
+            if wfs.worker_reply(cqe.res) {
+                events.fetch_or(FLAG_WEATHER, Ordering::Relaxed);
+            }
+        }
         uring::EV_CANCEL => {}
         _ => {}
     }
 }
 
 /// io_uring event loop with multi-shot polls and atomic event flags.
+/// Returns the exit status: 0 after a shutdown signal, 1 if the fetch
+/// worker was lost.
 fn event_loop_uring(
     state: &mut DaemonState,
     ring: &mut AbraxasRing,
+    wfs: &mut FetchState,
     ino_fd: i32,
     signal_fd: i32,
-) {
+) -> i32 {
     let ts = KernelTimespec {
         tv_sec: TEMP_UPDATE_SEC,
         tv_nsec: 0,
     };
 
-    let mut wfs = FetchState::new();
     let mut polls = PollState {
         inotify: false,
         signal: false,
         weather: false,
+        worker: false,
     };
 
     loop {
@@ -263,6 +276,13 @@ fn event_loop_uring(
             ring.prep_poll(wfs.pipe_fd, uring::EV_WEATHER);
             polls.weather = true;
         }
+        // Fetch worker replies: the "S" carries the next pipe
+        #[cfg(feature = "noaa")]
+        if weather::worker_fd() >= 0 && !polls.worker {
+            ring.prep_recvmsg(weather::worker_fd(), wfs.worker_msghdr(),
+                              libc::MSG_CMSG_CLOEXEC as u32, uring::EV_WORKER);
+            polls.worker = true;
+        }
 
         // Fresh timeout each iteration (one-shot)
         ring.prep_timeout(&ts, uring::EV_TIMEOUT);
@@ -275,7 +295,7 @@ fn event_loop_uring(
         // Process all CQEs through unified handler
         let events = AtomicU32::new(0);
         while let Some(cqe) = ring.peek_cqe() {
-            process_cqe(cqe, &events, &mut polls, ino_fd, &state.paths);
+            process_cqe(cqe, &events, &mut polls, wfs, ino_fd, &state.paths);
             ring.cqe_seen();
         }
 
@@ -286,7 +306,7 @@ fn event_loop_uring(
             ring.prep_cancel(uring::EV_TIMEOUT, uring::EV_CANCEL);
             ring.submit_and_wait();
             while let Some(cqe) = ring.peek_cqe() {
-                process_cqe(cqe, &events, &mut polls, ino_fd, &state.paths);
+                process_cqe(cqe, &events, &mut polls, wfs, ino_fd, &state.paths);
                 ring.cqe_seen();
             }
             flags = events.load(Ordering::Relaxed);
@@ -304,6 +324,12 @@ fn event_loop_uring(
             break;
         }
 
+        // No weather without a worker; the service manager brings both back
+        if weather::worker_gone() {
+            wfs.abort();
+            return 1;
+        }
+
         tick(state, flags & FLAG_OVERRIDE != 0, flags & FLAG_CONFIG != 0);
 
         // Async weather fetch (non-blocking, io_uring integrated)
@@ -324,7 +350,7 @@ fn event_loop_uring(
                         lt.hour, lt.min, lt.sec
                     );
                     wfs.start(state.location.lat, state.location.lon);
-                    polls.weather = false; // new pipe_fd needs registration
+                    polls.weather = false; // the worker's reply brings a new pipe_fd
                 }
             }
 
@@ -332,7 +358,7 @@ fn event_loop_uring(
                 match wfs.read_response() {
                     ReadResult::Pending => {}
                     ReadResult::NewPipe => {
-                        polls.weather = false; // new pipe_fd needs registration
+                        polls.weather = false; // phase transition, next pipe_fd to come
                     }
                     ReadResult::Done(result) => {
                         polls.weather = false;
@@ -362,9 +388,10 @@ fn event_loop_uring(
             }
         }
     }
+    0
 }
 
-pub fn run(location: Location, paths: &Paths) {
+pub fn run(location: Location, paths: &Paths) -> i32 {
     // Block SIGTERM/SIGINT immediately and create signalfd.
     // Must happen before gamma retry so SIGTERM is never lost during init.
     let signal_fd = setup_signalfd();
@@ -427,6 +454,9 @@ pub fn run(location: Location, paths: &Paths) {
         eprintln!("[warn] Failed to write PID file: {}", e);
     }
 
+    // Fetch worker: forked now, as the sandbox allows no new processes
+    weather::init();
+
     // prctl hardening
     unsafe {
         libc::prctl(libc::PR_SET_TIMERSLACK, 1); // 1ns timer precision
@@ -449,7 +479,10 @@ pub fn run(location: Location, paths: &Paths) {
 
     // seccomp-bpf syscall whitelist (must be last -- no new syscalls after this)
     if seccomp::install_filter() {
-        eprintln!("[kernel] seccomp: syscall whitelist active (~81 syscalls)");
+        eprintln!(
+            "[kernel] seccomp: syscall whitelist active ({} syscalls)",
+            seccomp::allowed_count()
+        );
     } else {
         eprintln!("[kernel] seccomp: failed to install filter");
     }
@@ -460,8 +493,9 @@ pub fn run(location: Location, paths: &Paths) {
     // Apply gamma immediately at startup (force override check)
     tick(&mut state, true, false);
 
-    // Initialize weather subsystem
-    weather::init();
+    // Declared before the ring so it outlives it: a posted worker
+    // recvmsg points into it
+    let mut wfs = FetchState::new();
 
     // io_uring event loop (no fallback -- requires kernel >= 5.1)
     let mut ring = match AbraxasRing::init(8) {
@@ -477,7 +511,7 @@ pub fn run(location: Location, paths: &Paths) {
         if ino_fd >= 0 { "active" } else { "unavailable" },
         if signal_fd >= 0 { "active" } else { "unavailable" },
     );
-    event_loop_uring(&mut state, &mut ring, ino_fd, signal_fd);
+    let status = event_loop_uring(&mut state, &mut ring, &mut wfs, ino_fd, signal_fd);
 
     // Clean shutdown
     eprintln!("[abraxas] shutting down...");
@@ -489,6 +523,7 @@ pub fn run(location: Location, paths: &Paths) {
 
     if ino_fd >= 0 { unsafe { libc::close(ino_fd) }; }
     if signal_fd >= 0 { unsafe { libc::close(signal_fd) }; }
+    status
 }
 
 /// Recover from an active override that was in progress before daemon restart.
@@ -533,6 +568,7 @@ fn recover_override(state: &mut DaemonState) {
             duration_minutes: ovr.duration_minutes,
             issued_at: ovr.issued_at,
             start_temp: temp,
+            fade_ms: ovr.fade_ms,
         };
         let _ = config::save_override(&state.paths, &updated);
         temp
@@ -615,6 +651,13 @@ fn tick(state: &mut DaemonState, override_changed: bool, config_changed: bool) {
 
     // Weather refresh is now async via io_uring POLL_ADD in event_loop_uring()
 
+    tick_at(state, now);
+}
+
+/// The steady-state part of a tick: pick the temperature for `now`, and
+/// log and apply it if it changed. Touches no file unless an override
+/// auto-resumes, and allocates nothing.
+fn tick_at(state: &mut DaemonState, now: i64) {
     // Calculate target temperature
     let target_temp = if state.manual_mode {
         let temp = sigmoid::calculate_manual_temp(
@@ -680,3 +723,166 @@ fn tick(state: &mut DaemonState, override_changed: bool, config_changed: bool) {
         }
     }
 }
+
+/// A daemon state on the null backend, for ticking on a virtual clock
+fn null_state(location: Location, paths: &Paths) -> Result<DaemonState, gamma::Error> {
+    Ok(DaemonState {
+        location,
+        paths: paths.clone(),
+        weather: None,
+        gamma: Some(gamma::init_null(1, 1024)?),
+        manual_mode: false,
+        manual_start_temp: 0,
+        manual_target_temp: 0,
+        manual_start_time: 0,
+        manual_duration_min: 0,
+        manual_issued_at: 0,
+        manual_resume_time: 0,
+        last_temp: 0,
+        last_temp_valid: false,
+    })
+}
+
+/// Local midnight starting 2026-03-19, the day before the equinox
+fn equinox_midnight() -> i64 {
+    let mut base: libc::tm = unsafe { std::mem::zeroed() };
+    base.tm_year = 2026 - 1900;
+    base.tm_mon = 2;
+    base.tm_mday = 19;
+    base.tm_isdst = -1;
+    unsafe { libc::mktime(&mut base) as i64 }
+}
+
+/// What applying a `--set TEMP MINUTES` issued at `now` does to the state
+fn start_fade(state: &mut DaemonState, temp: i32, minutes: i32, now: i64) {
+    state.manual_mode = true;
+    state.manual_start_temp = state.last_temp;
+    state.manual_target_temp = temp;
+    state.manual_start_time = now;
+    state.manual_duration_min = minutes;
+    state.manual_issued_at = now;
+    state.manual_resume_time = 0;
+}
+
+/// `--alloc-check`: three simulated days around an equinox, ticked every
+/// TEMP_UPDATE_SEC against the null backend. The first day warms up; the
+/// other two cover both solar transitions under clear and overcast skies
+/// and a manual fade, and must not allocate.
+pub fn alloc_check(location: Location, paths: &Paths) -> i32 {
+    let mut state = match null_state(location, paths) {
+        Ok(s) => s,
+        Err(e) => {
+            eprintln!("[alloc-check] {}", e);
+            return 1;
+        }
+    };
+
+    let start = equinox_midnight();
+    let (count_from, end) = (start + 86400, start + 3 * 86400);
+    let (fade_at, resume_at, overcast_at) = (count_from + 12 * 3600, count_from + 14 * 3600, end - 86400);
+
+    // Built ahead: applying an event is not part of a tick
+    let mut overcast = Some(WeatherData {
+        cloud_cover: 90,
+        forecast: "Simulated".to_string(),
+        temperature: 0.0,
+        is_day: true,
+        fetched_at: overcast_at,
+        has_error: false,
+    });
+
+    let (mut ticks, mut sets, mut allocs) = (0u64, 0u64, 0u64);
+    let mut now = start;
+    while now < end {
+        if now == fade_at {
+            start_fade(&mut state, 3500, 45, now);
+        } else if now == resume_at {
+            state.manual_mode = false;
+            state.manual_issued_at = 0;
+        } else if now == overcast_at {
+            state.weather = overcast.take();
+        }
+
+        let last = (state.last_temp, state.last_temp_valid);
+        let before = crate::alloccount::count();
+        tick_at(&mut state, now);
+        if now >= count_from {
+            allocs += crate::alloccount::count() - before;
+            sets += ((state.last_temp, state.last_temp_valid) != last) as u64;
+            ticks += 1;
+        }
+        now += TEMP_UPDATE_SEC;
+    }
+
+    println!(
+        "alloc-check: {} ticks, {} transition steps, {} heap allocations",
+        ticks, sets, allocs
+    );
+    if allocs == 0 { 0 } else { 1 }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::alloccount::thread_count;
+    use std::path::PathBuf;
+
+    fn state() -> DaemonState {
+        let dir = PathBuf::from("/nonexistent/abraxas");
+        let paths = Paths {
+            config_file: dir.join("config.ini"),
+            cache_file: dir.join("weather_cache.json"),
+            override_file: dir.join("override.json"),
+            zipdb_file: dir.join("us_zips.bin"),
+            pid_file: dir.join("daemon.pid"),
+        };
+        null_state(Location { lat: 41.88, lon: -87.63 }, &paths).unwrap()
+    }
+
+    /// Heap allocations made by one tick_at(state, now)
+    fn tick_allocs(state: &mut DaemonState, now: i64) -> u64 {
+        let before = thread_count();
+        tick_at(state, now);
+        thread_count() - before
+    }
+
+    #[test]
+    fn solar_tick_allocates_nothing() {
+        let mut state = state();
+        let start = equinox_midnight();
+        let mut now = start;
+        while now < start + 86400 {
+            tick_at(&mut state, now); // warm-up day
+            now += TEMP_UPDATE_SEC;
+        }
+        while now < start + 2 * 86400 {
+            assert_eq!(tick_allocs(&mut state, now), 0, "tick at {}", now);
+            now += TEMP_UPDATE_SEC;
+        }
+    }
+
+    #[test]
+    fn fade_step_allocates_nothing() {
+        let mut state = state();
+        let noon = equinox_midnight() + 12 * 3600;
+        tick_at(&mut state, noon);
+        for day in 0..2 {
+            let at = noon + day * 86400;
+            start_fade(&mut state, if day == 0 { 3500 } else { 2900 }, 45, at);
+            let mut steps = 0;
+            for sec in (0..=45 * 60).step_by(10) {
+                let last = state.last_temp;
+                let n = tick_allocs(&mut state, at + sec);
+                if day > 0 {
+                    // The first fade warms up
+                    assert_eq!(n, 0, "fade step at +{}s", sec);
+                    steps += (state.last_temp != last) as u32;
+                }
+            }
+            if day > 0 {
+                assert!(steps > 100, "only {} fade steps", steps);
+            }
+            state.manual_mode = false;
+        }
+    }
+}
@@ -1,6 +1,9 @@
 //! Blackbody color temperature to RGB conversion.
 //!
-//! Based on data from Ingo Thies (2013) and redshift project.
+//! Based on data from Ingo Thies (2013) and redshift project. The table
+//! is `blackbody.def` at the repo root, shared with the C23 build and
+//! rounded to Q16 at compile time; ramps are integer-only from there, so
+//! both ports produce bit-identical output.
 
 use super::Error;
 
@@ -8,280 +11,317 @@ use super::Error;
 pub const TEMP_MIN: i32 = 1000;
 pub const TEMP_MAX: i32 = 25000;
 
-/// RGB color (0.0 - 1.0 range)
-pub struct Rgb {
-    pub r: f32,
-    pub g: f32,
-    pub b: f32,
+/// Kelvin between table rows
+const BLACKBODY_STEP: i32 = 100;
+const BLACKBODY_ROWS: usize = 240;
+const Q16_ONE: u32 = 1 << 16;
+
+const BLACKBODY_DEF: &str = include_str!("../../../blackbody.def");
+
+/// Whitepoints at 100K intervals from 1000K, Q16 per channel.
+static BLACKBODY_Q16: [[u32; 3]; BLACKBODY_ROWS] = parse_blackbody(BLACKBODY_DEF.as_bytes());
+
+/// blackbody.def channels are in 1e-8; round to Q16 (same expression as C23)
+const fn blackbody_q16(v: u64) -> u32 {
+    ((v * Q16_ONE as u64 + 50_000_000) / 100_000_000) as u32
 }
 
-/// Whitepoint values for temperatures at 100K intervals (1000K - 25000K).
-/// Each entry is [R, G, B], interpolated for actual temperature.
-static BLACKBODY_COLOR: &[[f32; 3]] = &[
-    [1.00000000, 0.18172716, 0.00000000], // 1000K
-    [1.00000000, 0.25503671, 0.00000000], // 1100K
-    [1.00000000, 0.30942099, 0.00000000], // 1200K
-    [1.00000000, 0.35357379, 0.00000000],
-    [1.00000000, 0.39091524, 0.00000000],
-    [1.00000000, 0.42322816, 0.00000000],
-    [1.00000000, 0.45159884, 0.00000000],
-    [1.00000000, 0.47675916, 0.00000000],
-    [1.00000000, 0.49923747, 0.00000000],
-    [1.00000000, 0.51943421, 0.00000000], // 2000K
-    [1.00000000, 0.54360078, 0.08679949],
-    [1.00000000, 0.56618736, 0.14065513],
-    [1.00000000, 0.58734976, 0.18362641],
-    [1.00000000, 0.60724493, 0.22137978],
-    [1.00000000, 0.62600248, 0.25591950],
-    [1.00000000, 0.64373109, 0.28819679],
-    [1.00000000, 0.66052319, 0.31873863],
-    [1.00000000, 0.67645822, 0.34786758],
-    [1.00000000, 0.69160518, 0.37579588],
-    [1.00000000, 0.70602449, 0.40267128], // 3000K
-    [1.00000000, 0.71976951, 0.42860152],
-    [1.00000000, 0.73288760, 0.45366838],
-    [1.00000000, 0.74542112, 0.47793608],
-    [1.00000000, 0.75740814, 0.50145662],
-    [1.00000000, 0.76888303, 0.52427322],
-    [1.00000000, 0.77987699, 0.54642268],
-    [1.00000000, 0.79041843, 0.56793692],
-    [1.00000000, 0.80053332, 0.58884417],
-    [1.00000000, 0.81024551, 0.60916971],
-    [1.00000000, 0.81957693, 0.62893653], // 4000K
-    [1.00000000, 0.82854786, 0.64816570],
-    [1.00000000, 0.83717703, 0.66687674],
-    [1.00000000, 0.84548188, 0.68508786],
-    [1.00000000, 0.85347859, 0.70281616],
-    [1.00000000, 0.86118227, 0.72007777],
-    [1.00000000, 0.86860704, 0.73688797],
-    [1.00000000, 0.87576611, 0.75326132],
-    [1.00000000, 0.88267187, 0.76921169],
-    [1.00000000, 0.88933596, 0.78475236],
-    [1.00000000, 0.89576933, 0.79989606], // 5000K
-    [1.00000000, 0.90198230, 0.81465502],
-    [1.00000000, 0.90963069, 0.82838210],
-    [1.00000000, 0.91710889, 0.84190889],
-    [1.00000000, 0.92441842, 0.85523742],
-    [1.00000000, 0.93156127, 0.86836903],
-    [1.00000000, 0.93853986, 0.88130458],
-    [1.00000000, 0.94535695, 0.89404470],
-    [1.00000000, 0.95201559, 0.90658983],
-    [1.00000000, 0.95851906, 0.91894041],
-    [1.00000000, 0.96487079, 0.93109690], // 6000K
-    [1.00000000, 0.97107439, 0.94305985],
-    [1.00000000, 0.97713351, 0.95482993],
-    [1.00000000, 0.98305189, 0.96640795],
-    [1.00000000, 0.98883326, 0.97779486],
-    [1.00000000, 0.99448139, 0.98899179],
-    [1.00000000, 1.00000000, 1.00000000], // 6600K - D65 white point
-    [0.98947904, 0.99348723, 1.00000000],
-    [0.97940448, 0.98722715, 1.00000000],
-    [0.96975025, 0.98120637, 1.00000000],
-    [0.96049223, 0.97541240, 1.00000000], // 7000K
-    [0.95160805, 0.96983355, 1.00000000],
-    [0.94303638, 0.96443333, 1.00000000],
-    [0.93480451, 0.95923080, 1.00000000],
-    [0.92689056, 0.95421394, 1.00000000],
-    [0.91927697, 0.94937330, 1.00000000],
-    [0.91194747, 0.94470005, 1.00000000],
-    [0.90488690, 0.94018594, 1.00000000],
-    [0.89808115, 0.93582323, 1.00000000],
-    [0.89151710, 0.93160469, 1.00000000],
-    [0.88518247, 0.92752354, 1.00000000], // 8000K
-    [0.87906581, 0.92357340, 1.00000000],
-    [0.87315640, 0.91974827, 1.00000000],
-    [0.86744421, 0.91604254, 1.00000000],
-    [0.86191983, 0.91245088, 1.00000000],
-    [0.85657444, 0.90896831, 1.00000000],
-    [0.85139976, 0.90559011, 1.00000000],
-    [0.84638799, 0.90231183, 1.00000000],
-    [0.84153180, 0.89912926, 1.00000000],
-    [0.83682430, 0.89603843, 1.00000000],
-    [0.83225897, 0.89303558, 1.00000000], // 9000K
-    [0.82782969, 0.89011714, 1.00000000],
-    [0.82353066, 0.88727974, 1.00000000],
-    [0.81935641, 0.88452017, 1.00000000],
-    [0.81530175, 0.88183541, 1.00000000],
-    [0.81136180, 0.87922257, 1.00000000],
-    [0.80753191, 0.87667891, 1.00000000],
-    [0.80380769, 0.87420182, 1.00000000],
-    [0.80018497, 0.87178882, 1.00000000],
-    [0.79665980, 0.86943756, 1.00000000],
-    [0.79322843, 0.86714579, 1.00000000], // 10000K
-    [0.78988728, 0.86491137, 1.00000000],
-    [0.78663296, 0.86273225, 1.00000000],
-    [0.78346225, 0.86060650, 1.00000000],
-    [0.78037207, 0.85853224, 1.00000000],
-    [0.77735950, 0.85650771, 1.00000000],
-    [0.77442176, 0.85453121, 1.00000000],
-    [0.77155617, 0.85260112, 1.00000000],
-    [0.76876022, 0.85071588, 1.00000000],
-    [0.76603147, 0.84887402, 1.00000000],
-    [0.76336762, 0.84707411, 1.00000000], // 11000K
-    [0.76076645, 0.84531479, 1.00000000],
-    [0.75822586, 0.84359476, 1.00000000],
-    [0.75574383, 0.84191277, 1.00000000],
-    [0.75331843, 0.84026762, 1.00000000],
-    [0.75094780, 0.83865816, 1.00000000],
-    [0.74863017, 0.83708329, 1.00000000],
-    [0.74636386, 0.83554194, 1.00000000],
-    [0.74414722, 0.83403311, 1.00000000],
-    [0.74197871, 0.83255582, 1.00000000],
-    [0.73985682, 0.83110912, 1.00000000], // 12000K
-    [0.73778012, 0.82969211, 1.00000000],
-    [0.73574723, 0.82830393, 1.00000000],
-    [0.73375683, 0.82694373, 1.00000000],
-    [0.73180765, 0.82561071, 1.00000000],
-    [0.72989845, 0.82430410, 1.00000000],
-    [0.72802807, 0.82302316, 1.00000000],
-    [0.72619537, 0.82176715, 1.00000000],
-    [0.72439927, 0.82053539, 1.00000000],
-    [0.72263872, 0.81932722, 1.00000000],
-    [0.72091270, 0.81814197, 1.00000000], // 13000K
-    [0.71922025, 0.81697905, 1.00000000],
-    [0.71756043, 0.81583783, 1.00000000],
-    [0.71593234, 0.81471775, 1.00000000],
-    [0.71433510, 0.81361825, 1.00000000],
-    [0.71276788, 0.81253878, 1.00000000],
-    [0.71122987, 0.81147883, 1.00000000],
-    [0.70972029, 0.81043789, 1.00000000],
-    [0.70823838, 0.80941546, 1.00000000],
-    [0.70678342, 0.80841109, 1.00000000],
-    [0.70535469, 0.80742432, 1.00000000], // 14000K
-    [0.70395153, 0.80645469, 1.00000000],
-    [0.70257327, 0.80550180, 1.00000000],
-    [0.70121928, 0.80456522, 1.00000000],
-    [0.69988894, 0.80364455, 1.00000000],
-    [0.69858167, 0.80273941, 1.00000000],
-    [0.69729688, 0.80184943, 1.00000000],
-    [0.69603402, 0.80097423, 1.00000000],
-    [0.69479255, 0.80011347, 1.00000000],
-    [0.69357196, 0.79926681, 1.00000000],
-    [0.69237173, 0.79843391, 1.00000000], // 15000K
-    [0.69119138, 0.79761446, 1.00000000],
-    [0.69003044, 0.79680814, 1.00000000],
-    [0.68888844, 0.79601466, 1.00000000],
-    [0.68776494, 0.79523371, 1.00000000],
-    [0.68665951, 0.79446502, 1.00000000],
-    [0.68557173, 0.79370830, 1.00000000],
-    [0.68450119, 0.79296330, 1.00000000],
-    [0.68344751, 0.79222975, 1.00000000],
-    [0.68241029, 0.79150740, 1.00000000],
-    [0.68138918, 0.79079600, 1.00000000], // 16000K
-    [0.68038380, 0.79009531, 1.00000000],
-    [0.67939381, 0.78940511, 1.00000000],
-    [0.67841888, 0.78872517, 1.00000000],
-    [0.67745866, 0.78805526, 1.00000000],
-    [0.67651284, 0.78739518, 1.00000000],
-    [0.67558112, 0.78674472, 1.00000000],
-    [0.67466317, 0.78610368, 1.00000000],
-    [0.67375872, 0.78547186, 1.00000000],
-    [0.67286748, 0.78484907, 1.00000000],
-    [0.67198916, 0.78423512, 1.00000000], // 17000K
-    [0.67112350, 0.78362984, 1.00000000],
-    [0.67027024, 0.78303305, 1.00000000],
-    [0.66942911, 0.78244457, 1.00000000],
-    [0.66859988, 0.78186425, 1.00000000],
-    [0.66778228, 0.78129191, 1.00000000],
-    [0.66697610, 0.78072740, 1.00000000],
-    [0.66618110, 0.78017057, 1.00000000],
-    [0.66539706, 0.77962127, 1.00000000],
-    [0.66462376, 0.77907934, 1.00000000],
-    [0.66386098, 0.77854465, 1.00000000], // 18000K
-    [0.66310852, 0.77801705, 1.00000000],
-    [0.66236618, 0.77749642, 1.00000000],
-    [0.66163375, 0.77698261, 1.00000000],
-    [0.66091106, 0.77647551, 1.00000000],
-    [0.66019791, 0.77597498, 1.00000000],
-    [0.65949412, 0.77548090, 1.00000000],
-    [0.65879952, 0.77499315, 1.00000000],
-    [0.65811392, 0.77451161, 1.00000000],
-    [0.65743716, 0.77403618, 1.00000000],
-    [0.65676908, 0.77356673, 1.00000000], // 19000K
-    [0.65610952, 0.77310316, 1.00000000],
-    [0.65545831, 0.77264537, 1.00000000],
-    [0.65481530, 0.77219324, 1.00000000],
-    [0.65418036, 0.77174669, 1.00000000],
-    [0.65355332, 0.77130560, 1.00000000],
-    [0.65293404, 0.77086988, 1.00000000],
-    [0.65232240, 0.77043944, 1.00000000],
-    [0.65171824, 0.77001419, 1.00000000],
-    [0.65112144, 0.76959404, 1.00000000],
-    [0.65053187, 0.76917889, 1.00000000], // 20000K
-    [0.64994941, 0.76876866, 1.00000000],
-    [0.64937392, 0.76836326, 1.00000000],
-    [0.64880528, 0.76796263, 1.00000000],
-    [0.64824339, 0.76756666, 1.00000000],
-    [0.64768812, 0.76717529, 1.00000000],
-    [0.64713935, 0.76678844, 1.00000000],
-    [0.64659699, 0.76640603, 1.00000000],
-    [0.64606092, 0.76602798, 1.00000000],
-    [0.64553103, 0.76565424, 1.00000000],
-    [0.64500722, 0.76528472, 1.00000000], // 21000K
-    [0.64448939, 0.76491935, 1.00000000],
-    [0.64397745, 0.76455808, 1.00000000],
-    [0.64347129, 0.76420082, 1.00000000],
-    [0.64297081, 0.76384753, 1.00000000],
-    [0.64247594, 0.76349813, 1.00000000],
-    [0.64198657, 0.76315256, 1.00000000],
-    [0.64150261, 0.76281076, 1.00000000],
-    [0.64102399, 0.76247267, 1.00000000],
-    [0.64055061, 0.76213824, 1.00000000],
-    [0.64008239, 0.76180740, 1.00000000], // 22000K
-    [0.63961926, 0.76148010, 1.00000000],
-    [0.63916112, 0.76115628, 1.00000000],
-    [0.63870790, 0.76083590, 1.00000000],
-    [0.63825953, 0.76051890, 1.00000000],
-    [0.63781592, 0.76020522, 1.00000000],
-    [0.63737701, 0.75989482, 1.00000000],
-    [0.63694273, 0.75958764, 1.00000000],
-    [0.63651299, 0.75928365, 1.00000000],
-    [0.63608774, 0.75898278, 1.00000000],
-    [0.63566691, 0.75868499, 1.00000000], // 23000K
-    [0.63525042, 0.75839025, 1.00000000],
-    [0.63483822, 0.75809849, 1.00000000],
-    [0.63443023, 0.75780969, 1.00000000],
-    [0.63402641, 0.75752379, 1.00000000],
-    [0.63362667, 0.75724075, 1.00000000],
-    [0.63323097, 0.75696053, 1.00000000],
-    [0.63283925, 0.75668310, 1.00000000],
-    [0.63245144, 0.75640840, 1.00000000],
-    [0.63206749, 0.75613641, 1.00000000],
-    [0.63168735, 0.75586707, 1.00000000], // 24000K
-    [0.63131096, 0.75560036, 1.00000000],
-    [0.63093826, 0.75533624, 1.00000000],
-    [0.63056920, 0.75507467, 1.00000000],
-    [0.63020374, 0.75481562, 1.00000000],
-    [0.62984181, 0.75455904, 1.00000000],
-    [0.62948337, 0.75430491, 1.00000000],
-    [0.62912838, 0.75405319, 1.00000000],
-    [0.62877678, 0.75380385, 1.00000000],
-    [0.62842852, 0.75355685, 1.00000000],
-    [0.62808356, 0.75331217, 1.00000000], // 25000K
-];
-
-/// Convert color temperature to RGB multipliers
-pub fn temp_to_rgb(temp: i32) -> Result<Rgb, Error> {
-    if temp < TEMP_MIN || temp > TEMP_MAX {
-        return Err(Error::InvalidTemp);
+/// Parse `BLACKBODY(kelvin, r, g, b)` rows, skipping C comments. Runs
+/// at compile time: a malformed file fails the build.
+const fn parse_blackbody(def: &[u8]) -> [[u32; 3]; BLACKBODY_ROWS] {
+    const KEY: &[u8] = b"BLACKBODY(";
+    let mut table = [[0u32; 3]; BLACKBODY_ROWS];
+    let mut rows = 0;
+    let mut i = 0;
+
+    while i < def.len() {
+        if def[i] == b'/' && i + 1 < def.len() && def[i + 1] == b'*' {
+            i += 2;
+            while !(def[i] == b'*' && def[i + 1] == b'/') {
+                i += 1;
+            }
+            i += 2;
+            continue;
+        }
+
+        let mut k = 0;
+        while k < KEY.len() && i + k < def.len() && def[i + k] == KEY[k] {
+            k += 1;
+        }
+        if k < KEY.len() {
+            i += 1;
+            continue;
+        }
+        i += KEY.len();
+
+        let mut field = [0u64; 4];
+        let mut f = 0;
+        while f < 4 {
+            while def[i] == b' ' {
+                i += 1;
+            }
+            let start = i;
+            while def[i].is_ascii_digit() {
+                field[f] = field[f] * 10 + (def[i] - b'0') as u64;
+                i += 1;
+            }
+            while def[i] == b' ' {
+                i += 1;
+            }
+            assert!(i > start, "blackbody.def: expected a number");
+            assert!(def[i] == if f < 3 { b',' } else { b')' }, "blackbody.def: malformed row");
+            i += 1;
+            f += 1;
+        }
+
+        assert!(rows < BLACKBODY_ROWS, "blackbody.def: too many rows");
+        assert!(
+            field[0] == (TEMP_MIN + rows as i32 * BLACKBODY_STEP) as u64,
+            "blackbody.def: rows must be 100K apart from 1000K"
+        );
+        assert!(
+            field[1] <= 100_000_000 && field[2] <= 100_000_000 && field[3] <= 100_000_000,
+            "blackbody.def: channel above 1.0"
+        );
+        table[rows] = [blackbody_q16(field[1]), blackbody_q16(field[2]), blackbody_q16(field[3])];
+        rows += 1;
+    }
+
+    assert!(rows == BLACKBODY_ROWS, "blackbody.def: expected 240 rows (1000K-24900K)");
+    table
+}
+
+/// Q16 multipliers for a validated temperature, interpolated per kelvin
+/// between rows. 24900K-25000K use the last row.
+fn blackbody_lookup(temp: i32) -> [u32; 3] {
+    let off = temp - TEMP_MIN;
+    let mut idx = (off / BLACKBODY_STEP) as usize;
+    let mut f = (off % BLACKBODY_STEP) as u32;
+
+    if idx >= BLACKBODY_ROWS - 1 {
+        idx = BLACKBODY_ROWS - 2;
+        f = BLACKBODY_STEP as u32;
+    }
+
+    let (c1, c2) = (&BLACKBODY_Q16[idx], &BLACKBODY_Q16[idx + 1]);
+    let step = BLACKBODY_STEP as u32;
+    std::array::from_fn(|c| (c1[c] * (step - f) + c2[c] * f + step / 2) / step)
+}
+
+/// One ramp fill request for [`fill_gamma_ramps_batch`].
+/// Each output slice must hold at least `gamma_size` entries.
+pub struct RampJob<'a> {
+    pub temp: i32,
+    pub gamma_size: usize,
+    pub brightness: f32,
+    pub r: &'a mut [u16],
+    pub g: &'a mut [u16],
+    pub b: &'a mut [u16],
+}
+
+// Ramp fill kernels. A channel's ramp is out[i] = (i * step) >> 16, with
+// step its Q16 multiplier times index_scale(n). (n - 1) * step stays
+// below 2^32, so the scalar kernel's multiply and the vector kernels'
+// running i * step (lanes advanced by 8 * step) give the same values,
+// and the same values as the C23 kernels.
+
+type Kernel = fn(&mut [u16], u32);
+
+/// Largest supported ramp: keeps (n - 1) * step within 32 bits
+const RAMP_SIZE_MAX: usize = 65536;
+
+/// Output per index step at full scale, Q16: ceil(65535 * 2^16 / (n - 1)).
+/// Rounding up makes a full-scale ramp end exactly at 65535.
+const fn index_scale(n: usize) -> u32 {
+    ((u16::MAX as u64 * Q16_ONE as u64 + n as u64 - 2) / (n as u64 - 1)) as u32
+}
+
+/// Run a kernel body with a constant length for the common gamma sizes,
+/// so those loops unroll with no tail.
+macro_rules! specialize {
+    ($body:ident, $out:expr, $step:expr) => {{
+        let out: &mut [u16] = $out;
+        match out.len() {
+            256 => $body(<&mut [u16; 256]>::try_from(out).unwrap(), $step),
+            1024 => $body(<&mut [u16; 1024]>::try_from(out).unwrap(), $step),
+            4096 => $body(<&mut [u16; 4096]>::try_from(out).unwrap(), $step),
+            _ => $body(out, $step),
+        }
+    }};
+}
+
+#[inline]
+fn fill_tail(out: &mut [u16], from: usize, step: u32) {
+    for i in from..out.len() {
+        out[i] = ((i as u32).wrapping_mul(step) >> 16) as u16;
+    }
+}
+
+#[inline(always)]
+fn body_scalar(out: &mut [u16], step: u32) {
+    fill_tail(out, 0, step);
+}
+
+fn kernel_scalar(out: &mut [u16], step: u32) {
+    specialize!(body_scalar, out, step)
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2")]
+#[inline]
+unsafe fn body_avx2(out: &mut [u16], step: u32) {
+    use std::arch::x86_64::*;
+
+    let n = out.len();
+    let stride = _mm256_set1_epi32(step.wrapping_mul(8) as i32);
+    let mut acc = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(step as i32));
+
+    let mut i = 0;
+    while i + 8 <= n {
+        let q = _mm256_srli_epi32(acc, 16);
+
+        // Values are 0..65535, so the unsigned-saturating pack is exact
+        let packed = _mm_packus_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+        _mm_storeu_si128(out.as_mut_ptr().add(i) as *mut __m128i, packed);
+        acc = _mm256_add_epi32(acc, stride);
+        i += 8;
+    }
+
+    fill_tail(out, i, step);
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2")]
+unsafe fn fill_avx2(out: &mut [u16], step: u32) {
+    specialize!(body_avx2, out, step)
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "sse4.1")]
+#[inline]
+unsafe fn body_sse41(out: &mut [u16], step: u32) {
+    use std::arch::x86_64::*;
+
+    let n = out.len();
+    let vstep = _mm_set1_epi32(step as i32);
+    let stride = _mm_set1_epi32(step.wrapping_mul(8) as i32);
+    let mut lo = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3), vstep);
+    let mut hi = _mm_mullo_epi32(_mm_setr_epi32(4, 5, 6, 7), vstep);
+
+    let mut i = 0;
+    while i + 8 <= n {
+        let packed = _mm_packus_epi32(_mm_srli_epi32(lo, 16), _mm_srli_epi32(hi, 16));
+        _mm_storeu_si128(out.as_mut_ptr().add(i) as *mut __m128i, packed);
+        lo = _mm_add_epi32(lo, stride);
+        hi = _mm_add_epi32(hi, stride);
+        i += 8;
     }
 
-    let alpha = (temp - TEMP_MIN) as f32 / 100.0;
-    let mut idx = alpha as usize;
-    let frac = alpha - idx as f32;
+    fill_tail(out, i, step);
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "sse4.1")]
+unsafe fn fill_sse41(out: &mut [u16], step: u32) {
+    specialize!(body_sse41, out, step)
+}
+
+#[cfg(target_arch = "x86_64")]
+fn kernel_avx2(out: &mut [u16], step: u32) {
+    // SAFETY: only selected by select_kernel() when AVX2 is detected
+    unsafe { fill_avx2(out, step) }
+}
+
+#[cfg(target_arch = "x86_64")]
+fn kernel_sse41(out: &mut [u16], step: u32) {
+    // SAFETY: only selected by select_kernel() when SSE4.1 is detected
+    unsafe { fill_sse41(out, step) }
+}
+
+#[cfg(target_arch = "aarch64")]
+#[inline(always)]
+fn body_neon(out: &mut [u16], step: u32) {
+    use std::arch::aarch64::*;
+
+    const LANES: [u32; 8] = [0, 1, 2, 3, 4, 5, 6, 7];
+    let n = out.len();
+    let mut i = 0;
+
+    // SAFETY: Advanced SIMD is mandatory on AArch64; stores stay below n
+    unsafe {
+        let stride = vdupq_n_u32(step.wrapping_mul(8));
+        let mut lo = vmulq_n_u32(vld1q_u32(LANES.as_ptr()), step);
+        let mut hi = vmulq_n_u32(vld1q_u32(LANES.as_ptr().add(4)), step);
 
-    if idx >= BLACKBODY_COLOR.len() - 1 {
-        idx = BLACKBODY_COLOR.len() - 2;
+        while i + 8 <= n {
+            let packed = vcombine_u16(vshrn_n_u32::<16>(lo), vshrn_n_u32::<16>(hi));
+            vst1q_u16(out.as_mut_ptr().add(i), packed);
+            lo = vaddq_u32(lo, stride);
+            hi = vaddq_u32(hi, stride);
+            i += 8;
+        }
     }
 
-    let c1 = &BLACKBODY_COLOR[idx];
-    let c2 = &BLACKBODY_COLOR[idx + 1];
+    fill_tail(out, i, step);
+}
+
+#[cfg(target_arch = "aarch64")]
+fn kernel_neon(out: &mut [u16], step: u32) {
+    specialize!(body_neon, out, step)
+}
 
-    Ok(Rgb {
-        r: c1[0] * (1.0 - frac) + c2[0] * frac,
-        g: c1[1] * (1.0 - frac) + c2[1] * frac,
-        b: c1[2] * (1.0 - frac) + c2[2] * frac,
-    })
+fn select_kernel() -> (Kernel, &'static str) {
+    #[cfg(target_arch = "x86_64")]
+    {
+        if is_x86_feature_detected!("avx2") {
+            return (kernel_avx2, "avx2");
+        }
+        if is_x86_feature_detected!("sse4.1") {
+            return (kernel_sse41, "sse4.1");
+        }
+    }
+    #[cfg(target_arch = "aarch64")]
+    {
+        return (kernel_neon, "neon");
+    }
+    #[allow(unreachable_code)]
+    (kernel_scalar, "scalar")
+}
+
+static KERNEL: std::sync::OnceLock<(Kernel, &'static str)> = std::sync::OnceLock::new();
+
+#[inline]
+fn kernel() -> Kernel {
+    KERNEL.get_or_init(select_kernel).0
+}
+
+/// Name of the ramp fill kernel selected for this CPU
+/// ("avx2", "sse4.1", "neon", or "scalar").
+pub fn kernel_name() -> &'static str {
+    KERNEL.get_or_init(select_kernel).1
+}
+
+/// Validate inputs and compute each channel's per-index step
+fn ramp_steps(temp: i32, gamma_size: usize, brightness: f32) -> Result<[u32; 3], Error> {
+    if !(2..=RAMP_SIZE_MAX).contains(&gamma_size) || !(TEMP_MIN..=TEMP_MAX).contains(&temp) {
+        return Err(Error::InvalidTemp);
+    }
+
+    // NaN clamps to NaN and casts to 0, as in C23
+    let bright = (brightness.clamp(0.0, 1.0) * Q16_ONE as f32 + 0.5) as u32;
+
+    let rgb = blackbody_lookup(temp);
+    let index_scale = match gamma_size {
+        // Common sizes fold to constants: no division per fill
+        256 => const { index_scale(256) },
+        1024 => const { index_scale(1024) },
+        4096 => const { index_scale(4096) },
+        n => index_scale(n),
+    } as u64;
+    Ok(rgb.map(|c| {
+        let scale = (c as u64 * bright as u64 + (Q16_ONE / 2) as u64) >> 16;
+        ((scale * index_scale) >> 16) as u32
+    }))
 }
 
 /// Fill gamma ramp arrays for the given temperature
@@ -293,23 +333,54 @@ pub fn fill_gamma_ramps(
     b: &mut [u16],
     brightness: f32,
 ) -> Result<(), Error> {
-    if gamma_size < 2 {
-        return Err(Error::InvalidTemp);
-    }
+    let step = ramp_steps(temp, gamma_size, brightness)?;
 
-    let brightness = brightness.clamp(0.0, 1.0);
+    let fill = kernel();
+    fill(&mut r[..gamma_size], step[0]);
+    fill(&mut g[..gamma_size], step[1]);
+    fill(&mut b[..gamma_size], step[2]);
 
-    let mut rgb = temp_to_rgb(temp)?;
-    rgb.r *= brightness;
-    rgb.g *= brightness;
-    rgb.b *= brightness;
+    Ok(())
+}
 
-    for i in 0..gamma_size {
-        let v = i as f32 / (gamma_size - 1) as f32;
-        r[i] = (v * rgb.r * u16::MAX as f32) as u16;
-        g[i] = (v * rgb.g * u16::MAX as f32) as u16;
-        b[i] = (v * rgb.b * u16::MAX as f32) as u16;
+/// Fill ramps for several temperatures or CRTCs in one call.
+///
+/// Consecutive jobs with identical parameters are copied from the previous
+/// result instead of recomputed. A failing job does not stop the batch;
+/// the first error is returned.
+pub fn fill_gamma_ramps_batch(jobs: &mut [RampJob]) -> Result<(), Error> {
+    let fill = kernel();
+    let mut first_err = None;
+    let mut prev: Option<usize> = None;
+
+    for i in 0..jobs.len() {
+        let (done, rest) = jobs.split_at_mut(i);
+        let job = &mut rest[0];
+        let n = job.gamma_size;
+
+        if let Some(p) = prev {
+            let p = &done[p];
+            if p.temp == job.temp && p.gamma_size == n && p.brightness == job.brightness {
+                job.r[..n].copy_from_slice(&p.r[..n]);
+                job.g[..n].copy_from_slice(&p.g[..n]);
+                job.b[..n].copy_from_slice(&p.b[..n]);
+                continue;
+            }
+        }
+
+        match ramp_steps(job.temp, n, job.brightness) {
+            Ok(step) => {
+                fill(&mut job.r[..n], step[0]);
+                fill(&mut job.g[..n], step[1]);
+                fill(&mut job.b[..n], step[2]);
+                prev = Some(i);
+            }
+            Err(e) => {
+                first_err.get_or_insert(e);
+                prev = None;
+            }
+        }
     }
 
-    Ok(())
+    first_err.map_or(Ok(()), Err)
 }
@@ -8,6 +8,7 @@
 
 pub mod colorramp;
 pub mod drm;
+pub mod null;
 
 #[cfg(feature = "wayland")]
 pub mod wayland;
@@ -63,6 +64,7 @@ impl std::error::Error for Error {}
 /// Backend type
 enum Backend {
     Drm(drm::DrmState),
+    Null(null::NullState),
     #[cfg(feature = "wayland")]
     Wayland(wayland::WaylandState),
     #[cfg(feature = "x11")]
@@ -80,6 +82,7 @@ impl GammaState {
     pub fn backend_name(&self) -> &str {
         match &self.backend {
             Backend::Drm(_) => "drm",
+            Backend::Null(_) => "null",
             #[cfg(feature = "wayland")]
             Backend::Wayland(_) => "wayland",
             #[cfg(feature = "x11")]
@@ -92,6 +95,7 @@ impl GammaState {
     pub fn set_temperature(&mut self, temp: i32, brightness: f32) -> Result<(), Error> {
         match &mut self.backend {
             Backend::Drm(state) => state.set_temperature(temp, brightness),
+            Backend::Null(state) => state.set_temperature(temp, brightness),
             #[cfg(feature = "wayland")]
             Backend::Wayland(state) => state.set_temperature(temp, brightness),
             #[cfg(feature = "x11")]
@@ -104,6 +108,7 @@ impl GammaState {
     pub fn restore(&mut self) -> Result<(), Error> {
         match &mut self.backend {
             Backend::Drm(state) => state.restore(),
+            Backend::Null(state) => state.restore(),
             #[cfg(feature = "wayland")]
             Backend::Wayland(state) => state.restore(),
             #[cfg(feature = "x11")]
@@ -114,6 +119,14 @@ impl GammaState {
     }
 }
 
+/// Null backend with `outputs` virtual CRTCs of `gamma_size` entries.
+/// Never chosen by init(); only for running the daemon without a display.
+pub fn init_null(outputs: usize, gamma_size: usize) -> Result<GammaState, Error> {
+    Ok(GammaState {
+        backend: Backend::Null(null::NullState::init(outputs, gamma_size)?),
+    })
+}
+
 /// Initialize gamma control with automatic backend selection.
 /// Tries DRM first (card0).
 pub fn init() -> Result<GammaState, Error> {
@@ -0,0 +1,48 @@
+//! Null backend: virtual outputs, no display.
+//!
+//! Each output's ramps are filled into buffers allocated at init, the same
+//! work a real backend does before its upload, and then dropped. Lets
+//! `--alloc-check` drive the full set_temperature path without a display.
+
+use super::{colorramp, Error};
+
+struct NullOutput {
+    gamma_size: usize,
+    work_r: Vec<u16>,
+    work_g: Vec<u16>,
+    work_b: Vec<u16>,
+}
+
+pub struct NullState {
+    outputs: Vec<NullOutput>,
+}
+
+impl NullState {
+    pub fn init(outputs: usize, gamma_size: usize) -> Result<Self, Error> {
+        if outputs == 0 || gamma_size < 2 {
+            return Err(Error::NoCrtc);
+        }
+        let outputs = (0..outputs)
+            .map(|_| NullOutput {
+                gamma_size,
+                work_r: vec![0; gamma_size],
+                work_g: vec![0; gamma_size],
+                work_b: vec![0; gamma_size],
+            })
+            .collect();
+        Ok(NullState { outputs })
+    }
+
+    pub fn set_temperature(&mut self, temp: i32, brightness: f32) -> Result<(), Error> {
+        for out in &mut self.outputs {
+            colorramp::fill_gamma_ramps(
+                temp, out.gamma_size, &mut out.work_r, &mut out.work_g, &mut out.work_b, brightness,
+            )?;
+        }
+        Ok(())
+    }
+
+    pub fn restore(&mut self) -> Result<(), Error> {
+        Ok(())
+    }
+}
@@ -2,6 +2,7 @@
 //!
 //! Used when DRM gamma fails (NVIDIA proprietary, etc.)
 //! Uses x11rb crate -- no libX11/libXrandr link dependency.
+//! Gamma updates have no reply; all CRTCs are queued and flushed once.
 
 use super::{colorramp, Error};
 use x11rb::connection::Connection;
@@ -103,12 +104,8 @@ impl X11State {
             .unwrap_or(0)
     }
 
-    pub fn set_temperature_crtc(
-        &mut self,
-        crtc_idx: usize,
-        temp: i32,
-        brightness: f32,
-    ) -> Result<(), Error> {
+    /// Fill a CRTC's working buffers and queue its update; the caller flushes
+    fn queue_crtc(&mut self, crtc_idx: usize, temp: i32, brightness: f32) -> Result<(), Error> {
         let crtc = self.crtcs.get_mut(crtc_idx).ok_or(Error::Crtc)?;
         if crtc.gamma_size == 0 {
             return Err(Error::Crtc);
@@ -119,23 +116,31 @@ impl X11State {
         // Reuse pre-allocated working buffers
         colorramp::fill_gamma_ramps(temp, size, &mut crtc.work_r, &mut crtc.work_g, &mut crtc.work_b, brightness)?;
 
-        let crtc_id = crtc.crtc;
+        // No reply: this only appends to the connection's write buffer
         self.conn
-            .randr_set_crtc_gamma(crtc_id, &crtc.work_r, &crtc.work_g, &crtc.work_b)
+            .randr_set_crtc_gamma(crtc.crtc, &crtc.work_r, &crtc.work_g, &crtc.work_b)
             .map_err(|_| Error::Gamma)?;
 
-        self.conn.flush().map_err(|_| Error::Gamma)?;
-
         Ok(())
     }
 
+    pub fn set_temperature_crtc(
+        &mut self,
+        crtc_idx: usize,
+        temp: i32,
+        brightness: f32,
+    ) -> Result<(), Error> {
+        self.queue_crtc(crtc_idx, temp, brightness)?;
+        self.conn.flush().map_err(|_| Error::Gamma)
+    }
+
     pub fn set_temperature(&mut self, temp: i32, brightness: f32) -> Result<(), Error> {
         let mut last_err = None;
         let mut success_count = 0;
 
         for i in 0..self.crtcs.len() {
             if self.crtcs[i].gamma_size > 0 {
-                match self.set_temperature_crtc(i, temp, brightness) {
+                match self.queue_crtc(i, temp, brightness) {
                     Ok(()) => success_count += 1,
                     Err(e) => last_err = Some(e),
                 }
@@ -143,7 +148,8 @@ impl X11State {
         }
 
         if success_count > 0 {
-            Ok(())
+            // One write for every CRTC
+            self.conn.flush().map_err(|_| Error::Gamma)
         } else {
             Err(last_err.unwrap_or(Error::NoCrtc))
         }
@@ -20,9 +20,21 @@ const ACCESS_FS_EXECUTE: u64 = 1 << 0;
 const ACCESS_FS_WRITE_FILE: u64 = 1 << 1;
 const ACCESS_FS_READ_FILE: u64 = 1 << 2;
 const ACCESS_FS_READ_DIR: u64 = 1 << 3;
+#[cfg(feature = "noaa")]
+const ACCESS_FS_REMOVE_DIR: u64 = 1 << 4;
 const ACCESS_FS_REMOVE_FILE: u64 = 1 << 5;
+#[cfg(feature = "noaa")]
+const ACCESS_FS_MAKE_CHAR: u64 = 1 << 6;
 const ACCESS_FS_MAKE_DIR: u64 = 1 << 7;
 const ACCESS_FS_MAKE_REG: u64 = 1 << 8;
+#[cfg(feature = "noaa")]
+const ACCESS_FS_MAKE_SOCK: u64 = 1 << 9;
+#[cfg(feature = "noaa")]
+const ACCESS_FS_MAKE_FIFO: u64 = 1 << 10;
+#[cfg(feature = "noaa")]
+const ACCESS_FS_MAKE_BLOCK: u64 = 1 << 11;
+#[cfg(feature = "noaa")]
+const ACCESS_FS_MAKE_SYM: u64 = 1 << 12;
 
 #[repr(C)]
 struct RulesetAttr {
@@ -139,3 +151,65 @@ pub fn install_sandbox(config_dir: &str) -> bool {
 
     ret == 0
 }
+
+/// The fetch worker's ruleset: nothing writable, system dirs readable,
+/// only /usr executable. Every curl it spawns inherits it.
+#[cfg(feature = "noaa")]
+pub fn install_worker_sandbox() -> bool {
+    let abi = unsafe {
+        libc::syscall(
+            NR_LANDLOCK_CREATE_RULESET,
+            std::ptr::null::<RulesetAttr>(),
+            0usize,
+            LANDLOCK_CREATE_RULESET_VERSION,
+        )
+    } as i32;
+    if abi < 0 {
+        return false;
+    }
+
+    // Every ABI 1 right is handled; only reading and running are granted
+    let read_only = ACCESS_FS_READ_FILE | ACCESS_FS_READ_DIR;
+    let attr = RulesetAttr {
+        handled_access_fs: read_only
+            | ACCESS_FS_EXECUTE
+            | ACCESS_FS_WRITE_FILE
+            | ACCESS_FS_REMOVE_DIR
+            | ACCESS_FS_REMOVE_FILE
+            | ACCESS_FS_MAKE_CHAR
+            | ACCESS_FS_MAKE_DIR
+            | ACCESS_FS_MAKE_REG
+            | ACCESS_FS_MAKE_SOCK
+            | ACCESS_FS_MAKE_FIFO
+            | ACCESS_FS_MAKE_BLOCK
+            | ACCESS_FS_MAKE_SYM,
+        handled_access_net: 0,
+    };
+
+    let ruleset_fd = unsafe {
+        libc::syscall(
+            NR_LANDLOCK_CREATE_RULESET,
+            &attr as *const RulesetAttr,
+            std::mem::size_of::<RulesetAttr>(),
+            0u32,
+        )
+    } as i32;
+    if ruleset_fd < 0 {
+        return false;
+    }
+
+    // curl and its libraries; CA bundle, resolver and TLS config
+    add_path_rule(ruleset_fd, "/usr", read_only | ACCESS_FS_EXECUTE);
+    add_path_rule(ruleset_fd, "/lib", read_only);
+    add_path_rule(ruleset_fd, "/lib64", read_only);
+    add_path_rule(ruleset_fd, "/etc", read_only);
+    // systemd-resolved's resolv.conf is a symlink into /run
+    add_path_rule(ruleset_fd, "/run/systemd/resolve", read_only);
+
+    let ret = unsafe {
+        libc::syscall(NR_LANDLOCK_RESTRICT_SELF, ruleset_fd, 0u32)
+    } as i32;
+    unsafe { libc::close(ruleset_fd) };
+
+    ret == 0
+}
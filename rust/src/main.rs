@@ -8,8 +8,13 @@
 //!   --set TEMP [MIN] Manual override to TEMP over MIN minutes
 //!   --resume         Clear manual override
 //!   --reset          Restore gamma and exit
+//!   --benchmark      Benchmark suite [--json] [--fixtures DIR]
+//!   --seccomp-verify Replay all syscall numbers through the seccomp filter
+//!   --alloc-check    Fail if the steady-state tick touches the heap
 //!   --help           Show usage
 
+mod alloccount;
+mod bench;
 mod config;
 mod daemon;
 mod gamma;
@@ -23,6 +28,9 @@ mod zipdb;
 
 use std::process;
 
+#[global_allocator]
+static ALLOC: alloccount::CountingAlloc = alloccount::CountingAlloc;
+
 /// Temperature bounds (Kelvin)
 pub const TEMP_MIN: i32 = 1000;
 pub const TEMP_MAX: i32 = 25000;
@@ -60,7 +68,9 @@ enum Command {
     Set { temp: i32, duration: i32 },
     Resume,
     Reset,
-    Benchmark,
+    Benchmark(bench::Options),
+    SeccompVerify,
+    AllocCheck,
 }
 
 fn print_usage() {
@@ -75,7 +85,11 @@ fn print_usage() {
     eprintln!("  --set TEMP [MINUTES]  Override to TEMP over MINUTES (default 3)");
     eprintln!("  --resume              Clear override, resume solar control");
     eprintln!("  --reset               Restore gamma and exit");
-    eprintln!("  --benchmark           Run nanosecond benchmark");
+    eprintln!("  --benchmark           Run benchmark suite");
+    eprintln!("    --json              Emit results as JSON");
+    eprintln!("    --fixtures DIR      Fixture corpus (default: bench/fixtures)");
+    eprintln!("  --seccomp-verify      Check the compiled seccomp filter against syscalls.def");
+    eprintln!("  --alloc-check         Count heap allocations in the steady-state tick");
     eprintln!("  --help                Show this help");
 }
 
@@ -127,7 +141,29 @@ fn parse_args() -> Command {
         }
         "--resume" | "resume" => Command::Resume,
         "--reset" | "reset" => Command::Reset,
-        "--benchmark" | "benchmark" => Command::Benchmark,
+        "--benchmark" | "benchmark" => {
+            let mut opt = bench::Options::default();
+            let mut rest = args[2..].iter();
+            while let Some(arg) = rest.next() {
+                match arg.as_str() {
+                    "--json" => opt.json = true,
+                    "--fixtures" => match rest.next() {
+                        Some(dir) => opt.fixtures = Some(dir.into()),
+                        None => {
+                            eprintln!("--fixtures requires a directory");
+                            process::exit(1);
+                        }
+                    },
+                    other => {
+                        eprintln!("Unknown benchmark option: {}", other);
+                        process::exit(1);
+                    }
+                }
+            }
+            Command::Benchmark(opt)
+        }
+        "--seccomp-verify" => Command::SeccompVerify,
+        "--alloc-check" => Command::AllocCheck,
         "--help" | "-h" | "help" => {
             print_usage();
             process::exit(0);
@@ -161,9 +197,11 @@ fn main() {
             cmd_resume(&paths);
             return;
         }
-        Command::Benchmark => {
-            cmd_benchmark(&paths);
-            return;
+        Command::Benchmark(opt) => {
+            process::exit(bench::run(&paths, opt));
+        }
+        Command::SeccompVerify => {
+            process::exit(seccomp::verify());
         }
         Command::SetLocation(location) => {
             process::exit(cmd_set_location(location, &paths));
@@ -185,8 +223,6 @@ fn main() {
         }
     };
 
-    weather::init();
-
     let result = match command {
         Command::Status => {
             cmd_status(loc.lat, loc.lon, &paths);
@@ -194,14 +230,11 @@ fn main() {
         }
         Command::Refresh => cmd_refresh(loc.lat, loc.lon, &paths),
         Command::Set { temp, duration } => cmd_set_temp(temp, duration, &paths),
-        Command::Daemon => {
-            daemon::run(loc, &paths);
-            0
-        }
+        Command::Daemon => daemon::run(loc, &paths),
+        Command::AllocCheck => daemon::alloc_check(loc, &paths),
         _ => unreachable!(),
     };
 
-    weather::cleanup();
     process::exit(result);
 }
 
@@ -366,6 +399,7 @@ fn cmd_set_temp(target_temp: i32, duration_min: i32, paths: &config::Paths) -> i
         duration_minutes: duration_min,
         issued_at: now_epoch(),
         start_temp: 0, // daemon fills this
+        fade_ms: 0,
     };
 
     if config::save_override(paths, &ovr).is_err() {
@@ -394,6 +428,7 @@ fn cmd_resume(paths: &config::Paths) {
         duration_minutes: 0,
         issued_at: 0,
         start_temp: 0,
+        fade_ms: 0,
     };
     let _ = config::save_override(paths, &ovr);
 
@@ -414,107 +449,6 @@ fn cmd_reset(paths: &config::Paths) {
     println!("Screen temperature reset.");
 }
 
-fn cmd_benchmark(paths: &config::Paths) {
-    println!("ABRAXAS v8.4.0 [Rust] -- Kernel-grade benchmark");
-    println!("Clock: CLOCK_MONOTONIC_RAW (hardware TSC)\n");
-
-    fn bench_ns() -> u64 {
-        let mut ts = libc::timespec { tv_sec: 0, tv_nsec: 0 };
-        unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC_RAW, &mut ts) };
-        ts.tv_sec as u64 * 1_000_000_000 + ts.tv_nsec as u64
-    }
-
-    const N: u64 = 1000;
-
-    // config_load_location
-    let start = bench_ns();
-    for _ in 0..N {
-        let _ = config::load_location(paths);
-    }
-    let elapsed = bench_ns() - start;
-    println!("  config_load_location()     {:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // Get location for solar calcs
-    let loc = config::load_location(paths);
-    let (lat, lon) = loc.map(|l| (l.lat, l.lon)).unwrap_or((41.88, -87.63));
-    let now = now_epoch();
-
-    // solar_sunrise_sunset
-    let start = bench_ns();
-    for _ in 0..N {
-        let _ = solar::sunrise_sunset(now, lat, lon);
-    }
-    let elapsed = bench_ns() - start;
-    println!("  solar_sunrise_sunset()     {:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // solar_position
-    let start = bench_ns();
-    for _ in 0..N {
-        let _ = solar::position(now, lat, lon);
-    }
-    let elapsed = bench_ns() - start;
-    println!("  solar_position()           {:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // calculate_solar_temp
-    let start = bench_ns();
-    for _ in 0..N {
-        std::hint::black_box(sigmoid::calculate_solar_temp(
-            std::hint::black_box(120.0),
-            std::hint::black_box(300.0),
-            false,
-        ));
-    }
-    let elapsed = bench_ns() - start;
-    println!("  calculate_solar_temp()     {:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // sigmoid_norm
-    let start = bench_ns();
-    for _ in 0..N {
-        std::hint::black_box(sigmoid::sigmoid_norm(
-            std::hint::black_box(0.5),
-            std::hint::black_box(SIGMOID_STEEPNESS),
-        ));
-    }
-    let elapsed = bench_ns() - start;
-    println!("  sigmoid_norm()             {:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // config_load_override
-    let start = bench_ns();
-    for _ in 0..N {
-        let _ = config::load_override(paths);
-    }
-    let elapsed = bench_ns() - start;
-    println!("  config_load_override()     {:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // config_load_weather_cache
-    let start = bench_ns();
-    for _ in 0..N {
-        let _ = config::load_weather_cache(paths);
-    }
-    let elapsed = bench_ns() - start;
-    println!("  config_load_weather_cache(){:>8} us  ({} ns/call, {} calls)",
-        elapsed / 1000, elapsed / N, N);
-
-    // io_uring setup + teardown
-    println!();
-    println!("Kernel facilities:");
-    let start = bench_ns();
-    let ring = uring::AbraxasRing::init(8);
-    let elapsed = bench_ns() - start;
-    if ring.is_some() {
-        println!("  io_uring_setup()           {:>8} us  (one-time)", elapsed / 1000);
-        drop(ring);
-    } else {
-        println!("  io_uring_setup()           UNAVAILABLE");
-    }
-}
-
 // Time helpers
 
 pub fn now_epoch() -> i64 {
@@ -4,6 +4,15 @@
 //! Uses raw BPF instructions + prctl(PR_SET_SECCOMP). No libseccomp.
 //!
 //! SECCOMP_RET_KILL_PROCESS on any syscall not in the whitelist.
+//!
+//! The whitelist is `syscalls.def` at the repo root, shared with the C23
+//! daemon. Its HOT entries are tested first; the rest are compiled into a
+//! balanced binary search over syscall numbers, the same program shape
+//! c23/src/seccomp.c builds.
+//!
+//! The fetch worker installs a second program from the same table: the
+//! daemon's entries plus the WORKER ones, which spawning curl needs and
+//! curl itself keeps across execve.
 
 // BPF instruction encoding
 const BPF_LD: u16 = 0x00;
@@ -11,7 +20,9 @@ const BPF_JMP: u16 = 0x05;
 const BPF_RET: u16 = 0x06;
 const BPF_W: u16 = 0x00;
 const BPF_ABS: u16 = 0x20;
+const BPF_JA: u16 = 0x00;
 const BPF_JEQ: u16 = 0x10;
+const BPF_JGE: u16 = 0x30;
 const BPF_K: u16 = 0x00;
 
 // seccomp constants
@@ -21,12 +32,22 @@ const SECCOMP_MODE_FILTER: libc::c_int = 2;
 
 // Architecture
 const AUDIT_ARCH_X86_64: u32 = 0xc000003e;
+const AUDIT_ARCH_I386: u32 = 0x40000003;
 
 // seccomp_data offsets
 const OFFSET_ARCH: u32 = 4;
 const OFFSET_NR: u32 = 0;
 
+/// Ranges this small are cheaper as a JEQ chain than another split
+const TREE_LEAF: usize = 3;
+
+/// Cover every number the kernel could hand us below this, plus edges
+const VERIFY_NR_MAX: u32 = 1024;
+
+const SYSCALLS_DEF: &str = include_str!("../../syscalls.def");
+
 #[repr(C)]
+#[derive(Clone, Copy)]
 struct SockFilter {
     code: u16,
     jt: u8,
@@ -40,329 +61,181 @@ struct SockFprog {
     filter: *const SockFilter,
 }
 
-const fn bpf_stmt(code: u16, k: u32) -> SockFilter {
-    SockFilter { code, jt: 0, jf: 0, k }
+#[derive(Clone, Copy, PartialEq)]
+enum Who {
+    Hot,
+    Both,
+    C23,
+    Rust,
+    Worker,
+}
+
+struct Entry {
+    nr: u32,
+    who: Who,
 }
 
-const fn bpf_jump(code: u16, k: u32, jt: u8, jf: u8) -> SockFilter {
-    SockFilter { code, jt, jf, k }
+impl Entry {
+    fn ours(&self, worker: bool) -> bool {
+        match self.who {
+            Who::C23 => false,
+            Who::Worker => worker,
+            _ => true,
+        }
+    }
+}
+
+/// `SYSCALL(name, nr, who)` lines; everything else is comments
+fn table() -> Vec<Entry> {
+    SYSCALLS_DEF
+        .lines()
+        .filter_map(|line| {
+            let args = line.trim().strip_prefix("SYSCALL(")?.strip_suffix(')')?;
+            let mut parts = args.split(',').map(str::trim);
+            let _name = parts.next()?;
+            let nr = parts.next()?.parse().ok()?;
+            let who = match parts.next()? {
+                "HOT" => Who::Hot,
+                "BOTH" => Who::Both,
+                "C23" => Who::C23,
+                "RUST" => Who::Rust,
+                "WORKER" => Who::Worker,
+                _ => return None,
+            };
+            Some(Entry { nr, who })
+        })
+        .collect()
 }
 
-/// Syscall numbers (x86_64) -- from asm/unistd_64.h
-mod nr {
-    pub const READ: u32 = 0;
-    pub const WRITE: u32 = 1;
-    pub const CLOSE: u32 = 3;
-    pub const FSTAT: u32 = 5;
-    pub const POLL: u32 = 7;
-    pub const LSEEK: u32 = 8;
-    pub const MMAP: u32 = 9;
-    pub const MPROTECT: u32 = 10;
-    pub const MUNMAP: u32 = 11;
-    pub const BRK: u32 = 12;
-    pub const RT_SIGACTION: u32 = 13;
-    pub const RT_SIGPROCMASK: u32 = 14;
-    pub const RT_SIGRETURN: u32 = 15;
-    pub const IOCTL: u32 = 16;
-    pub const PREAD64: u32 = 17;
-    pub const WRITEV: u32 = 20;
-    pub const ACCESS: u32 = 21;
-    pub const SCHED_YIELD: u32 = 24;
-    pub const MREMAP: u32 = 25;
-    pub const MADVISE: u32 = 28;
-    pub const DUP2: u32 = 33;
-    pub const NANOSLEEP: u32 = 35;
-    pub const GETPID: u32 = 39;
-    pub const SOCKET: u32 = 41;
-    pub const CONNECT: u32 = 42;
-    pub const SENDTO: u32 = 44;
-    pub const RECVFROM: u32 = 45;
-    pub const SENDMSG: u32 = 46;
-    pub const RECVMSG: u32 = 47;
-    pub const RECVMMSG: u32 = 299;
-    pub const SENDMMSG: u32 = 307;
-    pub const SHUTDOWN: u32 = 48;
-    pub const BIND: u32 = 49;
-    pub const GETSOCKNAME: u32 = 51;
-    pub const GETPEERNAME: u32 = 52;
-    pub const SETSOCKOPT: u32 = 54;
-    pub const GETSOCKOPT: u32 = 55;
-    pub const CLONE: u32 = 56;
-    pub const EXECVE: u32 = 59;
-    pub const EXIT: u32 = 60;
-    pub const WAIT4: u32 = 61;
-    pub const KILL: u32 = 62;
-    pub const UNAME: u32 = 63;
-    pub const FCNTL: u32 = 72;
-    pub const GETCWD: u32 = 79;
-    pub const MKDIR: u32 = 83;
-    pub const UNLINK: u32 = 87;
-    pub const READLINK: u32 = 89;
-    pub const GETTIMEOFDAY: u32 = 96;
-    pub const GETUID: u32 = 102;
-    pub const GETGID: u32 = 104;
-    pub const GETEUID: u32 = 107;
-    pub const GETEGID: u32 = 108;
-    pub const SIGALTSTACK: u32 = 131;
-    pub const PRCTL: u32 = 157;
-    pub const ARCH_PRCTL: u32 = 158;
-    pub const FUTEX: u32 = 202;
-    pub const SCHED_GETAFFINITY: u32 = 204;
-    pub const GETDENTS64: u32 = 217;
-    pub const SET_TID_ADDRESS: u32 = 218;
-    pub const CLOCK_GETTIME: u32 = 228;
-    pub const CLOCK_NANOSLEEP: u32 = 230;
-    pub const EXIT_GROUP: u32 = 231;
-    pub const INOTIFY_ADD_WATCH: u32 = 254;
-    pub const OPENAT: u32 = 257;
-    pub const MKDIRAT: u32 = 258;
-    pub const NEWFSTATAT: u32 = 262;
-    pub const UNLINKAT: u32 = 263;
-    pub const READLINKAT: u32 = 267;
-    pub const PPOLL: u32 = 271;
-    pub const SET_ROBUST_LIST: u32 = 273;
-    pub const EPOLL_WAIT: u32 = 232;
-    pub const EPOLL_CTL: u32 = 233;
-    pub const SIGNALFD4: u32 = 289;
-    pub const EVENTFD2: u32 = 290;
-    pub const EPOLL_CREATE1: u32 = 291;
-    pub const EPOLL_PWAIT: u32 = 281;
-    pub const DUP3: u32 = 292;
-    pub const PIPE2: u32 = 293;
-    pub const INOTIFY_INIT1: u32 = 294;
-    pub const PRLIMIT64: u32 = 302;
-    pub const GETRANDOM: u32 = 318;
-    pub const STATX: u32 = 332;
-    pub const RSEQ: u32 = 334;
-    pub const IO_URING_SETUP: u32 = 425;
-    pub const IO_URING_ENTER: u32 = 426;
-    pub const IO_URING_REGISTER: u32 = 427;
-    pub const CLONE3: u32 = 435;
-    pub const FACCESSAT2: u32 = 439;
+// --- Filter compiler ---
+
+#[derive(Clone, Copy)]
+enum Target {
+    At(usize),
+    Allow,
+    Kill,
+}
+
+struct Builder {
+    insn: Vec<SockFilter>,
+    targets: Vec<(Target, Target)>,
+}
+
+impl Builder {
+    fn emit(&mut self, code: u16, k: u32, jt: Target, jf: Target) -> usize {
+        self.insn.push(SockFilter { code, jt: 0, jf: 0, k });
+        self.targets.push((jt, jf));
+        self.insn.len() - 1
+    }
+
+    fn next(&self) -> Target {
+        Target::At(self.insn.len() + 1)
+    }
+
+    /// Sorted nrs -> ALLOW on a match, KILL otherwise
+    fn tree(&mut self, nrs: &[u32]) {
+        if nrs.is_empty() {
+            self.emit(BPF_JMP | BPF_JA | BPF_K, 0, Target::Kill, Target::Kill);
+            return;
+        }
+        if nrs.len() <= TREE_LEAF {
+            for (i, &nr) in nrs.iter().enumerate() {
+                let miss = if i + 1 < nrs.len() { self.next() } else { Target::Kill };
+                self.emit(BPF_JMP | BPF_JEQ | BPF_K, nr, Target::Allow, miss);
+            }
+            return;
+        }
+        let mid = nrs.len() / 2;
+        let next = self.next();
+        let split = self.emit(BPF_JMP | BPF_JGE | BPF_K, nrs[mid], Target::Kill, next);
+        self.tree(&nrs[..mid]);
+        self.targets[split].0 = Target::At(self.insn.len());
+        self.tree(&nrs[mid..]);
+    }
+
+    /// Resolve targets to relative offsets; BPF only jumps forward, 255 max
+    fn finish(mut self) -> Option<Vec<SockFilter>> {
+        let allow = self.insn.len();
+        self.insn.push(SockFilter { code: BPF_RET | BPF_K, jt: 0, jf: 0, k: SECCOMP_RET_ALLOW });
+        self.insn.push(SockFilter {
+            code: BPF_RET | BPF_K,
+            jt: 0,
+            jf: 0,
+            k: SECCOMP_RET_KILL_PROCESS,
+        });
+
+        for pc in 0..allow {
+            let code = self.insn[pc].code;
+            if code & 0x07 != BPF_JMP {
+                continue;
+            }
+            let (jt, jf) = self.targets[pc];
+            let offset = |t: Target| -> Option<usize> {
+                let to = match t {
+                    Target::At(i) => i,
+                    Target::Allow => allow,
+                    Target::Kill => allow + 1,
+                };
+                to.checked_sub(pc + 1)
+            };
+            let (jt, jf) = (offset(jt)?, offset(jf)?);
+            if code & 0xf0 == BPF_JA {
+                self.insn[pc].k = u32::try_from(jt).ok()?;
+            } else {
+                self.insn[pc].jt = u8::try_from(jt).ok()?;
+                self.insn[pc].jf = u8::try_from(jf).ok()?;
+            }
+        }
+        Some(self.insn)
+    }
+}
+
+fn build_filter(table: &[Entry], worker: bool) -> Option<Vec<SockFilter>> {
+    let mut b = Builder { insn: Vec::new(), targets: Vec::new() };
+
+    // Load architecture; kill if not x86_64
+    b.emit(BPF_LD | BPF_W | BPF_ABS, OFFSET_ARCH, Target::Kill, Target::Kill);
+    let next = b.next();
+    b.emit(BPF_JMP | BPF_JEQ | BPF_K, AUDIT_ARCH_X86_64, next, Target::Kill);
+
+    // Load syscall number
+    b.emit(BPF_LD | BPF_W | BPF_ABS, OFFSET_NR, Target::Kill, Target::Kill);
+
+    // Hot prefix in table order, then the search tree over the rest
+    let mut rest = Vec::new();
+    for e in table.iter().filter(|e| e.ours(worker)) {
+        if e.who == Who::Hot {
+            let next = b.next();
+            b.emit(BPF_JMP | BPF_JEQ | BPF_K, e.nr, Target::Allow, next);
+        } else {
+            rest.push(e.nr);
+        }
+    }
+    rest.sort_unstable();
+    b.tree(&rest);
+
+    b.finish()
+}
+
+/// Number of syscalls the Rust daemon is allowed
+pub fn allowed_count() -> usize {
+    table().iter().filter(|e| e.ours(false)).count()
 }
 
 pub fn install_filter() -> bool {
-    // Each ALLOW_SYSCALL expands to 2 instructions: JEQ + RET_ALLOW
-    let filter: &[SockFilter] = &[
-        // Load architecture
-        bpf_stmt(BPF_LD | BPF_W | BPF_ABS, OFFSET_ARCH),
-        // Verify x86_64 -- kill if wrong arch
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, AUDIT_ARCH_X86_64, 1, 0),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS),
-        // Load syscall number
-        bpf_stmt(BPF_LD | BPF_W | BPF_ABS, OFFSET_NR),
-
-        // --- Core I/O ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::READ, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::WRITE, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::OPENAT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::CLOSE, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::FSTAT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::NEWFSTATAT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::LSEEK, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::PREAD64, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Memory ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MMAP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MUNMAP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MPROTECT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::BRK, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MREMAP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MADVISE, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- io_uring ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::IO_URING_SETUP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::IO_URING_ENTER, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::IO_URING_REGISTER, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Time ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::CLOCK_GETTIME, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::CLOCK_NANOSLEEP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::NANOSLEEP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETTIMEOFDAY, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- ioctl (DRM gamma + inotify) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::IOCTL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Process spawn (weather via curl) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::CLONE3, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::CLONE, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EXECVE, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::PIPE2, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::DUP2, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::DUP3, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::WAIT4, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SET_ROBUST_LIST, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RSEQ, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::PRLIMIT64, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::ARCH_PRCTL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SET_TID_ADDRESS, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Signals ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RT_SIGPROCMASK, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RT_SIGACTION, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RT_SIGRETURN, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SIGALTSTACK, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- File ops ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::UNLINK, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::UNLINKAT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MKDIR, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::MKDIRAT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::ACCESS, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::FACCESSAT2, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::FCNTL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETCWD, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::READLINK, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::READLINKAT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::STATX, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETRANDOM, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Process info ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETPID, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETUID, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETEUID, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETGID, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETEGID, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::KILL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::PRCTL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::FUTEX, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Exit ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EXIT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EXIT_GROUP, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Event fds (inotify + signalfd) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SIGNALFD4, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::INOTIFY_INIT1, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::INOTIFY_ADD_WATCH, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Socket I/O (X11/Wayland backend, curl child) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SOCKET, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::CONNECT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::BIND, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SETSOCKOPT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETSOCKOPT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SHUTDOWN, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SENDTO, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SENDMSG, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SENDMMSG, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RECVFROM, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RECVMSG, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::RECVMMSG, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETPEERNAME, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETSOCKNAME, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::POLL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::PPOLL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::WRITEV, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::UNAME, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- epoll + eventfd (curl child process) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EPOLL_CREATE1, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EPOLL_CTL, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EPOLL_WAIT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EPOLL_PWAIT, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::EVENTFD2, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- dlopen (backend loading) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::GETDENTS64, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // --- Rust-specific (allocator, runtime) ---
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SCHED_YIELD, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-        bpf_jump(BPF_JMP | BPF_JEQ | BPF_K, nr::SCHED_GETAFFINITY, 0, 1),
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
-
-        // Default: KILL
-        bpf_stmt(BPF_RET | BPF_K, SECCOMP_RET_KILL_PROCESS),
-    ];
+    install(false)
+}
+
+/// The fetch worker's program, installed in the worker before its loop
+#[cfg(feature = "noaa")]
+pub fn install_worker_filter() -> bool {
+    install(true)
+}
+
+fn install(worker: bool) -> bool {
+    let Some(filter) = build_filter(&table(), worker) else {
+        return false;
+    };
 
     let prog = SockFprog {
         len: filter.len() as u16,
@@ -377,3 +250,114 @@ pub fn install_filter() -> bool {
         ) == 0
     }
 }
+
+// --- Verification ---
+
+/// Just the opcodes the compiler emits; anything else is a failure.
+/// Returns (verdict, instructions executed).
+fn bpf_run(filter: &[SockFilter], arch: u32, nr: u32) -> (u32, usize) {
+    let mut acc = 0u32;
+    let mut pc = 0usize;
+    let mut steps = 0usize;
+    while pc < filter.len() {
+        let ins = filter[pc];
+        steps += 1;
+        match ins.code {
+            c if c == BPF_LD | BPF_W | BPF_ABS => match ins.k {
+                OFFSET_NR => acc = nr,
+                OFFSET_ARCH => acc = arch,
+                _ => return (0, steps),
+            },
+            c if c == BPF_JMP | BPF_JA | BPF_K => pc += ins.k as usize,
+            c if c == BPF_JMP | BPF_JEQ | BPF_K => {
+                pc += if acc == ins.k { ins.jt } else { ins.jf } as usize
+            }
+            c if c == BPF_JMP | BPF_JGE | BPF_K => {
+                pc += if acc >= ins.k { ins.jt } else { ins.jf } as usize
+            }
+            c if c == BPF_RET | BPF_K => return (ins.k, steps),
+            _ => return (0, steps),
+        }
+        pc += 1;
+    }
+    (0, steps)
+}
+
+/// Replay every syscall number through the compiled filters (interpreted,
+/// nothing is installed) and compare with syscalls.def. Returns the exit code.
+pub fn verify() -> i32 {
+    let table = table();
+    let daemon = verify_filter(&table, false, "seccomp", "allow");
+    let worker = verify_filter(&table, true, "seccomp worker", "worker allow");
+    if daemon && worker { 0 } else { 1 }
+}
+
+/// One program against the table; prints its summary under `label` and
+/// the allowed numbers after `list:`
+fn verify_filter(table: &[Entry], worker: bool, label: &str, list: &str) -> bool {
+    let Some(filter) = build_filter(table, worker) else {
+        eprintln!("{label}: filter does not compile (jump out of range)");
+        return false;
+    };
+    let wanted = |nr: u32| table.iter().any(|e| e.nr == nr && e.ours(worker));
+    let hot = |nr: u32| table.iter().any(|e| e.nr == nr && e.who == Who::Hot);
+
+    let (mut mismatches, mut checked) = (0, 0);
+    let (mut hot_max, mut tree_min, mut tree_max, mut deny_max) = (0, usize::MAX, 0, 0);
+    let mut allowed = Vec::new();
+
+    // x32 ABI numbers (bit 30) must not alias the x86_64 ones
+    let edges = [0x4000_0000u32, 0x4000_0000 | 16, 0x7fff_ffff, 0xffff_ffff];
+    for nr in (0..VERIFY_NR_MAX).chain(edges) {
+        let (verdict, steps) = bpf_run(&filter, AUDIT_ARCH_X86_64, nr);
+        let allow = verdict == SECCOMP_RET_ALLOW;
+        let want = wanted(nr);
+        checked += 1;
+        if allow != want {
+            eprintln!(
+                "{label}: nr {nr} {} by filter, {} by syscalls.def",
+                if allow { "allowed" } else { "killed" },
+                if want { "allowed" } else { "killed" }
+            );
+            mismatches += 1;
+        }
+        if !allow {
+            deny_max = deny_max.max(steps);
+            continue;
+        }
+        allowed.push(nr);
+        if hot(nr) {
+            hot_max = hot_max.max(steps);
+        } else {
+            tree_min = tree_min.min(steps);
+            tree_max = tree_max.max(steps);
+        }
+    }
+
+    // Another architecture never reaches the table
+    for e in table {
+        checked += 1;
+        if bpf_run(&filter, AUDIT_ARCH_I386, e.nr).0 != SECCOMP_RET_KILL_PROCESS {
+            eprintln!("{label}: nr {} allowed for i386", e.nr);
+            mismatches += 1;
+        }
+    }
+
+    println!(
+        "{label}: {} insns, {} allowed, {checked} cases checked, {mismatches} mismatches",
+        filter.len(),
+        allowed.len()
+    );
+    println!(
+        "{label}: insns per syscall: hot <= {hot_max}, tree {}-{tree_max}, denied <= {deny_max}",
+        if tree_min == usize::MAX { 0 } else { tree_min }
+    );
+    let nrs: Vec<String> = allowed
+        .iter()
+        .filter(|&&nr| nr < VERIFY_NR_MAX)
+        .map(|nr| nr.to_string())
+        .collect();
+    println!("{list}: {}", nrs.join(" "));
+
+    mismatches == 0
+}
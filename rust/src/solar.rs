@@ -3,6 +3,10 @@
 //! Port of the C23 NOAA solar equations.
 //! Julian day -> Julian century -> geometric mean longitude/anomaly ->
 //! equation of center -> apparent longitude -> declination -> hour angle.
+//!
+//! `positions` and `sunrise_sunset_batch` are the batch forms: one
+//! timezone lookup per call, one solve per day for all locations, and
+//! three solves per local day interpolated across the rows of that day.
 
 use std::f64::consts::PI;
 
@@ -149,18 +153,24 @@ pub fn position(when: i64, lat: f64, lon: f64) -> SunPosition {
     }
 }
 
-/// Calculate sunrise and sunset times for a given day and location
-pub fn sunrise_sunset(when: i64, lat: f64, lon: f64) -> Option<SunTimes> {
-    let mut lt: libc::tm = unsafe { std::mem::zeroed() };
-    let t = when;
-    unsafe { libc::localtime_r(&t, &mut lt) };
-
-    // Use noon of the given day
+/// Solar parameters at noon of the local date in `lt`
+fn noon_params(lt: &libc::tm) -> SolarParams {
     let jd = julian_day(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday, 12.0);
-    let jc = (jd - 2451545.0) / 36525.0;
+    compute_solar_params((jd - 2451545.0) / 36525.0)
+}
 
-    let sp = compute_solar_params(jc);
+/// Base midnight of the local date in `lt`, `day_offset` days on
+fn local_midnight(lt: &libc::tm, day_offset: i32) -> i64 {
+    let mut base: libc::tm = unsafe { std::mem::zeroed() };
+    base.tm_year = lt.tm_year;
+    base.tm_mon = lt.tm_mon;
+    base.tm_mday = lt.tm_mday + day_offset;
+    base.tm_isdst = -1;
+    unsafe { libc::mktime(&mut base) as i64 }
+}
 
+/// Rise and set at one location, given the day's parameters
+fn rise_set(sp: &SolarParams, tz_offset: f64, midnight: i64, lat: f64, lon: f64) -> Option<SunTimes> {
     // Hour angle for sunrise/sunset (zenith 90.833 degrees)
     let zenith = 90.833_f64;
     let lat_rad = deg2rad(lat);
@@ -175,21 +185,142 @@ pub fn sunrise_sunset(when: i64, lat: f64, lon: f64) -> Option<SunTimes> {
     }
 
     let ha = rad2deg(cos_ha.acos());
-    let tz_offset = get_tz_offset_hours();
 
     let sunrise_min = 720.0 - 4.0 * (lon + ha) - sp.eq_time + tz_offset * 60.0;
     let sunset_min = 720.0 - 4.0 * (lon - ha) - sp.eq_time + tz_offset * 60.0;
 
-    // Base midnight of the given day
-    let mut base: libc::tm = unsafe { std::mem::zeroed() };
-    base.tm_year = lt.tm_year;
-    base.tm_mon = lt.tm_mon;
-    base.tm_mday = lt.tm_mday;
-    base.tm_isdst = -1;
-    let midnight = unsafe { libc::mktime(&mut base) } as i64;
-
     Some(SunTimes {
         sunrise: midnight + (sunrise_min * 60.0) as i64,
         sunset: midnight + (sunset_min * 60.0) as i64,
     })
 }
+
+/// Calculate sunrise and sunset times for a given day and location
+pub fn sunrise_sunset(when: i64, lat: f64, lon: f64) -> Option<SunTimes> {
+    let mut lt: libc::tm = unsafe { std::mem::zeroed() };
+    let t = when;
+    unsafe { libc::localtime_r(&t, &mut lt) };
+
+    // Use noon of the given day
+    let sp = noon_params(&lt);
+    rise_set(&sp, get_tz_offset_hours(), local_midnight(&lt, 0), lat, lon)
+}
+
+// --- Batch ---
+
+/// Sunrise and sunset at each (`lat[i]`, `lon[i]`) for the date containing
+/// `when`, from one solar solve. Same results as `sunrise_sunset`; rows
+/// with no rise or set get `valid[i] = false` and zero times.
+pub fn sunrise_sunset_batch(when: i64, lat: &[f64], lon: &[f64],
+                            sunrise: &mut [i64], sunset: &mut [i64], valid: &mut [bool]) {
+    let mut lt: libc::tm = unsafe { std::mem::zeroed() };
+    unsafe { libc::localtime_r(&when, &mut lt) };
+
+    let sp = noon_params(&lt);
+    let tz_offset = get_tz_offset_hours();
+    let midnight = local_midnight(&lt, 0);
+
+    for i in 0..lat.len() {
+        let st = rise_set(&sp, tz_offset, midnight, lat[i], lon[i]);
+        sunrise[i] = st.as_ref().map_or(0, |s| s.sunrise);
+        sunset[i] = st.as_ref().map_or(0, |s| s.sunset);
+        valid[i] = st.is_some();
+    }
+}
+
+/// Rows `i..end` on the local date and UTC offset of row `i`, which `lt`
+/// receives. A run also ends where `when` steps backwards; a DST change
+/// inside the day is found by bisection.
+fn local_run(when: &[i64], i: usize, lt: &mut libc::tm) -> usize {
+    unsafe { libc::localtime_r(&when[i], lt) };
+    let day_end = local_midnight(lt, 1);
+
+    let mut end = i + 1;
+    while end < when.len() && when[end] >= when[end - 1] && when[end] < day_end {
+        end += 1;
+    }
+
+    let offset_at = |k: usize| {
+        let mut probe: libc::tm = unsafe { std::mem::zeroed() };
+        unsafe { libc::localtime_r(&when[k], &mut probe) };
+        probe.tm_gmtoff
+    };
+    if offset_at(end - 1) != lt.tm_gmtoff {
+        let (mut lo, mut hi) = (i, end - 1); // lo has lt's offset, hi does not
+        while hi - lo > 1 {
+            let mid = lo + (hi - lo) / 2;
+            if offset_at(mid) == lt.tm_gmtoff { lo = mid } else { hi = mid }
+        }
+        end = hi;
+    }
+    end
+}
+
+/// f(u) = f0 + u * (b + u * c) through (0, f0), (1/2, f1), (1, f2)
+#[derive(Clone, Copy)]
+struct Quad {
+    f0: f64,
+    b: f64,
+    c: f64,
+}
+
+impl Quad {
+    fn fit(f: [f64; 3]) -> Self {
+        Quad { f0: f[0], b: 4.0 * f[1] - 3.0 * f[0] - f[2], c: 2.0 * (f[0] - 2.0 * f[1] + f[2]) }
+    }
+
+    fn at(self, u: f64) -> f64 {
+        self.f0 + u * (self.b + u * self.c)
+    }
+}
+
+/// Sun elevation for each instant in `when` at one location, into
+/// `elevation`. About 1e-6 degrees from `position`, up to 1e-4 near the
+/// zenith; ascending `when` keeps the per-day runs long.
+pub fn positions(when: &[i64], lat: f64, lon: f64, elevation: &mut [f64]) {
+    let tz_offset = get_tz_offset_hours();
+    let lat_rad = deg2rad(lat);
+    let (sin_lat, cos_lat) = (lat_rad.sin(), lat_rad.cos());
+    let time_offset = 4.0 * lon - 60.0 * tz_offset;
+
+    let mut i = 0;
+    while i < when.len() {
+        let mut lt: libc::tm = unsafe { std::mem::zeroed() };
+        let end = local_run(when, i, &mut lt);
+
+        // Julian century of the local wall clock, as `position` reads it
+        let gmtoff = lt.tm_gmtoff as i64;
+        let local_base = when[i] + gmtoff
+            - (lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec) as i64;
+        let jd_base = julian_day(lt.tm_year + 1900, lt.tm_mon + 1, lt.tm_mday, 0.0);
+
+        let t0 = when[i];
+        let span = (when[end - 1] - t0) as f64;
+        let sec0 = (t0 + gmtoff - local_base) as f64;
+        let sp: [SolarParams; 3] = std::array::from_fn(|k| {
+            let jc = (jd_base + (sec0 + span * 0.5 * k as f64) / 86400.0 - 2451545.0) / 36525.0;
+            compute_solar_params(jc)
+        });
+        let sin_d = Quad::fit(std::array::from_fn(|k| deg2rad(sp[k].sun_declin).sin()));
+        let cos_d = Quad::fit(std::array::from_fn(|k| deg2rad(sp[k].sun_declin).cos()));
+        let eq = Quad::fit(std::array::from_fn(|k| sp[k].eq_time));
+
+        let inv_span = if span > 0.0 { 1.0 / span } else { 0.0 };
+
+        for k in i..end {
+            let u = (when[k] - t0) as f64 * inv_span;
+
+            // True solar time and hour angle
+            let tst = (when[k] + gmtoff - local_base) as f64 / 60.0 + eq.at(u) + time_offset;
+            let mut hour_angle = tst / 4.0 - 180.0;
+            if hour_angle < -180.0 {
+                hour_angle += 360.0;
+            }
+
+            let cos_zenith = (sin_lat * sin_d.at(u) + cos_lat * cos_d.at(u) * deg2rad(hour_angle).cos())
+                .clamp(-1.0, 1.0);
+            elevation[k] = 90.0 - rad2deg(cos_zenith.acos());
+        }
+        i = end;
+    }
+}
@@ -24,6 +24,8 @@ const IORING_ENTER_GETEVENTS: u32 = 1;
 
 // Opcodes (from enum in linux/io_uring.h)
 const IORING_OP_POLL_ADD: u8 = 6;
+#[cfg_attr(not(feature = "noaa"), allow(dead_code))]
+const IORING_OP_RECVMSG: u8 = 10;
 const IORING_OP_TIMEOUT: u8 = 11;
 const IORING_OP_ASYNC_CANCEL: u8 = 14;
 
@@ -39,6 +41,8 @@ pub const EV_SIGNAL: u64 = 2;
 pub const EV_TIMEOUT: u64 = 3;
 pub const EV_CANCEL: u64 = 4;
 pub const EV_WEATHER: u64 = 5;
+#[cfg_attr(not(feature = "noaa"), allow(dead_code))]
+pub const EV_WORKER: u64 = 6;
 
 /// Kernel struct io_sqring_offsets (40 bytes)
 #[repr(C)]
@@ -275,6 +279,23 @@ impl AbraxasRing {
         }
     }
 
+    /// Single-shot RECVMSG into msg; flags as for recvmsg(2). msg must stay
+    /// valid until the CQE is reaped.
+    #[cfg_attr(not(feature = "noaa"), allow(dead_code))]
+    pub fn prep_recvmsg(&mut self, fd: i32, msg: *mut libc::msghdr, flags: u32, user_data: u64) {
+        if let Some(sqe) = self.get_sqe() {
+            unsafe {
+                (*sqe).opcode = IORING_OP_RECVMSG;
+                (*sqe).fd = fd;
+                (*sqe).addr = msg as u64;
+                (*sqe).len = 1;
+                (*sqe).rw_flags = flags;
+                (*sqe).user_data = user_data;
+            }
+            self.commit_sqe();
+        }
+    }
+
     pub fn prep_timeout(&mut self, ts: &KernelTimespec, user_data: u64) {
         if let Some(sqe) = self.get_sqe() {
             unsafe {
@@ -6,17 +6,25 @@
 //!   2. GET that URL
 //!      -> extract first period's shortForecast, temperature, isDaytime
 //!
-//! Uses curl(1) child process for HTTP -- zero TLS dependencies.
+//! Uses curl(1) child process for HTTP -- zero TLS dependencies. The
+//! daemon's async fetch has a worker process run it (see Fetch worker).
 //! When compiled without the "noaa" feature, all functions are no-ops.
 
 use crate::config::WeatherData;
 use crate::now_epoch;
 
 #[cfg(feature = "noaa")]
-pub fn init() {}
+use std::os::unix::io::{AsRawFd, FromRawFd, OwnedFd};
+#[cfg(feature = "noaa")]
+use std::sync::atomic::{AtomicBool, AtomicI32, AtomicU32, Ordering};
 
+/// Every request's curl options; the URL follows
 #[cfg(feature = "noaa")]
-pub fn cleanup() {}
+const CURL_ARGS: [&str; 9] = [
+    "-s", "-f", "-L", "--max-time", "5",
+    "-H", "User-Agent: abraxas/7.0 (weather color temp daemon)",
+    "-H", "Accept: application/geo+json",
+];
 
 #[cfg(feature = "noaa")]
 pub fn fetch(lat: f64, lon: f64) -> WeatherData {
@@ -36,12 +44,8 @@ pub fn fetch(lat: f64, lon: f64) -> WeatherData {
 #[cfg(feature = "noaa")]
 fn http_get(url: &str) -> Result<String, Box<dyn std::error::Error>> {
     let output = std::process::Command::new("curl")
-        .args([
-            "-s", "-f", "-L", "--max-time", "5",
-            "-H", "User-Agent: abraxas/7.0 (weather color temp daemon)",
-            "-H", "Accept: application/geo+json",
-            url,
-        ])
+        .args(CURL_ARGS)
+        .arg(url)
         .output()?;
 
     if !output.status.success() {
@@ -55,21 +59,30 @@ fn http_get(url: &str) -> Result<String, Box<dyn std::error::Error>> {
 fn fetch_inner(lat: f64, lon: f64) -> Result<WeatherData, Box<dyn std::error::Error>> {
     // Step 1: Get grid point
     let url = format!("https://api.weather.gov/points/{:.4},{:.4}", lat, lon);
-    let body = http_get(&url)?;
-    let resp: serde_json::Value = serde_json::from_str(&body)?;
+    let forecast_url = parse_points(&http_get(&url)?)?;
 
-    let forecast_url = resp["properties"]["forecastHourly"]
+    // Step 2: Get hourly forecast
+    parse_hourly(&http_get(&forecast_url)?)
+}
+
+/// points response -> properties.forecastHourly URL
+#[cfg(feature = "noaa")]
+pub fn parse_points(body: &str) -> Result<String, Box<dyn std::error::Error>> {
+    let resp: serde_json::Value = serde_json::from_str(body)?;
+    let url = resp["properties"]["forecastHourly"]
         .as_str()
-        .ok_or("No forecastHourly URL")?
-        .to_string();
+        .ok_or("no forecastHourly URL")?;
+    Ok(url.to_string())
+}
 
-    // Step 2: Get hourly forecast
-    let body = http_get(&forecast_url)?;
-    let resp: serde_json::Value = serde_json::from_str(&body)?;
+/// hourly response -> first period's fields
+#[cfg(feature = "noaa")]
+pub fn parse_hourly(body: &str) -> Result<WeatherData, Box<dyn std::error::Error>> {
+    let resp: serde_json::Value = serde_json::from_str(body)?;
 
     let period = &resp["properties"]["periods"][0];
     if period.is_null() {
-        return Err("No forecast periods".into());
+        return Err("no forecast periods".into());
     }
 
     let short_forecast = period["shortForecast"]
@@ -134,6 +147,311 @@ fn cloud_cover_from_forecast(forecast: &str) -> i32 {
     0
 }
 
+// --- Fetch worker ---
+//
+// init() forks one worker before the daemon's sandbox goes up; after that
+// the daemon never creates a process, and seccomp has no clone or execve.
+// The worker runs curl for each request and hands curl's stdout pipe back
+// with SCM_RIGHTS, so the daemon reads a response exactly as it read its
+// own child's. SOCK_SEQPACKET keeps one message per datagram:
+//
+//   daemon -> worker  "G <seq>\n<url>"     fetch
+//   daemon -> worker  "K <seq>"            SIGKILL that request's curl
+//   worker -> daemon  "S <seq> <errno>"    started; carries the pipe if 0
+//   worker -> daemon  "X <seq> <code>"     curl's exit code, -1 if killed
+//
+// The worker serves one request at a time and exits when the socket
+// closes. It cannot be restarted under seccomp: once it is gone, the
+// daemon exits nonzero and its service manager restarts the whole thing.
+//
+// curl parses whatever the network sends, so the worker has a sandbox of
+// its own, which every curl inherits: a landlock ruleset with nothing
+// writable and the daemon's seccomp filter plus what spawning needs.
+
+#[cfg(feature = "noaa")]
+const WORKER_MSG_MAX: usize = 2048;
+
+#[cfg(feature = "noaa")]
+static WORKER_FD: AtomicI32 = AtomicI32::new(-1);
+#[cfg(feature = "noaa")]
+static WORKER_SEQ: AtomicU32 = AtomicU32::new(0);
+#[cfg(feature = "noaa")]
+static WORKER_GONE: AtomicBool = AtomicBool::new(false);
+
+#[cfg(feature = "noaa")]
+fn worker_send(sock: i32, msg: &str, fd: Option<i32>) -> bool {
+    let mut iov = libc::iovec {
+        iov_base: msg.as_ptr() as *mut libc::c_void,
+        iov_len: msg.len(),
+    };
+    // u64 storage keeps the cmsghdr aligned
+    let mut ctl = [0u64; 4];
+    let mut mh: libc::msghdr = unsafe { std::mem::zeroed() };
+    mh.msg_iov = &mut iov;
+    mh.msg_iovlen = 1;
+    if let Some(fd) = fd {
+        unsafe {
+            mh.msg_control = ctl.as_mut_ptr() as *mut libc::c_void;
+            mh.msg_controllen = libc::CMSG_SPACE(std::mem::size_of::<i32>() as u32) as usize;
+            let c = libc::CMSG_FIRSTHDR(&mh);
+            (*c).cmsg_level = libc::SOL_SOCKET;
+            (*c).cmsg_type = libc::SCM_RIGHTS;
+            (*c).cmsg_len = libc::CMSG_LEN(std::mem::size_of::<i32>() as u32) as usize;
+            std::ptr::write_unaligned(libc::CMSG_DATA(c) as *mut i32, fd);
+        }
+    }
+    unsafe { libc::sendmsg(sock, &mh, libc::MSG_NOSIGNAL) >= 0 }
+}
+
+/// Reap curl, killing it on a matching "K". Any other message that comes
+/// in meanwhile is the next request: it is left in msg, its length in
+/// *pending. Exits with the daemon.
+#[cfg(feature = "noaa")]
+fn worker_reap(
+    sock: i32,
+    child: &mut std::process::Child,
+    seq: u32,
+    msg: &mut [u8],
+    pending: &mut usize,
+) -> i32 {
+    let pidfd = unsafe { libc::syscall(libc::SYS_pidfd_open, child.id() as libc::pid_t, 0) } as i32;
+    while pidfd >= 0 {
+        let mut fds = [
+            libc::pollfd { fd: pidfd, events: libc::POLLIN, revents: 0 },
+            libc::pollfd { fd: sock, events: libc::POLLIN, revents: 0 },
+        ];
+        let nfds = if *pending > 0 { 1 } else { 2 };
+        if unsafe { libc::poll(fds.as_mut_ptr(), nfds, -1) } < 0 {
+            if std::io::Error::last_os_error().raw_os_error() == Some(libc::EINTR) {
+                continue;
+            }
+            break;
+        }
+        if fds[0].revents != 0 {
+            break;
+        }
+        if fds[1].revents == 0 {
+            continue;
+        }
+
+        let n = unsafe { libc::recv(sock, msg.as_mut_ptr() as *mut libc::c_void, msg.len(), 0) };
+        if n <= 0 {
+            let _ = child.kill();
+            let _ = child.wait();
+            unsafe { libc::_exit(0) };
+        }
+        let n = n as usize;
+        match std::str::from_utf8(&msg[..n]).ok().and_then(|m| m.strip_prefix("K ")) {
+            Some(k) => {
+                if k.parse::<u32>() == Ok(seq) {
+                    let _ = child.kill();
+                }
+            }
+            None => *pending = n,
+        }
+    }
+    if pidfd >= 0 {
+        unsafe { libc::close(pidfd) };
+    }
+
+    match child.wait() {
+        Ok(status) => status.code().unwrap_or(-1),
+        Err(_) => -1,
+    }
+}
+
+#[cfg(feature = "noaa")]
+fn worker_main(sock: i32, parent: libc::pid_t) -> ! {
+    unsafe {
+        // Die with the daemon, even if it was already gone before this
+        libc::prctl(libc::PR_SET_PDEATHSIG, libc::SIGKILL);
+        if libc::getppid() != parent {
+            libc::_exit(0);
+        }
+        libc::prctl(libc::PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0);
+
+        // Only the socket and stdio: no display, uring or inotify fds
+        if libc::dup2(sock, 3) < 0 {
+            libc::_exit(1);
+        }
+        libc::fcntl(3, libc::F_SETFD, libc::FD_CLOEXEC); // dup2 drops it; curl must not hold it
+        if libc::syscall(libc::SYS_close_range, 4u32, u32::MAX, 0u32) != 0 {
+            for fd in 4..1024 {
+                libc::close(fd);
+            }
+        }
+
+        // The daemon blocks SIGTERM/SIGINT for its signalfd
+        let mut none: libc::sigset_t = std::mem::zeroed();
+        libc::sigemptyset(&mut none);
+        libc::sigprocmask(libc::SIG_SETMASK, &none, std::ptr::null_mut());
+    }
+    let landlocked = crate::landlock::install_worker_sandbox();
+    let filtered = crate::seccomp::install_worker_filter();
+    eprintln!(
+        "[weather] fetch worker: landlock {}, seccomp {}",
+        if landlocked { "active" } else { "unavailable" },
+        if filtered { "active" } else { "failed" }
+    );
+    let sock = 3;
+
+    let mut msg = [0u8; WORKER_MSG_MAX];
+    let mut pending = 0usize;
+    loop {
+        let n = if pending > 0 {
+            pending as isize
+        } else {
+            unsafe { libc::recv(sock, msg.as_mut_ptr() as *mut libc::c_void, msg.len(), 0) }
+        };
+        if n <= 0 {
+            unsafe { libc::_exit(0) };
+        }
+        pending = 0;
+
+        // Anything but a well-formed "G" is a late "K"
+        let Some((seq, url)) = std::str::from_utf8(&msg[..n as usize])
+            .ok()
+            .and_then(|m| m.strip_prefix("G "))
+            .and_then(|m| m.split_once('\n'))
+            .and_then(|(seq, url)| Some((seq.parse::<u32>().ok()?, url.to_string())))
+        else {
+            continue;
+        };
+
+        let spawned = std::process::Command::new("curl")
+            .args(CURL_ARGS)
+            .arg(&url)
+            .stdout(std::process::Stdio::piped())
+            .spawn();
+        let mut child = match spawned {
+            Ok(c) => c,
+            Err(e) => {
+                let reply = format!("S {} {}", seq, e.raw_os_error().unwrap_or(libc::EIO));
+                let _ = worker_send(sock, &reply, None);
+                continue;
+            }
+        };
+        {
+            use std::os::unix::io::AsRawFd;
+            let stdout = child.stdout.take();
+            let fd = stdout.as_ref().map(|s| s.as_raw_fd());
+            let _ = worker_send(sock, &format!("S {} 0", seq), fd);
+        }
+
+        let code = worker_reap(sock, &mut child, seq, &mut msg, &mut pending);
+        let _ = worker_send(sock, &format!("X {} {}", seq, code), None);
+    }
+}
+
+/// Fork the fetch worker that runs curl for the async fetch. Call before
+/// the sandbox is installed: the daemon itself may not spawn afterwards.
+#[cfg(feature = "noaa")]
+pub fn init() {
+    if WORKER_FD.load(Ordering::Relaxed) >= 0 {
+        return;
+    }
+
+    let mut sv = [-1i32; 2];
+    if unsafe {
+        libc::socketpair(libc::AF_UNIX, libc::SOCK_SEQPACKET | libc::SOCK_CLOEXEC, 0, sv.as_mut_ptr())
+    } != 0
+    {
+        eprintln!("[weather] fetch worker: socketpair: {}", std::io::Error::last_os_error());
+        return;
+    }
+    let parent = unsafe { libc::getpid() };
+    let pid = unsafe { libc::fork() };
+    if pid == 0 {
+        unsafe { libc::close(sv[0]) };
+        worker_main(sv[1], parent);
+    }
+    unsafe { libc::close(sv[1]) };
+    if pid < 0 {
+        eprintln!("[weather] fetch worker: fork: {}", std::io::Error::last_os_error());
+        unsafe { libc::close(sv[0]) };
+        return;
+    }
+    WORKER_FD.store(sv[0], Ordering::Relaxed);
+    eprintln!("[weather] fetch worker pid {}", pid);
+}
+
+/// Close the worker's socket; it exits on its own. Not waited for, as
+/// seccomp has no wait4: the daemon is about to exit and init reaps it.
+#[cfg(feature = "noaa")]
+pub fn cleanup() {
+    let fd = WORKER_FD.swap(-1, Ordering::Relaxed);
+    if fd >= 0 {
+        unsafe { libc::close(fd) };
+    }
+}
+
+/// Nothing can fork a new one under seccomp
+#[cfg(feature = "noaa")]
+fn worker_lost() {
+    if !WORKER_GONE.swap(true, Ordering::Relaxed) {
+        eprintln!("[fatal] weather: fetch worker gone, exiting to be restarted");
+    }
+    cleanup();
+}
+
+/// The worker has died. None can be forked under the sandbox, so the
+/// daemon should shut down with a nonzero status and be restarted.
+#[cfg(feature = "noaa")]
+pub fn worker_gone() -> bool {
+    WORKER_GONE.load(Ordering::Relaxed)
+}
+
+/// The fetch worker's socket, -1 without one. The event loop keeps one
+/// recvmsg of FetchState::worker_msghdr() posted on it.
+#[cfg(feature = "noaa")]
+pub fn worker_fd() -> i32 {
+    WORKER_FD.load(Ordering::Relaxed)
+}
+
+#[cfg(feature = "noaa")]
+fn fetch_cancel(seq: u32) {
+    let sock = WORKER_FD.load(Ordering::Relaxed);
+    if sock >= 0 {
+        let msg = format!("K {}", seq);
+        unsafe {
+            libc::send(sock, msg.as_ptr() as *const libc::c_void, msg.len(),
+                       libc::MSG_DONTWAIT | libc::MSG_NOSIGNAL)
+        };
+    }
+}
+
+/// Ask the worker to start curl; the pipe arrives with the "S" reply.
+/// Returns the request's seq (never 0).
+#[cfg(feature = "noaa")]
+fn fetch_start(url: &str) -> Result<u32, Box<dyn std::error::Error>> {
+    let sock = WORKER_FD.load(Ordering::Relaxed);
+    if sock < 0 {
+        return Err("no fetch worker".into());
+    }
+
+    let mut seq = WORKER_SEQ.fetch_add(1, Ordering::Relaxed).wrapping_add(1);
+    if seq == 0 {
+        seq = WORKER_SEQ.fetch_add(1, Ordering::Relaxed).wrapping_add(1);
+    }
+    let msg = format!("G {}\n{}", seq, url);
+    if msg.len() > WORKER_MSG_MAX {
+        return Err("url too long".into());
+    }
+    // A few hundred bytes into an idle socket: never would block
+    let sent = unsafe {
+        libc::send(sock, msg.as_ptr() as *const libc::c_void, msg.len(),
+                   libc::MSG_DONTWAIT | libc::MSG_NOSIGNAL)
+    };
+    if sent < 0 {
+        let err = std::io::Error::last_os_error();
+        if matches!(err.raw_os_error(), Some(libc::EPIPE) | Some(libc::ECONNRESET)) {
+            worker_lost();
+        }
+        return Err(err.into());
+    }
+    Ok(seq)
+}
+
 // --- Async weather fetch (non-blocking, io_uring integrated) ---
 
 #[cfg(feature = "noaa")]
@@ -151,12 +469,27 @@ pub enum ReadResult {
     Done(Result<WeatherData, Box<dyn std::error::Error>>),
 }
 
+/// One worker reply, received by the event loop. Boxed so the posted
+/// msghdr's pointers stay put.
+#[cfg(feature = "noaa")]
+struct WorkerRx {
+    buf: [u8; 64],
+    ctl: [u64; 4], // u64 storage keeps the cmsghdr aligned
+    iov: libc::iovec,
+    mh: libc::msghdr,
+}
+
 #[cfg(feature = "noaa")]
 pub struct FetchState {
     pub phase: FetchPhase,
-    child: Option<std::process::Child>,
+    request: u32,   // fetch worker request in flight, 0 = none
+    started: bool,  // its "S" reply is in: the pipe, or a failure
+    exited: bool,   // its "X" reply is in
+    exit_code: i32, // curl's, -1 if it failed to run or was killed
+    pipe: Option<OwnedFd>,
     pub pipe_fd: i32,
     buf: Vec<u8>,
+    rx: Box<WorkerRx>,
     lat: f64,
     lon: f64,
 }
@@ -166,9 +499,14 @@ impl FetchState {
     pub fn new() -> Self {
         Self {
             phase: FetchPhase::Idle,
-            child: None,
+            request: 0,
+            started: false,
+            exited: false,
+            exit_code: -1,
+            pipe: None,
             pipe_fd: -1,
             buf: Vec::new(),
+            rx: Box::new(unsafe { std::mem::zeroed() }),
             lat: 0.0,
             lon: 0.0,
         }
@@ -178,34 +516,94 @@ impl FetchState {
         self.pipe_fd >= 0 && self.phase != FetchPhase::Idle
     }
 
-    fn spawn_curl(url: &str) -> Result<(std::process::Child, i32), Box<dyn std::error::Error>> {
-        use std::os::unix::io::AsRawFd;
-        use std::process::Stdio;
-
-        let child = std::process::Command::new("curl")
-            .args([
-                "-s", "-f", "-L", "--max-time", "5",
-                "-H", "User-Agent: abraxas/7.0 (weather color temp daemon)",
-                "-H", "Accept: application/geo+json",
-                url,
-            ])
-            .stdout(Stdio::piped())
-            .stderr(Stdio::inherit())
-            .spawn()?;
-
-        let fd = child.stdout.as_ref()
-            .ok_or("no stdout")?
-            .as_raw_fd();
-
-        let flags = unsafe { libc::fcntl(fd, libc::F_GETFL) };
-        if flags < 0 {
-            return Err("fcntl F_GETFL failed".into());
+    /// The fetch waits on the worker again
+    fn wait_for(&mut self, seq: u32) {
+        self.request = seq;
+        self.started = false;
+        self.exited = false;
+        self.exit_code = -1;
+    }
+
+    /// Reset and return the receive buffer for the next worker reply.
+    /// Valid until that receive completes; post it with MSG_CMSG_CLOEXEC.
+    pub fn worker_msghdr(&mut self) -> *mut libc::msghdr {
+        let rx = &mut *self.rx;
+        rx.iov = libc::iovec {
+            iov_base: rx.buf.as_mut_ptr() as *mut libc::c_void,
+            iov_len: rx.buf.len(),
+        };
+        rx.mh = unsafe { std::mem::zeroed() };
+        rx.mh.msg_iov = &mut rx.iov;
+        rx.mh.msg_iovlen = 1;
+        rx.mh.msg_control = rx.ctl.as_mut_ptr() as *mut libc::c_void;
+        rx.mh.msg_controllen = std::mem::size_of_val(&rx.ctl);
+        &mut rx.mh
+    }
+
+    /// A reply of n bytes (or -errno / 0 for a lost worker) has landed in
+    /// worker_msghdr(). Sets pipe_fd once curl runs. Returns true if the
+    /// fetch can advance: call read_response().
+    pub fn worker_reply(&mut self, n: i32) -> bool {
+        if n <= 0 {
+            if n == -libc::EINTR || n == -libc::ECANCELED {
+                return false;
+            }
+            worker_lost();
+            if self.request == 0 {
+                return false;
+            }
+            // Fail the fetch in flight: no pipe now, or no exit code later
+            self.started = true;
+            self.exited = true;
+            self.exit_code = -1;
+            return self.pipe.is_none();
         }
-        if unsafe { libc::fcntl(fd, libc::F_SETFL, flags | libc::O_NONBLOCK) } < 0 {
-            return Err("fcntl O_NONBLOCK failed".into());
+
+        let passed = unsafe {
+            let c = libc::CMSG_FIRSTHDR(&self.rx.mh);
+            if !c.is_null() && (*c).cmsg_level == libc::SOL_SOCKET && (*c).cmsg_type == libc::SCM_RIGHTS {
+                let fd = std::ptr::read_unaligned(libc::CMSG_DATA(c) as *const i32);
+                Some(OwnedFd::from_raw_fd(fd))
+            } else {
+                None
+            }
+        };
+
+        let reply = std::str::from_utf8(&self.rx.buf[..n as usize]).unwrap_or("");
+        let mut parts = reply.splitn(3, ' ');
+        let kind = parts.next().and_then(|t| t.chars().next());
+        let seq = parts.next().and_then(|s| s.parse::<u32>().ok());
+        let value = parts.next().and_then(|v| v.parse::<i32>().ok()).unwrap_or(-1);
+        if self.request == 0 || seq != Some(self.request) {
+            return false; // an abandoned request's; any pipe closes here
         }
 
-        Ok((child, fd))
+        match kind {
+            Some('S') if !self.started => {
+                self.started = true;
+                if let (0, Some(pipe)) = (value, passed) {
+                    let fd = pipe.as_raw_fd();
+                    let flags = unsafe { libc::fcntl(fd, libc::F_GETFL) };
+                    if flags >= 0 && unsafe { libc::fcntl(fd, libc::F_SETFL, flags | libc::O_NONBLOCK) } == 0 {
+                        self.pipe_fd = fd;
+                        self.pipe = Some(pipe);
+                        return false; // the loop arms the pipe
+                    }
+                    fetch_cancel(self.request);
+                } else if value > 0 {
+                    eprintln!("  curl: {}", std::io::Error::from_raw_os_error(value));
+                }
+                self.exited = true;
+                self.exit_code = -1;
+                true
+            }
+            Some('X') => {
+                self.exited = true;
+                self.exit_code = value;
+                self.started && self.pipe.is_none()
+            }
+            _ => false,
+        }
     }
 
     pub fn start(&mut self, lat: f64, lon: f64) -> i32 {
@@ -219,15 +617,14 @@ impl FetchState {
 
         let url = format!("https://api.weather.gov/points/{:.4},{:.4}", lat, lon);
 
-        match Self::spawn_curl(&url) {
-            Ok((child, fd)) => {
-                self.child = Some(child);
-                self.pipe_fd = fd;
+        match fetch_start(&url) {
+            Ok(seq) => {
+                self.wait_for(seq);
                 self.phase = FetchPhase::ReadingPoints;
-                fd
+                0
             }
             Err(e) => {
-                eprintln!("  spawn_curl failed: {}", e);
+                eprintln!("  curl: {}", e);
                 -1
             }
         }
@@ -259,31 +656,32 @@ impl FetchState {
         }
     }
 
+    /// Call when the pipe polls readable or worker_reply() returned true.
     pub fn read_response(&mut self) -> ReadResult {
-        match self.drain_pipe() {
-            Ok(false) => return ReadResult::Pending,
-            Err(()) => {
-                self.abort();
-                return ReadResult::Done(Err("pipe read error".into()));
-            }
-            Ok(true) => {} // EOF -- process below
+        if !self.started {
+            return ReadResult::Pending; // no "S" reply yet
         }
 
-        // EOF: reap child
-        self.pipe_fd = -1;
-        let status = match self.child.as_mut() {
-            Some(c) => c.wait(),
-            None => {
-                self.abort();
-                return ReadResult::Done(Err("no child".into()));
+        if self.pipe.is_some() {
+            match self.drain_pipe() {
+                Ok(false) => return ReadResult::Pending,
+                Err(()) => {
+                    self.abort();
+                    return ReadResult::Done(Err("pipe read error".into()));
+                }
+                Ok(true) => {} // EOF -- process below
             }
-        };
-        self.child = None;
+            self.pipe = None;
+            self.pipe_fd = -1;
+        }
+        if !self.exited {
+            return ReadResult::Pending; // its exit code is on the way
+        }
 
-        let ok = match status {
-            Ok(s) => s.success() && !self.buf.is_empty(),
-            Err(_) => false,
-        };
+        let code = self.exit_code;
+        self.request = 0;
+
+        let ok = code == 0 && !self.buf.is_empty();
 
         if !ok {
             self.phase = FetchPhase::Idle;
@@ -300,31 +698,22 @@ impl FetchState {
 
         match self.phase {
             FetchPhase::ReadingPoints => {
-                let resp: serde_json::Value = match serde_json::from_str(&body) {
-                    Ok(v) => v,
+                let forecast_url = match parse_points(&body) {
+                    Ok(u) => u,
                     Err(e) => {
                         self.phase = FetchPhase::Idle;
-                        return ReadResult::Done(Err(e.into()));
+                        return ReadResult::Done(Err(e));
                     }
                 };
 
-                let forecast_url = match resp["properties"]["forecastHourly"].as_str() {
-                    Some(u) => u.to_string(),
-                    None => {
-                        self.phase = FetchPhase::Idle;
-                        return ReadResult::Done(Err("no forecastHourly URL".into()));
-                    }
-                };
-
-                match Self::spawn_curl(&forecast_url) {
-                    Ok((child, fd)) => {
-                        self.child = Some(child);
-                        self.pipe_fd = fd;
+                match fetch_start(&forecast_url) {
+                    Ok(seq) => {
+                        self.wait_for(seq);
                         self.phase = FetchPhase::ReadingForecast;
                         ReadResult::NewPipe
                     }
                     Err(e) => {
-                        eprintln!("  spawn_curl (forecast) failed: {}", e);
+                        eprintln!("  curl (forecast): {}", e);
                         self.phase = FetchPhase::Idle;
                         ReadResult::Done(Err(e))
                     }
@@ -332,44 +721,18 @@ impl FetchState {
             }
             FetchPhase::ReadingForecast => {
                 self.phase = FetchPhase::Idle;
-
-                let resp: serde_json::Value = match serde_json::from_str(&body) {
-                    Ok(v) => v,
-                    Err(e) => return ReadResult::Done(Err(e.into())),
-                };
-
-                let period = &resp["properties"]["periods"][0];
-                if period.is_null() {
-                    return ReadResult::Done(Err("no forecast periods".into()));
-                }
-
-                let short_forecast = period["shortForecast"]
-                    .as_str()
-                    .unwrap_or("Unknown")
-                    .to_string();
-                let temperature = period["temperature"].as_f64().unwrap_or(0.0);
-                let is_day = period["isDaytime"].as_bool().unwrap_or(true);
-                let cloud_cover = cloud_cover_from_forecast(&short_forecast);
-
-                ReadResult::Done(Ok(WeatherData {
-                    cloud_cover,
-                    forecast: short_forecast,
-                    temperature,
-                    is_day,
-                    fetched_at: now_epoch(),
-                    has_error: false,
-                }))
+                ReadResult::Done(parse_hourly(&body))
             }
             FetchPhase::Idle => ReadResult::Done(Err("unexpected idle".into())),
         }
     }
 
     pub fn abort(&mut self) {
-        if let Some(ref mut child) = self.child {
-            let _ = child.kill();
-            let _ = child.wait();
+        if self.request != 0 && !self.exited {
+            fetch_cancel(self.request);
         }
-        self.child = None;
+        self.request = 0;
+        self.pipe = None;
         self.pipe_fd = -1;
         self.buf.clear();
         self.phase = FetchPhase::Idle;
@@ -383,6 +746,11 @@ pub fn init() {}
 #[cfg(not(feature = "noaa"))]
 pub fn cleanup() {}
 
+#[cfg(not(feature = "noaa"))]
+pub fn worker_gone() -> bool {
+    false
+}
+
 #[cfg(not(feature = "noaa"))]
 pub fn fetch(_lat: f64, _lon: f64) -> WeatherData {
     WeatherData {
@@ -1,94 +1,159 @@
 //! ZIP code database lookup.
 //!
-//! mmap'd binary search on us_zipcodes.bin.
-//! Entry format: 5 bytes ASCII ZIP + 4 bytes f32 lat + 4 bytes f32 lon.
-//! File header: 4 bytes u32 count (little-endian).
+//! mmap'd us_zipcodes.bin, two on-disk formats (all fields little-endian):
+//! - v1: u32 count, then count * 13-byte entries (5 ASCII ZIP + f32 lat +
+//!   f32 lon), sorted -- binary search.
+//! - v2: 16-byte header (magic "ABZD", u16 version, u16 record size,
+//!   u32 slots, u32 count), then 100,000 8-byte records (f32 lat, f32 lon)
+//!   indexed by the ZIP's numeric value; NaN marks an unused slot.
+//!
+//! Same layout as c23/include/zipdb.h; install.py writes v2.
 
 use std::fs::File;
 use std::os::unix::io::AsRawFd;
 use std::path::Path;
 
-const ENTRY_SIZE: usize = 13; // 5 + 4 + 4
-const HEADER_SIZE: usize = 4; // u32 count
+const V1_ENTRY_SIZE: usize = 13; // 5 + 4 + 4
+const V1_HEADER_SIZE: usize = 4; // u32 count
 
-pub fn lookup(db_path: &Path, zipcode: &str) -> Option<(f32, f32)> {
-    // Normalize to exactly 5 digits
-    let mut zip5 = [b'0'; 5];
-    let bytes = zipcode.as_bytes();
-    let len = bytes.len().min(5);
-    zip5[5 - len..].copy_from_slice(&bytes[..len]);
+const MAGIC: &[u8; 4] = b"ABZD";
+const VERSION: u16 = 2;
+const SLOTS: usize = 100_000;
+const V2_HEADER_SIZE: usize = 16;
+const V2_RECORD_SIZE: usize = 8;
 
-    let file = File::open(db_path).ok()?;
-    let file_size = file.metadata().ok()?.len() as usize;
+/// An open database; keep it across lookups to pay the mmap once.
+pub struct ZipDb {
+    data: &'static [u8],
+    version: u8,
+    count: usize,
+}
 
-    if file_size < HEADER_SIZE {
-        return None;
-    }
+fn read_u16(data: &[u8], off: usize) -> u16 {
+    u16::from_le_bytes([data[off], data[off + 1]])
+}
+
+fn read_u32(data: &[u8], off: usize) -> u32 {
+    u32::from_le_bytes([data[off], data[off + 1], data[off + 2], data[off + 3]])
+}
+
+fn read_f32(data: &[u8], off: usize) -> f32 {
+    f32::from_bits(read_u32(data, off))
+}
+
+fn is_v2(data: &[u8]) -> bool {
+    data.len() >= V2_HEADER_SIZE + SLOTS * V2_RECORD_SIZE
+        && &data[0..4] == MAGIC
+        && read_u16(data, 4) == VERSION
+        && read_u16(data, 6) as usize == V2_RECORD_SIZE
+        && read_u32(data, 8) as usize == SLOTS
+}
+
+impl ZipDb {
+    /// Map `db_path` read-only. None if missing or malformed.
+    pub fn open(db_path: &Path) -> Option<Self> {
+        let file = File::open(db_path).ok()?;
+        let file_size = file.metadata().ok()?.len() as usize;
 
-    // mmap the file
-    let data = unsafe {
-        let ptr = libc::mmap(
-            std::ptr::null_mut(),
-            file_size,
-            libc::PROT_READ,
-            libc::MAP_PRIVATE,
-            file.as_raw_fd(),
-            0,
-        );
-        if ptr == libc::MAP_FAILED {
+        if file_size < V1_HEADER_SIZE {
             return None;
         }
-        std::slice::from_raw_parts(ptr as *const u8, file_size)
-    };
 
-    // Read entry count (little-endian u32)
-    let count = u32::from_le_bytes([data[0], data[1], data[2], data[3]]) as usize;
+        // mmap the file; the mapping outlives the fd
+        let data: &'static [u8] = unsafe {
+            let ptr = libc::mmap(
+                std::ptr::null_mut(),
+                file_size,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            );
+            if ptr == libc::MAP_FAILED {
+                return None;
+            }
+            std::slice::from_raw_parts(ptr as *const u8, file_size)
+        };
+
+        let (version, count) = if is_v2(data) {
+            // Lookups touch one page each: don't read ahead the whole table
+            unsafe {
+                libc::madvise(data.as_ptr() as *mut libc::c_void, file_size, libc::MADV_RANDOM);
+            }
+            (2, read_u32(data, 12) as usize)
+        } else {
+            (1, read_u32(data, 0) as usize)
+        };
 
-    // Binary search
-    let mut low: usize = 0;
-    let mut high = count.wrapping_sub(1);
-    let mut result = None;
+        let db = ZipDb { data, version, count };
+        if version == 1 && (file_size - V1_HEADER_SIZE) / V1_ENTRY_SIZE < count {
+            return None; // Drop unmaps
+        }
+        Some(db)
+    }
 
-    while low <= high && high < count {
-        let mid = low + (high - low) / 2;
-        let offset = HEADER_SIZE + mid * ENTRY_SIZE;
+    /// Look up a ZIP (up to 5 digits, zero-padded on the left).
+    pub fn find(&self, zipcode: &str) -> Option<(f32, f32)> {
+        // Normalize to exactly 5 digits
+        let mut zip5 = [b'0'; 5];
+        let bytes = zipcode.as_bytes();
+        let len = bytes.len().min(5);
+        zip5[5 - len..].copy_from_slice(&bytes[..len]);
 
-        if offset + ENTRY_SIZE > file_size {
-            break;
+        if self.version == 2 {
+            self.find_v2(&zip5)
+        } else {
+            self.find_v1(&zip5)
         }
+    }
 
-        let entry_zip = &data[offset..offset + 5];
-        match entry_zip.cmp(&zip5) {
-            std::cmp::Ordering::Equal => {
-                let lat = f32::from_le_bytes([
-                    data[offset + 5],
-                    data[offset + 6],
-                    data[offset + 7],
-                    data[offset + 8],
-                ]);
-                let lon = f32::from_le_bytes([
-                    data[offset + 9],
-                    data[offset + 10],
-                    data[offset + 11],
-                    data[offset + 12],
-                ]);
-                result = Some((lat, lon));
-                break;
-            }
-            std::cmp::Ordering::Less => low = mid + 1,
-            std::cmp::Ordering::Greater => {
-                if mid == 0 {
-                    break;
+    fn find_v1(&self, zip5: &[u8; 5]) -> Option<(f32, f32)> {
+        let data = self.data;
+        let mut low: usize = 0;
+        let mut high = self.count;
+
+        while low < high {
+            let mid = low + (high - low) / 2;
+            let offset = V1_HEADER_SIZE + mid * V1_ENTRY_SIZE;
+
+            match data[offset..offset + 5].cmp(zip5) {
+                std::cmp::Ordering::Equal => {
+                    return Some((read_f32(data, offset + 5), read_f32(data, offset + 9)));
                 }
-                high = mid - 1;
+                std::cmp::Ordering::Less => low = mid + 1,
+                std::cmp::Ordering::Greater => high = mid,
+            }
+        }
+        None
+    }
+
+    fn find_v2(&self, zip5: &[u8; 5]) -> Option<(f32, f32)> {
+        let mut idx: usize = 0;
+        for &c in zip5 {
+            if !c.is_ascii_digit() {
+                return None;
             }
+            idx = idx * 10 + (c - b'0') as usize;
+        }
+
+        let offset = V2_HEADER_SIZE + idx * V2_RECORD_SIZE;
+        let lat = read_f32(self.data, offset);
+        if lat.is_nan() {
+            return None;
         }
+        Some((lat, read_f32(self.data, offset + 4)))
     }
+}
 
-    // munmap
-    unsafe {
-        libc::munmap(data.as_ptr() as *mut libc::c_void, file_size);
+impl Drop for ZipDb {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.data.as_ptr() as *mut libc::c_void, self.data.len());
+        }
     }
+}
 
-    result
+/// One-shot open + find.
+pub fn lookup(db_path: &Path, zipcode: &str) -> Option<(f32, f32)> {
+    ZipDb::open(db_path)?.find(zipcode)
 }
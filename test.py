@@ -8,8 +8,13 @@ Tests every subsystem across all implementations:
   - CLI commands (--help, --set-location, --set, --resume, --reset, --status)
   - Config cross-compatibility (C23 writes, Rust reads, and vice versa)
   - Override file format (identical JSON between implementations)
+  - seccomp filter (every syscall number replayed against syscalls.def)
   - Daemon lifecycle (start, signal handling, shutdown)
+  - Simulation (a day and a year of ticks on a virtual clock, C23)
+  - Allocations (zero heap allocations per steady-state tick, both;
+    C23 event loop wakeups through its abraxas-alloc-check build)
   - Solar calculation comparison (same input -> same output)
+  - Benchmark suite (C23 vs. Rust per case, regressions vs. bench/baseline.json)
   - Strace syscall audit (io_uring active, landlock active, no fallbacks)
 
 Modeled after muEmacs' Python test harness (pexpect/pyte pattern adapted
@@ -19,6 +24,8 @@ Usage:
     ./test.py                  Run all tests
     ./test.py --skip-build     Skip build phase (use existing binaries)
     ./test.py --verbose        Show command output
+    ./test.py --update-baseline  Rewrite bench/baseline.json from this run
+    ./test.py --bench-absolute   Gate benchmarks on raw baseline ns (baseline host)
 """
 
 import argparse
@@ -27,6 +34,7 @@ import json
 import os
 import re
 import signal
+import statistics
 import subprocess
 import sys
 import tempfile
@@ -42,14 +50,29 @@ SCRIPT_DIR = Path(__file__).parent.resolve()
 C23_DIR = SCRIPT_DIR / "c23"
 RUST_DIR = SCRIPT_DIR / "rust"
 C23_BIN = C23_DIR / "abraxas"
+C23_ALLOC_BIN = C23_DIR / "abraxas-alloc-check"   # make ALLOC_CHECK=1
 RUST_BIN = RUST_DIR / "target" / "release" / "abraxas"
 RUST_MUSL_BIN = RUST_DIR / "target" / "x86_64-unknown-linux-musl" / "release" / "abraxas"
+BENCH_FIXTURES = SCRIPT_DIR / "bench" / "fixtures"
+BENCH_BASELINE = SCRIPT_DIR / "bench" / "baseline.json"
+SYSCALLS_DEF = SCRIPT_DIR / "syscalls.def"
+
+# A case regresses when its p50 exceeds max(baseline * scale, floor) *
+# tolerance. The baseline is from one machine and the run may be on
+# another, so scale is this run's median p50/baseline over the cases above
+# the floor: a uniformly slower host moves every case and the median with
+# it, and only a case slower than its peers fails. --bench-absolute sets
+# scale to 1, for the host that wrote the baseline.
+BENCH_TOLERANCE = 3.0
+BENCH_FLOOR_NS = 100.0
 
 # Test location (Chicago, IL -- known NOAA coverage)
 TEST_LAT = 41.8781
 TEST_LON = -87.6298
 
 VERBOSE = False
+UPDATE_BASELINE = False
+BENCH_ABSOLUTE = False
 
 
 # =============================================================================
@@ -88,7 +111,7 @@ class Results:
         print(f"  [SKIP] {msg}{extra}")
         self.skipped += 1
 
-    def compare(self, label, c23_val, rust_val, unit="", ratio=True):
+    def compare(self, label, c23_val, rust_val, unit="", ratio=True, width=20):
         """Print a comparison row."""
         c23_str = f"{c23_val:>12} {unit}".rstrip()
         rust_str = f"{rust_val:>12} {unit}".rstrip()
@@ -96,7 +119,7 @@ class Results:
         if ratio and isinstance(c23_val, (int, float)) and c23_val > 0:
             r = rust_val / c23_val
             ratio_str = f"  ({r:.1f}x)"
-        print(f"  {label:<20} {c23_str:<20} {rust_str:<20}{ratio_str}")
+        print(f"  {label:<{width}} {c23_str:<20} {rust_str:<20}{ratio_str}")
 
     def summary(self):
         total = self.passed + self.failed + self.skipped
@@ -185,6 +208,16 @@ def test_build(R):
     else:
         R.fail("C23 build failed", result.stderr[:500])
 
+    # C23 with the malloc interposer, for the allocation checks
+    result = subprocess.run(
+        ["make", "-C", str(C23_DIR), "ALLOC_CHECK=1"],
+        capture_output=True, text=True, timeout=60,
+    )
+    if result.returncode == 0:
+        R.ok("C23 alloc-check variant builds (abraxas-alloc-check)")
+    else:
+        R.fail("C23 alloc-check build failed", result.stderr[:500])
+
     # Rust (glibc)
     result = subprocess.run(
         ["cargo", "build", "--release"],
@@ -1449,7 +1482,7 @@ def test_override_format(R):
 
         # Compare structure
         required_fields = {"active", "target_temp", "duration_minutes",
-                           "issued_at", "start_temp"}
+                           "issued_at", "start_temp", "fade_ms"}
         c23_fields = set(c23_data.keys())
         rust_fields = set(rust_data.keys())
 
@@ -1504,6 +1537,85 @@ def test_override_format(R):
 # EDGE CASES
 # =============================================================================
 
+def _syscalls_def():
+    """Parse syscalls.def -> list of (name, nr, who)."""
+    entries = []
+    for line in SYSCALLS_DEF.read_text().splitlines():
+        m = re.match(r"\s*SYSCALL\(\s*(\w+)\s*,\s*(\d+)\s*,\s*(\w+)\s*\)", line)
+        if m:
+            entries.append((m.group(1), int(m.group(2)), m.group(3)))
+    return entries
+
+
+def test_seccomp_filter(R):
+    R.section("SECCOMP: FILTER vs. syscalls.def")
+
+    if not SYSCALLS_DEF.exists():
+        R.skip("seccomp filter", "syscalls.def missing")
+        return
+    table = _syscalls_def()
+    if not table:
+        R.fail("syscalls.def has no SYSCALL() entries")
+        return
+
+    names = [n for n, _, _ in table]
+    nrs = [nr for _, nr, _ in table]
+    if len(set(names)) == len(names) and len(set(nrs)) == len(nrs):
+        R.ok(f"syscalls.def: {len(table)} unique entries")
+    else:
+        R.fail("syscalls.def has duplicate entries")
+
+    for name, binary in _all_binaries():
+        if not binary.exists():
+            R.skip(f"{name} seccomp filter", "binary not built")
+            continue
+
+        own = "C23" if name == "C23" else "RUST"
+        want = sorted(nr for _, nr, who in table if who in ("HOT", "BOTH", own))
+
+        ret, out, err = run_cmd([str(binary), "--seccomp-verify"])
+        if ret != 0:
+            R.fail(f"{name}: --seccomp-verify exit={ret}", (out + err)[:300])
+            continue
+        R.ok(f"{name}: every syscall number matches the table")
+
+        allow = next((l for l in out.splitlines() if l.startswith("allow:")), None)
+        got = sorted(int(x) for x in allow.split()[1:]) if allow else []
+        if got == want:
+            R.ok(f"{name}: filter allows exactly the {len(want)} {own}/BOTH/HOT entries")
+        else:
+            extra = sorted(set(got) - set(want))
+            missing = sorted(set(want) - set(got))
+            R.fail(f"{name}: filter differs from syscalls.def",
+                   f"extra={extra} missing={missing}")
+
+        # The fetch worker's filter: the same entries plus the WORKER ones
+        want_worker = sorted(nr for _, nr, who in table
+                             if who in ("HOT", "BOTH", own, "WORKER"))
+        line = next((l for l in out.splitlines() if l.startswith("worker allow:")), None)
+        got = sorted(int(x) for x in line.split()[2:]) if line else []
+        if got == want_worker:
+            R.ok(f"{name}: worker filter allows exactly those plus "
+                 f"{len(want_worker) - len(want)} WORKER entries")
+        else:
+            extra = sorted(set(got) - set(want_worker))
+            missing = sorted(set(want_worker) - set(got))
+            R.fail(f"{name}: worker filter differs from syscalls.def",
+                   f"extra={extra} missing={missing}")
+
+        cost = re.search(r"hot <= (\d+), tree (\d+)-(\d+), denied <= (\d+)", out)
+        if cost:
+            worst = max(int(cost.group(3)), int(cost.group(4)))
+            # A linear JEQ chain over the same table would be 2 per entry
+            if worst < len(want):
+                R.ok(f"{name}: <= {worst} insns per syscall "
+                     f"(hot <= {cost.group(1)}, linear chain up to {2 * len(want) + 4})")
+            else:
+                R.fail(f"{name}: filter is not logarithmic ({worst} insns)")
+        else:
+            R.fail(f"{name}: no cost line in --seccomp-verify output", out[:300])
+
+
 def test_edge_cases(R):
     R.section("EDGE CASES")
 
@@ -1564,6 +1676,188 @@ def test_edge_cases(R):
             cleanup_test_env(test_home)
 
 
+# =============================================================================
+# SIMULATION (virtual clock, null gamma backend)
+# =============================================================================
+
+# Summer solstice in Chicago: dawn ~05:15, dusk ~20:30 CDT, so the override
+# below ends and the clouds arrive in the middle of the day plateau
+SIM_TZ = "America/Chicago"
+SIM_EVENTS = """\
+# time             event
+2026-06-21 13:00   set 3000 30
+2026-06-21 15:00   resume
+2026-06-21 16:00   clouds 90
+2026-06-21 17:00   set 2500
+"""
+
+# The year must simulate well under a second (the request's budget)
+SIM_YEAR_MAX_MS = 1000.0
+
+
+def _record_temp_at(lines, when):
+    """Temperature in effect at local time 'when' (ISO, e.g. 2026-06-21T12:00)."""
+    temp = None
+    for line in lines:
+        stamp, _crtc, value = line.split()[:3]
+        if stamp > when:
+            break
+        if value.endswith("K"):
+            temp = int(value[:-1])
+    return temp
+
+
+def test_simulation(R):
+    """abraxas --simulate: the daemon's tick against a recording null backend.
+
+    One scripted day is checked through the ramp record: solar plateaus,
+    an override curve, resume, a weather change and auto-resume at dusk.
+    A year without recording checks throughput. C23 only.
+    """
+    R.section("SIMULATION (virtual clock)")
+
+    if not C23_BIN.exists():
+        R.skip("C23 simulation", "binary not built")
+        return
+    R.skip("Rust simulation", "C23 only")
+
+    test_home, config_dir, env = make_test_env()
+    env = {**env, "TZ": SIM_TZ}
+    try:
+        run_cmd([str(C23_BIN), "--set-location", f"{TEST_LAT},{TEST_LON}"], env=env)
+        events = os.path.join(test_home, "events.txt")
+        with open(events, "w") as f:
+            f.write(SIM_EVENTS)
+
+        records = []
+        for run in range(2):
+            record = os.path.join(test_home, f"ramps{run}.txt")
+            ret, out, err = run_cmd(
+                [str(C23_BIN), "--simulate", "2026-06-21", "2026-06-22",
+                 "--events", events, "--record", record], env=env
+            )
+            if ret != 0:
+                R.fail(f"C23: --simulate one day exit={ret}", err[-400:])
+                return
+            with open(record) as f:
+                records.append(f.read())
+
+        lines = records[0].splitlines()
+        expect = [
+            ("2026-06-21T03:00", 2900, "night"),
+            ("2026-06-21T12:00", 6500, "clear day"),
+            ("2026-06-21T14:00", 3000, "override target"),
+            ("2026-06-21T15:30", 6500, "resumed"),
+            ("2026-06-21T16:30", 4500, "dark day"),
+            ("2026-06-21T17:30", 2500, "instant override"),
+            ("2026-06-21T23:00", 2900, "auto-resumed night"),
+        ]
+        wrong = []
+        for when, temp, label in expect:
+            got = _record_temp_at(lines, when)
+            if got != temp:
+                wrong.append(f"{when} {label}: {got}K (expected {temp}K)")
+        if wrong:
+            R.fail("C23: simulated day follows the script", "\n".join(wrong))
+        else:
+            R.ok(f"C23: simulated day follows the script ({len(lines)} ramps recorded)")
+
+        if "Auto-resuming solar control" in err:
+            R.ok("C23: override auto-resumes before dusk")
+        else:
+            R.fail("C23: no auto-resume in simulated day", err[-400:])
+
+        if records[0] == records[1]:
+            R.ok("C23: simulation is deterministic (identical ramp records)")
+        else:
+            R.fail("C23: two runs recorded different ramps")
+
+        written = sorted(set(os.listdir(config_dir)) - {"config.ini"})
+        if not written:
+            R.ok("C23: simulation leaves the config dir alone")
+        else:
+            R.fail("C23: simulation wrote files", ", ".join(written))
+
+        ret, out, err = run_cmd(
+            [str(C23_BIN), "--simulate", "2026-01-01", "2027-01-01"], env=env, timeout=30
+        )
+        m = re.search(r"\[sim\] [\d.]+ days: (\d+) ticks, (\d+) set, ([\d.]+) ms", err)
+        if ret != 0 or not m:
+            R.fail(f"C23: --simulate one year exit={ret}", err[-400:])
+        else:
+            ticks, ms = int(m.group(1)), float(m.group(3))
+            if ms < SIM_YEAR_MAX_MS:
+                R.ok(f"C23: one year, {ticks} ticks in {ms:.0f} ms")
+            else:
+                R.fail(f"C23: one year took {ms:.0f} ms (budget {SIM_YEAR_MAX_MS:.0f} ms)")
+    finally:
+        cleanup_test_env(test_home)
+
+
+def test_alloc_check(R):
+    """abraxas --alloc-check: heap allocations made by the steady-state tick.
+
+    Both implementations tick three simulated days against their null
+    backend and count allocations after the first: C23 through the malloc
+    interposer of its abraxas-alloc-check build, Rust through its counting
+    global allocator. Any count above zero is a regression for the
+    long-running daemon. The C23 check build then runs as a daemon through
+    a fade, counting its event loop's timer and frame wakeups.
+    """
+    R.section("ALLOCATIONS (steady-state tick)")
+
+    test_home, _, env = make_test_env()
+    env = {**env, "TZ": SIM_TZ}
+    try:
+        bins = [(n, C23_ALLOC_BIN if n == "C23" else b) for n, b in _all_binaries()]
+        for name, binary in bins:
+            if not binary.exists():
+                R.skip(f"{name} alloc-check", "binary not built")
+                continue
+            run_cmd([str(binary), "--set-location", f"{TEST_LAT},{TEST_LON}"], env=env)
+            ret, out, err = run_cmd([str(binary), "--alloc-check"], env=env, timeout=30)
+            m = re.search(r"alloc-check: (\d+) ticks, (\d+) transition steps, "
+                          r"(\d+) heap allocations", out)
+            if not m:
+                R.fail(f"{name}: --alloc-check exit={ret}", (out + err)[-400:])
+            elif ret == 0 and int(m.group(3)) == 0:
+                R.ok(f"{name}: 0 allocations over {m.group(1)} ticks "
+                     f"({m.group(2)} transition steps)")
+            else:
+                R.fail(f"{name}: steady-state tick allocated", m.group(0))
+    finally:
+        cleanup_test_env(test_home)
+
+    if not C23_ALLOC_BIN.exists():
+        R.skip("C23 event loop alloc-check", "abraxas-alloc-check not built")
+        return
+    test_home, _, env = make_test_env()
+    proc = None
+    try:
+        run_cmd([str(C23_ALLOC_BIN), "--set-location", f"{TEST_LAT},{TEST_LON}"], env=env)
+        proc, skip = _start_daemon(C23_ALLOC_BIN, env)
+        if proc is None:
+            R.skip("C23 event loop alloc-check", skip)
+            return
+        run_cmd([str(C23_ALLOC_BIN), "--set", "3000", "1"], env=env)
+        time.sleep(4)
+        output = _stop_daemon(proc) or ""
+        proc = None
+        m = re.search(r"\[alloc-check\] (\d+) steady-state wakeups, (\d+) heap allocations",
+                      output)
+        if not m and not _daemon_reached_event_loop(output):
+            R.skip("C23 event loop alloc-check", "no gamma backend")
+        elif not m:
+            R.fail("C23: event loop alloc-check: no summary", output[-400:])
+        elif int(m.group(2)) == 0:
+            R.ok(f"C23: 0 allocations over {m.group(1)} steady-state event loop wakeups")
+        else:
+            R.fail("C23: steady-state event loop allocated", m.group(0))
+    finally:
+        if proc:
+            _kill_daemon(proc)
+        cleanup_test_env(test_home)
+
 # =============================================================================
 # NOAA WEATHER API (live fetch -- NYC)
 # =============================================================================
@@ -1576,7 +1870,7 @@ def test_weather_api(R):
     """Live NOAA weather fetch via --refresh for both C23 and Rust.
 
     Uses NYC coordinates. Requires network access and curl(1).
-    Tests that the seccomp filter allows curl child processes to complete.
+    With no daemon running, --refresh runs curl itself, outside any sandbox.
     """
     R.section("NOAA WEATHER API (NYC)")
 
@@ -1687,10 +1981,89 @@ def test_performance(R):
         print()
 
         R.ok("Performance comparison complete")
+
+        test_benchmark_suite(R, env)
     finally:
         cleanup_test_env(test_home)
 
 
+def run_benchmark(binary, env):
+    """Run --benchmark --json against the fixture corpus, return the document."""
+    code, out, err = run_cmd([str(binary), "--benchmark", "--json",
+                              "--fixtures", str(BENCH_FIXTURES)], env=env, timeout=120)
+    if code != 0:
+        return None, f"exit {code}: {err.strip()[:200]}"
+    try:
+        doc = json.loads(out)
+    except json.JSONDecodeError as e:
+        return None, f"invalid JSON: {e}"
+    if not isinstance(doc.get("cases"), list) or not doc["cases"]:
+        return None, "no cases"
+    return doc, None
+
+
+def test_benchmark_suite(R, env):
+    docs = {}
+    for impl, binary in (("c23", C23_BIN), ("rust", RUST_BIN)):
+        doc, err = run_benchmark(binary, env)
+        if doc is None:
+            R.fail(f"--benchmark --json ({impl})", err)
+            continue
+        if doc.get("implementation") != impl:
+            R.fail(f"--benchmark --json ({impl})",
+                   f"implementation = {doc.get('implementation')!r}")
+            continue
+        R.ok(f"--benchmark --json ({impl}): {len(doc['cases'])} cases, "
+             f"{len(doc.get('skipped', []))} skipped")
+        docs[impl] = doc
+
+    p50 = {impl: {c["name"]: c["p50_ns"] for c in doc["cases"]}
+           for impl, doc in docs.items()}
+
+    # Side by side for the cases both implementations ran
+    if len(p50) == 2:
+        common = [n for n in p50["c23"] if n in p50["rust"]]
+        print(f"\n  {'p50 per call':<32} {'C23':>20} {'Rust':>20}")
+        print(f"  {'-' * 72}")
+        for name in common:
+            R.compare(name, round(p50["c23"][name], 1),
+                      round(p50["rust"][name], 1), "ns", width=32)
+        print()
+
+    if UPDATE_BASELINE:
+        if len(p50) != 2:
+            R.fail("Benchmark baseline", "both implementations must run to update it")
+            return
+        BENCH_BASELINE.write_text(json.dumps(p50, indent=2, sort_keys=True) + "\n")
+        R.ok(f"Benchmark baseline written to {BENCH_BASELINE.relative_to(SCRIPT_DIR)}")
+        return
+
+    if not BENCH_BASELINE.exists():
+        R.skip("Benchmark regressions", "no bench/baseline.json (--update-baseline)")
+        return
+    baseline = json.loads(BENCH_BASELINE.read_text())
+
+    for impl, cases in p50.items():
+        base = baseline.get(impl, {})
+        checked = [n for n in cases if n in base]
+        if not checked:
+            R.skip(f"Benchmark regressions ({impl})", "no cases in baseline")
+            continue
+
+        ratios = [cases[n] / base[n] for n in checked if base[n] >= BENCH_FLOOR_NS]
+        scale = 1.0 if BENCH_ABSOLUTE or not ratios else statistics.median(ratios)
+        slow = [f"{n}: {cases[n]:.0f} ns vs. baseline {base[n]:.0f} ns"
+                for n in checked
+                if cases[n] > max(base[n] * scale, BENCH_FLOOR_NS) * BENCH_TOLERANCE]
+        against = f"{BENCH_TOLERANCE:.0f}x baseline (host scale {scale:.2f})"
+        if slow:
+            R.fail(f"Benchmark regressions ({impl}): {len(slow)} of {len(checked)} "
+                   f"cases over {against}", "\n".join(slow))
+        else:
+            R.ok(f"Benchmark regressions ({impl}): {len(checked)} cases "
+                 f"within {against}")
+
+
 # =============================================================================
 # STRACE: SYSCALL AUDIT
 # =============================================================================
@@ -1905,6 +2278,9 @@ def run_tests(skip_build=False):
     # Edge cases
     test_edge_cases(R)
 
+    # seccomp filter
+    test_seccomp_filter(R)
+
     # Daemon tests
     test_daemon_lifecycle(R)
     test_daemon_set_response(R)
@@ -1914,6 +2290,10 @@ def run_tests(skip_build=False):
     test_sigterm_responsiveness(R)
     test_sigterm_during_gamma_retry(R)
 
+    # Virtual-clock simulation
+    test_simulation(R)
+    test_alloc_check(R)
+
     # NOAA weather API (live)
     test_weather_api(R)
 
@@ -1934,11 +2314,18 @@ def main():
                         help="Skip build phase, use existing binaries")
     parser.add_argument("--verbose", action="store_true",
                         help="Show command output")
+    parser.add_argument("--update-baseline", action="store_true",
+                        help="Rewrite bench/baseline.json from this run's benchmark")
+    parser.add_argument("--bench-absolute", action="store_true",
+                        help="Compare benchmark ns to the baseline unscaled "
+                             "(on the host that wrote it)")
 
     args = parser.parse_args()
 
-    global VERBOSE
+    global VERBOSE, UPDATE_BASELINE, BENCH_ABSOLUTE
     VERBOSE = args.verbose
+    UPDATE_BASELINE = args.update_baseline
+    BENCH_ABSOLUTE = args.bench_absolute
 
     success = run_tests(skip_build=args.skip_build)
     sys.exit(0 if success else 1)